@@ -51,11 +51,15 @@ AccountList * gnc_account_get_descendants_sorted (const Account *account);
 %newobject gnc_accounts_and_all_descendants;
 AccountList * gnc_accounts_and_all_descendants (AccountList *accounts);
 
+%newobject xaccAccountGetSplitList;
+SplitList * xaccAccountGetSplitList (const Account *account);
+
 %ignore gnc_account_get_children;
 %ignore gnc_account_get_children_sorted;
 %ignore gnc_account_get_descendants;
 %ignore gnc_account_get_descendants_sorted;
 %ignore gnc_accounts_and_all_descendants;
+%ignore xaccAccountGetSplitList;
 %include <Account.h>
 
 %include <Transaction.h>
@@ -196,6 +196,10 @@ functions. */
 %typemap(in) char * action;
 
 %include <policy.h>
+/* The batch conversions take C arrays; Scheme callers loop over
+   gnc-pricedb-convert-balance-nearest-price-t64 instead. */
+%ignore gnc_pricedb_convert_balances_nearest_price_t64;
+%ignore gnc_pricedb_convert_balances_nearest_before_price_t64;
 %include <gnc-pricedb.h>
 
 QofSession * qof_session_new (QofBook* book);
@@ -97,6 +97,20 @@ function(gnc_add_test _TARGET _SOURCE_FILES TEST_INCLUDE_VAR_NAME TEST_LIBS_VAR_
   add_dependencies(check ${_TARGET})
 endfunction()
 
+# Benchmarks are built on demand by the "benchmark" target and are not
+# registered with ctest because they are meant to be run by hand on
+# large synthetic data sets. They share the helpers in
+# common/test-core/gnc-bench.hpp.
+function(gnc_add_benchmark _TARGET _SOURCE_FILES BENCH_INCLUDE_VAR_NAME BENCH_LIBS_VAR_NAME)
+  set(BENCH_INCLUDE_DIRS ${${BENCH_INCLUDE_VAR_NAME}} ${CMAKE_SOURCE_DIR}/common/test-core)
+  set(BENCH_LIBS ${${BENCH_LIBS_VAR_NAME}})
+  set_source_files_properties (${_SOURCE_FILES} PROPERTIES OBJECT_DEPENDS ${CONFIG_H})
+  add_executable(${_TARGET} EXCLUDE_FROM_ALL ${_SOURCE_FILES})
+  target_link_libraries(${_TARGET} ${BENCH_LIBS})
+  target_include_directories(${_TARGET} PRIVATE ${BENCH_INCLUDE_DIRS})
+  add_dependencies(benchmark ${_TARGET})
+endfunction()
+
 function(gnc_add_test_with_guile _TARGET _SOURCE_FILES TEST_INCLUDE_VAR_NAME TEST_LIBS_VAR_NAME)
   get_guile_env()
   gnc_add_test(${_TARGET} "${_SOURCE_FILES}" "${TEST_INCLUDE_VAR_NAME}" "${TEST_LIBS_VAR_NAME}"
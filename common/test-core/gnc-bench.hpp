@@ -0,0 +1,50 @@
+/********************************************************************
+ * gnc-bench.hpp: Helpers shared by the benchmark programs.         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/* Programs added with gnc_add_benchmark get this directory on their
+ * include path. They time their phases with Clock and elapsed_ms and
+ * take their sizes from optional positional arguments. */
+
+#ifndef GNC_BENCH_HPP
+#define GNC_BENCH_HPP
+
+#include <chrono>
+#include <cstdlib>
+
+using Clock = std::chrono::steady_clock;
+
+/* Milliseconds since start. */
+static inline double
+elapsed_ms (Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now () - start).count ();
+}
+
+/* The integer in argv[index], or fallback if there are fewer arguments. */
+static inline int
+bench_arg (int argc, char** argv, int index, int fallback)
+{
+    return argc > index ? atoi (argv[index]) : fallback;
+}
+
+#endif /* GNC_BENCH_HPP */
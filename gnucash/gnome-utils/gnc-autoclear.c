@@ -82,7 +82,8 @@ gnc_account_get_autoclear_splits (Account *account, gnc_numeric toclear_value,
                                   g_free, NULL);
 
     /* Extract which splits are not cleared and compute the amount we have to clear */
-    for (GList *node = xaccAccountGetSplitList (account); node; node = node->next)
+    GList *splits = xaccAccountGetSplitList (account);
+    for (GList *node = splits; node; node = node->next)
     {
         Split *split = (Split *)node->data;
 
@@ -92,6 +93,7 @@ gnc_account_get_autoclear_splits (Account *account, gnc_numeric toclear_value,
             toclear_value = gnc_numeric_sub_fixed
                 (toclear_value, xaccSplitGetAmount (split));
     }
+    g_list_free (splits);
 
     if (gnc_numeric_zero_p (toclear_value))
     {
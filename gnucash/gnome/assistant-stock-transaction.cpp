@@ -31,6 +31,7 @@
 #include <optional>
 #include <stdexcept>
 
+#include "Account.hpp"
 #include "Transaction.h"
 #include "engine-helpers.h"
 #include "dialog-utils.h"
@@ -730,10 +731,10 @@ refresh_page_finish (StockTransactionInfo *info)
     // the later stock transactions will be invalidated. warn the user
     // to review them.
     auto new_date = gnc_date_edit_get_date_end (GNC_DATE_EDIT (info->date_edit));
-    auto last_split_node = g_list_last (xaccAccountGetSplitList (info->acct));
-    if (last_split_node)
+    const auto& splits = xaccAccountGetSplits (info->acct);
+    if (!splits.empty())
     {
-        auto last_split = static_cast<const Split*> (last_split_node->data);
+        auto last_split = splits.back();
         auto last_split_date = xaccTransGetDate (xaccSplitGetParent (last_split));
         if (new_date <= last_split_date)
         {
@@ -231,6 +231,7 @@ lv_show_splits_free (GNCLotViewer *lv)
             filtered_list = g_list_prepend (filtered_list, split);
         }
     }
+    g_list_free (split_list);
     filtered_list = g_list_reverse (filtered_list);
 
     /* display list */
@@ -849,6 +849,7 @@ gnc_sxed_check_consistent (GncSxEditorDialog *sxed)
         g_hash_table_foreach (txns, set_sums_to_zero, NULL);
 
         splitCount += g_list_length (splitList);
+        g_list_free (splitList);
 
         xaccAccountForEachTransaction (tmpl_acct, check_transaction_splits, &sd);
 
@@ -1511,6 +1512,7 @@ schedXact_editor_populate (GncSxEditorDialog *sxed)
         {
             splitReg = gnc_ledger_display_get_split_register (sxed->ledger);
             gnc_split_register_load (splitReg, splitList, NULL);
+            g_list_free (splitList);
         } /* otherwise, use the existing stuff. */
     }
 
@@ -1147,17 +1147,17 @@ delete_account_helper (Account * account, gpointer data)
     if (splits)
     {
         helper_res->has_splits = TRUE;
-        while (splits)
+        for (GList *node = splits; node; node = node->next)
         {
-            Split *s = splits->data;
+            Split *s = node->data;
             Transaction *txn = xaccSplitGetParent (s);
             if (xaccTransGetReadOnly (txn))
             {
                 helper_res->has_ro_splits = TRUE;
                 break;
             }
-            splits = splits->next;
         }
+        g_list_free (splits);
     }
 
     return GINT_TO_POINTER (helper_res->has_splits || helper_res->has_ro_splits);
@@ -1383,7 +1383,7 @@ account_delete_dialog (Account *account, GtkWindow *parent, Adopters* adopt)
     gchar *title = NULL;
     GtkBuilder *builder = gtk_builder_new();
     gchar *acct_name = gnc_account_get_full_name(account);
-    GList* splits = xaccAccountGetSplitList(account);
+    gboolean has_splits = (xaccAccountGetSplitsSize (account) != 0);
     GList* filter = g_list_prepend(NULL, (gpointer)xaccAccountGetType(account));
 
     if (!acct_name)
@@ -1416,7 +1416,7 @@ account_delete_dialog (Account *account, GtkWindow *parent, Adopters* adopt)
                   account, FALSE);
 
     // Does the selected account have splits
-    if (splits)
+    if (has_splits)
     {
         delete_helper_t delete_res2 = { FALSE, FALSE };
 
@@ -1537,7 +1537,7 @@ gnc_plugin_page_account_tree_cmd_delete_account (GSimpleAction *simple,
     }
 
     // If no transaction or children just delete it.
-    if (!(xaccAccountGetSplitList (account) != NULL ||
+    if (!(xaccAccountGetSplitsSize (account) != 0 ||
           gnc_account_n_children (account)))
     {
         do_delete_account (account, NULL, NULL, NULL);
@@ -1581,7 +1581,7 @@ confirm_delete_account (GSimpleAction *simple, GncPluginPageAccountTree *page,
                         delete_helper_t delete_res)
 {
     Account *account = gnc_plugin_page_account_tree_get_current_account (page);
-    GList* splits = xaccAccountGetSplitList(account);
+    gboolean has_splits = (xaccAccountGetSplitsSize (account) != 0);
     GtkWidget* window = gnc_plugin_page_get_window(GNC_PLUGIN_PAGE(page));
     gint response;
 
@@ -1595,7 +1595,7 @@ confirm_delete_account (GSimpleAction *simple, GncPluginPageAccountTree *page,
                                 acct_name);
     g_free(acct_name);
 
-    if (splits)
+    if (has_splits)
     {
         if (ta)
         {
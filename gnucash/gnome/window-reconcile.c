@@ -1612,7 +1612,7 @@ recn_set_watches_one_account (gpointer data, gpointer user_data)
 {
     Account *account = (Account *)data;
     RecnWindow *recnData = (RecnWindow *)user_data;
-    GList *node;
+    GList *node, *splits;
 
     /* add a watch on the account */
     gnc_gui_component_watch_entity (recnData->component_id,
@@ -1620,7 +1620,8 @@ recn_set_watches_one_account (gpointer data, gpointer user_data)
                                     QOF_EVENT_MODIFY | QOF_EVENT_DESTROY);
 
     /* add a watch on each unreconciled or cleared split for the account */
-    for (node = xaccAccountGetSplitList (account); node; node = node->next)
+    splits = xaccAccountGetSplitList (account);
+    for (node = splits; node; node = node->next)
     {
         Split *split = node->data;
         Transaction *trans;
@@ -1644,6 +1645,7 @@ recn_set_watches_one_account (gpointer data, gpointer user_data)
             break;
         }
     }
+    g_list_free (splits);
 }
 
 
@@ -1941,7 +1943,8 @@ recnWindowWithBalance (GtkWidget *parent, Account *account, gnc_numeric new_endi
         GtkWidget *image = gtk_image_new_from_icon_name
             ("dialog-warning", GTK_ICON_SIZE_SMALL_TOOLBAR);
 
-        for (GList *n = xaccAccountGetSplitList (account); n; n = n->next)
+        GList *splits = xaccAccountGetSplitList (account);
+        for (GList *n = splits; n; n = n->next)
         {
             Split* split = n->data;
             time64 recn_date = xaccSplitGetDateReconciled (split);
@@ -1969,6 +1972,7 @@ use Find Transactions to find them, unreconcile, and re-reconcile."));
             gtk_box_reorder_child (GTK_BOX(box), image, 0);
             break;
         }
+        g_list_free (splits);
     }
 
     /* The main area */
@@ -2260,6 +2264,7 @@ find_payment_account(Account *account)
 {
     GList *list;
     GList *node;
+    Account *retval = NULL;
 
     if (account == NULL)
         return NULL;
@@ -2302,11 +2307,17 @@ find_payment_account(Account *account)
             type = xaccAccountGetType(a);
             if ((type == ACCT_TYPE_BANK) || (type == ACCT_TYPE_CASH) ||
                     (type == ACCT_TYPE_ASSET))
-                return a;
+            {
+                retval = a;
+                break;
+            }
         }
+        if (retval)
+            break;
     }
+    g_list_free (list);
 
-    return NULL;
+    return retval;
 }
 
 typedef void (*AccountProc) (Account *a);
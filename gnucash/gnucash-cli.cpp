@@ -66,6 +66,8 @@ namespace Gnucash {
         boost::optional <std::string> m_report_name;
         boost::optional <std::string> m_export_type;
         boost::optional <std::string> m_output_file;
+
+        std::vector<std::string> m_journal_cmd;
     };
 
 }
@@ -124,6 +126,15 @@ may be specified to describe some saved options.\n"
     m_opt_desc_display->add (report_options);
     m_opt_desc_all.add (report_options);
 
+    bpo::options_description journal_options(_("Transaction Journal Options"));
+    journal_options.add_options()
+    ("journal,J", bpo::value<std::vector<std::string>> (&m_journal_cmd)->multitoken(),
+     _("Execute transaction journal related commands. The following commands are supported.\n\n"
+       "  text: \tConvert a binary transaction journal to a text .log file.\n"
+       "        \tThis must be followed with the journal and the name of the text file to write.\n"));
+    m_opt_desc_display->add (journal_options);
+    m_opt_desc_all.add (journal_options);
+
 }
 
 int
@@ -217,6 +228,25 @@ Gnucash::GnucashCli::start ([[maybe_unused]] int argc, [[maybe_unused]] char **a
         }
     }
 
+    if (!m_journal_cmd.empty())
+    {
+        if (m_journal_cmd.front() == "text")
+        {
+            if (m_journal_cmd.size() != 3)
+            {
+                std::cerr << bl::translate("Not enough information for journal conversion") << std::endl;
+                return 1;
+            }
+            return Gnucash::journal_to_text (m_journal_cmd[1], m_journal_cmd[2]);
+        }
+        else
+        {
+            std::cerr << bl::format (bl::translate("Unknown journal command '{1}'")) % m_journal_cmd.front() << "\n\n"
+                      << *m_opt_desc_display.get() << std::endl;
+            return 1;
+        }
+    }
+
     std::cerr << _("Missing command or option") << "\n\n"
               << *m_opt_desc_display.get() << std::endl;
 
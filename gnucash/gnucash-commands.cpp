@@ -38,6 +38,7 @@
 #include <gnc-gnome-utils.h>
 #include <gnc-session.h>
 #include <qoflog.h>
+#include <TransLog.h>
 
 #include <boost/locale.hpp>
 #include <fstream>
@@ -425,3 +426,19 @@ Gnucash::report_list (void)
     scm_boot_guile (0, nullptr, scm_report_list, NULL);
     return 0;
 }
+
+int
+Gnucash::journal_to_text (const std::string& journal, const std::string& log)
+{
+    if (!xaccLogIsJournal (journal.c_str()))
+    {
+        std::cerr << bl::format (bl::translate ("'{1}' is not a binary transaction journal.")) % journal << std::endl;
+        return 1;
+    }
+    if (!xaccLogJournalToText (journal.c_str(), log.c_str()))
+    {
+        std::cerr << bl::format (bl::translate ("Failed to write the transaction log '{1}'.")) % log << std::endl;
+        return 1;
+    }
+    return 0;
+}
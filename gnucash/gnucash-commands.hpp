@@ -46,5 +46,7 @@ namespace Gnucash {
     int report_list (void);
     int report_show (const bo_str& file_to_load,
                      const bo_str& run_report);
+    int journal_to_text (const std::string& journal,
+                         const std::string& log);
 }
 #endif
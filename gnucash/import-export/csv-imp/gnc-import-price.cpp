@@ -380,7 +380,7 @@ void GncPriceImport::tokenize (bool guessColTypes)
     uint32_t max_cols = 0;
     m_tokenizer->tokenize();
     m_parsed_lines.clear();
-    for (auto tokenized_line : m_tokenizer->get_tokens())
+    for (const auto& tokenized_line : m_tokenizer->get_tokens())
     {
         auto length = tokenized_line.size();
         if (length > 0)
@@ -4,12 +4,9 @@
 #include <fstream>      // fstream
 #include <vector>
 #include <string>
-#include <algorithm>    // copy
-#include <iterator>     // ostream_operator
-
-#include <boost/tokenizer.hpp>
-#include <boost/locale.hpp>
-#include <boost/algorithm/string.hpp>
+#include <string_view>
+#include <locale>
+#include <stdexcept>
 
 #include <glib/gi18n.h>
 
@@ -20,91 +17,145 @@ GncCsvTokenizer::set_separators(const std::string& separators)
 }
 
 
-int GncCsvTokenizer::tokenize()
+/* Splits one logical line into fields.
+ *
+ * The rules are those the tokenizer has always applied, formerly by
+ * rewriting the line several times before handing it to a
+ * boost::tokenizer with an escaped_list_separator:
+ * - a backslash followed by a double quote, a backslash or an 'n' is an
+ *   escape for a double quote, a backslash or a newline; any other
+ *   backslash stands for itself,
+ * - a pair of double quotes inside a field stands for a double quote,
+ *   while one that is a whole field is an empty quoted field,
+ * - double quotes are otherwise removed and protect the separators
+ *   between them.
+ * Only lines holding a backslash are copied, to double the ones that
+ * stand for themselves; the rest is done in one pass over the line.
+ */
+void
+GncCsvTokenizer::tokenize_line (std::string_view line, StrVec& fields,
+                                std::string& scratch)
 {
-    using Tokenizer = boost::tokenizer< boost::escaped_list_separator<char>>;
+    if (line.empty())
+        return;
 
-    boost::escaped_list_separator<char> sep("\\", m_sep_str, "\"");
-
-    StrVec vec;
-    std::string line;
-    std::string buffer;
+    if (line.find ('\\') != std::string_view::npos)
+    {
+        scratch.clear();
+        for (size_t pos = 0; pos < line.size(); ++pos)
+        {
+            scratch.push_back (line[pos]);
+            if (line[pos] != '\\')
+                continue;
+            auto next = pos + 1 < line.size() ? line[pos + 1] : '\0';
+            if (next == '"' || next == '\\' || next == 'n')
+                scratch.push_back (line[++pos]);
+            else
+                scratch.push_back ('\\');
+        }
+        line = scratch;
+    }
 
-    bool inside_quotes(false);
-    size_t last_quote(0);
+    auto is_sep = [this](char c) { return m_sep_str.find (c) != std::string::npos; };
 
-    m_tokenized_contents.clear();
-    std::istringstream in_stream(m_utf8_contents);
+    fields.emplace_back();
+    auto in_quotes = false;
+    auto escaped = false;
+    auto feed = [&](char c)
+    {
+        auto& field = fields.back();
+        if (escaped)
+        {
+            escaped = false;
+            if (c == 'n')
+                field.push_back ('\n');
+            else if (c == '"' || c == '\\' || is_sep (c))
+                field.push_back (c);
+            else
+                throw (std::range_error N_("There was an error parsing the file."));
+        }
+        else if (c == '\\')
+            escaped = true;
+        else if (is_sep (c))
+        {
+            if (in_quotes)
+                field.push_back (c);
+            else
+                fields.emplace_back();
+        }
+        else if (c == '"')
+            in_quotes = !in_quotes;
+        else
+            field.push_back (c);
+    };
 
-    try
+    for (size_t pos = 0; pos < line.size();)
     {
-        while (std::getline (in_stream, buffer))
+        if (line[pos] == '"' && pos + 1 < line.size() && line[pos + 1] == '"')
         {
-            // --- deal with line breaks in quoted strings
-            buffer = boost::trim_copy (buffer); // Removes trailing newline and spaces
-            last_quote = buffer.find_first_of('"');
-            while (last_quote != std::string::npos)
-            {
-                if (last_quote == 0) // Test separately because last_quote - 1 would be out of range
-                    inside_quotes = !inside_quotes;
-                else if (buffer[ last_quote - 1 ] != '\\')
-                    inside_quotes = !inside_quotes;
-
-                last_quote = buffer.find_first_of('"',last_quote+1);
-            }
-
-            line.append(buffer);
-            if (inside_quotes)
-            {
-                line.append(" ");
-                continue;
-            }
-            // ---
-
-            // Deal with backslashes that are not meant to be escapes
-            // The boost::tokenizer with escaped_list_separator as we use
-            // it would choke on this.
-            auto bs_pos = line.find ('\\');
-            while (bs_pos != std::string::npos)
-            {
-                if ((bs_pos == line.size()) ||                                 // got trailing single backslash
-                    (line.find_first_of ("\"\\n", bs_pos + 1) != bs_pos + 1))  // backslash is not part of known escapes \\, \" or \n
-                    line = line.substr(0, bs_pos) + "\\\\" + line.substr(bs_pos + 1);
-                bs_pos += 2;
-                bs_pos = line.find ('\\', bs_pos);
-            }
-
-            // Deal with repeated " ("") in strings.
-            // This is commonly used as escape mechanism for double quotes in csv files.
-            // However boost just eats them.
-            bs_pos = line.find ("\"\"");
-            while (bs_pos != std::string::npos)
-            {
-                // Only make changes in case the double quotes are part of a larger field
-                // In other words a field which only contains two double quotes represent an
-                // empty field. We don't need to touch those.
-                // The way to determine whether the double quotes represent an empty string
-                // is by checking whether the character in front or after are either
-                // a field separator or the beginning or end of of the string.
-                if (!(((bs_pos == 0) ||                                          // quotes are at start of line
-                       (m_sep_str.find (line[bs_pos-1]) != std::string::npos))    // quotes preceded by field separator
-                      &&
-                      ((bs_pos + 2 >= line.length()) ||                          // quotes are at end of line
-                       (m_sep_str.find (line[bs_pos+2]) != std::string::npos))))   // quotes followed by field separator
-                    // Only make changes in case the double quotes are not an empty field
-                    line.replace (bs_pos, 2, "\\\"");
-                bs_pos = line.find ("\"\"", bs_pos + 2);
-            }
-
-            Tokenizer tok(line, sep);
-            vec.assign(tok.begin(),tok.end());
-            m_tokenized_contents.push_back(vec);
-            line.clear();
+            auto field_start = pos == 0 || is_sep (line[pos - 1]);
+            auto field_end = pos + 2 >= line.size() || is_sep (line[pos + 2]);
+            feed (field_start && field_end ? '"' : '\\');
+            feed ('"');
+            pos += 2;
         }
+        else
+            feed (line[pos++]);
     }
-    catch (boost::escaped_list_error &e)
-    {
+
+    if (escaped)
         throw (std::range_error N_("There was an error parsing the file."));
+}
+
+int GncCsvTokenizer::tokenize()
+{
+    m_tokenized_contents.clear();
+
+    /* Lines are trimmed of the characters the current locale considers
+     * spaces, and continue on the next line if they end within double
+     * quotes. */
+    auto& ctype = std::use_facet<std::ctype<char>> (std::locale());
+    auto is_space = [&ctype](char c) { return ctype.is (std::ctype_base::space, c); };
+
+    std::string_view contents {m_utf8_contents};
+    std::string continued;
+    std::string scratch;
+    auto inside_quotes = false;
+
+    for (size_t pos = 0; pos < contents.size();)
+    {
+        auto eol = contents.find ('\n', pos);
+        if (eol == std::string_view::npos)
+            eol = contents.size();
+        auto buffer = contents.substr (pos, eol - pos);
+        pos = eol + 1;
+
+        while (!buffer.empty() && is_space (buffer.front()))
+            buffer.remove_prefix (1);
+        while (!buffer.empty() && is_space (buffer.back()))
+            buffer.remove_suffix (1);
+
+        for (size_t i = 0; i < buffer.size(); ++i)
+            if (buffer[i] == '"' && (i == 0 || buffer[i - 1] != '\\'))
+                inside_quotes = !inside_quotes;
+
+        if (inside_quotes)
+        {
+            continued.append (buffer).append (" ");
+            continue;
+        }
+
+        auto line = buffer;
+        if (!continued.empty())
+        {
+            continued.append (buffer);
+            line = continued;
+        }
+
+        StrVec fields;
+        tokenize_line (line, fields, scratch);
+        m_tokenized_contents.push_back (std::move (fields));
+        continued.clear();
     }
 
     return 0;
@@ -40,6 +40,7 @@
 #include <fstream>      // fstream
 #include <vector>
 #include <string>
+#include <string_view>
 #include "gnc-tokenizer.hpp"
 
 class GncCsvTokenizer : public GncTokenizer
@@ -56,6 +57,8 @@ public:
     int  tokenize() override;
 
 private:
+    void tokenize_line (std::string_view line, StrVec& fields, std::string& scratch);
+
     std::string m_sep_str = ",";
 };
 
@@ -12,7 +12,6 @@
 #include <memory>
 
 #include <boost/locale.hpp>
-#include <boost/algorithm/string.hpp>
 
 #include <go-glib-extras.h>
 #include <glib.h>
@@ -49,14 +48,20 @@ GncTokenizer::load_file(const std::string& path)
     GError *error = nullptr;
 
     if (!g_file_get_contents(path.c_str(), &raw_contents, &raw_length, &error))
-      throw std::ifstream::failure(error->message);
+    {
+        std::string message {error->message};
+        g_error_free (error);
+        throw std::ifstream::failure(message);
+    }
+    m_raw_buffer.reset (raw_contents, g_free);
+
+    // The contents end at the first NUL, as they always have.
+    m_raw_contents = std::string_view (raw_contents,
+        std::find (raw_contents, raw_contents + raw_length, '\0') - raw_contents);
 
-    m_raw_contents = raw_contents;
-    g_free(raw_contents);
-    
     // Guess encoding, user can override if needed later on.
     const char *guessed_enc = NULL;
-    guessed_enc = go_guess_encoding (m_raw_contents.c_str(),
+    guessed_enc = go_guess_encoding (m_raw_contents.data(),
                                      m_raw_contents.length(),
                                      m_enc_str.empty() ? "UTF-8" : m_enc_str.c_str(),
                                      NULL);
@@ -73,16 +78,47 @@ GncTokenizer::current_file()
     return m_imp_file_str;
 }
 
+/* Replaces "\r\n" and "\r" line endings with "\n", in place. */
+static void
+normalize_line_endings (std::string& contents)
+{
+    auto out = contents.find ('\r');
+    if (out == std::string::npos)
+        return;
+
+    for (auto in = out; in < contents.size(); ++in)
+    {
+        if (contents[in] == '\r')
+        {
+            contents[out++] = '\n';
+            if (in + 1 < contents.size() && contents[in + 1] == '\n')
+                ++in;
+        }
+        else
+            contents[out++] = contents[in];
+    }
+    contents.resize (out);
+}
+
 void
 GncTokenizer::encoding(const std::string& encoding)
 {
     m_enc_str = encoding;
-    m_utf8_contents = boost::locale::conv::to_utf<char>(m_raw_contents, m_enc_str);
+
+    /* Valid UTF-8 needs no conversion, which saves boost::locale a
+     * second copy of large files. */
+    if ((g_ascii_strcasecmp (m_enc_str.c_str(), "UTF-8") == 0 ||
+         g_ascii_strcasecmp (m_enc_str.c_str(), "UTF8") == 0) &&
+        g_utf8_validate (m_raw_contents.data(), m_raw_contents.size(), nullptr))
+        m_utf8_contents.assign (m_raw_contents);
+    else
+        m_utf8_contents = boost::locale::conv::to_utf<char>(m_raw_contents.data(),
+                                                            m_raw_contents.data() + m_raw_contents.size(),
+                                                            m_enc_str);
 
     // While we are converting here, let's also normalize line-endings to "\n"
     // That's what STL expects by default
-    boost::replace_all (m_utf8_contents, "\r\n", "\n");
-    boost::replace_all (m_utf8_contents, "\r", "\n");
+    normalize_line_endings (m_utf8_contents);
 }
 
 const std::string&
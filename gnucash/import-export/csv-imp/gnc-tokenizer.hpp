@@ -41,8 +41,11 @@
 #include <fstream>      // fstream
 #include <vector>
 #include <string>
+#include <string_view>
 #include <memory>
 
+#include <glib.h>
+
 using StrVec = std::vector<std::string>;
 
 /** Enumeration for file formats supported by this importer. */
@@ -78,7 +81,10 @@ protected:
 
 private:
     std::string m_imp_file_str;
-    std::string m_raw_contents;
+    /* The file as read, kept to convert it again when the encoding is
+     * changed, without copying it into a string first. */
+    std::shared_ptr<char> m_raw_buffer;
+    std::string_view m_raw_contents;
     std::string m_enc_str;
 };
 
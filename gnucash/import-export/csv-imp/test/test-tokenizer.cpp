@@ -29,6 +29,8 @@
 #include "../gnc-tokenizer-csv.hpp"
 #include "../gnc-tokenizer-fw.hpp"
 #include <gtest/gtest.h>
+#include <glib.h>
+#include <glib/gstdio.h>
 #include <iostream>
 #include <fstream>      // fstream
 
@@ -111,6 +113,23 @@ TEST_F (GncTokenizerTest, load_file_existing)
     EXPECT_EQ(expected_contents, get_utf8_contents (csv_tok));
 }
 
+TEST_F (GncTokenizerTest, load_file_then_change_it)
+{
+    auto file = std::string(g_get_tmp_dir()) + "/test-tokenizer-" +
+        std::to_string(g_random_int()) + ".csv";
+    g_file_set_contents (file.c_str(), "a,b\r\nc,d\r\n", -1, nullptr);
+
+    ASSERT_NO_THROW (csv_tok->load_file (file));
+
+    /* The contents are read when the file is loaded; changing the
+     * encoding afterwards converts them again, not the file. */
+    g_file_set_contents (file.c_str(), "x", -1, nullptr);
+    g_unlink (file.c_str());
+    csv_tok->encoding ("ISO-8859-1");
+
+    EXPECT_EQ(std::string("a,b\nc,d\n"), get_utf8_contents (csv_tok));
+}
+
 TEST_F (GncTokenizerTest, tokenize_from_csv_file)
 {
 
@@ -200,6 +219,25 @@ TEST_F (GncTokenizerTest, tokenize_semicolon_sep)
 }
 
 
+TEST_F (GncTokenizerTest, tokenize_multiple_lines)
+{
+    GncCsvTokenizer *csvtok = dynamic_cast<GncCsvTokenizer*>(csv_tok.get());
+    csvtok->set_separators (",");
+
+    /* A line ending in a separator right after one with a field fewer
+     * used to get that line's last but one field. Quoted fields may
+     * span lines, which are joined with a space. */
+    set_utf8_contents (csv_tok, std::string(",\na\n;n,\n\"x\n  y\",z\n"));
+    csv_tok->tokenize();
+
+    auto tokens = csv_tok->get_tokens();
+    ASSERT_EQ(4ul, tokens.size());
+    EXPECT_EQ((StrVec{ "", "" }), tokens[0]);
+    EXPECT_EQ((StrVec{ "a" }), tokens[1]);
+    EXPECT_EQ((StrVec{ ";n", "" }), tokens[2]);
+    EXPECT_EQ((StrVec{ "x y", "z" }), tokens[3]);
+}
+
 
 void
 GncTokenizerTest::test_gnc_tokenize_helper (tokenize_fw_test_data* test_data)
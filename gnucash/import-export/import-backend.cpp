@@ -45,6 +45,10 @@
 #include "gnc-ui-util.h"
 
 #include <algorithm>
+#include <cmath>
+#include <limits>
+#include <unordered_map>
+#include <vector>
 
 #define GNCIMPORT_DESC    "desc"
 #define GNCIMPORT_MEMO    "memo"
@@ -737,6 +741,229 @@ void split_find_match (GNCImportTransInfo * trans_info,
     trans_info->match_list = g_list_prepend(trans_info->match_list, match_info);
 }
 
+/***********************************************************************
+ */
+
+/* A split in the match index. seq is the order in which it was added. */
+struct MatchIndexEntry
+{
+    time64 date;
+    size_t seq;
+    Split *split;
+};
+
+/* The splits of one account, ordered by date, both all together and
+ * bucketed by amount. */
+struct AccountMatchIndex
+{
+    std::vector<MatchIndexEntry> by_date;
+    std::unordered_map<int64_t, std::vector<MatchIndexEntry>> by_amount;
+    /* Splits whose amount is too large, or not a number, to bucket. */
+    std::vector<MatchIndexEntry> unbucketed;
+    bool sorted = true;
+};
+
+struct _matchindex
+{
+    gint display_threshold;
+    gint date_threshold;
+    gint date_not_threshold;
+    double fuzzy_amount_difference;
+    /* Half the width of the amount window in which split_find_match
+     * gives points for the amount, and the width of the buckets, which is
+     * at least that so that a window spans few buckets. */
+    double amount_window;
+    double bucket_width;
+    size_t next_seq;
+    std::unordered_map<Account*, AccountMatchIndex> accounts;
+};
+
+/* The score split_find_match gives for an amount in the window, and the
+ * penalty for one outside it. */
+static constexpr gint max_amount_score = 3;
+static constexpr gint min_amount_score = -5;
+
+static bool
+amount_bucket (double amount, double width, int64_t *bucket)
+{
+    auto b = std::floor (amount / width);
+    if (!std::isfinite (b) || std::fabs (b) > 1e15)
+        return false;
+    *bucket = static_cast<int64_t> (b);
+    return true;
+}
+
+GNCImportMatchIndex *
+gnc_import_MatchIndex_new (gint display_threshold,
+                           gint date_threshold,
+                           gint date_not_threshold,
+                           double fuzzy_amount_difference)
+{
+    auto index = new GNCImportMatchIndex;
+    index->display_threshold = display_threshold;
+    index->date_threshold = date_threshold;
+    index->date_not_threshold = date_not_threshold;
+    index->fuzzy_amount_difference = fuzzy_amount_difference;
+    /* split_find_match takes amounts within 1e-6 as equal. */
+    index->amount_window = fuzzy_amount_difference > 1e-6 ? fuzzy_amount_difference : 1e-6;
+    index->bucket_width = index->amount_window > 1.0 ? index->amount_window : 1.0;
+    index->next_seq = 0;
+    return index;
+}
+
+void
+gnc_import_MatchIndex_delete (GNCImportMatchIndex *index)
+{
+    delete index;
+}
+
+void
+gnc_import_MatchIndex_add_split (GNCImportMatchIndex *index, Split *split)
+{
+    g_assert (index && split);
+    auto& acc_index = index->accounts[xaccSplitGetAccount (split)];
+    MatchIndexEntry entry {xaccTransGetDate (xaccSplitGetParent (split)),
+                           index->next_seq++, split};
+    acc_index.by_date.push_back (entry);
+    int64_t bucket;
+    if (amount_bucket (gnc_numeric_to_double (xaccSplitGetAmount (split)),
+                       index->bucket_width, &bucket))
+        acc_index.by_amount[bucket].push_back (entry);
+    else
+        acc_index.unbucketed.push_back (entry);
+    acc_index.sorted = false;
+}
+
+/* The most that split_find_match's number, memo and description
+ * heuristics can give trans_info's matches. */
+static gint
+max_text_score (GNCImportTransInfo *trans_info)
+{
+    auto trans = gnc_import_TransInfo_get_trans (trans_info);
+    auto fsplit = gnc_import_TransInfo_get_fsplit (trans_info);
+    gint score = 0;
+    auto num = gnc_get_num_action (trans, fsplit);
+    if (num && *num)
+        score += 4;
+    auto memo = xaccSplitGetMemo (fsplit);
+    if (memo && *memo)
+        score += 2;
+    auto descr = xaccTransGetDescription (trans);
+    if (descr && *descr)
+        score += 2;
+    return score;
+}
+
+/* The most days apart a split may be from the imported transaction and
+ * still get min_score or more from split_find_match's date heuristics;
+ * -1 if none can and the maximum int64_t if all do. */
+static int64_t
+max_days_apart (const GNCImportMatchIndex *index, gint min_score)
+{
+    if (min_score <= -5)
+        return std::numeric_limits<int64_t>::max ();
+    if (min_score <= 0)
+        return std::max ({0, index->date_threshold, index->date_not_threshold});
+    if (min_score <= 2)
+        return std::max (0, index->date_threshold);
+    if (min_score <= 3)
+        return 0;
+    return -1;
+}
+
+static bool
+entry_date_order (const MatchIndexEntry& a, const MatchIndexEntry& b)
+{
+    return a.date != b.date ? a.date < b.date : a.seq < b.seq;
+}
+
+/* Adds the entries within days of date, as split_find_match counts the
+ * days, to candidates. */
+static void
+add_entries_near (const std::vector<MatchIndexEntry>& entries, time64 date,
+                  int64_t days, std::vector<const MatchIndexEntry*>& candidates)
+{
+    if (days < 0)
+        return;
+    auto first = entries.begin ();
+    auto last = entries.end ();
+    /* llabs (diff) / 86400 <= days */
+    if (days < std::numeric_limits<int64_t>::max () / 86400 - 1)
+    {
+        auto reach = (days + 1) * 86400 - 1;
+        first = std::lower_bound (first, last, date - reach,
+                                  [] (const MatchIndexEntry& e, time64 t)
+                                  { return e.date < t; });
+        last = std::upper_bound (first, last, date + reach,
+                                 [] (time64 t, const MatchIndexEntry& e)
+                                 { return t < e.date; });
+    }
+    for (auto iter = first; iter != last; ++iter)
+        candidates.push_back (&*iter);
+}
+
+void
+gnc_import_MatchIndex_find_matches (GNCImportMatchIndex *index,
+                                    GNCImportTransInfo *trans_info)
+{
+    g_assert (index && trans_info);
+    auto fsplit = gnc_import_TransInfo_get_fsplit (trans_info);
+    auto iter = index->accounts.find (xaccSplitGetAccount (fsplit));
+    if (iter == index->accounts.end ())
+        return;
+    auto& acc_index = iter->second;
+    if (!acc_index.sorted)
+    {
+        std::sort (acc_index.by_date.begin (), acc_index.by_date.end (), entry_date_order);
+        for (auto& bucket : acc_index.by_amount)
+            std::sort (bucket.second.begin (), bucket.second.end (), entry_date_order);
+        acc_index.sorted = true;
+    }
+
+    /* What a split must get from its amount and date to be displayed. */
+    auto needed = index->display_threshold - max_text_score (trans_info);
+    auto date = xaccTransGetDate (gnc_import_TransInfo_get_trans (trans_info));
+    auto amount = gnc_numeric_to_double (xaccSplitGetAmount (fsplit));
+    std::vector<const MatchIndexEntry*> candidates;
+
+    /* Splits with any amount, penalized for it if need be. */
+    add_entries_near (acc_index.by_date, date,
+                      max_days_apart (index, needed - min_amount_score), candidates);
+
+    /* Splits with an amount in the window. Widening the range of buckets
+     * by one on each side makes up for rounding. */
+    auto days = max_days_apart (index, needed - max_amount_score);
+    int64_t first, last;
+    if (amount_bucket (amount - index->amount_window, index->bucket_width, &first) &&
+        amount_bucket (amount + index->amount_window, index->bucket_width, &last))
+    {
+        for (auto bucket = first - 1; bucket <= last + 1; ++bucket)
+        {
+            auto entries = acc_index.by_amount.find (bucket);
+            if (entries != acc_index.by_amount.end ())
+                add_entries_near (entries->second, date, days, candidates);
+        }
+        add_entries_near (acc_index.unbucketed, date, days, candidates);
+    }
+    else
+        add_entries_near (acc_index.by_date, date, days, candidates);
+
+    /* Evaluate them in the order they were added, once each, so that
+     * equally probable matches are listed as they would be without the
+     * index. */
+    std::sort (candidates.begin (), candidates.end (),
+               [] (const MatchIndexEntry *a, const MatchIndexEntry *b)
+               { return a->seq < b->seq; });
+    candidates.erase (std::unique (candidates.begin (), candidates.end (),
+                                   [] (const MatchIndexEntry *a, const MatchIndexEntry *b)
+                                   { return a->seq == b->seq; }),
+                      candidates.end ());
+    for (auto entry : candidates)
+        split_find_match (trans_info, entry->split, index->display_threshold,
+                          index->date_threshold, index->date_not_threshold,
+                          index->fuzzy_amount_difference);
+}
+
 /***********************************************************************
  */
 
@@ -992,12 +1219,14 @@ hash_account_online_ids (Account *account)
 {
      auto acct_hash = g_hash_table_new_full
           (g_str_hash, g_str_equal, g_free, nullptr);
-     for (GList *n = xaccAccountGetSplitList (account) ; n; n = n->next)
+     auto splits = xaccAccountGetSplitList (account);
+     for (GList *n = splits; n; n = n->next)
      {
         auto id = gnc_import_get_split_online_id (static_cast<Split *>(n->data));
         if (id && *id)
             g_hash_table_insert (acct_hash, (void*) id, GINT_TO_POINTER (1));
      }
+     g_list_free (splits);
      return acct_hash;
 }
 
@@ -37,6 +37,7 @@ extern "C" {
 
 typedef struct _transactioninfo GNCImportTransInfo;
 typedef struct _selected_match_info GNCImportSelectedMatchInfo;
+typedef struct _matchindex GNCImportMatchIndex;
 typedef struct _matchinfo
 {
     Transaction * trans;
@@ -102,6 +103,39 @@ void split_find_match (GNCImportTransInfo * trans_info,
                        gint date_not_threshold,
                        double fuzzy_amount_difference);
 
+/** Creates an index of the register splits that imported transactions
+ * may match, by account, amount and posted date. It lets
+ * gnc_import_MatchIndex_find_matches pass split_find_match only the
+ * splits whose amount and date leave them a chance of reaching the
+ * display threshold, instead of every split of the account.
+ *
+ * The parameters are those of split_find_match.
+ */
+GNCImportMatchIndex *
+gnc_import_MatchIndex_new (gint display_threshold,
+                           gint date_threshold,
+                           gint date_not_threshold,
+                           double fuzzy_amount_difference);
+
+void gnc_import_MatchIndex_delete (GNCImportMatchIndex *index);
+
+/** Adds a split that imported transactions into its account may match.
+ * Splits are evaluated in the order they were added, so that
+ * the match lists come out as if split_find_match had been called for
+ * each split of the account in turn. The split's transaction must not
+ * change while the index is in use.
+ */
+void gnc_import_MatchIndex_add_split (GNCImportMatchIndex *index,
+                                      Split *split);
+
+/** Calls split_find_match for trans_info and each split of its
+ * account in the index that could score at least the display
+ * threshold. The resulting match list is the same as calling it for
+ * every split of the account.
+ */
+void gnc_import_MatchIndex_find_matches (GNCImportMatchIndex *index,
+                                         GNCImportTransInfo *trans_info);
+
 /** Iterates through all splits of the originating account of
  * trans_info. Sorts the resulting list and sets the selected_match
  * and action fields in the trans_info.
@@ -467,7 +467,8 @@ load_hash_tables (GNCImportMainMatcher *info)
     }
     for (GList *m = accounts_list; m; m = m->next)
     {
-        for (GList *n = xaccAccountGetSplitList (m->data); n; n = n->next)
+        GList *splits = xaccAccountGetSplitList (m->data);
+        for (GList *n = splits; n; n = n->next)
         {
             const Split *s = n->data;
             const Transaction *t = xaccSplitGetParent (s);
@@ -484,6 +485,7 @@ load_hash_tables (GNCImportMainMatcher *info)
             if (key && *key)
                 g_hash_table_insert (info->memo_hash, (gpointer)key, one);
         }
+        g_list_free (splits);
     }
     g_list_free (accounts_list);
 }
@@ -2250,15 +2252,15 @@ query_imported_transaction_accounts (GNCImportMainMatcher *gui)
     return retval;
 }
 
-/* Create a hash by account of all splits that could match one of the imported
- * transactions based on their account and date and organized per account.
+/* Add all splits that could match one of the imported transactions based on
+ * their account and date to the match index. They're added last to first,
+ * the order in which they have always been scored.
  */
-static GHashTable*
-create_hash_of_potential_matches (GList *candidate_txns,
-                                  GHashTable *account_hash)
+static void
+index_potential_matches (GList *candidate_txns, GNCImportMatchIndex *match_index)
 {
-    for (GList* candidate = candidate_txns; candidate != NULL;
-         candidate = g_list_next (candidate))
+    for (GList* candidate = g_list_last (candidate_txns); candidate != NULL;
+         candidate = g_list_previous (candidate))
     {
         if (gnc_import_split_has_online_id (candidate->data))
             continue;
@@ -2266,64 +2268,26 @@ create_hash_of_potential_matches (GList *candidate_txns,
          * downloaded one. That can't possibly be a match yet */
         if (xaccTransIsOpen(xaccSplitGetParent(candidate->data)))
             continue;
-        Account *split_account = xaccSplitGetAccount (candidate->data);
-        /* g_hash_table_steal_extended would do the two calls in one shot but is
-         * not available until GLib 2.58.
-         */
-        GSList *split_list = g_hash_table_lookup (account_hash, split_account);
-        g_hash_table_steal (account_hash, split_account);
-        split_list = g_slist_prepend (split_list, candidate->data);
-        g_hash_table_insert (account_hash, split_account, split_list);
+        gnc_import_MatchIndex_add_split (match_index, candidate->data);
     }
-    return account_hash;
-}
-
-typedef struct _match_struct
-{
-    GNCImportTransInfo* transaction_info;
-    gint display_threshold;
-    gint date_threshold;
-    gint date_not_threshold;
-    double fuzzy_amount;
-} match_struct;
-
-static void
-match_helper (Split* data, match_struct* s)
-{
-    split_find_match (s->transaction_info, data,
-                      s->display_threshold,
-                      s->date_threshold,
-                      s->date_not_threshold,
-                      s->fuzzy_amount);
 }
 
 /* Iterate through the imported transactions selecting matches from the
- * potential match lists in the account hash and update the matcher with the
+ * potential matches in the match index and update the matcher with the
  * results.
  */
 
 static void
-perform_matching (GNCImportMainMatcher *gui, GHashTable *account_hash)
+perform_matching (GNCImportMainMatcher *gui, GNCImportMatchIndex *match_index)
 {
     GtkTreeModel* model = gtk_tree_view_get_model (gui->view);
-    gint display_threshold =
-        gnc_import_Settings_get_display_threshold (gui->user_settings);
-    gint date_threshold =
-        gnc_import_Settings_get_date_threshold (gui->user_settings);
-    gint date_not_threshold =
-        gnc_import_Settings_get_date_not_threshold (gui->user_settings);
-    double fuzzy_amount =
-        gnc_import_Settings_get_fuzzy_amount (gui->user_settings);
 
     for (GSList *imported_txn = gui->temp_trans_list; imported_txn !=NULL;
          imported_txn = g_slist_next (imported_txn))
     {
         GNCImportTransInfo* txn_info = imported_txn->data;
-        Account *importaccount = xaccSplitGetAccount (gnc_import_TransInfo_get_fsplit (txn_info));
-        match_struct s = {txn_info, display_threshold, date_threshold, date_not_threshold, fuzzy_amount};
 
-        g_slist_foreach (g_hash_table_lookup (account_hash, importaccount),
-                         (GFunc) match_helper, &s);
+        gnc_import_MatchIndex_find_matches (match_index, txn_info);
 
         // Sort the matches, select the best match, and set the action.
         gnc_import_TransInfo_init_matches (txn_info, gui->user_settings);
@@ -2346,17 +2310,19 @@ perform_matching (GNCImportMainMatcher *gui, GHashTable *account_hash)
 void
 gnc_gen_trans_list_create_matches (GNCImportMainMatcher *gui)
 {
-    GHashTable* account_hash =
-        g_hash_table_new_full (g_direct_hash, g_direct_equal, NULL,
-                              (GDestroyNotify)g_slist_free);
     g_assert (gui);
+    GNCImportMatchIndex *match_index = gnc_import_MatchIndex_new
+        (gnc_import_Settings_get_display_threshold (gui->user_settings),
+         gnc_import_Settings_get_date_threshold (gui->user_settings),
+         gnc_import_Settings_get_date_not_threshold (gui->user_settings),
+         gnc_import_Settings_get_fuzzy_amount (gui->user_settings));
     GList *candidate_txns = query_imported_transaction_accounts (gui);
 
-    create_hash_of_potential_matches (candidate_txns, account_hash);
-    perform_matching (gui, account_hash);
+    index_potential_matches (candidate_txns, match_index);
+    perform_matching (gui, match_index);
 
     g_list_free (candidate_txns);
-    g_hash_table_destroy (account_hash);
+    gnc_import_MatchIndex_delete (match_index);
     return;
 }
 
@@ -62,9 +62,7 @@ gnc_import_set_acc_online_id (Account *account, const gchar *id)
 gchar *
 gnc_import_get_trans_online_id (Transaction * transaction)
 {
-    gchar *id = NULL;
-    qof_instance_get (QOF_INSTANCE (transaction), "online-id", &id, NULL);
-    return id;
+    return g_strdup (xaccTransGetOnlineID (transaction));
 }
 
 /* Not actually used */
@@ -80,18 +78,14 @@ gnc_import_set_trans_online_id (Transaction *transaction, const gchar *id)
 gboolean
 gnc_import_trans_has_online_id (Transaction * transaction)
 {
-    gchar *online_id = gnc_import_get_trans_online_id(transaction);
-    gboolean retval = (online_id && *online_id);
-    g_free (online_id);
-    return retval;
+    const char *online_id = xaccTransGetOnlineID (transaction);
+    return (online_id && *online_id);
 }
 
 gchar *
 gnc_import_get_split_online_id (Split * split)
 {
-    gchar *id = NULL;
-    qof_instance_get (QOF_INSTANCE (split), "online-id", &id, NULL);
-    return id;
+    return g_strdup (xaccSplitGetOnlineID (split));
 }
 
 /* Used several places in a transaction edit where many other
@@ -107,10 +101,8 @@ gnc_import_set_split_online_id (Split *split, const gchar *id)
 gboolean
 gnc_import_split_has_online_id (Split * split)
 {
-    gchar *online_id = gnc_import_get_split_online_id(split);
-    gboolean retval = (online_id && *online_id);
-    g_free (online_id);
-    return retval;
+    const char *online_id = xaccSplitGetOnlineID (split);
+    return (online_id && *online_id);
 }
 
 /* @} */
@@ -141,6 +141,25 @@ static char * my_strtok (char *s, const char *delim)
     return token;
 }
 
+static void set_log_action(split_record *record, char flag)
+{
+    switch (flag)
+    {
+    case 'B':
+        record->log_action = LOG_BEGIN_EDIT;
+        break;
+    case 'D':
+        record->log_action = LOG_DELETE;
+        break;
+    case 'C':
+        record->log_action = LOG_COMMIT;
+        break;
+    case 'R':
+        record->log_action = LOG_ROLLBACK;
+        break;
+    }
+}
+
 static split_record interpret_split_record( char *record_line)
 {
     char * tok_ptr;
@@ -149,21 +168,7 @@ static split_record interpret_split_record( char *record_line)
     DEBUG("interpret_split_record(): Start...");
     if (strlen(tok_ptr = my_strtok(record_line, "\t")) != 0)
     {
-        switch (tok_ptr[0])
-        {
-        case 'B':
-            record.log_action = LOG_BEGIN_EDIT;
-            break;
-        case 'D':
-            record.log_action = LOG_DELETE;
-            break;
-        case 'C':
-            record.log_action = LOG_COMMIT;
-            break;
-        case 'R':
-            record.log_action = LOG_ROLLBACK;
-            break;
-        }
+        set_log_action(&record, tok_ptr[0]);
         record.log_action_present = TRUE;
     }
     if (strlen(tok_ptr = my_strtok(NULL, "\t")) != 0)
@@ -356,20 +361,186 @@ static void dump_split_record(split_record record)
     }
 }
 
+/* The transaction played back from the lines of one log record. */
+typedef struct
+{
+    QofBook *book;
+    Transaction *trans;
+    char *trans_ro;
+    int first_record;
+} replay_state;
+
+static void replay_split_record(replay_state *state, const split_record *record)
+{
+    Split * split = NULL;
+    Account * acct = NULL;
+    QofBook * book = state->book;
+
+    if (record->log_action_present)
+    {
+        switch (record->log_action)
+        {
+        case LOG_BEGIN_EDIT:
+            DEBUG("replay_split_record():Ignoring log action: LOG_BEGIN_EDIT"); /*Do nothing, there is no point*/
+            break;
+        case LOG_ROLLBACK:
+            DEBUG("replay_split_record():Ignoring log action: LOG_ROLLBACK");/*Do nothing, since we didn't do the begin_edit either*/
+            break;
+        case LOG_DELETE:
+            DEBUG("replay_split_record(): Playing back LOG_DELETE");
+            if ((state->trans = xaccTransLookup (&(record->trans_guid), book)) != NULL
+                    && state->first_record == TRUE)
+            {
+                state->first_record = FALSE;
+                if (xaccTransGetReadOnly(state->trans))
+                {
+                    PWARN("Destroying a read only transaction.");
+                    xaccTransClearReadOnly(state->trans);
+                }
+                xaccTransBeginEdit(state->trans);
+                xaccTransDestroy(state->trans);
+            }
+            else if (state->first_record == TRUE)
+            {
+                PERR("The transaction to delete was not found!");
+            }
+            else
+                xaccTransDestroy(state->trans);
+            break;
+        case LOG_COMMIT:
+            DEBUG("replay_split_record(): Playing back LOG_COMMIT");
+            if (record->trans_guid_present == TRUE
+                    && state->first_record == TRUE)
+            {
+                state->trans = xaccTransLookupDirect (record->trans_guid, book);
+                if (state->trans != NULL)
+                {
+                    DEBUG("replay_split_record(): Transaction to be edited was found");
+                    xaccTransBeginEdit(state->trans);
+                    state->trans_ro = g_strdup(xaccTransGetReadOnly(state->trans));
+                    if (state->trans_ro)
+                    {
+                        PWARN("Replaying a read only transaction.");
+                        xaccTransClearReadOnly(state->trans);
+                    }
+                }
+                else
+                {
+                    DEBUG("replay_split_record(): Creating a new transaction");
+                    state->trans = xaccMallocTransaction (book);
+                    xaccTransBeginEdit(state->trans);
+                }
+
+                qof_instance_set_guid (QOF_INSTANCE (state->trans),
+                                       &(record->trans_guid));
+                /*Fill the transaction info*/
+                if (record->date_entered_present)
+                {
+                    xaccTransSetDateEnteredSecs(state->trans, record->date_entered);
+                }
+                if (record->date_posted_present)
+                {
+                    xaccTransSetDatePostedSecs(state->trans, record->date_posted);
+                }
+                if (record->trans_num_present)
+                {
+                    xaccTransSetNum(state->trans, record->trans_num);
+                }
+                if (record->trans_descr_present)
+                {
+                    xaccTransSetDescription(state->trans, record->trans_descr);
+                }
+                if (record->trans_notes_present)
+                {
+                    xaccTransSetNotes(state->trans, record->trans_notes);
+                }
+            }
+            if (record->split_guid_present == TRUE) /*Fill the split info*/
+            {
+                gboolean is_new_split;
+
+                split = xaccSplitLookupDirect (record->split_guid, book);
+                if (split != NULL)
+                {
+                    DEBUG("replay_split_record(): Split to be edited was found");
+                    is_new_split = FALSE;
+                }
+                else
+                {
+                    DEBUG("replay_split_record(): Creating a new split");
+                    split = xaccMallocSplit(book);
+                    is_new_split = TRUE;
+                }
+                xaccSplitSetGUID (split, &(record->split_guid));
+                if (record->acc_guid_present)
+                {
+                    acct = xaccAccountLookupDirect(record->acc_guid, book);
+                    xaccAccountInsertSplit(acct, split);
+
+                    // No currency in the txn yet? Set one now.
+                    if (!xaccTransGetCurrency(state->trans))
+                        xaccTransSetCurrency(state->trans, gnc_account_or_default_currency(acct, NULL));
+                }
+                if (is_new_split)
+                    xaccTransAppendSplit(state->trans, split);
+
+                if (record->split_memo_present)
+                {
+                    xaccSplitSetMemo(split, record->split_memo);
+                }
+                if (record->split_action_present)
+                {
+                    xaccSplitSetAction(split, record->split_action);
+                }
+                if (record->date_reconciled_present)
+                {
+                    xaccSplitSetDateReconciledSecs (split, record->date_reconciled);
+                }
+                if (record->split_reconcile_present)
+                {
+                    xaccSplitSetReconcile(split, record->split_reconcile);
+                }
+
+                if (record->amount_present)
+                {
+                    xaccSplitSetAmount(split, record->amount);
+                }
+                if (record->value_present)
+                {
+                    xaccSplitSetValue(split, record->value);
+                }
+            }
+            state->first_record = FALSE;
+            break;
+        }
+    }
+    else
+    {
+        PERR("Corrupted record");
+    }
+}
+
+/* Commit the transaction played back from a record, if there was one. */
+static void replay_record_end(replay_state *state)
+{
+    if (state->trans != NULL)
+    {
+        xaccTransScrubCurrency(state->trans);
+        xaccTransSetReadOnly(state->trans, state->trans_ro);
+        xaccTransCommitEdit(state->trans);
+        g_free(state->trans_ro);
+    }
+}
+
 /* File pointer must already be at the beginning of a record */
 static void  process_trans_record(  FILE *log_file)
 {
     char read_buf[2048];
     char *read_retval;
-    char * trans_ro = NULL;
     const char * record_end_str = "===== END";
-    int first_record = TRUE;
     int record_ended = FALSE;
     split_record record;
-    Transaction * trans = NULL;
-    Split * split = NULL;
-    Account * acct = NULL;
-    QofBook * book = gnc_get_current_book();
+    replay_state state = {gnc_get_current_book(), NULL, NULL, TRUE};
 
     DEBUG("process_trans_record(): Begin...\n");
 
@@ -383,164 +554,87 @@ static void  process_trans_record(  FILE *log_file)
 
             record = interpret_split_record(g_strchomp(read_buf));
             dump_split_record( record);
-            if (record.log_action_present)
-            {
-                switch (record.log_action)
-                {
-                case LOG_BEGIN_EDIT:
-                    DEBUG("process_trans_record():Ignoring log action: LOG_BEGIN_EDIT"); /*Do nothing, there is no point*/
-                    break;
-                case LOG_ROLLBACK:
-                    DEBUG("process_trans_record():Ignoring log action: LOG_ROLLBACK");/*Do nothing, since we didn't do the begin_edit either*/
-                    break;
-                case LOG_DELETE:
-                    DEBUG("process_trans_record(): Playing back LOG_DELETE");
-                    if ((trans = xaccTransLookup (&(record.trans_guid), book)) != NULL
-                            && first_record == TRUE)
-                    {
-                        first_record = FALSE;
-                        if (xaccTransGetReadOnly(trans))
-                        {
-                            PWARN("Destroying a read only transaction.");
-                            xaccTransClearReadOnly(trans);
-                        }
-                        xaccTransBeginEdit(trans);
-                        xaccTransDestroy(trans);
-                    }
-                    else if (first_record == TRUE)
-                    {
-                        PERR("The transaction to delete was not found!");
-                    }
-                    else
-                        xaccTransDestroy(trans);
-                    break;
-                case LOG_COMMIT:
-                    DEBUG("process_trans_record(): Playing back LOG_COMMIT");
-                    if (record.trans_guid_present == TRUE
-                            && first_record == TRUE)
-                    {
-                        trans = xaccTransLookupDirect (record.trans_guid, book);
-                        if (trans != NULL)
-                        {
-                            DEBUG("process_trans_record(): Transaction to be edited was found");
-                            xaccTransBeginEdit(trans);
-                            trans_ro = g_strdup(xaccTransGetReadOnly(trans));
-                            if (trans_ro)
-                            {
-                                PWARN("Replaying a read only transaction.");
-                                xaccTransClearReadOnly(trans);
-                            }
-                        }
-                        else
-                        {
-                            DEBUG("process_trans_record(): Creating a new transaction");
-                            trans = xaccMallocTransaction (book);
-                            xaccTransBeginEdit(trans);
-                        }
-
-                        qof_instance_set_guid (QOF_INSTANCE (trans),
-					       &(record.trans_guid));
-                        /*Fill the transaction info*/
-                        if (record.date_entered_present)
-                        {
-                            xaccTransSetDateEnteredSecs(trans, record.date_entered);
-                        }
-                        if (record.date_posted_present)
-                        {
-                            xaccTransSetDatePostedSecs(trans, record.date_posted);
-                        }
-                        if (record.trans_num_present)
-                        {
-                            xaccTransSetNum(trans, record.trans_num);
-                        }
-                        if (record.trans_descr_present)
-                        {
-                            xaccTransSetDescription(trans, record.trans_descr);
-                        }
-                        if (record.trans_notes_present)
-                        {
-                            xaccTransSetNotes(trans, record.trans_notes);
-                        }
-                    }
-                    if (record.split_guid_present == TRUE) /*Fill the split info*/
-                    {
-                        gboolean is_new_split;
-
-                        split = xaccSplitLookupDirect (record.split_guid, book);
-                        if (split != NULL)
-                        {
-                            DEBUG("process_trans_record(): Split to be edited was found");
-                            is_new_split = FALSE;
-                        }
-                        else
-                        {
-                            DEBUG("process_trans_record(): Creating a new split");
-                            split = xaccMallocSplit(book);
-                            is_new_split = TRUE;
-                        }
-                        xaccSplitSetGUID (split, &(record.split_guid));
-                        if (record.acc_guid_present)
-                        {
-                            acct = xaccAccountLookupDirect(record.acc_guid, book);
-                            xaccAccountInsertSplit(acct, split);
-
-                            // No currency in the txn yet? Set one now.
-                            if (!xaccTransGetCurrency(trans))
-                                xaccTransSetCurrency(trans, gnc_account_or_default_currency(acct, NULL));
-                        }
-                        if (is_new_split)
-                            xaccTransAppendSplit(trans, split);
-
-                        if (record.split_memo_present)
-                        {
-                            xaccSplitSetMemo(split, record.split_memo);
-                        }
-                        if (record.split_action_present)
-                        {
-                            xaccSplitSetAction(split, record.split_action);
-                        }
-                        if (record.date_reconciled_present)
-                        {
-                            xaccSplitSetDateReconciledSecs (split, record.date_reconciled);
-                        }
-                        if (record.split_reconcile_present)
-                        {
-                            xaccSplitSetReconcile(split, record.split_reconcile);
-                        }
-
-                        if (record.amount_present)
-                        {
-                            xaccSplitSetAmount(split, record.amount);
-                        }
-                        if (record.value_present)
-                        {
-                            xaccSplitSetValue(split, record.value);
-                        }
-                    }
-                    first_record = FALSE;
-                    break;
-                }
-            }
-            else
-            {
-                PERR("Corrupted record");
-            }
+            replay_split_record(&state, &record);
         }
         else /* The record ended */
         {
             record_ended = TRUE;
             DEBUG("process_trans_record(): Record ended\n");
-            if (trans != NULL) /*If we played with a transaction, commit it here*/
-            {
-                xaccTransScrubCurrency(trans);
-                xaccTransSetReadOnly(trans, trans_ro);
-                xaccTransCommitEdit(trans);
-                g_free(trans_ro);
-            }
+            replay_record_end(&state);
         }
     }
 }
 
+static void copy_string_field(char *field, int *present, const char *value)
+{
+    if (*value != '\0')
+    {
+        strncpy(field, value, STRING_FIELD_SIZE - 1);
+        *present = TRUE;
+    }
+}
+
+/* Play back a transaction of a binary journal as if its splits had been
+   read from the lines of a text record. */
+static gboolean process_journal_trans(const XaccLogTrans *trans, gpointer data)
+{
+    replay_state state = {data, NULL, NULL, TRUE};
+    split_record record;
+    guint i;
+
+    DEBUG("process_journal_trans(): Begin...");
+    for (i = 0; i < trans->num_splits; i++)
+    {
+        const XaccLogSplit *split = &trans->splits[i];
+
+        memset(&record, 0, sizeof(record));
+        set_log_action(&record, trans->flag);
+        record.log_action_present = TRUE;
+        record.trans_guid = trans->guid;
+        record.trans_guid_present = TRUE;
+        record.split_guid = split->guid;
+        record.split_guid_present = TRUE;
+        record.log_date = trans->time_now;
+        record.log_date_present = TRUE;
+        record.date_entered = trans->date_entered;
+        record.date_entered_present = TRUE;
+        record.date_posted = trans->date_posted;
+        record.date_posted_present = TRUE;
+        record.acc_guid = split->account_guid;
+        record.acc_guid_present = split->has_account;
+        copy_string_field(record.acc_name, &record.acc_name_present,
+                          split->account_name);
+        copy_string_field(record.trans_num, &record.trans_num_present,
+                          trans->num);
+        copy_string_field(record.trans_descr, &record.trans_descr_present,
+                          trans->description);
+        copy_string_field(record.trans_notes, &record.trans_notes_present,
+                          trans->notes);
+        copy_string_field(record.split_memo, &record.split_memo_present,
+                          split->memo);
+        copy_string_field(record.split_action, &record.split_action_present,
+                          split->action);
+        record.split_reconcile = split->reconciled;
+        record.split_reconcile_present = split->reconciled != '\0';
+        record.amount = split->amount;
+        record.amount_present = TRUE;
+        record.value = split->value;
+        record.value_present = TRUE;
+        record.date_reconciled = split->date_reconciled;
+        record.date_reconciled_present = TRUE;
+
+        dump_split_record(record);
+        replay_split_record(&state, &record);
+    }
+    replay_record_end(&state);
+    return TRUE;
+}
+
+gboolean gnc_log_replay_journal (QofBook *book, const char *path)
+{
+    return xaccLogReadJournal(path, process_journal_trans, book);
+}
+
 void gnc_file_log_replay (GtkWindow *parent)
 {
     char *selected_filename;
@@ -569,8 +663,9 @@ void gnc_file_log_replay (GtkWindow *parent)
     default_dir = gnc_get_default_directory(GNC_PREFS_GROUP);
 
     filter = gtk_file_filter_new();
-    gtk_file_filter_set_name(filter, "*.log");
+    gtk_file_filter_set_name(filter, "*.log, *.jrnl");
     gtk_file_filter_add_pattern(filter, "*.[Ll][Oo][Gg]");
+    gtk_file_filter_add_pattern(filter, "*.[Jj][Rr][Nn][Ll]");
     selected_filename = gnc_file_dialog(parent,
                                         _("Select a .log file to replay"),
                                         g_list_prepend(NULL, filter),
@@ -595,6 +690,13 @@ void gnc_file_log_replay (GtkWindow *parent)
                              _("Cannot open the current log file: %s"),
                              selected_filename);
         }
+        else if (xaccLogIsJournal(selected_filename))
+        {
+            DEBUG("Replaying binary journal");
+            if (!gnc_log_replay_journal(gnc_get_current_book(), selected_filename))
+                gnc_error_dialog(NULL, "%s",
+                                 _("The log file you selected cannot be read."));
+        }
         else
         {
             DEBUG("Opening selected file");
@@ -26,10 +26,26 @@
 #define OFX_IMPORT_H
 
 #include <gtk/gtk.h>
+#include "qof.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
 
 /** The gnc_file_log_replay() routine will pop up a standard file
  *     selection dialogue asking the user to pick a log file to replay. If one
  *     is selected the .log file is opened and read.  Its contents
  *     are then silently merged in the current log file. */
 void              gnc_file_log_replay (GtkWindow *parent);
+
+/** The gnc_log_replay_journal() routine plays back the binary journal
+ *     at path into book, as gnc_file_log_replay() does for the journal
+ *     the user selects.
+ *
+ *     @return FALSE if the file cannot be read or isn't a binary journal. */
+gboolean          gnc_log_replay_journal (QofBook *book, const char *path);
+
+#ifdef __cplusplus
+}
+#endif
 #endif
@@ -0,0 +1,211 @@
+/********************************************************************\
+ * gtest-log-replay.cpp -- Unit tests for replaying binary journals *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include <Account.h>
+#include <Transaction.h>
+#include <TransLog.h>
+#include <gnc-commodity.h>
+#include <qof.h>
+#include <gnc-log-replay.h>
+#include <gtest/gtest.h>
+#include <string>
+
+class LogReplayTest : public testing::Test
+{
+protected:
+    void SetUp()
+    {
+        m_book = qof_book_new ();
+        m_table = gnc_commodity_table_new ();
+        qof_book_set_data (m_book, GNC_COMMODITY_TABLE, m_table);
+        m_usd = gnc_commodity_new (m_book, "United States Dollar", "CURRENCY",
+                                   "USD", NULL, 100);
+        gnc_commodity_table_insert (m_table, m_usd);
+
+        m_root = gnc_account_create_root (m_book);
+        m_bank = make_account ("Bank");
+        m_food = make_account ("Food");
+
+        m_dir = g_dir_make_tmp ("gtest-log-replay-XXXXXX", nullptr);
+        auto base = g_build_filename (m_dir, "translog", nullptr);
+        xaccLogSetBaseName (base);
+        g_free (base);
+        xaccLogSetBinary (TRUE);
+        xaccLogEnable ();
+    }
+
+    void TearDown()
+    {
+        xaccCloseLog ();
+        xaccLogSetBinary (FALSE);
+        xaccLogDisable ();
+        if (!m_journal.empty ())
+            g_unlink (m_journal.c_str ());
+        g_rmdir (m_dir);
+        g_free (m_dir);
+
+        if (auto trans = xaccTransLookup (&m_trans_guid, m_book))
+        {
+            xaccTransBeginEdit (trans);
+            xaccTransDestroy (trans);
+            xaccTransCommitEdit (trans);
+        }
+        xaccAccountBeginEdit (m_root);
+        xaccAccountDestroy (m_root);
+        gnc_commodity_destroy (m_usd);
+        qof_book_set_data (m_book, GNC_COMMODITY_TABLE, nullptr);
+        gnc_commodity_table_destroy (m_table);
+        qof_book_destroy (m_book);
+    }
+
+    Account* make_account (const char *name)
+    {
+        auto acc = xaccMallocAccount (m_book);
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetName (acc, name);
+        xaccAccountSetCommodity (acc, m_usd);
+        gnc_account_append_child (m_root, acc);
+        xaccAccountCommitEdit (acc);
+        return acc;
+    }
+
+    Transaction* add_trans ()
+    {
+        auto trans = xaccMallocTransaction (m_book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, m_usd);
+        xaccTransSetDatePostedSecsNormalized (trans, 1700000000);
+        xaccTransSetNum (trans, "42");
+        xaccTransSetDescription (trans, "Groceries");
+        xaccTransSetNotes (trans, "weekly");
+
+        auto amount = gnc_numeric_create (1234, 100);
+        auto bank = xaccMallocSplit (m_book);
+        xaccSplitSetParent (bank, trans);
+        xaccSplitSetAccount (bank, m_bank);
+        xaccSplitSetMemo (bank, "card");
+        xaccSplitSetAmount (bank, gnc_numeric_neg (amount));
+        xaccSplitSetValue (bank, gnc_numeric_neg (amount));
+        m_bank_split_guid = *xaccSplitGetGUID (bank);
+
+        auto food = xaccMallocSplit (m_book);
+        xaccSplitSetParent (food, trans);
+        xaccSplitSetAccount (food, m_food);
+        xaccSplitSetAction (food, "Buy");
+        xaccSplitSetReconcile (food, CREC);
+        xaccSplitSetAmount (food, amount);
+        xaccSplitSetValue (food, amount);
+        xaccTransCommitEdit (trans);
+
+        m_trans_guid = *xaccTransGetGUID (trans);
+        return trans;
+    }
+
+    /* Close the journal and forget the transactions logged, without
+     * logging that. */
+    void close_journal ()
+    {
+        xaccCloseLog ();
+        xaccLogDisable ();
+
+        auto gdir = g_dir_open (m_dir, 0, nullptr);
+        ASSERT_NE (gdir, nullptr);
+        auto name = g_dir_read_name (gdir);
+        ASSERT_NE (name, nullptr);
+        auto path = g_build_filename (m_dir, name, nullptr);
+        m_journal = path;
+        g_free (path);
+        g_dir_close (gdir);
+
+        if (auto trans = xaccTransLookup (&m_trans_guid, m_book))
+        {
+            xaccTransBeginEdit (trans);
+            xaccTransDestroy (trans);
+            xaccTransCommitEdit (trans);
+        }
+    }
+
+    QofBook *m_book {};
+    gnc_commodity_table *m_table {};
+    gnc_commodity *m_usd {};
+    Account *m_root {};
+    Account *m_bank {};
+    Account *m_food {};
+    gchar *m_dir {};
+    std::string m_journal;
+    GncGUID m_trans_guid {};
+    GncGUID m_bank_split_guid {};
+};
+
+TEST_F (LogReplayTest, replay_commit)
+{
+    add_trans ();
+    close_journal ();
+    ASSERT_EQ (xaccTransLookup (&m_trans_guid, m_book), nullptr);
+
+    ASSERT_TRUE (gnc_log_replay_journal (m_book, m_journal.c_str ()));
+
+    auto trans = xaccTransLookup (&m_trans_guid, m_book);
+    ASSERT_NE (trans, nullptr);
+    EXPECT_STREQ (xaccTransGetNum (trans), "42");
+    EXPECT_STREQ (xaccTransGetDescription (trans), "Groceries");
+    EXPECT_STREQ (xaccTransGetNotes (trans), "weekly");
+    EXPECT_EQ (xaccTransGetCurrency (trans), m_usd);
+    EXPECT_EQ (xaccTransCountSplits (trans), 2);
+    EXPECT_TRUE (xaccTransIsBalanced (trans));
+
+    auto bank = xaccSplitLookup (&m_bank_split_guid, m_book);
+    ASSERT_NE (bank, nullptr);
+    EXPECT_EQ (xaccSplitGetParent (bank), trans);
+    EXPECT_EQ (xaccSplitGetAccount (bank), m_bank);
+    EXPECT_STREQ (xaccSplitGetMemo (bank), "card");
+    EXPECT_TRUE (gnc_numeric_equal (xaccSplitGetAmount (bank),
+                                    gnc_numeric_create (-1234, 100)));
+
+    auto food = xaccSplitGetOtherSplit (bank);
+    ASSERT_NE (food, nullptr);
+    EXPECT_EQ (xaccSplitGetAccount (food), m_food);
+    EXPECT_STREQ (xaccSplitGetAction (food), "Buy");
+    EXPECT_EQ (xaccSplitGetReconcile (food), CREC);
+    EXPECT_TRUE (gnc_numeric_equal (xaccSplitGetValue (food),
+                                    gnc_numeric_create (1234, 100)));
+}
+
+TEST_F (LogReplayTest, replay_delete)
+{
+    auto trans = add_trans ();
+    xaccTransBeginEdit (trans);
+    xaccTransDestroy (trans);
+    xaccTransCommitEdit (trans);
+    close_journal ();
+
+    ASSERT_TRUE (gnc_log_replay_journal (m_book, m_journal.c_str ()));
+    EXPECT_EQ (xaccTransLookup (&m_trans_guid, m_book), nullptr);
+    EXPECT_EQ (xaccSplitLookup (&m_bank_split_guid, m_book), nullptr);
+}
+
+TEST_F (LogReplayTest, replay_not_a_journal)
+{
+    EXPECT_FALSE (gnc_log_replay_journal (m_book, "no-such-journal.log"));
+}
@@ -0,0 +1,245 @@
+/********************************************************************
+ * bench-import-match.cpp: Time finding the register splits that    *
+ * imported transactions may match.                                 *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/* Usage: bench-import-match [existing-splits [imported [checked]]]
+ *
+ * Builds an account holding splits (500k by default) spread over two
+ * years and imports transactions (10k by default) dated in the second
+ * year, some of them copies of existing ones. Each imported transaction
+ * is matched through a GNCImportMatchIndex, and the first of them (100
+ * by default) also by calling split_find_match for every split of the
+ * account, as the main matcher used to do. Both must give the same
+ * match lists.
+ */
+
+#include <glib.h>
+#include <gtk/gtk.h> /* for references in import-backend.h */
+
+#include <config.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gnc-bench.hpp>
+
+#include "qof.h"
+#include "cashobjects.h"
+#include "Account.h"
+#include "Split.h"
+#include "Transaction.h"
+#include "TransLog.h"
+#include "gnc-commodity.h"
+#include "import-backend.h"
+
+static constexpr time64 seconds_per_day = 24 * 60 * 60;
+static constexpr time64 start_date = 1577880000; /* 2020-01-01 12:00 UTC */
+static constexpr time64 two_years = 730 * seconds_per_day;
+
+/* The main matcher's default settings. */
+static constexpr gint display_threshold = 1;
+static constexpr gint date_threshold = 4;
+static constexpr gint date_not_threshold = 14;
+static constexpr double fuzzy_amount = 2.0;
+
+struct Entry
+{
+    time64 date;
+    gint64 cents;
+    int payee;
+    int num;
+};
+
+static Split *
+add_transaction (QofBook *book, Account *acc, Account *offset, const Entry& entry)
+{
+    auto table = gnc_commodity_table_get_table (book);
+    auto currency = gnc_commodity_table_lookup (table, "ISO4217", "USD");
+    auto amount = gnc_numeric_create (entry.cents, 100);
+
+    auto trans = xaccMallocTransaction (book);
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, currency);
+    xaccTransSetDatePostedSecsNormalized (trans, entry.date);
+    xaccTransSetDescription (trans, ("Payee " + std::to_string (entry.payee)).c_str ());
+    if (entry.num)
+        xaccTransSetNum (trans, std::to_string (entry.num).c_str ());
+
+    auto split = xaccMallocSplit (book);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, acc);
+    xaccSplitSetAmount (split, amount);
+    xaccSplitSetValue (split, amount);
+
+    auto other = xaccMallocSplit (book);
+    xaccSplitSetParent (other, trans);
+    xaccSplitSetAccount (other, offset);
+    xaccSplitSetAmount (other, gnc_numeric_neg (amount));
+    xaccSplitSetValue (other, gnc_numeric_neg (amount));
+    xaccTransCommitEdit (trans);
+    return split;
+}
+
+static void
+free_matches (GNCImportTransInfo *info)
+{
+    g_list_free_full (gnc_import_TransInfo_get_match_list (info), g_free);
+    gnc_import_TransInfo_set_match_list (info, nullptr);
+}
+
+static bool
+same_matches (GList *a, GList *b)
+{
+    for (; a && b; a = a->next, b = b->next)
+    {
+        auto ma = static_cast<GNCImportMatchInfo*>(a->data);
+        auto mb = static_cast<GNCImportMatchInfo*>(b->data);
+        if (ma->split != mb->split || ma->probability != mb->probability ||
+            ma->update_proposed != mb->update_proposed)
+            return false;
+    }
+    return !a && !b;
+}
+
+int
+main (int argc, char **argv)
+{
+    int nexisting = bench_arg (argc, argv, 1, 500000);
+    int nimported = bench_arg (argc, argv, 2, 10000);
+    int nchecked = bench_arg (argc, argv, 3, 100);
+    int failures = 0;
+
+    if (nexisting < 1 || nimported < 1)
+        return EXIT_FAILURE;
+    nchecked = std::min (std::max (nchecked, 0), nimported);
+
+    qof_init ();
+    if (!cashobjects_register ())
+        return EXIT_FAILURE;
+    xaccLogDisable ();
+
+    auto book = qof_book_new ();
+    auto root = gnc_account_create_root (book);
+    auto acc = xaccMallocAccount (book);
+    auto offset = xaccMallocAccount (book);
+    gnc_account_append_child (root, acc);
+    gnc_account_append_child (root, offset);
+
+    std::mt19937 gen (42);
+    std::uniform_int_distribution<time64> date_dist (start_date, start_date + two_years);
+    std::uniform_int_distribution<gint64> cents_dist (-50000, 50000);
+    std::uniform_int_distribution<int> payee_dist (1, 200);
+    std::uniform_int_distribution<int> num_dist (0, 3000);
+
+    auto start = Clock::now ();
+    std::vector<Entry> existing (nexisting);
+    std::vector<Split*> candidates;
+    candidates.reserve (nexisting);
+    xaccAccountBeginEdit (acc);
+    xaccAccountBeginEdit (offset);
+    for (auto& entry : existing)
+    {
+        entry = {date_dist (gen), cents_dist (gen), payee_dist (gen), num_dist (gen)};
+        candidates.push_back (add_transaction (book, acc, offset, entry));
+    }
+
+    /* One in ten imported transactions was already entered, a few days
+     * off; the others are new. */
+    std::uniform_int_distribution<int> pick_dist (0, nexisting - 1);
+    std::uniform_int_distribution<time64> shift_dist (-3 * seconds_per_day, 3 * seconds_per_day);
+    std::uniform_int_distribution<time64> second_year (start_date + two_years / 2,
+                                                       start_date + two_years);
+    std::vector<GNCImportTransInfo*> imported;
+    imported.reserve (nimported);
+    for (int i = 0; i < nimported; ++i)
+    {
+        Entry entry;
+        if (i % 10 == 0)
+        {
+            entry = existing[pick_dist (gen)];
+            entry.date += shift_dist (gen);
+        }
+        else
+            entry = {second_year (gen), cents_dist (gen), payee_dist (gen), 0};
+        auto split = add_transaction (book, acc, offset, entry);
+        imported.push_back (gnc_import_TransInfo_new (xaccSplitGetParent (split), nullptr));
+    }
+    xaccAccountCommitEdit (offset);
+    xaccAccountCommitEdit (acc);
+    std::cout << "Created " << nexisting << " splits and " << nimported
+              << " imported transactions in " << elapsed_ms (start) << " ms\n";
+
+    start = Clock::now ();
+    std::vector<GList*> expected;
+    for (int i = 0; i < nchecked; ++i)
+    {
+        for (auto split : candidates)
+            split_find_match (imported[i], split, display_threshold,
+                              date_threshold, date_not_threshold, fuzzy_amount);
+        expected.push_back (gnc_import_TransInfo_get_match_list (imported[i]));
+        gnc_import_TransInfo_set_match_list (imported[i], nullptr);
+    }
+    auto linear_ms = elapsed_ms (start);
+
+    start = Clock::now ();
+    auto index = gnc_import_MatchIndex_new (display_threshold, date_threshold,
+                                            date_not_threshold, fuzzy_amount);
+    for (auto split : candidates)
+        gnc_import_MatchIndex_add_split (index, split);
+    for (auto info : imported)
+        gnc_import_MatchIndex_find_matches (index, info);
+    auto indexed_ms = elapsed_ms (start);
+    gnc_import_MatchIndex_delete (index);
+
+    size_t nmatches = 0;
+    for (int i = 0; i < nimported; ++i)
+    {
+        auto matches = gnc_import_TransInfo_get_match_list (imported[i]);
+        nmatches += g_list_length (matches);
+        if (i < nchecked)
+        {
+            if (!same_matches (expected[i], matches))
+                ++failures;
+            g_list_free_full (expected[i], g_free);
+        }
+        free_matches (imported[i]);
+        gnc_import_TransInfo_delete (imported[i]);
+    }
+
+    std::cout << nchecked << " transactions matched against every split: "
+              << linear_ms << " ms";
+    if (nchecked)
+        std::cout << ", " << linear_ms / nchecked * nimported
+                  << " ms projected for " << nimported;
+    std::cout << "\n" << nimported << " transactions matched through the index: "
+              << indexed_ms << " ms, " << nmatches << " matches\n";
+    if (failures)
+        std::cout << failures << " transactions got different matches\n";
+
+    qof_book_destroy (book);
+    qof_close ();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -662,23 +662,24 @@ static Split *
 gnc_find_split_in_account_by_memo (Account *account, const char *memo,
                                    gboolean unit_price)
 {
-    GList *slp;
+    GList *splits, *slp;
+    Split *retval = NULL;
 
     if (account == NULL) return NULL;
 
-    for (slp = g_list_last (xaccAccountGetSplitList (account));
-            slp;
-            slp = slp->prev)
+    splits = xaccAccountGetSplitList (account);
+    for (slp = g_list_last (splits); slp; slp = slp->prev)
     {
         Split *split = slp->data;
         Transaction *trans = xaccSplitGetParent (split);
 
-        split = gnc_find_split_in_trans_by_memo (trans, memo, unit_price);
+        retval = gnc_find_split_in_trans_by_memo (trans, memo, unit_price);
 
-        if (split) return split;
+        if (retval) break;
     }
+    g_list_free (splits);
 
-    return NULL;
+    return retval;
 }
 
 static Split *
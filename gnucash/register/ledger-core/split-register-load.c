@@ -50,6 +50,9 @@
 /* This static indicates the debugging module that this .o belongs to. */
 static QofLogModule log_module = GNC_MOD_LEDGER;
 
+/* Number of transactions added to the quickfill cells per idle call */
+#define QUICKFILL_CHUNK 500
+
 
 static void gnc_split_register_load_xfer_cells (SplitRegister* reg,
                                                 Account* base_account);
@@ -241,18 +244,12 @@ _find_split_with_parent_txn (gconstpointer a, gconstpointer b)
     return xaccSplitGetParent (split) == txn ? 0 : 1;
 }
 
-static void add_quickfill_completions (TableLayout* layout, Transaction* trans,
-                                       Split* split, gboolean has_last_num)
+static void add_quickfill_completions (TableLayout* layout, Transaction* trans)
 {
     gnc_quickfill_cell_add_completion (
         (QuickFillCell*) gnc_table_layout_get_cell (layout, NOTES_CELL),
         xaccTransGetNotes (trans));
 
-    if (!has_last_num)
-        gnc_num_cell_set_last_num (
-            (NumCell*) gnc_table_layout_get_cell (layout, NUM_CELL),
-            gnc_get_num_action (trans, split));
-
     for (GList *n = xaccTransGetSplitList (trans); n; n = n->next)
     {
         Split *s = n->data;
@@ -262,6 +259,49 @@ static void add_quickfill_completions (TableLayout* layout, Transaction* trans,
     }
 }
 
+/* Adds the next chunk of the loaded transactions to the description
+ * menu and, after the first load, to the quickfill cells. Transactions
+ * deleted since the load are skipped. */
+static gboolean
+quickfill_idle_cb (gpointer user_data)
+{
+    SplitRegister* reg = user_data;
+    SRInfo* info = gnc_split_register_get_info (reg);
+    TableLayout* layout = reg->table->layout;
+    QofBook* book = gnc_get_current_book ();
+    ComboCell* desc_cell;
+    guint end;
+
+    desc_cell = (ComboCell*) gnc_table_layout_get_cell (layout, DESC_CELL);
+    end = MIN (info->quickfill_next + QUICKFILL_CHUNK,
+               info->quickfill_guids->len);
+
+    for (; info->quickfill_next < end; info->quickfill_next++)
+    {
+        GncGUID* guid = &g_array_index (info->quickfill_guids, GncGUID,
+                                        info->quickfill_next);
+        Transaction* trans = xaccTransLookup (guid, book);
+
+        if (!trans)
+            continue;
+
+        if (info->quickfill_full)
+            add_quickfill_completions (layout, trans);
+
+        gnc_combo_cell_add_menu_item_unique (desc_cell,
+                                             xaccTransGetDescription (trans));
+    }
+
+    if (info->quickfill_next < info->quickfill_guids->len)
+        return TRUE;
+
+    g_array_set_size (info->quickfill_guids, 0);
+    info->quickfill_next = 0;
+    info->quickfill_full = FALSE;
+    info->quickfill_idle_id = 0;
+    return FALSE;
+}
+
 static Split*
 create_blank_split (Account* default_account, SRInfo* info)
 {
@@ -574,6 +614,14 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
     if (multi_line)
         trans_table = g_hash_table_new (g_direct_hash, g_direct_equal);
 
+    /* queue the transactions for quickfill_idle_cb; a reload replaces
+     * the queue but keeps the notes and memos of a first pass to do */
+    if (!info->quickfill_guids)
+        info->quickfill_guids = g_array_new (FALSE, FALSE, sizeof (GncGUID));
+    g_array_set_size (info->quickfill_guids, 0);
+    info->quickfill_next = 0;
+    info->quickfill_full = info->quickfill_full || info->first_pass;
+
     /* populate the table */
     for (node = slist; node; node = node->next)
     {
@@ -666,14 +714,15 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
             }
         }
 
-        /* If this is the first load of the register,
-         * fill up the quickfill cells. */
-        if (info->first_pass)
-            add_quickfill_completions (reg->table->layout, trans, split, has_last_num);
+        /* If this is the first load of the register, take the last
+         * number from the transactions. Their text is added to the
+         * quickfill cells and the description menu in the background. */
+        if (info->first_pass && !has_last_num)
+            gnc_num_cell_set_last_num (
+                (NumCell*) gnc_table_layout_get_cell (table->layout, NUM_CELL),
+                gnc_get_num_action (trans, split));
 
-        gnc_combo_cell_add_menu_item_unique (
-            (ComboCell*) gnc_table_layout_get_cell (reg->table->layout, DESC_CELL),
-            xaccTransGetDescription (trans));
+        g_array_append_vals (info->quickfill_guids, xaccTransGetGUID (trans), 1);
 
         if (trans == find_trans)
             new_trans_row = vcell_loc.virt_row;
@@ -752,6 +801,9 @@ gnc_split_register_load (SplitRegister* reg, GList* slist,
         }
     }
 
+    if (info->quickfill_guids->len > 0 && !info->quickfill_idle_id)
+        info->quickfill_idle_id = g_idle_add (quickfill_idle_cb, reg);
+
     /* go to blank on first pass */
     if (info->first_pass)
     {
@@ -133,6 +133,17 @@ struct sr_info
 
     /** true if the account separator has changed */
     gboolean separator_changed;
+
+    /** GUIDs of the loaded transactions whose text still has to be
+     * added to the description menu in the background */
+    GArray *quickfill_guids;
+    guint quickfill_next;
+
+    /** true if their notes and memos go into the quickfill cells too */
+    gboolean quickfill_full;
+
+    /** idle source working through quickfill_guids, or 0 */
+    guint quickfill_idle_id;
 };
 
 
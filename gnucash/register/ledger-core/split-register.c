@@ -2984,6 +2984,12 @@ gnc_split_register_destroy_info (SplitRegister* reg)
     if (!info)
         return;
 
+    if (info->quickfill_idle_id)
+        g_source_remove (info->quickfill_idle_id);
+
+    if (info->quickfill_guids)
+        g_array_free (info->quickfill_guids, TRUE);
+
     g_free (info->tdebit_str);
     g_free (info->tcredit_str);
 
@@ -59,6 +59,143 @@ static void gnc_table_free_data (Table * table);
 static void gnc_virtual_cell_construct (gpointer vcell, gpointer user_data);
 static void gnc_virtual_cell_destroy (gpointer vcell, gpointer user_data);
 static void gnc_table_resize (Table * table, int virt_rows, int virt_cols);
+static void gnc_table_invalidate_vcell (Table *table,
+                                        VirtualCellLocation vcell_loc);
+
+
+/** Entry cache ********************************************************/
+
+/* The entries fetched for one virtual cell near the viewport. The
+ * array has one slot per physical cell of the cellblock and is filled
+ * as the cells are drawn. */
+typedef struct
+{
+    VirtualCellLocation vcell_loc;
+    CellBlock *cellblock;
+    int num_cells;
+    gchar **entries;
+} EntryRow;
+
+static guint
+entry_row_hash (gconstpointer key)
+{
+    const VirtualCellLocation *vcell_loc = key;
+
+    return (guint) vcell_loc->virt_row * 31 + (guint) vcell_loc->virt_col;
+}
+
+static gboolean
+entry_row_equal (gconstpointer a, gconstpointer b)
+{
+    return virt_cell_loc_equal (*(const VirtualCellLocation *) a,
+                                *(const VirtualCellLocation *) b);
+}
+
+static void
+entry_row_free (gpointer data)
+{
+    EntryRow *row = data;
+    int i;
+
+    for (i = 0; i < row->num_cells; i++)
+        g_free (row->entries[i]);
+
+    g_free (row->entries);
+    g_free (row);
+}
+
+/* The rows kept are those of the viewport and one viewport height
+ * either side of it, so that scrolling by a page still hits. */
+static gboolean
+gnc_table_row_near_viewport (Table *table, int virt_row)
+{
+    int margin;
+
+    if (table->viewport_last_row < table->viewport_first_row)
+        return FALSE;
+
+    margin = table->viewport_last_row - table->viewport_first_row + 1;
+
+    return virt_row >= table->viewport_first_row - margin &&
+           virt_row <= table->viewport_last_row + margin;
+}
+
+/* Returns the entry row for vcell_loc, creating it if needed, or NULL
+ * if the location's entries should not be kept. */
+static EntryRow *
+gnc_table_get_entry_row (Table *table, VirtualCellLocation vcell_loc)
+{
+    VirtualCell *vcell;
+    EntryRow *row;
+
+    if (!table->entry_cache ||
+            !gnc_table_row_near_viewport (table, vcell_loc.virt_row))
+        return NULL;
+
+    vcell = gnc_table_get_virtual_cell (table, vcell_loc);
+    if (!vcell || !vcell->cellblock)
+        return NULL;
+
+    row = g_hash_table_lookup (table->entry_cache, &vcell_loc);
+    if (row && row->cellblock == vcell->cellblock)
+        return row;
+
+    row = g_new0 (EntryRow, 1);
+    row->vcell_loc = vcell_loc;
+    row->cellblock = vcell->cellblock;
+    row->num_cells = vcell->cellblock->num_rows * vcell->cellblock->num_cols;
+    row->entries = g_new0 (gchar *, row->num_cells);
+
+    g_hash_table_replace (table->entry_cache, &row->vcell_loc, row);
+
+    return row;
+}
+
+static gboolean
+entry_row_outside_viewport (gpointer key, gpointer value, gpointer user_data)
+{
+    const VirtualCellLocation *vcell_loc = key;
+
+    return !gnc_table_row_near_viewport (user_data, vcell_loc->virt_row);
+}
+
+void
+gnc_table_set_viewport (Table *table, int first_row, int last_row)
+{
+    if (!table)
+        return;
+
+    table->viewport_first_row = first_row;
+    table->viewport_last_row = last_row;
+
+    if (last_row < first_row)
+    {
+        gnc_table_invalidate_entries (table);
+        return;
+    }
+
+    if (!table->entry_cache)
+        table->entry_cache = g_hash_table_new_full (entry_row_hash,
+                                                    entry_row_equal,
+                                                    NULL, entry_row_free);
+    else
+        g_hash_table_foreach_remove (table->entry_cache,
+                                     entry_row_outside_viewport, table);
+}
+
+void
+gnc_table_invalidate_entries (Table *table)
+{
+    if (table && table->entry_cache)
+        g_hash_table_remove_all (table->entry_cache);
+}
+
+static void
+gnc_table_invalidate_vcell (Table *table, VirtualCellLocation vcell_loc)
+{
+    if (table->entry_cache)
+        g_hash_table_remove (table->entry_cache, &vcell_loc);
+}
 
 
 /** Implementation *****************************************************/
@@ -112,6 +249,10 @@ gnc_table_init (Table * table)
 
     table->virt_cells = NULL;
     table->ui_data = NULL;
+
+    table->entry_cache = NULL;
+    table->viewport_first_row = 0;
+    table->viewport_last_row = -1;
 }
 
 void
@@ -127,6 +268,9 @@ gnc_table_destroy (Table * table)
     /* free the cell tables */
     g_table_destroy (table->virt_cells);
 
+    if (table->entry_cache)
+        g_hash_table_destroy (table->entry_cache);
+
     gnc_table_layout_destroy (table->layout);
     table->layout = NULL;
 
@@ -269,6 +413,8 @@ gnc_table_get_entry (Table *table, VirtualLocation virt_loc)
     TableGetEntryHandler entry_handler;
     const char *entry;
     BasicCell *cell;
+    EntryRow *row;
+    int index = 0;
 
     cell = gnc_table_get_cell (table, virt_loc);
     if (!cell || !cell->cell_name)
@@ -283,6 +429,19 @@ gnc_table_get_entry (Table *table, VirtualLocation virt_loc)
 
         if (io_flags & XACC_CELL_ALLOW_INPUT)
             return cell->value;
+
+        /* the other cells of the cursor row may show its edits */
+        row = NULL;
+    }
+    else
+        row = gnc_table_get_entry_row (table, virt_loc.vcell_loc);
+
+    if (row)
+    {
+        index = virt_loc.phys_row_offset * row->cellblock->num_cols +
+                virt_loc.phys_col_offset;
+        if (row->entries[index])
+            return row->entries[index];
     }
 
     entry_handler = gnc_table_model_get_entry_handler (table->model,
@@ -294,6 +453,12 @@ gnc_table_get_entry (Table *table, VirtualLocation virt_loc)
     if (!entry)
         entry = "";
 
+    if (row)
+    {
+        row->entries[index] = g_strdup (entry);
+        return row->entries[index];
+    }
+
     return entry;
 }
 
@@ -595,6 +760,7 @@ gnc_table_set_size (Table * table, int virt_rows, int virt_cols)
     {
         gnc_virtual_location_init (&table->current_cursor_loc);
         table->current_cursor = NULL;
+        gnc_table_invalidate_entries (table);
     }
 
     gnc_table_resize (table, virt_rows, virt_cols);
@@ -683,6 +849,8 @@ gnc_table_set_vcell (Table *table,
     if (vcell == NULL)
         return;
 
+    gnc_table_invalidate_vcell (table, vcell_loc);
+
     /* this cursor is the handler for this block */
     vcell->cellblock = cursor;
 
@@ -710,6 +878,8 @@ gnc_table_set_virt_cell_data (Table *table,
     if (vcell == NULL)
         return;
 
+    gnc_table_invalidate_vcell (table, vcell_loc);
+
     if (table->model->cell_data_copy)
         table->model->cell_data_copy (vcell->vcell_data, vcell_data);
     else
@@ -730,6 +900,8 @@ gnc_table_set_virt_cell_visible (Table *table,
     if (vcell == NULL)
         return;
 
+    gnc_table_invalidate_vcell (table, vcell_loc);
+
     vcell->visible = visible ? 1 : 0;
 }
 
@@ -747,6 +919,8 @@ gnc_table_set_virt_cell_cursor (Table *table,
     if (vcell == NULL)
         return;
 
+    gnc_table_invalidate_vcell (table, vcell_loc);
+
     vcell->cellblock = cursor;
 }
 
@@ -782,6 +956,10 @@ gnc_table_move_cursor_internal (Table *table,
     /* invalidate the cursor for now; we'll fix it back up below */
     gnc_virtual_location_init (&table->current_cursor_loc);
 
+    /* the move callback may have saved the old cursor's changes, and
+     * the rows of the transaction being edited show them */
+    gnc_table_invalidate_entries (table);
+
     curs = table->current_cursor;
     table->current_cursor = NULL;
 
@@ -1518,6 +1696,8 @@ gnc_table_refresh_cursor_gui (Table * table,
     g_return_if_fail (table != NULL);
     g_return_if_fail (table->gui_handlers.cursor_refresh != NULL);
 
+    gnc_table_invalidate_entries (table);
+
     table->gui_handlers.cursor_refresh (table, vcell_loc, do_scroll);
 }
 
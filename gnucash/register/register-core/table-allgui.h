@@ -64,6 +64,9 @@
  *  - An array of virtual cells. These cells contain:
  *     - the cellblock handler for that virtual cell.
  *     - a user data pointer
+ *  - Cell entries fetched from the model when they are drawn. Only
+ *     the entries of the rows around the GUI's viewport are kept; the
+ *     rest of the table is just its virtual cells.
  *  - Tab-traversing mechanism so that operator can tab in a
  *     predefined order between cells.
  *
@@ -174,6 +177,11 @@ struct table
     /* The virtual cell table */
     GTable *virt_cells;
 
+    /* Entries kept for the rows around the viewport */
+    GHashTable *entry_cache;
+    int viewport_first_row;
+    int viewport_last_row;
+
     TableGUIHandlers gui_handlers;
     gpointer ui_data;
 };
@@ -238,6 +246,18 @@ VirtualCell *  gnc_table_get_virtual_cell (Table *table,
 
 const char *   gnc_table_get_entry (Table *table, VirtualLocation virt_loc);
 
+/** Tell the table which virtual rows the GUI is showing. While a viewport
+ *  is set, gnc_table_get_entry() keeps the entries it fetches for rows
+ *  within a viewport's height of it, so redraws and short scrolls do not
+ *  format them again. Entries of the current cursor row are never kept.
+ *  Passing a last_row below first_row clears the viewport. */
+void           gnc_table_set_viewport (Table *table, int first_row,
+                                       int last_row);
+
+/** Forget all kept entries. Call this when the model has changed in a
+ *  way the table cannot see, e.g. after a reload or a preference change. */
+void           gnc_table_invalidate_entries (Table *table);
+
 char *         gnc_table_get_tooltip (Table *table, VirtualLocation virt_loc);
 
 const char *   gnc_table_get_label (Table *table, VirtualLocation virt_loc);
@@ -490,25 +490,41 @@ gnucash_sheet_cursor_move (GnucashSheet *sheet, VirtualLocation virt_loc)
 }
 
 
-static gint
+/* Returns the first visible block ending below pixel row y, or
+ * num_virt_rows if there is none. The bottom edges of the blocks never
+ * decrease down the sheet, taking an invisible block's to be its
+ * origin, so the block is found by bisection. */
+gint
 gnucash_sheet_y_pixel_to_block (GnucashSheet *sheet, int y)
 {
     VirtualCellLocation vcell_loc = { 1, 0 };
+    gint lo = 1;
+    gint hi = sheet->num_virt_rows;
 
-    for (;
-            vcell_loc.virt_row < sheet->num_virt_rows;
-            vcell_loc.virt_row++)
+    while (lo < hi)
     {
         SheetBlock *block;
+        gint bottom;
+
+        vcell_loc.virt_row = lo + (hi - lo) / 2;
 
         block = gnucash_sheet_get_block (sheet, vcell_loc);
-        if (!block || !block->visible)
+        if (!block)
+        {
+            lo = vcell_loc.virt_row + 1;
             continue;
+        }
 
-        if (block->origin_y + block->style->dimensions->height > y)
-            break;
+        bottom = block->origin_y;
+        if (block->visible)
+            bottom += block->style->dimensions->height;
+
+        if (bottom > y)
+            hi = vcell_loc.virt_row;
+        else
+            lo = vcell_loc.virt_row + 1;
     }
-    return vcell_loc.virt_row;
+    return lo;
 }
 
 
@@ -553,6 +569,11 @@ gnucash_sheet_compute_visible_range (GnucashSheet *sheet)
                 >= height)
             break;
     }
+
+    if (sheet->table)
+        gnc_table_set_viewport (sheet->table, top_block,
+                                MIN (vcell_loc.virt_row,
+                                     sheet->num_virt_rows - 1));
 }
 
 
@@ -732,6 +753,8 @@ gnucash_sheet_redraw_all (GnucashSheet *sheet)
     g_return_if_fail (sheet != NULL);
     g_return_if_fail (GNUCASH_IS_SHEET(sheet));
 
+    gnc_table_invalidate_entries (sheet->table);
+
     gtk_widget_queue_draw (GTK_WIDGET(sheet));
 
     g_signal_emit_by_name (sheet->reg, "redraw_all");
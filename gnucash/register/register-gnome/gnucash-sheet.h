@@ -88,6 +88,8 @@ void gnucash_sheet_cursor_set_from_table (GnucashSheet *sheet,
 
 void gnucash_sheet_compute_visible_range (GnucashSheet *sheet);
 
+gint gnucash_sheet_y_pixel_to_block (GnucashSheet *sheet, int y);
+
 void gnucash_sheet_make_cell_visible (GnucashSheet *sheet,
                                       VirtualLocation virt_loc);
 
@@ -27,6 +27,7 @@
 #include "gnc-prefs-utils.h"
 #include "gnc-prefs.h"
 #include "xml/gnc-backend-xml.h"
+#include "TransLog.h"
 
 static QofLogModule log_module = G_LOG_DOMAIN;
 
@@ -36,6 +37,9 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 #define GNC_PREF_RETAIN_TYPE_DAYS    "retain-type-days"
 #define GNC_PREF_RETAIN_TYPE_FOREVER "retain-type-forever"
 #define GNC_PREF_RETAIN_DAYS         "retain-days"
+#define GNC_PREF_TRANSLOG_BINARY     "translog-binary"
+#define GNC_PREF_TRANSLOG_FLUSH      "translog-flush-interval"
+#define GNC_PREF_TRANSLOG_SYNC       "translog-sync"
 
 /***************************************************************
  * Initialization                                              *
@@ -78,6 +82,35 @@ file_compression_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
     }
 }
 
+static guint translog_flush_source = 0;
+
+static gboolean
+translog_flush_cb (gpointer user_data)
+{
+    xaccLogFlush ();
+    return G_SOURCE_CONTINUE;
+}
+
+static void
+translog_changed_cb(gpointer gsettings, gchar *key, gpointer user_data)
+{
+    if (gnc_prefs_is_set_up())
+    {
+        gint interval = gnc_prefs_get_int(GNC_PREFS_GROUP_GENERAL, GNC_PREF_TRANSLOG_FLUSH);
+        xaccLogSetFlushInterval (MAX (interval, 0));
+
+        /* Held log entries are otherwise only written out when more are
+         * logged, so write them out once the interval is over even if
+         * nothing else is changed. */
+        if (translog_flush_source)
+            g_source_remove (translog_flush_source);
+        translog_flush_source = interval > 0 ?
+            g_timeout_add (interval, translog_flush_cb, NULL) : 0;
+        xaccLogSetSync (gnc_prefs_get_bool(GNC_PREFS_GROUP_GENERAL, GNC_PREF_TRANSLOG_SYNC));
+        xaccLogSetBinary (gnc_prefs_get_bool(GNC_PREFS_GROUP_GENERAL, GNC_PREF_TRANSLOG_BINARY));
+    }
+}
+
 
 void gnc_prefs_init (void)
 {
@@ -89,6 +122,7 @@ void gnc_prefs_init (void)
     file_retain_changed_cb (NULL, NULL, NULL);
     file_retain_type_changed_cb (NULL, NULL, NULL);
     file_compression_changed_cb (NULL, NULL, NULL);
+    translog_changed_cb (NULL, NULL, NULL);
 
     /* Check for invalid retain_type (days)/retain_days (0) combo.
      * This can happen either because a user changed the preferences
@@ -122,6 +156,12 @@ void gnc_prefs_init (void)
                            file_retain_type_changed_cb, NULL);
     gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_COMPRESSION,
                            file_compression_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_TRANSLOG_BINARY,
+                           translog_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_TRANSLOG_FLUSH,
+                           translog_changed_cb, NULL);
+    gnc_prefs_register_cb (GNC_PREFS_GROUP_GENERAL, GNC_PREF_TRANSLOG_SYNC,
+                           translog_changed_cb, NULL);
 
 }
 
@@ -139,4 +179,10 @@ gnc_prefs_remove_registered (void)
                            file_retain_type_changed_cb, NULL);
     gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_FILE_COMPRESSION,
                            file_compression_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_TRANSLOG_BINARY,
+                           translog_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_TRANSLOG_FLUSH,
+                           translog_changed_cb, NULL);
+    gnc_prefs_remove_cb_by_func (GNC_PREFS_GROUP_GENERAL, GNC_PREF_TRANSLOG_SYNC,
+                           translog_changed_cb, NULL);
 }
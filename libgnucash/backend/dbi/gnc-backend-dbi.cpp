@@ -951,6 +951,10 @@ GncDbiBackend<Type>::safe_sync (QofBook* book)
     g_return_if_fail (book != nullptr);
 
     ENTER ("book=%p, primary=%p", book, m_book);
+    /* The tables are renamed before sync() writes the book, so everything
+     * must be read first. */
+    if (partly_loaded())
+        load (m_book, LOAD_TYPE_LOAD_ALL);
     if (!conn->begin_transaction())
     {
         LEAVE("Failed to obtain a transaction.");
@@ -994,6 +998,10 @@ GncDbiBackend<DbType::DBI_MYSQL>::safe_sync (QofBook* book)
     g_return_if_fail (book != nullptr);
 
     ENTER ("book=%p, primary=%p", book, m_book);
+    /* The tables are renamed before sync() writes the book, so everything
+     * must be read first. */
+    if (partly_loaded())
+        load (m_book, LOAD_TYPE_LOAD_ALL);
     if (!conn->table_operation (TableOpType::backup))
     {
         set_error(ERR_BACKEND_SERVER_ERR);
@@ -44,6 +44,9 @@ public:
                                 const GncSqlColumnInfo& info) = 0;
     virtual StrVec get_index_list (dbi_conn conn) = 0;
     virtual void drop_index(dbi_conn conn, const std::string& index) = 0;
+    virtual std::string upsert_clause(const std::string& key,
+                                      const StrVec& update_cols) = 0;
+    virtual bool can_upsert(dbi_conn conn) = 0;
 };
 
 using GncDbiProviderPtr = std::unique_ptr<GncDbiProvider>;
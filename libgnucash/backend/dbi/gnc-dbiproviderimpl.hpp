@@ -44,6 +44,9 @@ public:
     void append_col_def(std::string& ddl, const GncSqlColumnInfo& info);
     StrVec get_index_list (dbi_conn conn);
     void drop_index(dbi_conn conn, const std::string& index);
+    std::string upsert_clause(const std::string& key,
+                              const StrVec& update_cols);
+    bool can_upsert(dbi_conn conn);
 };
 
 template <DbType T> GncDbiProviderPtr
@@ -385,4 +388,61 @@ GncDbiProviderImpl<DbType::DBI_MYSQL>::drop_index (dbi_conn conn, const std::str
     if (result)
         dbi_result_free (result);
 }
+
+/* SQLite (3.24 and later) and PostgreSQL (9.5 and later) share the
+ * ON CONFLICT syntax; MySQL has its own. */
+template <DbType P> std::string
+GncDbiProviderImpl<P>::upsert_clause(const std::string& key,
+                                     const StrVec& update_cols)
+{
+    std::string clause{" ON CONFLICT(" + key + ") DO "};
+    if (update_cols.empty())
+        return clause + "NOTHING";
+    clause += "UPDATE SET ";
+    for (auto const& col : update_cols)
+    {
+        if (col != *update_cols.begin())
+            clause += ",";
+        clause += col + "=excluded." + col;
+    }
+    return clause;
+}
+
+template<> std::string
+GncDbiProviderImpl<DbType::DBI_MYSQL>::upsert_clause(const std::string& key,
+                                                     const StrVec& update_cols)
+{
+    std::string clause{" ON DUPLICATE KEY UPDATE "};
+    /* Assigning the key to itself changes nothing, so the row counts as
+     * unaffected just like ON CONFLICT DO NOTHING. */
+    if (update_cols.empty())
+        return clause + key + "=" + key;
+    for (auto const& col : update_cols)
+    {
+        if (col != *update_cols.begin())
+            clause += ",";
+        clause += col + "=VALUES(" + col + ")";
+    }
+    return clause;
+}
+
+/* dbi_conn_get_engine_version() encodes version x.y.z as x * 10000 +
+ * y * 100 + z. ON CONFLICT came with SQLite 3.24 and PostgreSQL 9.5. */
+template<> bool
+GncDbiProviderImpl<DbType::DBI_SQLITE>::can_upsert(dbi_conn conn)
+{
+    return dbi_conn_get_engine_version (conn) >= 32400;
+}
+
+template<> bool
+GncDbiProviderImpl<DbType::DBI_PGSQL>::can_upsert(dbi_conn conn)
+{
+    return dbi_conn_get_engine_version (conn) >= 90500;
+}
+
+template<> bool
+GncDbiProviderImpl<DbType::DBI_MYSQL>::can_upsert(dbi_conn conn)
+{
+    return true;
+}
 #endif //__GNC_DBISQLPROVIDERIMPL_HPP__
@@ -84,6 +84,7 @@ GncDbiSqlConnection::GncDbiSqlConnection (DbType type, QofBackend* qbe,
             type == DbType::DBI_MYSQL ?
             make_dbi_provider<DbType::DBI_MYSQL>() :
             make_dbi_provider<DbType::DBI_PGSQL>()},
+    m_can_upsert{m_provider->can_upsert(conn)},
     m_conn_ok{true}, m_last_error{ERR_BACKEND_NO_ERR}, m_error_repeat{0},
     m_retry{false}, m_sql_savepoint{0}, m_readonly{false}
 {
@@ -549,6 +550,13 @@ GncDbiSqlConnection::quote_string (const std::string& unquoted_str)
     return retval;
 }
 
+std::string
+GncDbiSqlConnection::upsert_clause (const std::string& key,
+                                    const StrVec& update_cols) const noexcept
+{
+    return m_provider->upsert_clause (key, update_cols);
+}
+
 
 /** Check if the dbi connection is valid. If not attempt to re-establish it
  * Returns TRUE if there is a valid connection in the end or FALSE otherwise
@@ -60,6 +60,10 @@ public:
     bool add_columns_to_table (const std::string&, const ColVec&)
         const noexcept override;
     std::string quote_string (const std::string&) const noexcept override;
+    std::string upsert_clause (const std::string& key,
+                               const StrVec& update_cols)
+        const noexcept override;
+    bool can_upsert () const noexcept override { return m_can_upsert; }
     int dberror() const noexcept override {
         return dbi_conn_error(m_conn, nullptr); }
     QofBackend* qbe () const noexcept { return m_qbe; }
@@ -89,6 +93,8 @@ private:
     QofBackend* m_qbe = nullptr;
     dbi_conn m_conn;
     std::unique_ptr<GncDbiProvider> m_provider;
+    /** The server is new enough for the provider's upsert_clause. */
+    bool m_can_upsert;
     /** Used by the error handler routines to flag if the connection is ok to
      * use
      */
@@ -184,3 +184,115 @@ GncDbiSqlResult::IteratorImpl::get_time64_at_col (const char* col) const
 
 /* --------------------------------------------------------- */
 
+/* Column types that fetch_columns() accepts for each requested type. The
+ * TIME64 string case covers databases that store dates as text. */
+static bool
+field_type_matches (GncSqlColumnType type, unsigned short field_type)
+{
+    switch (type)
+    {
+    case GncSqlColumnType::INT64:
+        return field_type == DBI_TYPE_INTEGER;
+    case GncSqlColumnType::TIME64:
+        return field_type == DBI_TYPE_DATETIME || field_type == DBI_TYPE_STRING;
+    case GncSqlColumnType::STRING:
+    case GncSqlColumnType::GUID:
+        return field_type == DBI_TYPE_STRING;
+    }
+    return false;
+}
+
+/* The current row's datetime at a field index; see get_time64_at_col for
+ * why it's read this way. */
+static time64
+datetime_at_idx (dbi_result_t* result, unsigned int idx)
+{
+#if HAVE_LIBDBI_TO_LONGLONG
+    time64 retval = dbi_result_get_as_longlong_idx (result, idx);
+#else
+    auto row = dbi_result_get_currow (result);
+    time64 retval = result->rows[row]->field_values[idx - 1].d_datetime;
+#endif //HAVE_LIBDBI_TO_LONGLONG
+    if (retval < MINTIME || retval > MAXTIME)
+        retval = 0;
+    return retval;
+}
+
+void
+GncDbiSqlResult::resolve_fields (const GncSqlColumnBatch& columns)
+{
+    m_fetch_fields.clear();
+    m_fetch_fields.reserve (columns.size());
+    for (const auto& column : columns)
+    {
+        auto idx = dbi_result_get_field_idx (m_dbi_result, column.name());
+        unsigned short type = idx ?
+            dbi_result_get_field_type_idx (m_dbi_result, idx) : DBI_TYPE_ERROR;
+        if (idx && !field_type_matches (column.type(), type))
+        {
+            PWARN ("Column %s has type %d, which can't be decoded as requested.",
+                   column.name(), type);
+            idx = 0;
+        }
+        m_fetch_fields.push_back ({idx, type});
+    }
+}
+
+void
+GncDbiSqlResult::decode_field (const FetchField& field,
+                               GncSqlColumnBuffer& column) const
+{
+    auto result = (dbi_result_t*) (m_dbi_result);
+    if (field.idx == 0 || dbi_result_field_is_null_idx (result, field.idx))
+    {
+        column.append_null();
+        return;
+    }
+    switch (column.type())
+    {
+    case GncSqlColumnType::INT64:
+        column.append_int (dbi_result_get_longlong_idx (result, field.idx));
+        break;
+    case GncSqlColumnType::STRING:
+    case GncSqlColumnType::GUID:
+        column.append_string (dbi_result_get_string_idx (result, field.idx));
+        break;
+    case GncSqlColumnType::TIME64:
+        if (field.type == DBI_TYPE_STRING)
+            column.append_time_string (dbi_result_get_string_idx (result,
+                                                                  field.idx));
+        else
+            column.append_int (datetime_at_idx (result, field.idx));
+        break;
+    }
+}
+
+std::size_t
+GncDbiSqlResult::fetch_columns (GncSqlColumnBatch& columns,
+                                std::size_t max_rows)
+{
+    for (auto& column : columns)
+        column.clear();
+    if (m_dbi_result == nullptr)
+        return 0;
+    auto numrows = dbi_result_get_numrows (m_dbi_result);
+    if (numrows == DBI_ROW_ERROR)
+        return 0;
+    if (m_fetch_fields.size() != columns.size())
+        resolve_fields (columns);
+
+    std::size_t nrows = 0;
+    for (; nrows < max_rows && m_fetch_next <= numrows; ++nrows, ++m_fetch_next)
+    {
+        if (!dbi_result_seek_row (m_dbi_result, m_fetch_next))
+        {
+            PERR ("Error %d in dbi_result_seek_row()", dberror());
+            qof_backend_set_error (m_conn->qbe(), ERR_BACKEND_SERVER_ERR);
+            m_fetch_next = numrows + 1;
+            break;
+        }
+        for (std::size_t col = 0; col < columns.size(); ++col)
+            decode_field (m_fetch_fields[col], columns[col]);
+    }
+    return nrows;
+}
@@ -44,6 +44,7 @@ public:
     int dberror() const noexcept;
     GncSqlRow& begin();
     GncSqlRow& end() { return m_sentinel; }
+    std::size_t fetch_columns (GncSqlColumnBatch& columns, std::size_t max_rows);
 protected:
     class IteratorImpl : public GncSqlResult::IteratorImpl
     {
@@ -67,11 +68,22 @@ protected:
     };
 
 private:
+    /** A column of fetch_columns() resolved against the result set; idx 0
+     * means the column is missing or can't be decoded as requested. */
+    struct FetchField
+    {
+        unsigned int idx;
+        unsigned short type;
+    };
+    void resolve_fields (const GncSqlColumnBatch& columns);
+    void decode_field (const FetchField& field, GncSqlColumnBuffer& column) const;
     const GncDbiSqlConnection* m_conn = nullptr;
     dbi_result m_dbi_result;
     IteratorImpl m_iter;
     GncSqlRow m_row;
     GncSqlRow m_sentinel;
+    std::vector<FetchField> m_fetch_fields;
+    unsigned long long m_fetch_next = 1;
 
 };
 
@@ -0,0 +1,232 @@
+/********************************************************************
+ * bench-dbi-load.cpp: Time loading a book of many splits from an   *
+ * SQLite database.                                                 *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/* Usage: bench-dbi-load [number-of-splits [database-file]]
+ *
+ * Saves a book of two-split transactions (500k splits by default) to an
+ * SQLite database, a temporary one unless a file is given, and times
+ * loading it into a fresh book. It then times decoding the splits table
+ * alone twice: row by row through the GncSqlRow getters, which the
+ * default GncSqlResult::fetch_columns does, and through
+ * GncDbiSqlResult::fetch_columns' resolved column indexes. The loaded
+ * book must have every split and the same balances as the saved one.
+ */
+
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include <config.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <gnc-bench.hpp>
+
+#include <qof.h>
+#include <cashobjects.h>
+#include <TransLog.h>
+#include <Account.h>
+#include <Transaction.h>
+#include <gnc-commodity.h>
+
+#include <gnc-sql-backend.hpp>
+#include <gnc-sql-result.hpp>
+#include "../gnc-backend-dbi.h"
+
+static constexpr time64 seconds_per_day = 24 * 60 * 60;
+static constexpr time64 start_date = 946728000; /* 2000-01-01 12:00 UTC */
+static constexpr size_t batch_rows = 4096;
+
+struct bench_book
+{
+    Account* acc;
+    Account* offset;
+};
+
+static bench_book
+populate_book (QofBook* book, int ntrans)
+{
+    auto table = gnc_commodity_table_get_table (book);
+    auto currency = gnc_commodity_table_lookup (table, "ISO4217", "USD");
+    auto root = gnc_book_get_root_account (book);
+    bench_book bb;
+    bb.acc = xaccMallocAccount (book);
+    bb.offset = xaccMallocAccount (book);
+    xaccAccountSetCommodity (bb.acc, currency);
+    xaccAccountSetCommodity (bb.offset, currency);
+    gnc_account_append_child (root, bb.acc);
+    gnc_account_append_child (root, bb.offset);
+
+    xaccAccountBeginEdit (bb.acc);
+    xaccAccountBeginEdit (bb.offset);
+    for (int i = 0; i < ntrans; ++i)
+    {
+        auto amount = gnc_numeric_create ((i % 1000) - 400, 100);
+        auto trans = xaccMallocTransaction (book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, currency);
+        xaccTransSetDatePostedSecsNormalized (trans, start_date + (i % 7300) * seconds_per_day);
+        xaccTransSetNum (trans, std::to_string (i).c_str ());
+        xaccTransSetDescription (trans, "Payee & Sons");
+
+        auto split = xaccMallocSplit (book);
+        xaccSplitSetParent (split, trans);
+        xaccSplitSetAccount (split, bb.acc);
+        xaccSplitSetMemo (split, "groceries");
+        xaccSplitSetAmount (split, amount);
+        xaccSplitSetValue (split, amount);
+        if (i % 3 == 0)
+            xaccSplitSetReconcile (split, CREC);
+
+        auto other = xaccMallocSplit (book);
+        xaccSplitSetParent (other, trans);
+        xaccSplitSetAccount (other, bb.offset);
+        xaccSplitSetAmount (other, gnc_numeric_neg (amount));
+        xaccSplitSetValue (other, gnc_numeric_neg (amount));
+        xaccTransCommitEdit (trans);
+    }
+    xaccAccountCommitEdit (bb.offset);
+    xaccAccountCommitEdit (bb.acc);
+    return bb;
+}
+
+static bool
+balances_match (const bench_book& expected, QofBook* loaded)
+{
+    auto acc = xaccAccountLookup (xaccAccountGetGUID (expected.acc), loaded);
+    auto offset = xaccAccountLookup (xaccAccountGetGUID (expected.offset), loaded);
+    return acc && offset &&
+        gnc_numeric_equal (xaccAccountGetBalance (expected.acc),
+                           xaccAccountGetBalance (acc)) &&
+        gnc_numeric_equal (xaccAccountGetBalance (expected.offset),
+                           xaccAccountGetBalance (offset));
+}
+
+static GncSqlColumnBatch
+split_columns ()
+{
+    using T = GncSqlColumnType;
+    return GncSqlColumnBatch{
+        {"guid", T::GUID}, {"tx_guid", T::GUID}, {"account_guid", T::GUID},
+        {"memo", T::STRING}, {"action", T::STRING},
+        {"reconcile_state", T::STRING}, {"reconcile_date", T::TIME64},
+        {"value_num", T::INT64}, {"value_denom", T::INT64},
+        {"quantity_num", T::INT64}, {"quantity_denom", T::INT64},
+        {"lot_guid", T::GUID},
+    };
+}
+
+/* Decodes the splits table, through GncSqlRow if by_row is set, and
+ * returns the number of rows. */
+static size_t
+decode_splits (GncSqlBackend* sql_be, bool by_row)
+{
+    auto stmt = sql_be->create_statement_from_sql ("SELECT * FROM splits");
+    auto result = sql_be->execute_select_statement (stmt);
+    if (result == nullptr)
+        return 0;
+    auto columns = split_columns ();
+    size_t total = 0;
+    while (auto nrows = by_row ?
+           result->GncSqlResult::fetch_columns (columns, batch_rows) :
+           result->fetch_columns (columns, batch_rows))
+        total += nrows;
+    delete result;
+    return total;
+}
+
+int
+main (int argc, char** argv)
+{
+    int nsplits = bench_arg (argc, argv, 1, 500000);
+    auto ntrans = nsplits / 2;
+    std::string filename = argc > 2 ? argv[2] :
+        "/tmp/bench-dbi-load-" + std::to_string (getpid ()) + ".gnucash";
+    auto url = "sqlite3://" + filename;
+    int failures = 0;
+
+    qof_init ();
+    if (!cashobjects_register ())
+        return EXIT_FAILURE;
+    gnc_module_init_backend_dbi ();
+    xaccLogDisable ();
+
+    auto source = qof_session_new (qof_book_new ());
+    auto start = Clock::now ();
+    auto bb = populate_book (qof_session_get_book (source), ntrans);
+    std::cout << "Created " << ntrans << " transactions in "
+              << elapsed_ms (start) << " ms\n";
+
+    auto saved = qof_session_new (qof_book_new ());
+    qof_session_begin (saved, url.c_str (), SESSION_NEW_OVERWRITE);
+    qof_session_swap_data (source, saved);
+    qof_book_mark_session_dirty (qof_session_get_book (saved));
+    start = Clock::now ();
+    qof_session_save (saved, nullptr);
+    if (qof_session_get_error (saved) != ERR_BACKEND_NO_ERR)
+    {
+        std::cerr << "Saving " << url << " failed\n";
+        return EXIT_FAILURE;
+    }
+    std::cout << "Saved " << nsplits << " splits in " << elapsed_ms (start)
+              << " ms\n";
+
+    auto loaded = qof_session_new (qof_book_new ());
+    qof_session_begin (loaded, url.c_str (), SESSION_READ_ONLY);
+    start = Clock::now ();
+    qof_session_load (loaded, nullptr);
+    auto load_ms = elapsed_ms (start);
+    auto book = qof_session_get_book (loaded);
+    auto nloaded = qof_collection_count (qof_book_get_collection (book, GNC_ID_SPLIT));
+    if (qof_session_get_error (loaded) != ERR_BACKEND_NO_ERR ||
+        nloaded != static_cast<guint>(ntrans * 2) || !balances_match (bb, book))
+        ++failures;
+
+    auto sql_be = reinterpret_cast<GncSqlBackend*>(qof_session_get_backend (loaded));
+    start = Clock::now ();
+    auto row_count = decode_splits (sql_be, true);
+    auto row_ms = elapsed_ms (start);
+    start = Clock::now ();
+    auto column_count = decode_splits (sql_be, false);
+    auto column_ms = elapsed_ms (start);
+    if (row_count != nloaded || column_count != nloaded)
+        ++failures;
+
+    std::cout << "Loaded " << nloaded << " splits in " << load_ms << " ms\n"
+              << "Decoded the splits table by row in " << row_ms
+              << " ms, by column batch in " << column_ms << " ms\n";
+    if (failures)
+        std::cout << "The loaded book differs from the one saved\n";
+
+    qof_session_end (loaded);
+    qof_session_destroy (loaded);
+    qof_session_end (saved);
+    qof_session_destroy (saved);
+    qof_session_destroy (source);
+    if (argc <= 2)
+        g_unlink (filename.c_str ());
+    qof_close ();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
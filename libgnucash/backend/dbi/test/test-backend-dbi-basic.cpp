@@ -39,9 +39,12 @@
 #include <gnc-uri-utils.h>
 /* For setup_business */
 #include "Account.h"
+#include <Account.hpp>
 #include <TransLog.h>
 #include "Transaction.h"
 #include "Split.h"
+#include "gnc-lot.h"
+#include "Query.h"
 #include "gnc-commodity.h"
 #include "gncAddress.h"
 #include "gncCoOwner.h"
@@ -52,9 +55,13 @@
 /* For test_conn_index_functions */
 #include "../gnc-backend-dbi.hpp"
 #include "../gnc-backend-dbi.h"
+/* For slot_changes */
+#include <gnc-slots-sql.h>
+#include <gnc-sql-result.hpp>
 #include <unittest-support.h>
 #include <test-stuff.h>
 
+#include <stdexcept>
 #include <string>
 #include <vector>
 #include <algorithm>
@@ -460,6 +467,239 @@ test_dbi_store_and_reload (Fixture* fixture, gconstpointer pData)
     qof_session_destroy (session_3);
 }
 
+/* Once the book is saved, committing a commodity writes it with an UPSERT
+ * instead of looking for its row first; the change must survive a reload. */
+static void
+test_dbi_commodity_upsert (Fixture* fixture, gconstpointer pData)
+{
+    const gchar* url = (const gchar*)pData;
+    auto msg = "[GncDbiSqlConnection::unlock_database()] There was no lock entry in the Lock table";
+    auto log_domain = nullptr;
+    auto loglevel = static_cast<GLogLevelFlags> (
+        G_LOG_LEVEL_WARNING | G_LOG_FLAG_FATAL);
+    TestErrorStruct* check = test_error_struct_new (log_domain, loglevel, msg);
+    fixture->hdlrs = test_log_set_fatal_handler (
+        fixture->hdlrs, check, (GLogFunc)test_checked_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+
+    // Save the session data
+    auto book2{qof_book_new()};
+    auto session_2 = qof_session_new (book2);
+    qof_session_begin (session_2, url, SESSION_NEW_OVERWRITE);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_2);
+    qof_book_mark_session_dirty (qof_session_get_book (session_2));
+    qof_session_save (session_2, NULL);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+
+    // Change a commodity that is already in the database
+    auto table = gnc_commodity_table_get_table (qof_session_get_book (session_2));
+    auto currency = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY,
+                                                "CAD");
+    gnc_commodity_begin_edit (currency);
+    gnc_commodity_set_fullname (currency, "Loonie");
+    gnc_commodity_commit_edit (currency);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+
+    // Reload the session data
+    auto book3{qof_book_new()};
+    auto session_3 = qof_session_new (book3);
+    qof_session_begin (session_3, url, SESSION_READ_ONLY);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    qof_session_load (session_3, NULL);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    table = gnc_commodity_table_get_table (qof_session_get_book (session_3));
+    currency = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY,
+                                           "CAD");
+    g_assert (currency != NULL);
+    g_assert_cmpstr (gnc_commodity_get_fullname (currency), == , "Loonie");
+
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+    qof_session_end (session_3);
+    qof_session_destroy (session_3);
+}
+
+static std::string
+column_text (GncSqlRow& row, const char* col)
+{
+    if (row.is_col_null (col))
+        return "NULL";
+    try
+    {
+        return row.get_string_at_col (col);
+    }
+    catch (std::invalid_argument&) {}
+    try
+    {
+        return std::to_string (row.get_int_at_col (col));
+    }
+    catch (std::invalid_argument&) {}
+    try
+    {
+        return std::to_string (row.get_double_at_col (col));
+    }
+    catch (std::invalid_argument&) {}
+    try
+    {
+        return std::to_string (row.get_time64_at_col (col));
+    }
+    catch (std::invalid_argument&) {}
+    return "?";
+}
+
+/* Appends a line for each slot row of obj_guid, naming the rows of frames
+ * and lists by the path leading to them rather than by the guid they
+ * happen to be stored under. */
+static void
+dump_slot_rows (GncSqlBackend* sql_be, const std::string& obj_guid,
+                const std::string& prefix, StrVec& lines)
+{
+    const auto frame_type = static_cast<int64_t> (KvpValue::Type::FRAME);
+    const auto list_type = static_cast<int64_t> (KvpValue::Type::GLIST);
+    std::vector<std::pair<std::string, std::string>> children;
+
+    auto stmt = sql_be->create_statement_from_sql (
+        "SELECT * FROM slots WHERE obj_guid='" + obj_guid + "'");
+    auto result = sql_be->execute_select_statement (stmt);
+    for (auto row : *result)
+    {
+        auto name = row.get_string_at_col ("name");
+        auto type = row.get_int_at_col ("slot_type");
+        auto line = prefix + name + "|" + std::to_string (type);
+        for (auto col : {"int64_val", "string_val", "double_val",
+                         "timespec_val", "numeric_val_num",
+                         "numeric_val_denom", "gdate_val"})
+            line += "|" + column_text (row, col);
+        if (type == frame_type || type == list_type)
+            children.emplace_back (name, row.get_string_at_col ("guid_val"));
+        else
+            line += "|" + column_text (row, "guid_val");
+        lines.push_back (line);
+    }
+    delete result;
+    for (auto const& child : children)
+        dump_slot_rows (sql_be, child.second, prefix + child.first + ">",
+                        lines);
+}
+
+static int64_t
+slot_row_id (GncSqlBackend* sql_be, const std::string& obj_guid,
+             const char* name)
+{
+    int64_t id = -1;
+    auto stmt = sql_be->create_statement_from_sql (
+        "SELECT id FROM slots WHERE obj_guid='" + obj_guid +
+        "' AND name='" + name + "'");
+    auto result = sql_be->execute_select_statement (stmt);
+    for (auto row : *result)
+        id = row.get_int_at_col ("id");
+    delete result;
+    return id;
+}
+
+/* Committing an object writes only the slot rows that changed; the slots
+ * table must end up as rewriting all of the object's slots leaves it. */
+static void
+test_dbi_slot_changes (Fixture* fixture, gconstpointer pData)
+{
+    const gchar* url = (const gchar*)pData;
+    auto msg = "[GncDbiSqlConnection::unlock_database()] There was no lock entry in the Lock table";
+    auto log_domain = nullptr;
+    auto loglevel = static_cast<GLogLevelFlags> (
+        G_LOG_LEVEL_WARNING | G_LOG_FLAG_FATAL);
+    TestErrorStruct* check = test_error_struct_new (log_domain, loglevel, msg);
+    fixture->hdlrs = test_log_set_fatal_handler (
+        fixture->hdlrs, check, (GLogFunc)test_checked_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+
+    // Save the session data
+    auto book2{qof_book_new()};
+    auto session_2 = qof_session_new (book2);
+    qof_session_begin (session_2, url, SESSION_NEW_OVERWRITE);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_2);
+    qof_book_mark_session_dirty (qof_session_get_book (session_2));
+    qof_session_save (session_2, NULL);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+
+    auto sql_be = reinterpret_cast<GncSqlBackend*>(qof_session_get_backend (session_2));
+    auto root = gnc_book_get_root_account (qof_session_get_book (session_2));
+    auto acct = gnc_account_lookup_by_name (root, "Bank 1");
+    g_assert (acct != NULL);
+    auto inst = QOF_INSTANCE (acct);
+    auto frame = qof_instance_get_slots (inst);
+    gchar guid_buf[GUID_ENCODING_LENGTH + 1];
+    guid_to_string_buff (qof_instance_get_guid (inst), guid_buf);
+    const std::string guid{guid_buf};
+
+    // Add nested frames and a list to the slots already stored
+    xaccAccountBeginEdit (acct);
+    delete frame->set_path ({"nested", "a"}, new KvpValue (INT64_C (1)));
+    delete frame->set_path ({"nested", "b"}, new KvpValue (g_strdup ("bee")));
+    delete frame->set_path ({"nested", "deeper", "c"}, new KvpValue (2.5));
+    auto list = g_list_append (nullptr, new KvpValue (INT64_C (1)));
+    list = g_list_append (list, new KvpValue (g_strdup ("two")));
+    delete frame->set ({"list-val"}, new KvpValue (list));
+    qof_instance_set_dirty (inst);
+    xaccAccountCommitEdit (acct);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    auto int64_id = slot_row_id (sql_be, guid, "int64-val");
+    g_assert_cmpint (int64_id, != , -1);
+
+    // Change values, types and the shape of the frames
+    xaccAccountBeginEdit (acct);
+    delete frame->set ({"string-val"}, new KvpValue (g_strdup ("qrstuvwxyz")));
+    delete frame->set ({"double-val"}, nullptr);
+    delete frame->set ({"time-val"}, new KvpValue (g_strdup ("not a time")));
+    delete frame->set_path ({"nested", "a"}, nullptr);
+    delete frame->set_path ({"nested", "b"}, new KvpValue (g_strdup ("bumblebee")));
+    delete frame->set_path ({"nested", "deeper"}, new KvpValue (INT64_C (3)));
+    delete frame->set_path ({"nested", "e"},
+                            new KvpValue (gnc_numeric_create (1, 3)));
+    list = g_list_append (nullptr, new KvpValue (INT64_C (1)));
+    delete frame->set ({"list-val"}, new KvpValue (list));
+    qof_instance_set_dirty (inst);
+    xaccAccountCommitEdit (acct);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+
+    // The unchanged slot kept its row
+    g_assert_cmpint (slot_row_id (sql_be, guid, "int64-val"), == , int64_id);
+    g_assert_cmpint (slot_row_id (sql_be, guid, "double-val"), == , -1);
+
+    // Reload the session data
+    auto book3{qof_book_new()};
+    auto session_3 = qof_session_new (book3);
+    qof_session_begin (session_3, url, SESSION_READ_ONLY);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    qof_session_load (session_3, NULL);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    auto root3 = gnc_book_get_root_account (qof_session_get_book (session_3));
+    auto acct3 = gnc_account_lookup_by_name (root3, "Bank 1");
+    g_assert (acct3 != NULL);
+    g_assert_cmpint (compare (*frame, *qof_instance_get_slots (QOF_INSTANCE (acct3))),
+                     == , 0);
+    qof_session_end (session_3);
+    qof_session_destroy (session_3);
+
+    // Compare the rows with those of a complete rewrite
+    StrVec changed, rewritten;
+    dump_slot_rows (sql_be, guid, "", changed);
+    g_assert (gnc_sql_slots_delete (sql_be, qof_instance_get_guid (inst)));
+    g_assert (gnc_sql_slots_save (sql_be, qof_instance_get_guid (inst), TRUE,
+                                  inst));
+    dump_slot_rows (sql_be, guid, "", rewritten);
+    std::sort (changed.begin (), changed.end ());
+    std::sort (rewritten.begin (), rewritten.end ());
+    g_assert_cmpint (changed.size (), == , rewritten.size ());
+    g_assert (changed == rewritten);
+
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+}
+
 /** Test the safe_save mechanism.  Beware that this test used on its
  * own doesn't ensure that the resave is done safely, only that the
  * database is intact and unchanged after the save. To observe the
@@ -541,6 +781,384 @@ cleanup:
     }
     return;
 }
+
+static int64_t
+count_rows (GncSqlBackend* sql_be, const std::string& table,
+            const std::string& where)
+{
+    auto stmt = sql_be->create_statement_from_sql (
+        "SELECT * FROM " + table + " WHERE " + where);
+    auto result = sql_be->execute_select_statement (stmt);
+    int64_t count = result->size ();
+    delete result;
+    return count;
+}
+
+static Account*
+add_partial_account (QofBook* book, const char* name, GNCAccountType type)
+{
+    auto table = gnc_commodity_table_get_table (book);
+    auto currency = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY,
+                                                "CAD");
+    auto acct = xaccMallocAccount (book);
+    xaccAccountBeginEdit (acct);
+    xaccAccountSetType (acct, type);
+    xaccAccountSetName (acct, name);
+    xaccAccountSetCommodity (acct, currency);
+    gnc_account_append_child (gnc_book_get_root_account (book), acct);
+    xaccAccountCommitEdit (acct);
+    return acct;
+}
+
+static Split*
+add_partial_tx (Account* acct, Account* other, gint64 cents, time64 date,
+                char reconciled)
+{
+    auto book = qof_instance_get_book (QOF_INSTANCE (acct));
+    auto amount = gnc_numeric_create (cents, 100);
+    auto tx = xaccMallocTransaction (book);
+    xaccTransBeginEdit (tx);
+    xaccTransSetCurrency (tx, xaccAccountGetCommodity (acct));
+    xaccTransSetDatePostedSecsNormalized (tx, date);
+    auto spl1 = xaccMallocSplit (book);
+    xaccSplitSetParent (spl1, tx);
+    xaccSplitSetAccount (spl1, acct);
+    xaccSplitSetAmount (spl1, amount);
+    xaccSplitSetValue (spl1, amount);
+    xaccSplitSetReconcile (spl1, reconciled);
+    auto spl2 = xaccMallocSplit (book);
+    xaccSplitSetParent (spl2, tx);
+    xaccSplitSetAccount (spl2, other);
+    xaccSplitSetAmount (spl2, gnc_numeric_neg (amount));
+    xaccSplitSetValue (spl2, gnc_numeric_neg (amount));
+    xaccTransCommitEdit (tx);
+    return spl1;
+}
+
+static guint
+query_account_splits (QofBook* book, Account* acct, time64 start)
+{
+    auto query = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (query, book);
+    xaccQueryAddSingleAccountMatch (query, acct, QOF_QUERY_AND);
+    if (start != INT64_MIN)
+        xaccQueryAddDateMatchTT (query, TRUE, start, FALSE, 0, QOF_QUERY_AND);
+    auto count = g_list_length (qof_query_run (query));
+    qof_query_destroy (query);
+    return count;
+}
+
+static void
+assert_balance (Account* acct, gint64 cents)
+{
+    g_assert (gnc_numeric_equal (xaccAccountGetBalance (acct),
+                                 gnc_numeric_create (cents, 100)));
+}
+
+static void
+count_destroy_events (QofInstance* ent, QofEventId event_type,
+                      gpointer handler_data, gpointer event_data)
+{
+    if (event_type == QOF_EVENT_DESTROY)
+        ++*static_cast<int*>(handler_data);
+}
+
+/* A book opened with partial loading has the balances of all its splits,
+ * reads the transactions queries look for and drops the least recently used
+ * ones beyond its limit, unless a live query still needs them. */
+static void
+test_dbi_partial_load (Fixture* fixture, gconstpointer pData)
+{
+    const gchar* url = (const gchar*)pData;
+    auto msg = "[GncDbiSqlConnection::unlock_database()] There was no lock entry in the Lock table";
+    auto log_domain = nullptr;
+    auto loglevel = static_cast<GLogLevelFlags> (
+        G_LOG_LEVEL_WARNING | G_LOG_FLAG_FATAL);
+    TestErrorStruct* check = test_error_struct_new (log_domain, loglevel, msg);
+    fixture->hdlrs = test_log_set_fatal_handler (
+        fixture->hdlrs, check, (GLogFunc)test_checked_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+
+    // Save the session data and add transactions through the backend
+    auto book2{qof_book_new()};
+    auto session_2 = qof_session_new (book2);
+    qof_session_begin (session_2, url, SESSION_NEW_OVERWRITE);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_2);
+    qof_book_mark_session_dirty (qof_session_get_book (session_2));
+    qof_session_save (session_2, NULL);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+
+    auto book = qof_session_get_book (session_2);
+    auto checking = add_partial_account (book, "Checking", ACCT_TYPE_BANK);
+    auto income = add_partial_account (book, "Income", ACCT_TYPE_INCOME);
+    auto savings = add_partial_account (book, "Savings", ACCT_TYPE_BANK);
+    auto interest = add_partial_account (book, "Interest", ACCT_TYPE_INCOME);
+    auto day1 = gnc_dmy2time64_neutral (1, 3, 2020);
+    auto day10 = gnc_dmy2time64_neutral (10, 3, 2020);
+    auto day20 = gnc_dmy2time64_neutral (20, 3, 2020);
+    add_partial_tx (checking, income, 10000, day1, NREC);
+    add_partial_tx (checking, income, 5000, day10, YREC);
+    add_partial_tx (checking, income, 2500, day20, NREC);
+    add_partial_tx (savings, interest, 1000, day10, CREC);
+    auto payable = add_partial_account (book, "Payable", ACCT_TYPE_PAYABLE);
+    auto lot = gnc_lot_new (book);
+    gnc_lot_add_split (lot, add_partial_tx (payable, interest, -3000, day1, NREC));
+    gnc_lot_add_split (lot, add_partial_tx (payable, interest, 3000, day20, NREC));
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+
+    // Reopen it with partial loading
+    auto book3{qof_book_new()};
+    auto session_3 = qof_session_new (book3);
+    qof_session_begin (session_3, url, SESSION_NORMAL_OPEN);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    auto sql_be = reinterpret_cast<GncSqlBackend*>(qof_session_get_backend (session_3));
+    sql_be->set_partial_load (true, 0);
+    qof_session_load (session_3, NULL);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    g_assert (sql_be->partly_loaded ());
+
+    auto root3 = gnc_book_get_root_account (book3);
+    auto checking3 = gnc_account_lookup_by_name (root3, "Checking");
+    auto savings3 = gnc_account_lookup_by_name (root3, "Savings");
+    g_assert (checking3 != NULL);
+    g_assert (savings3 != NULL);
+    g_assert_cmpint (xaccAccountGetSplitsSize (checking3), == , 0);
+    assert_balance (checking3, 17500);
+    g_assert (gnc_numeric_equal (xaccAccountGetReconciledBalance (checking3),
+                                 gnc_numeric_create (5000, 100)));
+    g_assert (gnc_numeric_equal (xaccAccountGetClearedBalance (savings3),
+                                 gnc_numeric_create (1000, 100)));
+    g_assert (gnc_numeric_equal (xaccAccountGetPresentBalance (checking3),
+                                 gnc_numeric_create (17500, 100)));
+
+    // Lots are read whole, so the paid one is closed
+    auto payable3 = gnc_account_lookup_by_name (root3, "Payable");
+    g_assert (payable3 != NULL);
+    g_assert_cmpint (xaccAccountGetSplitsSize (payable3), == , 2);
+    auto lot3 = xaccSplitGetLot (xaccAccountGetSplits (payable3).front ());
+    g_assert (lot3 != NULL);
+    g_assert_cmpint (gnc_lot_count_splits (lot3), == , 2);
+    g_assert (gnc_lot_is_closed (lot3));
+    assert_balance (payable3, 0);
+
+    // Queries fault in the transactions of an account from a date on
+    g_assert_cmpint (query_account_splits (book3, checking3, day10), == , 2);
+    g_assert_cmpint (xaccAccountGetSplitsSize (checking3), == , 2);
+    assert_balance (checking3, 17500);
+    g_assert (gnc_numeric_equal (xaccAccountGetPresentBalance (checking3),
+                                 gnc_numeric_create (17500, 100)));
+    // Before the loaded window the balance is that of the older splits
+    g_assert (gnc_numeric_equal (xaccAccountGetBalanceAsOfDate (checking3, day10),
+                                 gnc_numeric_create (10000, 100)));
+    auto first = xaccAccountGetSplits (checking3).front ();
+    g_assert (gnc_numeric_equal (xaccSplitGetBalance (first),
+                                 gnc_numeric_create (15000, 100)));
+    g_assert_cmpint (query_account_splits (book3, checking3, INT64_MIN), == , 3);
+    assert_balance (checking3, 17500);
+
+    // Beyond the limit the least recently used account's transactions go
+    sql_be->set_partial_load (true, 1);
+    g_assert_cmpint (query_account_splits (book3, savings3, INT64_MIN), == , 1);
+    g_assert_cmpint (xaccAccountGetSplitsSize (checking3), == , 0);
+    assert_balance (checking3, 17500);
+    assert_balance (savings3, 1000);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+
+    /* A query still alive, like an open register's, keeps its account's
+     * transactions; dropping the others raises no events. */
+    auto register_query = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (register_query, book3);
+    xaccQueryAddSingleAccountMatch (register_query, checking3, QOF_QUERY_AND);
+    g_assert_cmpint (g_list_length (qof_query_run (register_query)), == , 3);
+    g_assert_cmpint (query_account_splits (book3, savings3, INT64_MIN), == , 1);
+    g_assert_cmpint (xaccAccountGetSplitsSize (checking3), == , 3);
+    int destroyed = 0;
+    auto handler = qof_event_register_handler (count_destroy_events, &destroyed);
+    qof_query_destroy (register_query);
+    g_assert_cmpint (query_account_splits (book3, savings3, INT64_MIN), == , 1);
+    qof_event_unregister_handler (handler);
+    g_assert_cmpint (xaccAccountGetSplitsSize (checking3), == , 0);
+    g_assert_cmpint (destroyed, == , 0);
+    assert_balance (checking3, 17500);
+
+    // Saving reads everything first, so no rows are lost
+    auto tx_count = count_rows (sql_be, "transactions", "1=1");
+    qof_session_safe_save (session_3, NULL);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    g_assert (!sql_be->partly_loaded ());
+    g_assert_cmpint (xaccAccountGetSplitsSize (checking3), == , 3);
+    assert_balance (checking3, 17500);
+    g_assert_cmpint (count_rows (sql_be, "transactions", "1=1"), == , tx_count);
+
+    // A query may outlive the session and book it was run on
+    auto late_query = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (late_query, book3);
+    xaccQueryAddSingleAccountMatch (late_query, checking3, QOF_QUERY_AND);
+    g_assert_cmpint (g_list_length (qof_query_run (late_query)), == , 3);
+    qof_session_end (session_3);
+    qof_session_destroy (session_3);
+    qof_query_destroy (late_query);
+}
+
+/* Fetch a batch of columns the way the default GncSqlResult::fetch_columns
+ * does, through the row getters, or through the DBI result's own. */
+static size_t
+fetch_batch (GncSqlResult* result, GncSqlColumnBatch& columns, bool by_row)
+{
+    return by_row ? result->GncSqlResult::fetch_columns (columns, 3) :
+        result->fetch_columns (columns, 3);
+}
+
+static void
+assert_columns_equal (const GncSqlColumnBuffer& l, const GncSqlColumnBuffer& r,
+                      size_t nrows)
+{
+    g_assert_cmpstr (l.name (), == , r.name ());
+    for (size_t row = 0; row < nrows; ++row)
+    {
+        g_assert_cmpint (l.is_null (row), == , r.is_null (row));
+        switch (l.type ())
+        {
+        case GncSqlColumnType::INT64:
+        case GncSqlColumnType::TIME64:
+            g_assert_cmpint (l.int_at (row), == , r.int_at (row));
+            break;
+        case GncSqlColumnType::STRING:
+            g_assert_cmpstr (l.string_at (row), == , r.string_at (row));
+            break;
+        case GncSqlColumnType::GUID:
+            if (!l.is_null (row))
+                g_assert (guid_equal (l.guid_at (row), r.guid_at (row)));
+            break;
+        }
+    }
+}
+
+/* The DBI result decodes columns like the row getters do, across batches,
+ * and the transactions and splits loaded from them match what was saved. */
+static void
+test_dbi_fetch_columns (Fixture* fixture, gconstpointer pData)
+{
+    const gchar* url = (const gchar*)pData;
+    auto msg = "[GncDbiSqlConnection::unlock_database()] There was no lock entry in the Lock table";
+    auto log_domain = nullptr;
+    auto loglevel = static_cast<GLogLevelFlags> (
+        G_LOG_LEVEL_WARNING | G_LOG_FLAG_FATAL);
+    TestErrorStruct* check = test_error_struct_new (log_domain, loglevel, msg);
+    fixture->hdlrs = test_log_set_fatal_handler (
+        fixture->hdlrs, check, (GLogFunc)test_checked_handler);
+    if (fixture->filename)
+        url = fixture->filename;
+
+    auto book2{qof_book_new()};
+    auto session_2 = qof_session_new (book2);
+    qof_session_begin (session_2, url, SESSION_NEW_OVERWRITE);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_swap_data (fixture->session, session_2);
+    qof_book_mark_session_dirty (qof_session_get_book (session_2));
+    qof_session_save (session_2, NULL);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+
+    auto book = qof_session_get_book (session_2);
+    auto checking = add_partial_account (book, "Checking", ACCT_TYPE_BANK);
+    auto income = add_partial_account (book, "Income", ACCT_TYPE_INCOME);
+    for (int day = 1; day <= 4; ++day)
+        add_partial_tx (checking, income, 1000 * day,
+                        gnc_dmy2time64_neutral (day, 2, 2024),
+                        day % 2 ? NREC : YREC);
+    auto split = xaccAccountGetSplits (checking).back ();
+    xaccSplitSetMemo (split, "Leap 'day'");
+    auto tx = xaccSplitGetParent (split);
+    xaccTransBeginEdit (tx);
+    xaccTransSetDatePostedSecs (tx, gnc_dmy2time64 (29, 2, 2024) + 12345);
+    xaccTransSetDateEnteredSecs (tx, gnc_dmy2time64 (1, 3, 2024) + 54321);
+    xaccTransSetDescription (tx, "Fetched");
+    xaccTransCommitEdit (tx);
+    auto tx_guid = *xaccTransGetGUID (tx);
+    auto split_guid = *xaccSplitGetGUID (split);
+    auto posted = xaccTransGetDate (tx);
+    auto entered = xaccTransGetDateEntered (tx);
+    g_assert_cmpint (qof_session_get_error (session_2), == , ERR_BACKEND_NO_ERR);
+    qof_session_end (session_2);
+    qof_session_destroy (session_2);
+
+    auto book3{qof_book_new()};
+    auto session_3 = qof_session_new (book3);
+    qof_session_begin (session_3, url, SESSION_NORMAL_OPEN);
+    qof_session_load (session_3, NULL);
+    g_assert_cmpint (qof_session_get_error (session_3), == , ERR_BACKEND_NO_ERR);
+    auto sql_be = reinterpret_cast<GncSqlBackend*>(qof_session_get_backend (session_3));
+
+    using T = GncSqlColumnType;
+    std::vector<std::pair<std::string, GncSqlColumnBatch>> tables{
+        {"transactions", {{"guid", T::GUID}, {"num", T::STRING},
+                          {"post_date", T::TIME64}, {"enter_date", T::TIME64},
+                          {"description", T::STRING}}},
+        {"splits", {{"guid", T::GUID}, {"tx_guid", T::GUID},
+                    {"memo", T::STRING}, {"reconcile_state", T::STRING},
+                    {"reconcile_date", T::TIME64}, {"value_num", T::INT64},
+                    {"value_denom", T::INT64}, {"lot_guid", T::GUID}}},
+    };
+    for (auto& table : tables)
+    {
+        auto sql = "SELECT * FROM " + table.first;
+        auto by_row = sql_be->execute_select_statement (
+            sql_be->create_statement_from_sql (sql));
+        auto by_field = sql_be->execute_select_statement (
+            sql_be->create_statement_from_sql (sql));
+        auto row_columns = table.second;
+        auto& columns = table.second;
+        size_t total = 0, nrows;
+        while ((nrows = fetch_batch (by_row, row_columns, true)) != 0)
+        {
+            g_assert_cmpint (fetch_batch (by_field, columns, false), == , nrows);
+            for (size_t col = 0; col < columns.size (); ++col)
+                assert_columns_equal (row_columns[col], columns[col], nrows);
+            total += nrows;
+
+            for (size_t row = 0; row < nrows; ++row)
+            {
+                auto guid = columns[0].guid_at (row);
+                if (table.first == "transactions" && guid_equal (guid, &tx_guid))
+                {
+                    g_assert_cmpint (columns[2].int_at (row), == , posted);
+                    g_assert_cmpint (columns[3].int_at (row), == , entered);
+                    g_assert_cmpstr (columns[4].string_at (row), == , "Fetched");
+                }
+                if (table.first == "splits" && guid_equal (guid, &split_guid))
+                {
+                    g_assert_cmpstr (columns[2].string_at (row), == , "Leap 'day'");
+                    g_assert (columns[7].is_null (row));
+                }
+            }
+        }
+        g_assert_cmpint (fetch_batch (by_field, columns, false), == , 0);
+        g_assert_cmpint (total, == , by_field->size ());
+        delete by_row;
+        delete by_field;
+    }
+
+    auto tx3 = xaccTransLookup (&tx_guid, book3);
+    g_assert (tx3 != NULL);
+    g_assert_cmpint (xaccTransGetDate (tx3), == , posted);
+    g_assert_cmpint (xaccTransGetDateEntered (tx3), == , entered);
+    g_assert_cmpstr (xaccTransGetDescription (tx3), == , "Fetched");
+    auto split3 = xaccSplitLookup (&split_guid, book3);
+    g_assert (split3 != NULL);
+    g_assert (xaccSplitGetParent (split3) == tx3);
+    g_assert_cmpstr (xaccSplitGetMemo (split3), == , "Leap 'day'");
+    g_assert (gnc_numeric_equal (xaccSplitGetValue (split3),
+                                 gnc_numeric_create (4000, 100)));
+    g_assert_cmpint (xaccSplitGetReconcile (split3), == , YREC);
+
+    qof_session_end (session_3);
+    qof_session_destroy (session_3);
+}
+
 /* Test the gnc_dbi_load logic that forces a newer database to be
  * opened read-only and an older one to be safe-saved. Again, it would
  * be better to do this starting from a fresh file, but instead we're
@@ -683,6 +1301,14 @@ create_dbi_test_suite (const char* dbm_name, const char* url)
                   test_dbi_store_and_reload, teardown);
     GNC_TEST_ADD (subsuite, "safe_save", Fixture, url, setup_memory,
                   test_dbi_safe_save, teardown);
+    GNC_TEST_ADD (subsuite, "partial_load", Fixture, url, setup_memory,
+                  test_dbi_partial_load, teardown);
+    GNC_TEST_ADD (subsuite, "fetch_columns", Fixture, url, setup_memory,
+                  test_dbi_fetch_columns, teardown);
+    GNC_TEST_ADD (subsuite, "commodity_upsert", Fixture, url, setup_memory,
+                  test_dbi_commodity_upsert, teardown);
+    GNC_TEST_ADD (subsuite, "slot_changes", Fixture, url, setup_memory,
+                  test_dbi_slot_changes, teardown);
     GNC_TEST_ADD (subsuite, "version_control", Fixture, url, setup_memory,
                   test_dbi_version_control, teardown);
     GNC_TEST_ADD (subsuite, "business_store_and_reload", Fixture, url,
@@ -156,6 +156,7 @@ GncSqlCommodityBackend::load_all (GncSqlBackend* sql_be)
             if (qof_instance_is_dirty (QOF_INSTANCE (pCommodity)))
                 sql_be->commodity_for_postload_processing(pCommodity);
             qof_instance_set_guid (QOF_INSTANCE (pCommodity), &guid);
+            sql_be->set_commodity_in_db (pCommodity, true);
         }
 
     }
@@ -167,26 +168,29 @@ GncSqlCommodityBackend::load_all (GncSqlBackend* sql_be)
 }
 /* ================================================================= */
 static gboolean
-do_commit_commodity (GncSqlBackend* sql_be, QofInstance* inst,
-                     gboolean force_insert)
+do_commit_commodity (GncSqlBackend* sql_be, QofInstance* inst)
 {
     const GncGUID* guid;
     gboolean is_infant;
     E_DB_OPERATION op;
     gboolean is_ok;
+    auto comm = GNC_COMMODITY (inst);
 
     is_infant = qof_instance_get_infant (inst);
     if (qof_instance_get_destroying (inst))
     {
         op = OP_DB_DELETE;
     }
-    else if (sql_be->pristine() || is_infant || force_insert)
+    else if ((sql_be->pristine() && !sql_be->commodity_in_db (comm)) ||
+             is_infant)
     {
         op = OP_DB_INSERT;
     }
     else
     {
-        op = OP_DB_UPDATE;
+        /* The commodity may be referenced by other objects without ever
+         * having been saved, so it isn't necessarily in the database. */
+        op = OP_DB_ADD_OR_UPDATE;
     }
     is_ok = sql_be->do_db_operation(op, COMMODITIES_TABLE, GNC_ID_COMMODITY,
                                     inst, col_table);
@@ -204,6 +208,8 @@ do_commit_commodity (GncSqlBackend* sql_be, QofInstance* inst,
             is_ok = gnc_sql_slots_delete (sql_be, guid);
         }
     }
+    if (is_ok)
+        sql_be->set_commodity_in_db (comm, !qof_instance_get_destroying (inst));
 
     return is_ok;
 }
@@ -214,8 +220,7 @@ GncSqlCommodityBackend::commit (GncSqlBackend* sql_be, QofInstance* inst)
     g_return_val_if_fail (sql_be != NULL, FALSE);
     g_return_val_if_fail (inst != NULL, FALSE);
     g_return_val_if_fail (GNC_IS_COMMODITY (inst), FALSE);
-    auto in_be = instance_in_db(sql_be, inst);
-    return do_commit_commodity (sql_be, inst, !in_be);
+    return do_commit_commodity (sql_be, inst);
 }
 
 /* ----------------------------------------------------------------- */
@@ -39,6 +39,7 @@
 
 #include <string>
 #include <sstream>
+#include <unordered_map>
 
 #include "gnc-sql-connection.hpp"
 #include "gnc-sql-backend.hpp"
@@ -60,6 +61,18 @@ typedef enum
     LIST
 } context_t;
 
+/* The row a slot read back from the db is stored in, so that saving can
+ * update or delete just that row. Frames and lists also keep the guid their
+ * contents are stored under. */
+struct stored_slot_t
+{
+    GncGUID obj_guid;
+    std::string name;
+    GncGUID child_guid;
+};
+
+using StoredSlotMap = std::unordered_map<const KvpValue*, stored_slot_t>;
+
 struct slot_info_t
 {
     GncSqlBackend* be;
@@ -72,6 +85,7 @@ struct slot_info_t
     KvpValue* pKvpValue;
     std::string path;
     std::string parent_path;
+    StoredSlotMap* stored = nullptr;
 };
 
 
@@ -193,12 +207,26 @@ get_key (slot_info_t* pInfo)
     return path;
 }
 
+static void
+record_stored_slot (slot_info_t* pInfo, const KvpValue* pValue,
+                    const GncGUID* child_guid = nullptr)
+{
+    if (!pInfo->stored) return;
+
+    auto& stored = (*pInfo->stored)[pValue];
+    stored.obj_guid = *pInfo->guid;
+    stored.name = pInfo->path;
+    stored.child_guid = child_guid ? *child_guid : *guid_null ();
+}
+
 static void
 set_slot_from_value (slot_info_t* pInfo, KvpValue* pValue)
 {
     g_return_if_fail (pInfo != NULL);
     g_return_if_fail (pValue != NULL);
 
+    record_stored_slot (pInfo, pValue);
+
     switch (pInfo->context)
     {
     case FRAME:
@@ -444,6 +472,7 @@ set_guid_val (gpointer pObject,  gpointer pValue)
         slots_load_info (newInfo);
         pValue = new KvpValue {newInfo->pList};
         pInfo->pKvpFrame->set ({key.c_str()}, pValue);
+        record_stored_slot (pInfo, pValue, newInfo->guid);
 	delete newInfo;
         break;
     }
@@ -466,7 +495,9 @@ set_guid_val (gpointer pObject,  gpointer pValue)
         default:
         {
             auto key = get_key (pInfo);
-            pInfo->pKvpFrame->set ({key.c_str()}, new KvpValue {newFrame});
+            auto value = new KvpValue {newFrame};
+            pInfo->pKvpFrame->set ({key.c_str()}, value);
+            record_stored_slot (pInfo, value, newInfo->guid);
             break;
         }
         }
@@ -553,6 +584,7 @@ slot_info_copy (slot_info_t* pInfo, GncGUID* guid)
     newSlot->pList = pInfo->pList;
     newSlot->context = pInfo->context;
     newSlot->pKvpValue = pInfo->pKvpValue;
+    newSlot->stored = pInfo->stored;
     if (!pInfo->path.empty())
         newSlot->parent_path = pInfo->path + "/";
     else
@@ -629,6 +661,181 @@ save_slot (const char* key, KvpValue* value, slot_info_t & slot_info)
     }
 }
 
+/* The obj_guid and name of the row slot_info points at, for a WHERE clause. */
+static PairVec
+slot_row_key (slot_info_t& slot_info)
+{
+    PairVec key;
+    col_table[obj_guid_col]->add_to_query (TABLE_NAME, &slot_info, key);
+    col_table[name_col]->add_to_query (TABLE_NAME, &slot_info, key);
+    return key;
+}
+
+static gboolean
+update_slot_row (GncSqlBackend* sql_be, const stored_slot_t& stored,
+                 KvpValue* value)
+{
+    slot_info_t slot_info = { sql_be, &stored.obj_guid, TRUE, NULL,
+                              value->get_type (), NULL, FRAME, value,
+                              stored.name };
+    PairVec values;
+
+    for (auto const& table_row : col_table)
+    {
+        if (!table_row->is_autoincr ())
+            table_row->add_to_query (TABLE_NAME, &slot_info, values);
+    }
+    std::string sql{"UPDATE " TABLE_NAME " SET "};
+    for (auto const& col_value : values)
+    {
+        if (col_value != *values.begin())
+            sql += ",";
+        sql += col_value.first + "=" + col_value.second;
+    }
+    auto stmt = sql_be->create_statement_from_sql (sql);
+    if (stmt == nullptr)
+        return FALSE;
+    stmt->add_where_cond (TABLE_NAME, slot_row_key (slot_info));
+    return sql_be->execute_nonselect_statement (stmt) != -1;
+}
+
+/* Deletes the row of a stored slot and, for a frame or list, the rows of
+ * its contents. */
+static gboolean
+delete_slot_row (GncSqlBackend* sql_be, const stored_slot_t& stored,
+                 const KvpValue* value)
+{
+    auto type = value->get_type ();
+    slot_info_t slot_info = { sql_be, &stored.obj_guid, TRUE, NULL, type,
+                              NULL, FRAME, NULL, stored.name };
+
+    if (type == KvpValue::Type::FRAME || type == KvpValue::Type::GLIST)
+    {
+        if (!gnc_sql_slots_delete (sql_be, &stored.child_guid))
+            return FALSE;
+    }
+
+    auto stmt = sql_be->create_statement_from_sql ("DELETE FROM " TABLE_NAME);
+    if (stmt == nullptr)
+        return FALSE;
+    stmt->add_where_cond (TABLE_NAME, slot_row_key (slot_info));
+    return sql_be->execute_nonselect_statement (stmt) != -1;
+}
+
+struct slot_changes_t
+{
+    GncSqlBackend* be;
+    const StoredSlotMap& stored;
+    gboolean is_ok;
+};
+
+static void
+insert_slot (slot_changes_t& changes, const char* key, KvpValue* value,
+             const GncGUID* guid, const std::string& parent_path)
+{
+    slot_info_t slot_info = { changes.be, guid, TRUE, NULL,
+                              KvpValue::Type::INVALID, NULL, FRAME, NULL, "",
+                              parent_path };
+    save_slot (key, value, slot_info);
+    changes.is_ok = slot_info.is_ok;
+}
+
+/* Writes the differences between the slots stored for a frame, read back
+ * into stored_frame, and those it has now. Returns false if the stored rows
+ * are not laid out the way save_slot would have written them, in which
+ * case the caller must rewrite them all. */
+static bool
+save_frame_changes (slot_changes_t& changes, KvpFrame* stored_frame,
+                    KvpFrame* frame, const GncGUID* guid,
+                    const std::string& parent_path)
+{
+    for (auto const& stored_slot : *stored_frame)
+    {
+        if (!changes.is_ok) return true;
+        if (frame->get_slot ({stored_slot.first})) continue;
+
+        auto stored = changes.stored.find (stored_slot.second);
+        if (stored == changes.stored.end ())
+            return false;
+        changes.is_ok = delete_slot_row (changes.be, stored->second,
+                                         stored_slot.second);
+    }
+
+    for (auto const& slot : *frame)
+    {
+        if (!changes.is_ok) return true;
+        auto value = slot.second;
+        auto old_value = stored_frame->get_slot ({slot.first});
+        if (!old_value)
+        {
+            insert_slot (changes, slot.first, value, guid, parent_path);
+            continue;
+        }
+
+        auto stored = changes.stored.find (old_value);
+        if (stored == changes.stored.end () ||
+            stored->second.name != parent_path + slot.first ||
+            !guid_equal (&stored->second.obj_guid, guid))
+            return false;
+
+        auto type = value->get_type ();
+        if (type == KvpValue::Type::FRAME &&
+            old_value->get_type () == KvpValue::Type::FRAME)
+        {
+            if (!save_frame_changes (changes, old_value->get<KvpFrame*> (),
+                                     value->get<KvpFrame*> (),
+                                     &stored->second.child_guid,
+                                     stored->second.name + "/"))
+                return false;
+        }
+        else if (compare (old_value, value) == 0)
+        {
+            continue;
+        }
+        else if (type == KvpValue::Type::GLIST ||
+                 type != old_value->get_type ())
+        {
+            /* List items are told apart only by the order of their rows,
+             * so a changed list is written out again. */
+            changes.is_ok = delete_slot_row (changes.be, stored->second,
+                                             old_value);
+            if (changes.is_ok)
+                insert_slot (changes, slot.first, value, guid, parent_path);
+        }
+        else
+        {
+            changes.is_ok = update_slot_row (changes.be, stored->second, value);
+        }
+    }
+    return true;
+}
+
+/* Instead of deleting and inserting all of the slots of an object, reads
+ * back the ones stored and writes just the rows that differ. */
+static gboolean
+save_changed_slots (GncSqlBackend* sql_be, const GncGUID* guid,
+                    KvpFrame* pFrame)
+{
+    KvpFrame stored_frame;
+    StoredSlotMap stored;
+    slot_info_t info = { sql_be, guid, TRUE, &stored_frame,
+                         KvpValue::Type::INVALID, NULL, NONE, NULL, "" };
+    info.stored = &stored;
+    slots_load_info (&info);
+
+    slot_changes_t changes{sql_be, stored, TRUE};
+    if (save_frame_changes (changes, &stored_frame, pFrame, guid, ""))
+        return changes.is_ok;
+
+    PWARN ("Unexpected slot rows for an object, rewriting them all");
+    if (!gnc_sql_slots_delete (sql_be, guid))
+        return FALSE;
+    slot_info_t slot_info = { sql_be, guid, TRUE, NULL, KvpValue::Type::INVALID,
+                              NULL, FRAME, NULL, "" };
+    pFrame->for_each_slot_temp (save_slot, slot_info);
+    return slot_info.is_ok;
+}
+
 gboolean
 gnc_sql_slots_save (GncSqlBackend* sql_be, const GncGUID* guid, gboolean is_infant,
                     QofInstance* inst)
@@ -641,11 +848,9 @@ gnc_sql_slots_save (GncSqlBackend* sql_be, const GncGUID* guid, gboolean is_infa
     g_return_val_if_fail (guid != NULL, FALSE);
     g_return_val_if_fail (pFrame != NULL, FALSE);
 
-    // If this is not saving into a new db, clear out the old saved slots first
+    // If this is not saving into a new db, write only what changed
     if (!sql_be->pristine() && !is_infant)
-    {
-        (void)gnc_sql_slots_delete (sql_be, guid);
-    }
+        return save_changed_slots (sql_be, guid, pFrame);
 
     slot_info.be = sql_be;
     slot_info.guid = guid;
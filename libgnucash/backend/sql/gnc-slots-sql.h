@@ -50,6 +50,10 @@ public:
 /**
  * gnc_sql_slots_save - Saves slots for an object to the db.
  *
+ * Unless the object is new or the db is being written from scratch, the
+ * slots stored for it are read back and only the rows that differ are
+ * inserted, updated or deleted.
+ *
  * @param sql_be SQL backend
  * @param guid Object guid
  * @param is_infant Is this an infant object?
@@ -24,6 +24,8 @@
 #include <gnc-prefs.h>
 #include <gnc-engine.h>
 #include <gnc-commodity.h>
+#include <Account.hpp>
+#include <TransLog.h>
 #include <SX-book.h>
 #include <Recurrence.h>
 #include <gncBillTerm.h>
@@ -31,9 +33,11 @@
 #include <gncTaxTable.h>
 #include <gncInvoice.h>
 #include <gnc-pricedb.h>
+#include <qofquery-p.h>
 
 #include <algorithm>
 #include <cassert>
+#include <iterator>
 
 #include "gnc-sql-connection.hpp"
 #include "gnc-sql-backend.hpp"
@@ -69,6 +73,14 @@ static QofLogModule log_module = G_LOG_DOMAIN;
 #define MAX_TABLE_NAME_LEN 50
 #define TABLE_COL_NAME "table_name"
 #define VERSION_COL_NAME "table_version"
+#define GNC_PREF_SQL_PARTIAL_LOAD "sql-partial-load"
+#define GNC_PREF_SQL_CACHED_TX "sql-cached-transactions"
+
+/* Rows per multi-row INSERT. SQLite, MySQL and PostgreSQL all accept much
+ * longer VALUES lists, but the statement must fit in MySQL's
+ * max_allowed_packet. */
+static const unsigned int INSERT_BATCH_ROWS = 250;
+static const size_t INSERT_BATCH_BYTES = 512 * 1024;
 
 using StrVec = std::vector<std::string>;
 
@@ -80,16 +92,24 @@ static EntryVec version_table
     gnc_sql_make_table_entry<CT_INT>(VERSION_COL_NAME, 0, COL_NNUL)
 };
 
+static void
+release_query_cb (QofQuery* query, gpointer user_data)
+{
+    static_cast<GncSqlBackend*>(user_data)->release_query (query);
+}
+
 GncSqlBackend::GncSqlBackend(GncSqlConnection *conn, QofBook* book) :
     QofBackend {}, m_conn{conn}, m_book{book}, m_loading{false},
     m_in_query{false}, m_is_pristine_db{false}
 {
     if (conn != nullptr)
         connect (conn);
+    qof_query_add_destroy_handler (release_query_cb, this);
 }
 
 GncSqlBackend::~GncSqlBackend()
 {
+    qof_query_remove_destroy_handler (release_query_cb, this);
     connect(nullptr);
 }
 
@@ -99,6 +119,11 @@ GncSqlBackend::connect(GncSqlConnection *conn) noexcept
     if (m_conn != nullptr && m_conn != conn)
         delete m_conn;
     finalize_version_info();
+    m_insert_batches.clear();
+    m_commodities_in_db.clear();
+    /* The book is closing, so the windows and queries kept are done with. */
+    m_query_accounts.clear();
+    m_loaded_windows.clear();
     m_conn = conn;
 }
 
@@ -117,6 +142,8 @@ GncSqlBackend::create_statement_from_sql(const std::string& str) const noexcept
 GncSqlResultPtr
 GncSqlBackend::execute_select_statement(const GncSqlStatementPtr& stmt) const noexcept
 {
+    if (!flush_inserts())
+        return nullptr;
     auto result = m_conn ? m_conn->execute_select_statement(stmt) : nullptr;
     if (result == nullptr)
     {
@@ -129,6 +156,8 @@ GncSqlBackend::execute_select_statement(const GncSqlStatementPtr& stmt) const no
 int
 GncSqlBackend::execute_nonselect_statement(const GncSqlStatementPtr& stmt) const noexcept
 {
+    if (!flush_inserts())
+        return -1;
     int result = m_conn ? m_conn->execute_nonselect_statement(stmt) : -1;
     if (result == -1)
     {
@@ -294,10 +323,19 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
         auto num_types = m_backend_registry.size();
         auto num_done = 0;
 
+        if (!m_partial_load &&
+            gnc_prefs_get_bool (GNC_PREFS_GROUP_GENERAL, GNC_PREF_SQL_PARTIAL_LOAD))
+            set_partial_load (true, std::max (gnc_prefs_get_int (GNC_PREFS_GROUP_GENERAL,
+                                                                 GNC_PREF_SQL_CACHED_TX),
+                                              0));
+
         /* Load any initial stuff. Some of this needs to happen in a certain order */
         for (const auto& type : fixed_load_order)
         {
             num_done++;
+            /* Transactions are read by load_for_query() */
+            if (m_partial_load && type == GNC_ID_TRANS)
+                continue;
             auto obe = m_backend_registry.get_object_backend(type);
             if (obe)
             {
@@ -321,6 +359,13 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
                                        nullptr);
 
         m_backend_registry.load_remaining(this);
+        if (m_partial_load)
+        {
+            /* Lots, and the invoices and capital gains that go by them,
+             * need all of their splits, so those are never left out. */
+            gnc_sql_transaction_load_lot_txs (this);
+            load_balances();
+        }
 
         gnc_account_foreach_descendant(root, (AccountCb)xaccAccountCommitEdit,
                                        nullptr);
@@ -328,8 +373,7 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
     else if (loadType == LOAD_TYPE_LOAD_ALL)
     {
         // Load all transactions
-        auto obe = m_backend_registry.get_object_backend (GNC_ID_TRANS);
-        obe->load_all (this);
+        load_all_transactions();
     }
 
     m_loading = FALSE;
@@ -349,6 +393,308 @@ GncSqlBackend::load (QofBook* book, QofBackendLoadType loadType)
     LEAVE ("");
 }
 
+void
+GncSqlBackend::set_partial_load(bool partial, size_t max_tx) noexcept
+{
+    m_partial_load = partial;
+    m_max_loaded_tx = max_tx;
+}
+
+static void
+add_split_balances (acct_balances_t& bal, Split* split, bool add)
+{
+    auto amount = xaccSplitGetAmount (split);
+    if (!add)
+        amount = gnc_numeric_neg (amount);
+    bal.balance = gnc_numeric_add_fixed (bal.balance, amount);
+    if (!xaccTransGetIsClosingTxn (xaccSplitGetParent (split)))
+        bal.noclosing_balance = gnc_numeric_add_fixed (bal.noclosing_balance,
+                                                       amount);
+    auto state = xaccSplitGetReconcile (split);
+    if (state != NREC)
+        bal.cleared_balance = gnc_numeric_add_fixed (bal.cleared_balance,
+                                                     amount);
+    if (state == YREC || state == FREC)
+        bal.reconciled_balance = gnc_numeric_add_fixed (bal.reconciled_balance,
+                                                        amount);
+}
+
+static void
+set_start_balances (const acct_balances_t& bal)
+{
+    gnc_account_set_start_balance (bal.acct, bal.balance);
+    gnc_account_set_start_noclosing_balance (bal.acct, bal.noclosing_balance);
+    gnc_account_set_start_cleared_balance (bal.acct, bal.cleared_balance);
+    gnc_account_set_start_reconciled_balance (bal.acct,
+                                              bal.reconciled_balance);
+}
+
+/* Instead of the transactions, read the balances of the accounts' splits
+ * and start each account with those not loaded yet, so that its balances are
+ * those of all its splits. The accounts must be open for editing. */
+void
+GncSqlBackend::load_balances()
+{
+    auto totals = gnc_sql_transaction_get_account_balances (this);
+    auto root = gnc_book_get_root_account (m_book);
+    auto zero = gnc_numeric_zero ();
+
+    m_unloaded_balances.clear();
+    m_loaded_windows.clear();
+    auto accounts = gnc_account_get_descendants (root);
+    for (auto node = accounts; node; node = g_list_next (node))
+    {
+        auto acc = static_cast<Account*>(node->data);
+        auto total = totals.find (acc);
+        auto& bal = m_unloaded_balances[acc];
+        if (total != totals.end())
+            bal = total->second;
+        else
+            bal = acct_balances_t{acc, zero, zero, zero, zero};
+        /* Business objects may have brought in some transactions already. */
+        for (auto split : xaccAccountGetSplits (acc))
+            add_split_balances (bal, split, false);
+        set_start_balances (bal);
+    }
+    g_list_free (accounts);
+    m_partly_loaded = true;
+}
+
+/* Move transactions that were just loaded, or are about to be evicted, out
+ * of or into the starting balances of their accounts. The accounts must be
+ * open for editing. */
+void
+GncSqlBackend::count_loaded(const InstanceVec& txs, bool loaded)
+{
+    auto root = gnc_book_get_root_account (m_book);
+    auto zero = gnc_numeric_zero ();
+    std::unordered_set<Account*> changed;
+
+    for (auto inst : txs)
+    {
+        for (auto node = xaccTransGetSplitList (GNC_TRANSACTION (inst)); node;
+             node = g_list_next (node))
+        {
+            auto split = static_cast<Split*>(node->data);
+            auto acc = xaccSplitGetAccount (split);
+            if (acc == nullptr || gnc_account_get_root (acc) != root)
+                continue;
+            auto bal = m_unloaded_balances.find (acc);
+            if (bal == m_unloaded_balances.end())
+                bal = m_unloaded_balances.emplace (acc,
+                                                   acct_balances_t{acc, zero, zero,
+                                                                   zero, zero}).first;
+            add_split_balances (bal->second, split, !loaded);
+            changed.insert (acc);
+        }
+    }
+    for (auto acc : changed)
+        set_start_balances (m_unloaded_balances[acc]);
+}
+
+void
+GncSqlBackend::load_all_transactions()
+{
+    auto loading = m_loading;
+    m_loading = true;
+    auto obe = m_backend_registry.get_object_backend (GNC_ID_TRANS);
+    obe->load_all (this);
+    m_loading = loading;
+    if (!m_partly_loaded)
+        return;
+
+    /* Every split is in memory now. */
+    auto root = gnc_book_get_root_account (m_book);
+    gnc_account_foreach_descendant (root, (AccountCb)xaccAccountBeginEdit,
+                                    nullptr);
+    auto zero = gnc_numeric_zero ();
+    for (auto& entry : m_unloaded_balances)
+        set_start_balances (acct_balances_t{entry.first, zero, zero, zero, zero});
+    gnc_account_foreach_descendant (root, (AccountCb)xaccAccountCommitEdit,
+                                    nullptr);
+    m_unloaded_balances.clear();
+    m_loaded_windows.clear();
+    m_partly_loaded = false;
+}
+
+void
+GncSqlBackend::load_account_from(Account* acc, time64 start)
+{
+    g_return_if_fail (acc != nullptr);
+
+    auto root = gnc_book_get_root_account (m_book);
+    if (!m_partly_loaded || gnc_account_get_root (acc) != root)
+        return;
+
+    /* Every transaction of the account from the window's start on is
+     * already in memory, so only the older ones are needed. */
+    time64 end = INT64_MAX;
+    auto window = m_loaded_windows.find (acc);
+    if (window != m_loaded_windows.end())
+    {
+        window->second.m_last_use = ++m_window_clock;
+        if (window->second.m_start <= start)
+            return;
+        end = window->second.m_start;
+    }
+
+    ENTER ("acc=%s, start=%" G_GINT64_FORMAT, xaccAccountGetName (acc), start);
+    auto loading = m_loading;
+    auto logging = xaccLogIsEnabled ();
+    m_loading = true;
+    xaccLogDisable ();
+    gnc_account_foreach_descendant (root, (AccountCb)xaccAccountBeginEdit,
+                                    nullptr);
+    auto txs = gnc_sql_transaction_load_tx_for_account_between (this, acc,
+                                                                start, end);
+    count_loaded (txs, true);
+    gnc_account_foreach_descendant (root, (AccountCb)xaccAccountCommitEdit,
+                                    nullptr);
+    if (logging)
+        xaccLogEnable ();
+    m_loading = loading;
+    m_loaded_windows[acc] = LoadedWindow{start, ++m_window_clock};
+    LEAVE ("%zu transactions loaded", txs.size());
+}
+
+/* A transaction can be dropped from memory if it has no unsaved changes,
+ * nothing else keeps track of it and no loaded window still needs it. */
+bool
+GncSqlBackend::can_evict(Transaction* tx) const noexcept
+{
+    if (xaccTransIsOpen (tx) || qof_instance_is_dirty (QOF_INSTANCE (tx)) ||
+        xaccTransGetReadOnly (tx) != nullptr)
+        return false;
+
+    auto root = gnc_book_get_root_account (m_book);
+    auto date = xaccTransGetDate (tx);
+    for (auto node = xaccTransGetSplitList (tx); node; node = g_list_next (node))
+    {
+        auto split = static_cast<Split*>(node->data);
+        auto acc = xaccSplitGetAccount (split);
+        if (xaccSplitGetLot (split) != nullptr || acc == nullptr ||
+            gnc_account_get_root (acc) != root)
+            return false;
+        auto window = m_loaded_windows.find (acc);
+        if (window != m_loaded_windows.end() && window->second.m_start <= date)
+            return false;
+    }
+    return true;
+}
+
+/* Drop the transactions of the least recently used windows until no more
+ * than m_max_loaded_tx transactions are in memory, sparing the windows of
+ * the accounts that live queries, such as those of open registers, asked
+ * for. The rows stay in the database, so nothing is written. */
+void
+GncSqlBackend::evict_transactions()
+{
+    if (m_max_loaded_tx == 0)
+        return;
+    auto coll = qof_book_get_collection (m_book, GNC_ID_TRANS);
+    auto count = qof_collection_count (coll);
+    if (count <= m_max_loaded_tx)
+        return;
+
+    std::unordered_set<Account*> in_use;
+    for (const auto& query : m_query_accounts)
+        in_use.insert (query.second.begin(), query.second.end());
+    std::vector<std::pair<uint64_t, Account*>> lru;
+    for (const auto& window : m_loaded_windows)
+        if (in_use.find (window.first) == in_use.end())
+            lru.emplace_back (window.second.m_last_use, window.first);
+    std::sort (lru.begin(), lru.end());
+
+    ENTER ("%u transactions loaded, %zu allowed", count, m_max_loaded_tx);
+    auto root = gnc_book_get_root_account (m_book);
+    auto loading = m_loading;
+    auto logging = xaccLogIsEnabled ();
+    m_loading = true;
+    xaccLogDisable ();
+    gnc_account_foreach_descendant (root, (AccountCb)xaccAccountBeginEdit,
+                                    nullptr);
+    for (const auto& entry : lru)
+    {
+        if (count <= m_max_loaded_tx)
+            break;
+        auto acc = entry.second;
+        m_loaded_windows.erase (acc);
+
+        InstanceVec txs;
+        for (auto split : xaccAccountGetSplits (acc))
+        {
+            auto tx = xaccSplitGetParent (split);
+            if (std::find (txs.begin(), txs.end(), QOF_INSTANCE (tx)) == txs.end() &&
+                can_evict (tx))
+                txs.push_back (QOF_INSTANCE (tx));
+        }
+        count_loaded (txs, false);
+        /* The transactions are only dropped from memory, so nothing that
+         * shows them needs to hear of it; registers showing them are
+         * using their window and keep it. */
+        qof_event_suspend ();
+        for (auto inst : txs)
+        {
+            auto tx = GNC_TRANSACTION (inst);
+            xaccTransBeginEdit (tx);
+            xaccTransDestroy (tx);
+            xaccTransCommitEdit (tx);
+        }
+        qof_event_resume ();
+        count -= std::min<size_t> (count, txs.size());
+    }
+    gnc_account_foreach_descendant (root, (AccountCb)xaccAccountCommitEdit,
+                                    nullptr);
+    if (logging)
+        xaccLogEnable ();
+    m_loading = loading;
+    LEAVE ("%u transactions left", count);
+}
+
+void
+GncSqlBackend::load_for_query(QofBook* book, QofQuery* query)
+{
+    if (!m_partly_loaded || m_loading || m_in_query || book != m_book)
+        return;
+
+    /* Lots and invoices are worked out from their splits, so queries for
+     * them need every transaction. */
+    auto search_for = qof_query_get_search_for (query);
+    auto by_lots = g_strcmp0 (search_for, GNC_ID_LOT) == 0 ||
+        g_strcmp0 (search_for, GNC_ID_INVOICE) == 0;
+    if (g_strcmp0 (search_for, GNC_ID_SPLIT) != 0 &&
+        g_strcmp0 (search_for, GNC_ID_TRANS) != 0 && !by_lots)
+        return;
+
+    /* Loading generates events whose handlers may run queries of their
+     * own; those find the data being loaded already. */
+    m_in_query = true;
+    std::vector<std::pair<Account*, time64>> windows;
+    if (!by_lots && g_strcmp0 (search_for, GNC_ID_SPLIT) == 0 &&
+        gnc_sql_transaction_query_windows (book, query, windows))
+    {
+        auto& in_use = m_query_accounts[query];
+        in_use.clear();
+        for (const auto& window : windows)
+        {
+            load_account_from (window.first, window.second);
+            in_use.push_back (window.first);
+        }
+        evict_transactions ();
+    }
+    else
+    {
+        load_all_transactions();
+    }
+    m_in_query = false;
+}
+
+void
+GncSqlBackend::release_query(QofQuery* query) noexcept
+{
+    m_query_accounts.erase (query);
+}
+
 /* ================================================================= */
 
 bool
@@ -466,17 +812,25 @@ GncSqlBackend::sync(QofBook* book)
     g_return_if_fail (book != NULL);
     g_return_if_fail (m_conn != nullptr);
 
+    /* Everything must be in memory to be written out. */
+    if (m_partly_loaded && book == m_book)
+        load_all_transactions();
+
     reset_version_info();
     ENTER ("book=%p, sql_be->book=%p", book, m_book);
     update_progress(101.0);
 
     /* Create new tables */
     m_is_pristine_db = true;
+    m_commodities_in_db.clear();
     create_tables();
 
     /* Save all contents */
     m_book = book;
     auto is_ok = m_conn->begin_transaction();
+    /* Nothing is read back or changed while writing a pristine database, so
+     * the rows can go out as multi-row INSERTs. */
+    m_batch_inserts = true;
 
     // FIXME: should write the set of commodities that are used
     // write_commodities(sql_be, book);
@@ -507,6 +861,11 @@ GncSqlBackend::sync(QofBook* book)
             std::get<1>(entry)->write (this);
     }
     if (is_ok)
+    {
+        is_ok = flush_inserts();
+    }
+    m_batch_inserts = false;
+    if (is_ok)
     {
         is_ok = m_conn->commit_transaction();
     }
@@ -522,6 +881,8 @@ GncSqlBackend::sync(QofBook* book)
     else
     {
         set_error (ERR_BACKEND_SERVER_ERR);
+        m_insert_batches.clear();
+        m_commodities_in_db.clear();
         m_conn->rollback_transaction ();
     }
     finish_progress();
@@ -575,19 +936,20 @@ GncSqlBackend::commit (QofInstance* inst)
     g_return_if_fail (inst != NULL);
     g_return_if_fail (m_conn != nullptr);
 
-    if (qof_book_is_readonly(m_book))
-    {
-        set_error (ERR_BACKEND_READONLY);
-        (void)m_conn->rollback_transaction ();
-        return;
-    }
     /* During initial load where objects are being created, don't commit
-    anything, but do mark the object as clean. */
+    anything, but do mark the object as clean. The same goes for
+    transactions loaded or dropped later, also in read-only books. */
     if (m_loading)
     {
         qof_instance_mark_clean (inst);
         return;
     }
+    if (qof_book_is_readonly(m_book))
+    {
+        set_error (ERR_BACKEND_READONLY);
+        (void)m_conn->rollback_transaction ();
+        return;
+    }
 
     // The engine has a PriceDB object but it isn't in the database
     if (strcmp (inst->e_type, "PriceDB") == 0)
@@ -639,6 +1001,7 @@ GncSqlBackend::commit (QofInstance* inst)
     if (!is_ok)
     {
         // Error - roll it back
+        m_commodities_in_db.clear();
         (void)m_conn->rollback_transaction();
 
         // This *should* leave things marked dirty
@@ -855,6 +1218,8 @@ GncSqlBackend::do_db_operation (E_DB_OPERATION op, const char* table_name,
     switch(op)
     {
         case  OP_DB_INSERT:
+        if (m_batch_inserts)
+            return queue_insert (table_name, obj_name, pObject, table);
         stmt = build_insert_statement (table_name, obj_name, pObject, table);
         break;
         case OP_DB_UPDATE:
@@ -863,6 +1228,21 @@ GncSqlBackend::do_db_operation (E_DB_OPERATION op, const char* table_name,
         case OP_DB_DELETE:
         stmt = build_delete_statement (table_name, obj_name, pObject, table);
         break;
+        case OP_DB_ADD_OR_UPDATE:
+        if (!m_conn->can_upsert())
+        {
+            /* The server is too old for an upsert; replace the row. */
+            stmt = build_delete_statement (table_name, obj_name, pObject,
+                                           table);
+            if (stmt == nullptr || execute_nonselect_statement(stmt) == -1)
+                return false;
+            stmt = build_insert_statement (table_name, obj_name, pObject,
+                                           table);
+        }
+        else
+            stmt = build_upsert_statement (table_name, obj_name, pObject,
+                                           table);
+        break;
     }
     if (stmt == nullptr)
         return false;
@@ -873,47 +1253,169 @@ bool
 GncSqlBackend::save_commodity(gnc_commodity* comm) noexcept
 {
     if (comm == nullptr) return false;
+    /* Transactions, accounts and prices all ask for their commodity, so
+     * remember which rows are already written instead of looking each one
+     * up again. */
+    if (commodity_in_db(comm))
+        return true;
     QofInstance* inst = QOF_INSTANCE(comm);
     auto obe = m_backend_registry.get_object_backend(std::string(inst->e_type));
-    if (obe && !obe->instance_in_db(this, inst))
+    if (obe)
         return obe->commit(this, inst);
     return true;
 }
 
+void
+GncSqlBackend::set_commodity_in_db(const gnc_commodity* comm, bool in_db) noexcept
+{
+    auto guid = qof_instance_get_guid(comm);
+    if (in_db)
+        m_commodities_in_db.insert(*guid);
+    else
+        m_commodities_in_db.erase(*guid);
+}
+
+bool
+GncSqlBackend::commodity_in_db(const gnc_commodity* comm) const noexcept
+{
+    auto guid = qof_instance_get_guid(comm);
+    return m_commodities_in_db.find(*guid) != m_commodities_in_db.end();
+}
+
+static std::string
+column_list (const PairVec& values)
+{
+    std::string cols{"("};
+    for (auto const& col_value : values)
+    {
+        if (col_value != *values.begin())
+            cols += ",";
+        cols += col_value.first;
+    }
+    return cols + ")";
+}
+
+static std::string
+value_list (const PairVec& values)
+{
+    std::string vals{"("};
+    for (auto const& col_value : values)
+    {
+        if (col_value != *values.begin())
+            vals += ",";
+        vals += col_value.second;
+    }
+    return vals + ")";
+}
+
+bool
+GncSqlBackend::queue_insert (const char* table_name, QofIdTypeConst obj_name,
+                             gpointer pObject, const EntryVec& table) const noexcept
+{
+    PairVec values{get_object_values(obj_name, pObject, table)};
+    auto columns = column_list (values);
+    auto batch = std::find_if (m_insert_batches.begin(), m_insert_batches.end(),
+                               [table_name](const InsertBatch& b) {
+                                   return b.m_table == table_name;
+                               });
+    /* A multi-row INSERT names its columns once, so a row with other columns
+     * has to wait for the queued ones to be written. */
+    if (batch != m_insert_batches.end() && batch->m_columns != columns)
+    {
+        if (!flush_inserts())
+            return false;
+        batch = m_insert_batches.end();
+    }
+    if (batch == m_insert_batches.end())
+    {
+        m_insert_batches.push_back({table_name, columns, "", 0});
+        batch = std::prev(m_insert_batches.end());
+    }
+
+    if (batch->m_count > 0)
+        batch->m_rows += ",";
+    batch->m_rows += value_list (values);
+    if (++batch->m_count < INSERT_BATCH_ROWS &&
+        batch->m_rows.size() < INSERT_BATCH_BYTES)
+        return true;
+    return write_insert_batch (*batch);
+}
+
+bool
+GncSqlBackend::write_insert_batch (InsertBatch& batch) const noexcept
+{
+    auto sql = "INSERT INTO " + batch.m_table + batch.m_columns + " VALUES" +
+        batch.m_rows;
+    batch.m_rows.clear();
+    batch.m_count = 0;
+
+    auto stmt = create_statement_from_sql(sql);
+    if (stmt == nullptr)
+        return false;
+    /* Straight to the connection: the backend's execute functions would
+     * flush the queue again. */
+    if (m_conn->execute_nonselect_statement(stmt) == -1)
+    {
+        PERR ("SQL error: %s\n", stmt->to_sql());
+        qof_backend_set_error ((QofBackend*)this, ERR_BACKEND_SERVER_ERR);
+        return false;
+    }
+    return true;
+}
+
+bool
+GncSqlBackend::flush_inserts() const noexcept
+{
+    bool is_ok = true;
+    for (auto& batch : m_insert_batches)
+    {
+        if (is_ok && batch.m_count > 0)
+            is_ok = write_insert_batch (batch);
+    }
+    m_insert_batches.clear();
+    return is_ok;
+}
+
 GncSqlStatementPtr
 GncSqlBackend::build_insert_statement (const char* table_name,
                                        QofIdTypeConst obj_name,
                                        gpointer pObject,
                                        const EntryVec& table) const noexcept
 {
-    GncSqlStatementPtr stmt;
-    PairVec col_values;
-    std::ostringstream sql;
-
     g_return_val_if_fail (table_name != nullptr, nullptr);
     g_return_val_if_fail (obj_name != nullptr, nullptr);
     g_return_val_if_fail (pObject != nullptr, nullptr);
     PairVec values{get_object_values(obj_name, pObject, table)};
 
-    sql << "INSERT INTO " << table_name <<"(";
-    for (auto const& col_value : values)
-    {
-        if (col_value != *values.begin())
-            sql << ",";
-        sql << col_value.first;
-    }
+    auto sql = std::string{"INSERT INTO "} + table_name + column_list (values) +
+        " VALUES" + value_list (values);
+    return create_statement_from_sql(sql);
+}
 
-    sql << ") VALUES(";
-    for (const auto& col_value : values)
-    {
-        if (col_value != *values.begin())
-            sql << ",";
-        sql << col_value.second;
-    }
-    sql << ")";
+/* An INSERT that updates the row instead if its primary key, the first
+ * column, is already there, so that nobody has to look for the row with a
+ * SELECT first. */
+GncSqlStatementPtr
+GncSqlBackend::build_upsert_statement (const char* table_name,
+                                       QofIdTypeConst obj_name,
+                                       gpointer pObject,
+                                       const EntryVec& table) const noexcept
+{
+    g_return_val_if_fail (table_name != nullptr, nullptr);
+    g_return_val_if_fail (obj_name != nullptr, nullptr);
+    g_return_val_if_fail (pObject != nullptr, nullptr);
+    g_return_val_if_fail (m_conn != nullptr, nullptr);
+    PairVec values{get_object_values(obj_name, pObject, table)};
 
-    stmt = create_statement_from_sql(sql.str());
-    return stmt;
+    StrVec update_cols;
+    std::transform (values.begin() + 1, values.end(),
+                    std::back_inserter(update_cols),
+                    [](const auto& col_value) { return col_value.first; });
+
+    auto sql = std::string{"INSERT INTO "} + table_name + column_list (values) +
+        " VALUES" + value_list (values) +
+        m_conn->upsert_clause (values.begin()->first, update_cols);
+    return create_statement_from_sql(sql);
 }
 
 GncSqlStatementPtr
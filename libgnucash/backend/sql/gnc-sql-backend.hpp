@@ -30,6 +30,8 @@
 #include <memory>
 #include <exception>
 #include <sstream>
+#include <string>
+#include <unordered_set>
 #include <vector>
 #include <qof-backend.hpp>
 
@@ -48,14 +50,44 @@ using GncSqlResultPtr = GncSqlResult*;
 using VersionPair = std::pair<const std::string, unsigned int>;
 using VersionVec = std::vector<VersionPair>;
 using uint_t = unsigned int;
+using InstanceVec = std::vector<QofInstance*>;
+
+/** Hash and equality for keeping GncGUIDs in unordered containers. */
+struct GncGUIDHash
+{
+    std::size_t operator()(const GncGUID& guid) const noexcept
+    {
+        return guid_hash_to_guint (&guid);
+    }
+};
+
+struct GncGUIDEqual
+{
+    bool operator()(const GncGUID& l, const GncGUID& r) const noexcept
+    {
+        return guid_equal (&l, &r);
+    }
+};
 
 typedef enum
 {
     OP_DB_INSERT,
     OP_DB_UPDATE,
-    OP_DB_DELETE
+    OP_DB_DELETE,
+    OP_DB_ADD_OR_UPDATE
 } E_DB_OPERATION;
 
+/** The commodity balances of the splits of an account. */
+typedef struct
+{
+    Account* acct;
+    gnc_numeric balance;
+    gnc_numeric cleared_balance;
+    gnc_numeric reconciled_balance;
+    gnc_numeric noclosing_balance;
+} acct_balances_t;
+using AcctBalanceMap = std::unordered_map<Account*, acct_balances_t>;
+
 /**
  *
  * Main SQL backend structure.
@@ -77,6 +109,43 @@ public:
      * @param book Book to be saved
      */
     void sync(QofBook*) override;
+    /**
+     * Load the transactions that a query may match if they aren't in memory
+     * yet. Does nothing unless the book was only partly loaded.
+     *
+     * @param book The book the query is run on
+     * @param query The query about to be run
+     */
+    void load_for_query(QofBook*, QofQuery*) override;
+    /**
+     * Let the transactions a query asked for be evicted again, now that the
+     * query, for example that of a register being closed, is gone. Called
+     * for every query destroyed, so the query's book may be gone already.
+     *
+     * @param query The query being destroyed
+     */
+    void release_query(QofQuery*) noexcept;
+    /**
+     * Make sure that the transactions with a split in an account and posted
+     * on or after a date are in memory. Does nothing unless the book was only
+     * partly loaded.
+     *
+     * @param acc The account
+     * @param start The earliest post date needed, INT64_MIN for all
+     */
+    void load_account_from(Account* acc, time64 start);
+    /**
+     * Choose whether load() reads every transaction or only the accounts,
+     * their balances and the other objects, leaving transactions to be read
+     * as queries need them.
+     *
+     * @param partial true to read transactions only when needed
+     * @param max_tx The number of transactions to keep in memory before the
+     * least recently used clean ones are dropped again, 0 for no limit.
+     */
+    void set_partial_load(bool partial, size_t max_tx) noexcept;
+    /** @return true if some transactions haven't been read yet. */
+    bool partly_loaded() const noexcept { return m_partly_loaded; }
     /**
      * An object is about to be edited.
      *
@@ -232,6 +301,23 @@ public:
      * @return true if the commodity needed to be saved.
      */
     bool save_commodity(gnc_commodity* comm) noexcept;
+    /**
+     * Record whether a commodity's row is known to be in the database, so
+     * that save_commodity doesn't have to write it again.
+     *
+     * @param comm The commodity in question
+     * @param in_db true if the row was written, false if it was deleted
+     */
+    void set_commodity_in_db(const gnc_commodity* comm, bool in_db) noexcept;
+    bool commodity_in_db(const gnc_commodity* comm) const noexcept;
+    /**
+     * Writes the rows queued while INSERTs are being batched. Any other
+     * statement flushes the queue first, so callers need only flush before
+     * committing the database transaction.
+     *
+     * @return true if successful or nothing was queued, false if not
+     */
+    bool flush_inserts() const noexcept;
     QofBook* book() const noexcept { return m_book; }
     void set_loading(bool loading) noexcept { m_loading = loading; }
     bool pristine() const noexcept { return m_is_pristine_db; }
@@ -252,6 +338,11 @@ private:
     bool write_transactions();
     bool write_template_transactions();
     bool write_schedXactions();
+    void load_balances();
+    void load_all_transactions();
+    void count_loaded(const InstanceVec& txs, bool loaded);
+    bool can_evict(Transaction* tx) const noexcept;
+    void evict_transactions();
     GncSqlStatementPtr build_insert_statement (const char* table_name,
                                                QofIdTypeConst obj_name,
                                                gpointer pObject,
@@ -264,6 +355,21 @@ private:
                                                QofIdTypeConst obj_name,
                                                gpointer pObject,
                                                const EntryVec& table) const noexcept;
+    GncSqlStatementPtr build_upsert_statement (const char* table_name,
+                                               QofIdTypeConst obj_name,
+                                               gpointer pObject,
+                                               const EntryVec& table) const noexcept;
+    /** Rows waiting to be written to one table by a multi-row INSERT. */
+    struct InsertBatch
+    {
+        std::string m_table;
+        std::string m_columns;
+        std::string m_rows;
+        unsigned int m_count;
+    };
+    bool queue_insert (const char* table_name, QofIdTypeConst obj_name,
+                       gpointer pObject, const EntryVec& table) const noexcept;
+    bool write_insert_batch (InsertBatch& batch) const noexcept;
 
     class ObjectBackendRegistry
     {
@@ -286,6 +392,29 @@ private:
     };
     ObjectBackendRegistry m_backend_registry;
     std::vector<gnc_commodity*> m_postload_commodities;
+    /** Commodities whose rows have been written during this connection, by
+     * GUID because a destroyed commodity's address can be reused. */
+    std::unordered_set<GncGUID, GncGUIDHash, GncGUIDEqual> m_commodities_in_db;
+    bool m_batch_inserts = false; /**< Queue INSERTs during a full save */
+    mutable std::vector<InsertBatch> m_insert_batches;
+    bool m_partial_load = false;  /**< Read transactions only when needed */
+    bool m_partly_loaded = false; /**< Some transactions haven't been read */
+    size_t m_max_loaded_tx = 0;   /**< Evict beyond this many, 0 for never */
+    /** The post date from which an account's transactions are all in
+     * memory, and when they were last asked for. */
+    struct LoadedWindow
+    {
+        time64 m_start;
+        uint64_t m_last_use;
+    };
+    std::unordered_map<Account*, LoadedWindow> m_loaded_windows;
+    /** The accounts each query still alive has asked for, whose windows
+     * aren't evicted until the query is destroyed. */
+    std::unordered_map<QofQuery*, std::vector<Account*>> m_query_accounts;
+    uint64_t m_window_clock = 0;
+    /** The balances of the splits still in the database only, which are the
+     * accounts' starting balances. */
+    AcctBalanceMap m_unloaded_balances;
 };
 
 #endif //__GNC_SQL_BACKEND_HPP__
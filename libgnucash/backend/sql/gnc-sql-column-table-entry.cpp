@@ -25,6 +25,7 @@
 #include <qof.h>
 #include <sstream>
 #include <iomanip>
+#include <stdexcept>
 #include <gnc-datetime.hpp>
 #include "gnc-sql-backend.hpp"
 #include "gnc-sql-object-backend.hpp"
@@ -682,6 +683,42 @@ gnc_sql_load_object (const GncSqlBackend* sql_be, GncSqlRow& row,
     }
 }
 
+/* Object references and GUIDs are the only columns add_to_table() makes
+ * non-unicode strings of GUID_ENCODING_LENGTH. */
+static GncSqlColumnType
+column_batch_type (const GncSqlColumnInfo& info)
+{
+    switch (info.m_type)
+    {
+    case BCT_STRING:
+        if (!info.m_unicode && info.m_size == GUID_ENCODING_LENGTH)
+            return GncSqlColumnType::GUID;
+        return GncSqlColumnType::STRING;
+    case BCT_INT:
+    case BCT_INT64:
+        return GncSqlColumnType::INT64;
+    case BCT_DATETIME:
+        return GncSqlColumnType::TIME64;
+    default:
+        throw std::invalid_argument ("Column " + info.m_name +
+                                     " can't be decoded into a column batch.");
+    }
+}
+
+GncSqlColumnBatch
+gnc_sql_column_batch (const EntryVec& table)
+{
+    ColVec info_vec;
+    for (auto const& table_row : table)
+        table_row->add_to_table (info_vec);
+
+    GncSqlColumnBatch columns;
+    columns.reserve (info_vec.size());
+    for (auto const& info : info_vec)
+        columns.emplace_back (info.m_name, column_batch_type (info));
+    return columns;
+}
+
 uint_t
 gnc_sql_append_guids_to_sql (std::stringstream& sql,
                              const InstanceVec& instances)
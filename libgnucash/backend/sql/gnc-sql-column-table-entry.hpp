@@ -508,6 +508,18 @@ inline bool operator!=(const GncSqlColumnInfo& l,
     return !(l == r);
 }
 
+/**
+ * Make the buffers for decoding a table's columns with
+ * GncSqlResult::fetch_columns(), one per column that add_to_table() describes
+ * and with the same name, in table order.
+ *
+ * @param table The table's column entries
+ * @return The buffers
+ * @throw std::invalid_argument if the table has a BCT_DATE or BCT_DOUBLE
+ * column, which GncSqlColumnType has no type for.
+ */
+GncSqlColumnBatch gnc_sql_column_batch (const EntryVec& table);
+
 /**
  * Set an object property with a setter function.
  * @param pObject void* to the object being set.
@@ -86,6 +86,15 @@ public:
         const noexcept = 0;
     virtual std::string quote_string (const std::string&)
         const noexcept = 0;
+    /** Returns the clause which, appended to an INSERT, makes it update the
+     * named columns of a row whose primary key is already present, or leave
+     * that row alone if no columns are named.
+     */
+    virtual std::string upsert_clause (const std::string& key,
+                                       const std::vector<std::string>& update_cols)
+        const noexcept = 0;
+    /** Whether the server understands upsert_clause(); old ones don't. */
+    virtual bool can_upsert () const noexcept = 0;
     /** Get the connection error value.
      * If not 0 will normally be meaningless outside of implementation code.
      */
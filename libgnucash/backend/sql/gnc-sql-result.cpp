@@ -22,11 +22,16 @@
 \***********************************************************************/
 
 #include <config.h>
+#include <guid.hpp>
 #include <sstream>
+#include <stdexcept>
+#include <gnc-datetime.hpp>
 #include "gnc-sql-column-table-entry.hpp"
 
 #include "gnc-sql-result.hpp"
 
+static QofLogModule log_module = G_LOG_DOMAIN;
+
 GncSqlRow&
 GncSqlRow::operator++()
 {
@@ -43,3 +48,198 @@ GncSqlRow::operator++()
   return m_iter->operator*();
   }
 */
+
+/* --------------------------------------------------------- */
+
+void
+GncSqlColumnBuffer::clear() noexcept
+{
+    m_null.clear();
+    m_ints.clear();
+    m_guids.clear();
+    m_chars.clear();
+    m_offsets.clear();
+}
+
+void
+GncSqlColumnBuffer::append_null()
+{
+    m_null.push_back(true);
+    switch (m_type)
+    {
+    case GncSqlColumnType::INT64:
+    case GncSqlColumnType::TIME64:
+        m_ints.push_back(0);
+        break;
+    case GncSqlColumnType::GUID:
+        m_guids.push_back(*guid_null());
+        break;
+    case GncSqlColumnType::STRING:
+        m_offsets.push_back(m_chars.size());
+        m_chars.push_back('\0');
+        break;
+    }
+}
+
+void
+GncSqlColumnBuffer::append_int (int64_t value)
+{
+    m_null.push_back(false);
+    m_ints.push_back(value);
+}
+
+void
+GncSqlColumnBuffer::append_string (const char* value)
+{
+    if (value == nullptr)
+    {
+        append_null();
+        return;
+    }
+    if (m_type == GncSqlColumnType::GUID)
+    {
+        GncGUID guid;
+        if (!string_to_guid (value, &guid))
+        {
+            append_null();
+            return;
+        }
+        m_null.push_back(false);
+        m_guids.push_back(guid);
+        return;
+    }
+    m_null.push_back(false);
+    m_offsets.push_back(m_chars.size());
+    m_chars.append(value);
+    m_chars.push_back('\0');
+}
+
+/* The time64 of the "YYYY-MM-DD HH:MM:SS" UTC strings that the backend
+ * writes dates as, without the regular expressions GncDateTime parses
+ * with. Returns false for anything else, which is left to GncDateTime. */
+static bool
+parse_sql_datetime (const char* str, time64& t)
+{
+    static const int widths[] = {4, 2, 2, 2, 2, 2};
+    static const char seps[] = "-- ::";
+    int f[6];
+    auto p = str;
+    for (int i = 0; i < 6; ++i)
+    {
+        if (i > 0 && *p++ != seps[i - 1])
+            return false;
+        f[i] = 0;
+        for (int w = 0; w < widths[i]; ++w, ++p)
+        {
+            if (*p < '0' || *p > '9')
+                return false;
+            f[i] = f[i] * 10 + (*p - '0');
+        }
+    }
+    if (*p)
+        return false;
+
+    auto year = f[0], month = f[1], day = f[2];
+    static const int mdays[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    auto leap = (year % 4 == 0 && year % 100 != 0) || year % 400 == 0;
+    if (year < 1400 || month < 1 || month > 12 || day < 1 ||
+        day > mdays[month - 1] + (month == 2 && leap) ||
+        f[3] > 23 || f[4] > 59 || f[5] > 59)
+        return false;
+
+    /* Days since the epoch of the proleptic Gregorian date, counting years
+     * from March so that the leap day comes last. */
+    auto y = year - (month <= 2);
+    auto era = y / 400;
+    auto yoe = y - era * 400;
+    auto doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    auto doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    int64_t days = era * INT64_C(146097) + doe - 719468;
+    t = days * 86400 + f[3] * 3600 + f[4] * 60 + f[5];
+    return true;
+}
+
+void
+GncSqlColumnBuffer::append_time_string (const char* value)
+{
+    if (value == nullptr)
+    {
+        append_null();
+        return;
+    }
+    time64 t;
+    if (parse_sql_datetime (value, t))
+    {
+        append_int(t);
+        return;
+    }
+    try
+    {
+        GncDateTime time(value);
+        append_int(static_cast<time64>(time));
+    }
+    catch (const std::invalid_argument&)
+    {
+        PWARN("An invalid date %s was found in your database."
+              "It has been set to 1 January 1970.", value);
+        append_null();
+    }
+}
+
+/* Decode one cell with the row getters, falling back from datetime to
+ * string for TIME64 columns like GncSqlColumnTableEntryImpl<CT_TIME>. */
+static void
+decode_column (const GncSqlRow& row, GncSqlColumnBuffer& column)
+{
+    auto name = column.name();
+    if (row.is_col_null (name))
+    {
+        column.append_null();
+        return;
+    }
+    try
+    {
+        switch (column.type())
+        {
+        case GncSqlColumnType::INT64:
+            column.append_int (row.get_int_at_col (name));
+            break;
+        case GncSqlColumnType::TIME64:
+            try
+            {
+                column.append_int (row.get_time64_at_col (name));
+            }
+            catch (const std::invalid_argument&)
+            {
+                column.append_time_string (row.get_string_at_col (name).c_str());
+            }
+            break;
+        case GncSqlColumnType::STRING:
+        case GncSqlColumnType::GUID:
+            column.append_string (row.get_string_at_col (name).c_str());
+            break;
+        }
+    }
+    catch (const std::invalid_argument&)
+    {
+        column.append_null();
+    }
+}
+
+std::size_t
+GncSqlResult::fetch_columns (GncSqlColumnBatch& columns, std::size_t max_rows)
+{
+    for (auto& column : columns)
+        column.clear();
+    if (m_fetch_row == nullptr)
+        m_fetch_row = &begin();
+
+    std::size_t nrows = 0;
+    for (; nrows < max_rows && *m_fetch_row != end(); ++nrows)
+    {
+        for (auto& column : columns)
+            decode_column (*m_fetch_row, column);
+        m_fetch_row = &++(*m_fetch_row);
+    }
+    return nrows;
+}
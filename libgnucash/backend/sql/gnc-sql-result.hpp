@@ -26,11 +26,70 @@
 
 #include <qof.h>
 
+#include <cstddef>
 #include <cstdint>
 #include <string>
 #include <vector>
 
 class GncSqlRow;
+
+/**
+ * Value types GncSqlResult::fetch_columns() can decode a column into.
+ * TIME64 columns may hold either SQL datetimes or date strings; GUID
+ * columns hold the GUID's string encoding.
+ */
+enum class GncSqlColumnType
+{
+    INT64,
+    TIME64,
+    STRING,
+    GUID,
+};
+
+/**
+ * The decoded values of one column for a batch of rows.
+ *
+ * A result set fills one buffer per requested column and row i of the
+ * batch is element i of each of them. Null cells, and cells that could not
+ * be decoded as the requested type, read as 0, the empty string or nullptr
+ * and are flagged by is_null(). Strings are kept in one block of memory;
+ * the pointers string_at() returns stay valid until the buffer is refilled.
+ */
+class GncSqlColumnBuffer
+{
+public:
+    GncSqlColumnBuffer (std::string name, GncSqlColumnType type) :
+        m_name{std::move(name)}, m_type{type} {}
+    const char* name() const noexcept { return m_name.c_str(); }
+    GncSqlColumnType type() const noexcept { return m_type; }
+    std::size_t size() const noexcept { return m_null.size(); }
+    void clear() noexcept;
+    void append_null();
+    /** Append an INT64 or TIME64 value. */
+    void append_int (int64_t value);
+    /** Append a STRING, or the encoding of a GUID; nullptr appends a null. */
+    void append_string (const char* value);
+    /** Append the time64 of a date string, for TIME64 columns stored as
+     * text; unparseable strings append a null. */
+    void append_time_string (const char* value);
+    bool is_null (std::size_t row) const noexcept { return m_null[row]; }
+    int64_t int_at (std::size_t row) const noexcept { return m_ints[row]; }
+    const char* string_at (std::size_t row) const noexcept {
+        return m_chars.data() + m_offsets[row]; }
+    const GncGUID* guid_at (std::size_t row) const noexcept {
+        return m_null[row] ? nullptr : &m_guids[row]; }
+private:
+    std::string m_name;
+    GncSqlColumnType m_type;
+    std::vector<bool> m_null;
+    std::vector<int64_t> m_ints;
+    std::vector<GncGUID> m_guids;
+    std::string m_chars;
+    std::vector<std::size_t> m_offsets;
+};
+
+using GncSqlColumnBatch = std::vector<GncSqlColumnBuffer>;
+
 /**
  * Pure virtual class to iterate over a query result set.
  */
@@ -42,6 +101,24 @@ public:
     virtual uint64_t size() const noexcept = 0;
     virtual GncSqlRow& begin() = 0;
     virtual GncSqlRow& end() = 0;
+    /**
+     * Decode the next rows of the result set into columns, one buffer per
+     * column, replacing what the buffers held.
+     *
+     * This is the fast path for reading large tables: implementations
+     * resolve the columns once per result set instead of looking each
+     * one up by name on every row. Pass the same columns, in the same
+     * order, to every call on a result set and don't mix it with
+     * iterating the rows. The default implementation decodes through
+     * GncSqlRow.
+     *
+     * @param columns The columns to decode, named and typed by their
+     * buffers.
+     * @param max_rows The most rows to decode.
+     * @return The number of rows decoded, 0 once all have been.
+     */
+    virtual std::size_t fetch_columns (GncSqlColumnBatch& columns,
+                                       std::size_t max_rows);
     friend GncSqlRow;
 protected:
     class IteratorImpl {
@@ -56,6 +133,8 @@ protected:
         virtual time64 get_time64_at_col (const char* col) const = 0;
         virtual bool is_col_null (const char* col) const noexcept = 0;
     };
+private:
+    GncSqlRow* m_fetch_row = nullptr;
 };
 
 /**
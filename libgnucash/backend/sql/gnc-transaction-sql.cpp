@@ -46,6 +46,9 @@
 #include "splint-defs.h"
 #endif
 
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
 #include <string>
 #include <sstream>
 
@@ -78,6 +81,9 @@ struct split_info_t : public write_objects_t
     const GncGUID* guid;
 };
 
+/* The slot that marks a closing transaction, trans_is_closing_str in the
+ * engine. */
+#define TRANS_CLOSING_SLOT "book_closing"
 #define TX_MAX_NUM_LEN 2048
 #define TX_MAX_DESCRIPTION_LEN 2048
 
@@ -198,51 +204,133 @@ set_split_lot (gpointer pObject,  gpointer pLot)
     gnc_lot_add_split (lot, split);
 }
 
-static  Split*
-load_single_split (GncSqlBackend* sql_be, GncSqlRow& row)
-{
-    const GncGUID* guid;
-    GncGUID split_guid;
-    Split* pSplit = NULL;
+/* Rows decoded per GncSqlResult::fetch_columns() call when loading
+ * transactions and splits. */
+#define LOAD_BATCH_ROWS 4096
 
-    g_return_val_if_fail (sql_be != NULL, NULL);
-
-    guid = gnc_sql_load_guid (sql_be, row);
-    if (guid == NULL) return NULL;
-    if (guid_equal (guid, guid_null ()))
-    {
-        PWARN ("Bad GUID, creating new");
-        split_guid = guid_new_return ();
-    }
-    else
-    {
-        split_guid = *guid;
-        pSplit = xaccSplitLookup (&split_guid, sql_be->book());
-    }
+/* The buffer a load batch decodes a column of the table into. The batches
+ * are made from the tables by gnc_sql_column_batch(), so a name that isn't
+ * among their columns is a programming error. */
+static const GncSqlColumnBuffer&
+batch_column (const GncSqlColumnBatch& cols, const char* name)
+{
+    for (auto const& column : cols)
+        if (strcmp (column.name(), name) == 0)
+            return column;
+    throw std::out_of_range (std::string("No load batch column ") + name);
+}
 
-    if (pSplit)
-        return pSplit; //Already loaded, nothing to do.
+static InstanceVec query_transactions (GncSqlBackend* sql_be,
+                                       std::string selector);
 
-    pSplit = xaccMallocSplit (sql_be->book());
-    gnc_sql_load_object (sql_be, row, GNC_ID_SPLIT, pSplit, split_col_table);
+static bool
+numeric_at (const GncSqlColumnBuffer& num, const GncSqlColumnBuffer& denom,
+            size_t row, gnc_numeric& n)
+{
+    if (num.is_null (row) || denom.is_null (row))
+        return false;
+    n = gnc_numeric_create (num.int_at (row), denom.int_at (row));
+    return true;
+}
 
-    /*# -ifempty */
-    if (pSplit != xaccSplitLookup (&split_guid, sql_be->book()))
+/* The transaction a split row belongs to, loading it if it isn't yet. */
+static Transaction*
+split_parent_at (GncSqlBackend* sql_be, const GncSqlColumnBuffer& column,
+                 size_t row)
+{
+    auto guid = column.guid_at (row);
+    if (guid == nullptr)
+        return nullptr;
+    auto tx = xaccTransLookup (guid, sql_be->book());
+    if (tx == nullptr)
     {
         gchar guidstr[GUID_ENCODING_LENGTH + 1];
-        guid_to_string_buff (qof_instance_get_guid (pSplit), guidstr);
-        PERR ("A malformed split with id %s was found in the dataset.", guidstr);
-        qof_backend_set_error ((QofBackend*)sql_be, ERR_BACKEND_DATA_CORRUPT);
-        pSplit = NULL;
+        guid_to_string_buff (guid, guidstr);
+        std::string sql(tx_col_table[0]->name());
+        sql += std::string(" = '") + guidstr + "'";
+        query_transactions (sql_be, sql);
+        tx = xaccTransLookup (guid, sql_be->book());
     }
-    if (!xaccSplitGetAccount(pSplit))
+    return tx;
+}
+
+/**
+ * Creates the splits of a batch of split rows that aren't already loaded.
+ *
+ * This sets the same fields as gnc_sql_load_object() would with
+ * split_col_table, but with the engine's setters inside a single edit of
+ * each split rather than one edit per column.
+ */
+static void
+load_split_batch (GncSqlBackend* sql_be, const GncSqlColumnBatch& cols,
+                  size_t nrows)
+{
+    auto book = sql_be->book();
+    auto& guid_col = batch_column (cols, "guid");
+    auto& tx_col = batch_column (cols, "tx_guid");
+    auto& account_col = batch_column (cols, "account_guid");
+    auto& memo_col = batch_column (cols, "memo");
+    auto& action_col = batch_column (cols, "action");
+    auto& reconcile_col = batch_column (cols, "reconcile_state");
+    auto& reconcile_date_col = batch_column (cols, "reconcile_date");
+    auto& value_num_col = batch_column (cols, "value_num");
+    auto& value_denom_col = batch_column (cols, "value_denom");
+    auto& quantity_num_col = batch_column (cols, "quantity_num");
+    auto& quantity_denom_col = batch_column (cols, "quantity_denom");
+    auto& lot_col = batch_column (cols, "lot_guid");
+    for (size_t row = 0; row < nrows; ++row)
     {
-        gchar guidstr[GUID_ENCODING_LENGTH + 1];
-        guid_to_string_buff (qof_instance_get_guid (pSplit), guidstr);
-        PERR("Split %s created with no account!", guidstr);
+        auto guid = guid_col.guid_at (row);
+        if (guid == nullptr || guid_equal (guid, guid_null ()))
+        {
+            PWARN ("Bad GUID, creating new");
+            guid = nullptr;
+        }
+        else if (xaccSplitLookup (guid, book))
+            continue; //Already loaded, nothing to do.
+
+        auto pSplit = xaccMallocSplit (book);
+        auto inst = QOF_INSTANCE (pSplit);
+        qof_begin_edit (inst);
+        if (guid)
+            qof_instance_set_guid (inst, guid);
+
+        auto tx = split_parent_at (sql_be, tx_col, row);
+        if (tx)
+            xaccSplitSetParent (pSplit, tx);
+        if (auto acc_guid = account_col.guid_at (row))
+            if (auto acc = xaccAccountLookup (acc_guid, book))
+                xaccSplitSetAccount (pSplit, acc);
+        if (!memo_col.is_null (row))
+            xaccSplitSetMemo (pSplit, memo_col.string_at (row));
+        if (!action_col.is_null (row))
+            xaccSplitSetAction (pSplit, action_col.string_at (row));
+        if (!reconcile_col.is_null (row))
+            xaccSplitSetReconcile (pSplit, reconcile_col.string_at (row)[0]);
+        xaccSplitSetDateReconciledSecs (pSplit,
+                                        reconcile_date_col.int_at (row));
+        gnc_numeric n;
+        if (numeric_at (value_num_col, value_denom_col, row, n))
+            xaccSplitSetValue (pSplit, n);
+        if (numeric_at (quantity_num_col, quantity_denom_col, row, n))
+            xaccSplitSetAmount (pSplit, n);
+        if (auto lot_guid = lot_col.guid_at (row))
+            if (auto lot = gnc_lot_lookup (lot_guid, book))
+                gnc_lot_add_split (lot, pSplit);
+
+        /* Commit like set_parameter() does, to clear the infant flag. */
+        if (qof_commit_edit (inst))
+            qof_commit_edit_part2 (inst, nullptr, nullptr, nullptr);
+
+        if (!xaccSplitGetAccount(pSplit))
+        {
+            gchar guidstr[GUID_ENCODING_LENGTH + 1];
+            guid_to_string_buff (qof_instance_get_guid (pSplit), guidstr);
+            PERR("Split %s created with no account!", guidstr);
+        }
     }
-    return pSplit;
 }
+
 static void
 load_splits_for_transactions (GncSqlBackend* sql_be, std::string selector)
 {
@@ -267,45 +355,61 @@ load_splits_for_transactions (GncSqlBackend* sql_be, std::string selector)
     auto stmt = sql_be->create_statement_from_sql(sql);
     auto result = sql_be->execute_select_statement (stmt);
 
-    for (auto row : *result)
-        load_single_split (sql_be, row);
+    auto columns = gnc_sql_column_batch (split_col_table);
+    while (auto nrows = result->fetch_columns (columns, LOAD_BATCH_ROWS))
+        load_split_batch (sql_be, columns, nrows);
+    delete result;
     sql = "SELECT DISTINCT ";
     sql += spkey + " FROM " SPLIT_TABLE " WHERE " + sskey + " IN " + selector;
     gnc_sql_slots_load_for_sql_subquery(sql_be, sql,
                                         (BookLookupFn)xaccSplitLookup);
 }
 
-static  Transaction*
-load_single_tx (GncSqlBackend* sql_be, GncSqlRow& row)
+/**
+ * Creates the transactions of a batch of transaction rows that aren't
+ * already loaded, leaving them open for their splits to be added.
+ *
+ * @param instances Receives the transactions created.
+ */
+static void
+load_tx_batch (GncSqlBackend* sql_be, const GncSqlColumnBatch& cols,
+               size_t nrows, InstanceVec& instances)
 {
-    const GncGUID* guid;
-    GncGUID tx_guid;
-    Transaction* pTx;
-
-    g_return_val_if_fail (sql_be != NULL, NULL);
-
-    guid = gnc_sql_load_guid (sql_be, row);
-    if (guid == NULL) return NULL;
-    tx_guid = *guid;
-
-    pTx = xaccTransLookup (&tx_guid, sql_be->book());
-    if (pTx)
-        return nullptr; // Nothing to do. 
-
-    pTx = xaccMallocTransaction (sql_be->book());
-    xaccTransBeginEdit (pTx);
-    gnc_sql_load_object (sql_be, row, GNC_ID_TRANS, pTx, tx_col_table);
-
-    if (pTx != xaccTransLookup (&tx_guid, sql_be->book()))
+    auto book = sql_be->book();
+    auto& guid_col = batch_column (cols, "guid");
+    auto& currency_col = batch_column (cols, "currency_guid");
+    auto& num_col = batch_column (cols, "num");
+    auto& post_date_col = batch_column (cols, "post_date");
+    auto& enter_date_col = batch_column (cols, "enter_date");
+    auto& description_col = batch_column (cols, "description");
+    for (size_t row = 0; row < nrows; ++row)
     {
-        gchar guidstr[GUID_ENCODING_LENGTH + 1];
-        guid_to_string_buff (qof_instance_get_guid (pTx), guidstr);
-        PERR ("A malformed transaction with id %s was found in the dataset.", guidstr);
-        qof_backend_set_error ((QofBackend*)sql_be, ERR_BACKEND_DATA_CORRUPT);
-        pTx = NULL;
+        auto guid = guid_col.guid_at (row);
+        if (guid == nullptr)
+        {
+            PERR ("A transaction with a malformed id was found in the dataset.");
+            qof_backend_set_error ((QofBackend*)sql_be, ERR_BACKEND_DATA_CORRUPT);
+            continue;
+        }
+        if (xaccTransLookup (guid, book))
+            continue; // Nothing to do.
+
+        auto pTx = xaccMallocTransaction (book);
+        xaccTransBeginEdit (pTx);
+        qof_instance_set_guid (QOF_INSTANCE (pTx), guid);
+        if (auto curr_guid = currency_col.guid_at (row))
+            if (auto currency = gnc_commodity_find_commodity_by_guid (curr_guid,
+                                                                      book))
+                xaccTransSetCurrency (pTx, currency);
+        if (!num_col.is_null (row))
+            xaccTransSetNum (pTx, num_col.string_at (row));
+        xaccTransSetDatePostedSecs (pTx, post_date_col.int_at (row));
+        xaccTransSetDateEnteredSecs (pTx, enter_date_col.int_at (row));
+        if (!description_col.is_null (row))
+            xaccTransSetDescription (pTx, description_col.string_at (row));
+        xaccTransScrubPostedDate (pTx);
+        instances.push_back (QOF_INSTANCE (pTx));
     }
-
-    return pTx;
 }
 
 /**
@@ -331,11 +435,12 @@ typedef struct
  *
  * @param sql_be SQL backend
  * @param stmt SQL statement
+ * @return The transactions that were not already in memory
  */
-static void
+static InstanceVec
 query_transactions (GncSqlBackend* sql_be, std::string selector)
 {
-    g_return_if_fail (sql_be != NULL);
+    g_return_val_if_fail (sql_be != NULL, InstanceVec{});
 
     const std::string tpkey(tx_col_table[0]->name());
     std::string sql("SELECT * FROM " TRANSACTION_TABLE);
@@ -349,23 +454,17 @@ query_transactions (GncSqlBackend* sql_be, std::string selector)
     if (result->begin() == result->end())
     {
         PINFO("Query %s returned no results", sql.c_str());
-        return;
+        delete result;
+        return InstanceVec{};
     }
 
-    Transaction* tx;
-
     // Load the transactions
     InstanceVec instances;
     instances.reserve(result->size());
-    for (auto row : *result)
-    {
-        tx = load_single_tx (sql_be, row);
-        if (tx != nullptr)
-        {
-            xaccTransScrubPostedDate (tx);
-            instances.push_back(QOF_INSTANCE(tx));
-        }
-    }
+    auto columns = gnc_sql_column_batch (tx_col_table);
+    while (auto nrows = result->fetch_columns (columns, LOAD_BATCH_ROWS))
+        load_tx_batch (sql_be, columns, nrows, instances);
+    delete result;
 
     // Load all splits and slots for the transactions
     if (!instances.empty())
@@ -393,6 +492,7 @@ query_transactions (GncSqlBackend* sql_be, std::string selector)
     for (auto instance : instances)
          xaccTransCommitEdit(GNC_TRANSACTION(instance));
 
+    return instances;
 }
 
 
@@ -704,6 +804,156 @@ void gnc_sql_transaction_load_tx_for_account (GncSqlBackend* sql_be,
     query_transactions (sql_be, sql);
 }
 
+/**
+ * Loads the transactions which have splits for an account and were posted
+ * in a range of dates.
+ *
+ * @param sql_be SQL backend
+ * @param account Account
+ * @param start Earliest post date, or INT64_MIN for no limit
+ * @param end Post date to stop before, or INT64_MAX for no limit
+ * @return The transactions that were not already in memory
+ */
+InstanceVec
+gnc_sql_transaction_load_tx_for_account_between (GncSqlBackend* sql_be,
+                                                 Account* account,
+                                                 time64 start, time64 end)
+{
+    g_return_val_if_fail (sql_be != NULL, InstanceVec{});
+    g_return_val_if_fail (account != NULL, InstanceVec{});
+
+    auto guid = qof_instance_get_guid (QOF_INSTANCE (account));
+
+    const std::string tpkey(tx_col_table[0]->name());        //guid
+    const std::string stkey(split_col_table[1]->name());     //txn_guid
+    const std::string sakey(split_col_table[2]->name());     //account_guid
+    const std::string pdkey(post_date_col_table[0]->name()); //post_date
+    std::string sql("(SELECT DISTINCT " SPLIT_TABLE ".");
+    sql += stkey + " FROM " SPLIT_TABLE " INNER JOIN " TRANSACTION_TABLE
+        " ON " SPLIT_TABLE "." + stkey + " = " TRANSACTION_TABLE "." + tpkey +
+        " WHERE " SPLIT_TABLE "." + sakey + " = '" +
+        gnc::GUID(*guid).to_string() + "'";
+    if (start > MINTIME && start < MAXTIME)
+        sql += " AND " TRANSACTION_TABLE "." + pdkey + " >= '" +
+            GncDateTime(start).format_iso8601() + "'";
+    if (end > MINTIME && end < MAXTIME)
+        sql += " AND " TRANSACTION_TABLE "." + pdkey + " < '" +
+            GncDateTime(end).format_iso8601() + "'";
+    sql += ")";
+    return query_transactions (sql_be, sql);
+}
+
+/**
+ * Loads the transactions which have splits in a lot, so that every lot
+ * holds all of its splits.
+ *
+ * @param sql_be SQL backend
+ * @return The transactions that were not already in memory
+ */
+InstanceVec
+gnc_sql_transaction_load_lot_txs (GncSqlBackend* sql_be)
+{
+    g_return_val_if_fail (sql_be != NULL, InstanceVec{});
+
+    const std::string stkey(split_col_table[1]->name()); //txn_guid
+    const std::string slkey(split_col_table[9]->name()); //lot_guid
+    std::string sql("(SELECT DISTINCT ");
+    sql += stkey + " FROM " SPLIT_TABLE " WHERE " + slkey + " IS NOT NULL AND " +
+        slkey + " <> '')";
+    return query_transactions (sql_be, sql);
+}
+
+static bool
+param_path_is (QofQueryParamList* path, std::initializer_list<const char*> params)
+{
+    for (auto param : params)
+    {
+        if (path == nullptr ||
+            g_strcmp0 (static_cast<const char*>(path->data), param) != 0)
+            return false;
+        path = path->next;
+    }
+    return path == nullptr;
+}
+
+/**
+ * Finds which accounts and dates the splits a query looks for must be in.
+ * Each AND clause of the query must restrict the splits' accounts, or their
+ * transactions' accounts, for the query to be limited to some accounts. A
+ * lower bound on the transactions' post date limits it further.
+ *
+ * @param book The book the query is run on
+ * @param query A query for splits
+ * @param windows Filled with each account and the earliest post date that
+ * the query can match in it.
+ * @return false if the query can match splits in any account.
+ */
+bool
+gnc_sql_transaction_query_windows (QofBook* book, QofQuery* query,
+                                   std::vector<std::pair<Account*, time64>>& windows)
+{
+    g_return_val_if_fail (book != NULL, false);
+    g_return_val_if_fail (query != NULL, false);
+
+    windows.clear();
+    auto or_terms = qof_query_get_terms (query);
+    if (or_terms == nullptr)
+        return false;
+
+    for (auto or_node = or_terms; or_node; or_node = g_list_next (or_node))
+    {
+        GList* guids = nullptr;
+        time64 start = INT64_MIN;
+
+        for (auto and_node = static_cast<GList*>(or_node->data); and_node;
+             and_node = g_list_next (and_node))
+        {
+            auto term = static_cast<QofQueryTerm*>(and_node->data);
+            if (qof_query_term_is_inverted (term))
+                continue;
+            auto path = qof_query_term_get_param_path (term);
+            auto pdata = qof_query_term_get_pred_data (term);
+
+            if (param_path_is (path, {SPLIT_ACCOUNT, QOF_PARAM_GUID}) ||
+                param_path_is (path, {SPLIT_TRANS, TRANS_SPLITLIST,
+                                      SPLIT_ACCOUNT_GUID}))
+            {
+                auto gdata = reinterpret_cast<query_guid_t>(pdata);
+                if (gdata->options != QOF_GUID_MATCH_ANY &&
+                    gdata->options != QOF_GUID_MATCH_ALL)
+                    continue;
+                /* Any restriction will do; prefer the narrowest. */
+                if (guids == nullptr ||
+                    g_list_length (gdata->guids) < g_list_length (guids))
+                    guids = gdata->guids;
+            }
+            else if (param_path_is (path, {SPLIT_TRANS, TRANS_DATE_POSTED}) &&
+                     (pdata->how == QOF_COMPARE_GTE ||
+                      pdata->how == QOF_COMPARE_GT))
+            {
+                auto ddata = reinterpret_cast<query_date_t>(pdata);
+                auto date = ddata->date;
+                if (ddata->options == QOF_DATE_MATCH_DAY)
+                    date = gnc_time64_get_day_start (date);
+                start = std::max (start, date);
+            }
+        }
+
+        if (guids == nullptr)
+        {
+            windows.clear();
+            return false;
+        }
+        for (auto node = guids; node; node = g_list_next (node))
+        {
+            auto acc = xaccAccountLookup (static_cast<GncGUID*>(node->data), book);
+            if (acc)
+                windows.emplace_back (acc, start);
+        }
+    }
+    return true;
+}
+
 /**
  * Loads all transactions.  This might be used during a save-as operation to ensure that
  * all data is in memory and ready to be saved.
@@ -782,6 +1032,77 @@ static const EntryVec acct_balances_col_table
                                          (QofSetterFunc)set_acct_bal_balance),
 };
 
+static void
+add_account_balances (GncSqlBackend* sql_be, const std::string& sql,
+                      AcctBalanceMap& balances, bool closing)
+{
+    auto stmt = sql_be->create_statement_from_sql (sql);
+    auto result = sql_be->execute_select_statement (stmt);
+    if (result == nullptr)
+        return;
+
+    auto zero = gnc_numeric_zero ();
+    for (auto row : *result)
+    {
+        single_acct_balance_t bal {sql_be, nullptr, NREC, zero};
+        gnc_sql_load_object (sql_be, row, nullptr, &bal, acct_balances_col_table);
+        if (bal.acct == nullptr)
+            continue;
+
+        auto it = balances.find (bal.acct);
+        if (it == balances.end ())
+            it = balances.emplace (bal.acct,
+                                   acct_balances_t{bal.acct, zero, zero, zero,
+                                                   zero}).first;
+        auto& acct_bal = it->second;
+        if (closing)
+        {
+            acct_bal.noclosing_balance =
+                gnc_numeric_sub_fixed (acct_bal.noclosing_balance, bal.balance);
+            continue;
+        }
+        acct_bal.balance = gnc_numeric_add_fixed (acct_bal.balance, bal.balance);
+        acct_bal.noclosing_balance =
+            gnc_numeric_add_fixed (acct_bal.noclosing_balance, bal.balance);
+        if (bal.reconcile_state != NREC)
+            acct_bal.cleared_balance =
+                gnc_numeric_add_fixed (acct_bal.cleared_balance, bal.balance);
+        if (bal.reconcile_state == YREC || bal.reconcile_state == FREC)
+            acct_bal.reconciled_balance =
+                gnc_numeric_add_fixed (acct_bal.reconciled_balance, bal.balance);
+    }
+    delete result;
+}
+
+/**
+ * Adds up the split quantities in the database for each account without
+ * loading the splits. Only the account, reconcile state and quantity columns
+ * are read; the sums are taken here because the SQL sum of the quantity
+ * numerators doesn't come back as an integer from every database.
+ *
+ * @param sql_be SQL backend
+ * @return The balances of the accounts that have splits
+ */
+AcctBalanceMap
+gnc_sql_transaction_get_account_balances (GncSqlBackend* sql_be)
+{
+    AcctBalanceMap balances;
+
+    g_return_val_if_fail (sql_be != NULL, balances);
+
+    const std::string stkey(split_col_table[1]->name()); //txn_guid
+    const std::string columns("SELECT account_guid, reconcile_state, "
+                              "quantity_num, quantity_denom");
+    add_account_balances (sql_be, columns + " FROM " SPLIT_TABLE, balances,
+                          false);
+    /* Closing transactions are marked by a slot; their splits don't count in
+     * the balances without closing entries. */
+    add_account_balances (sql_be, columns + " FROM " SPLIT_TABLE " WHERE " +
+                          stkey + " IN (SELECT obj_guid FROM slots WHERE name = '"
+                          TRANS_CLOSING_SLOT "')", balances, true);
+    return balances;
+}
+
 /* ----------------------------------------------------------------- */
 template<> void
 GncSqlColumnTableEntryImpl<CT_TXREF>::load (const GncSqlBackend* sql_be,
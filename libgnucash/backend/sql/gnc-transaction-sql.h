@@ -59,13 +59,47 @@ public:
  */
 void gnc_sql_transaction_load_tx_for_account (GncSqlBackend* sql_be,
                                               Account* account);
-typedef struct
-{
-    Account* acct;
-    gnc_numeric balance;
-    gnc_numeric cleared_balance;
-    gnc_numeric reconciled_balance;
-} acct_balances_t;
-
+/**
+ * Loads the transactions which have splits for an account and were posted
+ * on or after start and before end.
+ *
+ * @param sql_be SQL backend
+ * @param account Account
+ * @param start Earliest post date, or INT64_MIN for no limit
+ * @param end Post date to stop before, or INT64_MAX for no limit
+ * @return The transactions that were not already in memory
+ */
+InstanceVec gnc_sql_transaction_load_tx_for_account_between (GncSqlBackend* sql_be,
+                                                             Account* account,
+                                                             time64 start,
+                                                             time64 end);
+/**
+ * Loads the transactions which have splits in a lot, so that every lot
+ * holds all of its splits.
+ *
+ * @param sql_be SQL backend
+ * @return The transactions that were not already in memory
+ */
+InstanceVec gnc_sql_transaction_load_lot_txs (GncSqlBackend* sql_be);
+/**
+ * Adds up the split quantities in the database for each account without
+ * loading the splits.
+ *
+ * @param sql_be SQL backend
+ * @return The balances of the accounts that have splits
+ */
+AcctBalanceMap gnc_sql_transaction_get_account_balances (GncSqlBackend* sql_be);
+/**
+ * Finds which accounts and dates the splits a query looks for must be in.
+ *
+ * @param book The book the query is run on
+ * @param query A query for splits
+ * @param windows Filled with each account and the earliest post date that
+ * the query can match in it.
+ * @return false if the query can match splits in any account, in which case
+ * windows is left empty.
+ */
+bool gnc_sql_transaction_query_windows (QofBook* book, QofQuery* query,
+                                        std::vector<std::pair<Account*, time64>>& windows);
 
 #endif /* GNC_TRANSACTION_SQL_H */
@@ -113,6 +113,10 @@ public:
         const noexcept override { return false; }
     virtual std::string quote_string (const std::string& str)
         const noexcept override { return std::string{str}; }
+    std::string upsert_clause (const std::string&,
+                               const std::vector<std::string>&)
+        const noexcept override { return std::string{}; }
+    bool can_upsert () const noexcept override { return true; }
     int dberror() const noexcept override { return 0; }
     void set_error(QofBackendError error, unsigned int repeat, bool retry) noexcept override { return; }
     bool verify() noexcept override { return true; }
@@ -30,6 +30,8 @@
 #include "TransactionP.h"
 #include "gnc-lot.h"
 #include "gnc-lot-p.h"
+#include "qofinstance-p.h"
+#include <kvp-frame.hpp>
 
 #include "gnc-xml-helper.h"
 
@@ -43,9 +45,18 @@
 #include "gnc-xml.h"
 
 #include "io-gncxml-gen.h"
+#include "gnc-xml-load-pipeline.hpp"
 
 #include "sixtp-dom-parsers.h"
 
+#include <algorithm>
+#include <iterator>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
 [[maybe_unused]] static const QofLogModule log_module = G_LOG_DOMAIN;
 const gchar* transaction_version_string = "2.0.0";
 
@@ -191,173 +202,284 @@ gnc_transaction_dom_tree_create (Transaction* trn)
     return ret;
 }
 
+/* The streaming counterparts of split_to_dom_tree and
+ * gnc_transaction_dom_tree_create; they must write the same elements in
+ * the same order. */
+static void
+write_split (GncXmlWriter& writer, const gchar* tag, Split* spl)
+{
+    writer.start_element (tag);
+
+    guid_to_xml (writer, "split:id", xaccSplitGetGUID (spl));
+
+    auto memo = xaccSplitGetMemo (spl);
+    if (memo && g_strcmp0 (memo, "") != 0)
+        writer.text_element ("split:memo", memo);
+
+    auto action = xaccSplitGetAction (spl);
+    if (action && g_strcmp0 (action, "") != 0)
+        writer.text_element ("split:action", action);
+
+    char tmp[2] = { xaccSplitGetReconcile (spl), '\0' };
+    writer.text_element ("split:reconciled-state", tmp);
+
+    auto reconciled = xaccSplitGetDateReconciled (spl);
+    if (reconciled)
+        time64_to_xml (writer, "split:reconcile-date", reconciled);
+
+    auto value = xaccSplitGetValue (spl);
+    gnc_numeric_to_xml (writer, "split:value", &value);
+
+    auto amount = xaccSplitGetAmount (spl);
+    gnc_numeric_to_xml (writer, "split:quantity", &amount);
+
+    guid_to_xml (writer, "split:account",
+                 xaccAccountGetGUID (xaccSplitGetAccount (spl)));
+
+    GNCLot* lot = xaccSplitGetLot (spl);
+    if (lot)
+        guid_to_xml (writer, "split:lot", gnc_lot_get_guid (lot));
+
+    qof_instance_slots_to_xml (writer, "split:slots", QOF_INSTANCE (spl));
+
+    writer.end_element ();
+}
+
+void
+gnc_transaction_write_xml (GncXmlWriter& writer, Transaction* trn)
+{
+    writer.start_element ("gnc:transaction");
+    writer.attribute ("version", transaction_version_string);
+
+    guid_to_xml (writer, "trn:id", xaccTransGetGUID (trn));
+
+    commodity_ref_to_xml (writer, "trn:currency", xaccTransGetCurrency (trn));
+
+    auto num = xaccTransGetNum (trn);
+    if (num && (g_strcmp0 (num, "") != 0))
+        writer.text_element ("trn:num", num);
+
+    time64_to_xml (writer, "trn:date-posted", xaccTransRetDatePosted (trn));
+
+    time64_to_xml (writer, "trn:date-entered", xaccTransRetDateEntered (trn));
+
+    auto description = xaccTransGetDescription (trn);
+    if (description)
+        writer.text_element ("trn:description", description);
+
+    qof_instance_slots_to_xml (writer, "trn:slots", QOF_INSTANCE (trn));
+
+    writer.start_element ("trn:splits");
+    for (auto n = xaccTransGetSplitList (trn); n; n = n->next)
+        write_split (writer, "trn:split", static_cast<Split*> (n->data));
+    writer.end_element ();
+
+    writer.end_element ();
+}
+
+/***********************************************************************/
+
+gboolean gnc_transaction_xml_v2_testing = FALSE;
+
+static void
+split_insert_in_account (Split* split, const GncGUID* id, QofBook* book)
+{
+    Account* account = xaccAccountLookup (id, book);
+    if (!account && gnc_transaction_xml_v2_testing &&
+        !guid_equal (id, guid_null ()))
+    {
+        account = xaccMallocAccount (book);
+        xaccAccountSetGUID (account, id);
+        xaccAccountSetCommoditySCU (account,
+                                    xaccSplitGetAmount (split).denom);
+    }
+
+    xaccAccountInsertSplit (account, split);
+}
+
+static void
+split_add_to_lot (Split* split, const GncGUID* id, QofBook* book)
+{
+    GNCLot* lot = gnc_lot_lookup (id, book);
+    if (!lot && gnc_transaction_xml_v2_testing &&
+        !guid_equal (id, guid_null ()))
+    {
+        lot = gnc_lot_new (book);
+        gnc_lot_set_guid (lot, *id);
+    }
+
+    gnc_lot_add_split (lot, split);
+}
+
 /***********************************************************************/
+/* A transaction's DOM tree is first decoded into a trans_record, which
+ * doesn't touch the engine, and the Transaction is then built from the
+ * record. When the file is loaded through a GncXmlLoadPipeline the
+ * decoding runs on a worker thread and the building on the parsing
+ * thread; otherwise dom_tree_to_transaction does both. */
+
+struct split_record
+{
+    GncGUID guid;
+    std::optional<std::string> memo;
+    std::optional<std::string> action;
+    char reconciled = NREC;
+    std::optional<time64> reconcile_date;
+    gnc_numeric value = gnc_numeric_zero ();
+    gnc_numeric amount = gnc_numeric_zero ();
+    GncGUID account;
+    std::optional<GncGUID> lot;
+    std::unique_ptr<KvpFrame> slots;
+};
 
-struct split_pdata
+struct trans_record
 {
-    Split* split;
-    QofBook* book;
+    GncGUID guid;
+    std::optional<std::pair<std::string, std::string>> currency;
+    std::optional<std::string> num;
+    time64 date_posted = 0;
+    time64 date_entered = 0;
+    std::optional<std::string> description;
+    std::unique_ptr<KvpFrame> slots;
+    std::vector<split_record> splits;
 };
 
-static inline gboolean
-set_spl_string (xmlNodePtr node, Split* spl,
-                void (*func) (Split* spl, const char* txt))
+static gboolean
+set_record_guid (xmlNodePtr node, GncGUID& guid)
+{
+    GncGUID* tmp = dom_tree_to_guid (node);
+    g_return_val_if_fail (tmp, FALSE);
+
+    guid = *tmp;
+
+    guid_free (tmp);
+    return TRUE;
+}
+
+static gboolean
+set_record_string (xmlNodePtr node, std::optional<std::string>& str)
 {
     gchar* tmp = dom_tree_to_text (node);
     g_return_val_if_fail (tmp, FALSE);
 
-    func (spl, tmp);
+    str = tmp;
 
     g_free (tmp);
-
     return TRUE;
 }
 
-static inline gboolean
-set_spl_gnc_num (xmlNodePtr node, Split* spl,
-                 void (*func) (Split* spl, gnc_numeric gn))
+static gboolean
+set_record_gnc_num (xmlNodePtr node, gnc_numeric& num)
 {
-    gnc_numeric* num = dom_tree_to_gnc_numeric (node);
-    g_return_val_if_fail (num, FALSE);
+    gnc_numeric* tmp = dom_tree_to_gnc_numeric (node);
+    g_return_val_if_fail (tmp, FALSE);
 
-    func (spl, *num);
+    num = *tmp;
 
-    g_free (num);
+    g_free (tmp);
+    return TRUE;
+}
 
-    return FALSE;
+static time64
+record_time64 (xmlNodePtr node)
+{
+    time64 time = dom_tree_to_time64 (node);
+    return dom_tree_valid_time64 (time, node->name) ? time : 0;
 }
 
 static gboolean
-spl_id_handler (xmlNodePtr node, gpointer data)
+set_record_slots (xmlNodePtr node, std::unique_ptr<KvpFrame>& slots)
 {
-    struct split_pdata* pdata = static_cast<decltype (pdata)> (data);
-    GncGUID* tmp = dom_tree_to_guid (node);
-    g_return_val_if_fail (tmp, FALSE);
-
-    xaccSplitSetGUID (pdata->split, tmp);
+    if (!slots)
+        slots.reset (new KvpFrame);
+    gboolean successful = dom_tree_to_kvp_frame_given (node, slots.get ());
+    g_return_val_if_fail (successful, FALSE);
 
-    guid_free (tmp);
     return TRUE;
 }
 
+static gboolean
+spl_id_handler (xmlNodePtr node, gpointer data)
+{
+    auto rec = static_cast<split_record*> (data);
+    return set_record_guid (node, rec->guid);
+}
+
 static gboolean
 spl_memo_handler (xmlNodePtr node, gpointer data)
 {
-    struct split_pdata* pdata = static_cast<decltype (pdata)> (data);
-    return set_spl_string (node, pdata->split, xaccSplitSetMemo);
+    auto rec = static_cast<split_record*> (data);
+    return set_record_string (node, rec->memo);
 }
 
 static gboolean
 spl_action_handler (xmlNodePtr node, gpointer data)
 {
-    struct split_pdata* pdata = static_cast<decltype (pdata)> (data);
-    return set_spl_string (node, pdata->split, xaccSplitSetAction);
+    auto rec = static_cast<split_record*> (data);
+    return set_record_string (node, rec->action);
 }
 
 static gboolean
 spl_reconciled_state_handler (xmlNodePtr node, gpointer data)
 {
-    struct split_pdata* pdata = static_cast<decltype (pdata)> (data);
+    auto rec = static_cast<split_record*> (data);
     gchar* tmp = dom_tree_to_text (node);
     g_return_val_if_fail (tmp, FALSE);
 
-    xaccSplitSetReconcile (pdata->split, tmp[0]);
+    rec->reconciled = tmp[0];
 
     g_free (tmp);
-
     return TRUE;
 }
 
 static gboolean
 spl_reconcile_date_handler (xmlNodePtr node, gpointer data)
 {
-    struct split_pdata* pdata = static_cast<decltype (pdata)> (data);
-    time64 time  = dom_tree_to_time64 (node);
-    if (!dom_tree_valid_time64 (time, node->name)) time = 0;
-    xaccSplitSetDateReconciledSecs (pdata->split, time);
+    auto rec = static_cast<split_record*> (data);
+    rec->reconcile_date = record_time64 (node);
     return TRUE;
 }
 
 static gboolean
 spl_value_handler (xmlNodePtr node, gpointer data)
 {
-    struct split_pdata* pdata = static_cast<decltype (pdata)> (data);
-    return set_spl_gnc_num (node, pdata->split, xaccSplitSetValue);
+    auto rec = static_cast<split_record*> (data);
+    return set_record_gnc_num (node, rec->value);
 }
 
 static gboolean
 spl_quantity_handler (xmlNodePtr node, gpointer data)
 {
-    struct split_pdata* pdata = static_cast<decltype (pdata)> (data);
-    return set_spl_gnc_num (node, pdata->split, xaccSplitSetAmount);
+    auto rec = static_cast<split_record*> (data);
+    return set_record_gnc_num (node, rec->amount);
 }
 
-gboolean gnc_transaction_xml_v2_testing = FALSE;
-
 static gboolean
 spl_account_handler (xmlNodePtr node, gpointer data)
 {
-    struct split_pdata* pdata = static_cast<decltype (pdata)> (data);
-    GncGUID* id = dom_tree_to_guid (node);
-    Account* account;
-
-    g_return_val_if_fail (id, FALSE);
-
-    account = xaccAccountLookup (id, pdata->book);
-    if (!account && gnc_transaction_xml_v2_testing &&
-        !guid_equal (id, guid_null ()))
-    {
-        account = xaccMallocAccount (pdata->book);
-        xaccAccountSetGUID (account, id);
-        xaccAccountSetCommoditySCU (account,
-                                    xaccSplitGetAmount (pdata->split).denom);
-    }
-
-    xaccAccountInsertSplit (account, pdata->split);
-
-    guid_free (id);
-
-    return TRUE;
+    auto rec = static_cast<split_record*> (data);
+    return set_record_guid (node, rec->account);
 }
 
 static gboolean
 spl_lot_handler (xmlNodePtr node, gpointer data)
 {
-    struct split_pdata* pdata = static_cast<decltype (pdata)> (data);
-    GncGUID* id = dom_tree_to_guid (node);
-    GNCLot* lot;
-
-    g_return_val_if_fail (id, FALSE);
-
-    lot = gnc_lot_lookup (id, pdata->book);
-    if (!lot && gnc_transaction_xml_v2_testing &&
-        !guid_equal (id, guid_null ()))
-    {
-        lot = gnc_lot_new (pdata->book);
-        gnc_lot_set_guid (lot, *id);
-    }
-
-    gnc_lot_add_split (lot, pdata->split);
-
-    guid_free (id);
-
+    auto rec = static_cast<split_record*> (data);
+    GncGUID lot;
+    if (!set_record_guid (node, lot))
+        return FALSE;
+    rec->lot = lot;
     return TRUE;
 }
 
 static gboolean
 spl_slots_handler (xmlNodePtr node, gpointer data)
 {
-    struct split_pdata* pdata = static_cast<decltype (pdata)> (data);
-    gboolean successful;
-
-    successful = dom_tree_create_instance_slots (node,
-                                                 QOF_INSTANCE (pdata->split));
-    g_return_val_if_fail (successful, FALSE);
-
-    return TRUE;
+    auto rec = static_cast<split_record*> (data);
+    return set_record_slots (node, rec->slots);
 }
 
-struct dom_tree_handler spl_dom_handlers[] =
+static const struct dom_tree_handler spl_dom_handlers[] =
 {
     { "split:id", spl_id_handler, 1, 0 },
     { "split:memo", spl_memo_handler, 0, 0 },
@@ -372,151 +494,82 @@ struct dom_tree_handler spl_dom_handlers[] =
     { NULL, NULL, 0, 0 },
 };
 
-static Split*
-dom_tree_to_split (xmlNodePtr node, QofBook* book)
-{
-    struct split_pdata pdata;
-    Split* ret;
-
-    g_return_val_if_fail (book, NULL);
-
-    ret = xaccMallocSplit (book);
-    g_return_val_if_fail (ret, NULL);
-
-    pdata.split = ret;
-    pdata.book = book;
-
-    /* this isn't going to work in a testing setup */
-    if (dom_tree_generic_parse (node, spl_dom_handlers, &pdata))
-    {
-        return ret;
-    }
-    else
-    {
-        xaccSplitDestroy (ret);
-        return NULL;
-    }
-}
-
-/***********************************************************************/
-
-struct trans_pdata
-{
-    Transaction* trans;
-    QofBook* book;
-};
-
-static inline gboolean
-set_tran_string (xmlNodePtr node, Transaction* trn,
-                 void (*func) (Transaction* trn, const char* txt))
-{
-    gchar* tmp;
-
-    tmp = dom_tree_to_text (node);
-
-    g_return_val_if_fail (tmp, FALSE);
-
-    func (trn, tmp);
-
-    g_free (tmp);
-
-    return TRUE;
-}
-
 static gboolean
-set_tran_time64 (xmlNodePtr node, Transaction * trn,
-        void (*func) (Transaction *, time64))
+trn_id_handler (xmlNodePtr node, gpointer data)
 {
-    time64 time = dom_tree_to_time64 (node);
-    if (!dom_tree_valid_time64 (time, node->name)) time = 0;
-    func (trn, time);
-    return TRUE;
+    auto rec = static_cast<trans_record*> (data);
+    return set_record_guid (node, rec->guid);
 }
 
 static gboolean
-trn_id_handler (xmlNodePtr node, gpointer trans_pdata)
+trn_currency_handler (xmlNodePtr node, gpointer data)
 {
-    struct trans_pdata* pdata = static_cast<decltype (pdata)> (trans_pdata);
-    Transaction* trn = pdata->trans;
-    GncGUID* tmp = dom_tree_to_guid (node);
-
-    g_return_val_if_fail (tmp, FALSE);
-
-    xaccTransSetGUID ((Transaction*)trn, tmp);
+    auto rec = static_cast<trans_record*> (data);
+    gchar* space = NULL;
+    gchar* id = NULL;
 
-    guid_free (tmp);
+    /* A bad reference leaves the currency unset rather than failing
+     * the transaction. */
+    if (dom_tree_to_commodity_names (node, &space, &id))
+        rec->currency.emplace (space, id);
 
+    g_free (space);
+    g_free (id);
     return TRUE;
 }
 
 static gboolean
-trn_currency_handler (xmlNodePtr node, gpointer trans_pdata)
+trn_num_handler (xmlNodePtr node, gpointer data)
 {
-    struct trans_pdata* pdata = static_cast<decltype (pdata)> (trans_pdata);
-    Transaction* trn = pdata->trans;
-    gnc_commodity* ref;
-
-    ref = dom_tree_to_commodity_ref (node, pdata->book);
-    xaccTransSetCurrency (trn, ref);
-
-    return TRUE;
+    auto rec = static_cast<trans_record*> (data);
+    return set_record_string (node, rec->num);
 }
 
 static gboolean
-trn_num_handler (xmlNodePtr node, gpointer trans_pdata)
+trn_date_posted_handler (xmlNodePtr node, gpointer data)
 {
-    struct trans_pdata* pdata = static_cast<decltype (pdata)> (trans_pdata);
-    Transaction* trn = pdata->trans;
-
-    return set_tran_string (node, trn, xaccTransSetNum);
+    auto rec = static_cast<trans_record*> (data);
+    rec->date_posted = record_time64 (node);
+    return TRUE;
 }
 
 static gboolean
-trn_date_posted_handler (xmlNodePtr node, gpointer trans_pdata)
+trn_date_entered_handler (xmlNodePtr node, gpointer data)
 {
-    struct trans_pdata* pdata = static_cast<decltype (pdata)> (trans_pdata);
-    Transaction* trn = pdata->trans;
-
-    return set_tran_time64 (node, trn, xaccTransSetDatePostedSecs);
+    auto rec = static_cast<trans_record*> (data);
+    rec->date_entered = record_time64 (node);
+    return TRUE;
 }
 
 static gboolean
-trn_date_entered_handler (xmlNodePtr node, gpointer trans_pdata)
+trn_description_handler (xmlNodePtr node, gpointer data)
 {
-    struct trans_pdata* pdata = static_cast<decltype (pdata)> (trans_pdata);
-    Transaction* trn = pdata->trans;
-
-    return set_tran_time64 (node, trn, xaccTransSetDateEnteredSecs);
+    auto rec = static_cast<trans_record*> (data);
+    return set_record_string (node, rec->description);
 }
 
 static gboolean
-trn_description_handler (xmlNodePtr node, gpointer trans_pdata)
+trn_slots_handler (xmlNodePtr node, gpointer data)
 {
-    struct trans_pdata* pdata = static_cast<decltype (pdata)> (trans_pdata);
-    Transaction* trn = pdata->trans;
-
-    return set_tran_string (node, trn, xaccTransSetDescription);
+    auto rec = static_cast<trans_record*> (data);
+    return set_record_slots (node, rec->slots);
 }
 
 static gboolean
-trn_slots_handler (xmlNodePtr node, gpointer trans_pdata)
-{
-    struct trans_pdata* pdata = static_cast<decltype (pdata)> (trans_pdata);
-    Transaction* trn = pdata->trans;
-    gboolean successful;
-
-    successful = dom_tree_create_instance_slots (node, QOF_INSTANCE (trn));
-
-    g_return_val_if_fail (successful, FALSE);
-
-    return TRUE;
+dom_tree_to_split_record (xmlNodePtr node, split_record& rec)
+{
+    /* dom_tree_generic_parse marks off the handlers it calls, so every
+     * thread needs its own copy of the table. */
+    struct dom_tree_handler handlers[G_N_ELEMENTS (spl_dom_handlers)];
+    std::copy (std::begin (spl_dom_handlers),
+               std::end (spl_dom_handlers), handlers);
+    return dom_tree_generic_parse (node, handlers, &rec);
 }
 
 static gboolean
-trn_splits_handler (xmlNodePtr node, gpointer trans_pdata)
+trn_splits_handler (xmlNodePtr node, gpointer data)
 {
-    struct trans_pdata* pdata = static_cast<decltype (pdata)> (trans_pdata);
-    Transaction* trn = pdata->trans;
+    auto rec = static_cast<trans_record*> (data);
     xmlNodePtr mark;
 
     g_return_val_if_fail (node, FALSE);
@@ -524,8 +577,6 @@ trn_splits_handler (xmlNodePtr node, gpointer trans_pdata)
 
     for (mark = node->xmlChildrenNode; mark; mark = mark->next)
     {
-        Split* spl;
-
         if (g_strcmp0 ("text", (char*)mark->name) == 0)
             continue;
 
@@ -534,21 +585,19 @@ trn_splits_handler (xmlNodePtr node, gpointer trans_pdata)
             return FALSE;
         }
 
-        spl = dom_tree_to_split (mark, pdata->book);
-
-        if (spl)
-        {
-            xaccTransAppendSplit (trn, spl);
-        }
-        else
+        /* A split that doesn't decode fails the parse, and with it the
+         * whole transaction. */
+        rec->splits.emplace_back ();
+        if (!dom_tree_to_split_record (mark, rec->splits.back ()))
         {
+            rec->splits.pop_back ();
             return FALSE;
         }
     }
     return TRUE;
 }
 
-struct dom_tree_handler trn_dom_handlers[] =
+static const struct dom_tree_handler trn_dom_handlers[] =
 {
     { "trn:id", trn_id_handler, 1, 0 },
     { "trn:currency", trn_currency_handler, 0, 0},
@@ -561,6 +610,101 @@ struct dom_tree_handler trn_dom_handlers[] =
     { NULL, NULL, 0, 0 },
 };
 
+static gboolean
+dom_tree_to_trans_record (xmlNodePtr node, trans_record& rec)
+{
+    struct dom_tree_handler handlers[G_N_ELEMENTS (trn_dom_handlers)];
+    std::copy (std::begin (trn_dom_handlers),
+               std::end (trn_dom_handlers), handlers);
+    return dom_tree_generic_parse (node, handlers, &rec);
+}
+
+/* The setters are called in the order the elements are written. */
+static Split*
+split_record_to_split (split_record& rec, QofBook* book)
+{
+    Split* split = xaccMallocSplit (book);
+
+    xaccSplitSetGUID (split, &rec.guid);
+    if (rec.memo)
+        xaccSplitSetMemo (split, rec.memo->c_str ());
+    if (rec.action)
+        xaccSplitSetAction (split, rec.action->c_str ());
+    xaccSplitSetReconcile (split, rec.reconciled);
+    if (rec.reconcile_date)
+        xaccSplitSetDateReconciledSecs (split, *rec.reconcile_date);
+    xaccSplitSetValue (split, rec.value);
+    xaccSplitSetAmount (split, rec.amount);
+    split_insert_in_account (split, &rec.account, book);
+    if (rec.lot)
+        split_add_to_lot (split, &*rec.lot, book);
+    if (rec.slots)
+        qof_instance_set_slots (QOF_INSTANCE (split), rec.slots.release ());
+
+    return split;
+}
+
+static Transaction*
+trans_record_to_transaction (trans_record& rec, QofBook* book)
+{
+    Transaction* trn = xaccMallocTransaction (book);
+    xaccTransBeginEdit (trn);
+
+    xaccTransSetGUID (trn, &rec.guid);
+    if (rec.currency)
+    {
+        auto table = gnc_commodity_table_get_table (book);
+        auto currency = gnc_commodity_table_lookup (table,
+                                                    rec.currency->first.c_str (),
+                                                    rec.currency->second.c_str ());
+        if (currency)
+            xaccTransSetCurrency (trn, currency);
+        else
+            PWARN ("Unknown currency %s:%s", rec.currency->first.c_str (),
+                   rec.currency->second.c_str ());
+    }
+    if (rec.num)
+        xaccTransSetNum (trn, rec.num->c_str ());
+    xaccTransSetDatePostedSecs (trn, rec.date_posted);
+    xaccTransSetDateEnteredSecs (trn, rec.date_entered);
+    if (rec.description)
+        xaccTransSetDescription (trn, rec.description->c_str ());
+    if (rec.slots)
+        qof_instance_set_slots (QOF_INSTANCE (trn), rec.slots.release ());
+    for (auto& split : rec.splits)
+        xaccTransAppendSplit (trn, split_record_to_split (split, book));
+
+    xaccTransCommitEdit (trn);
+    return trn;
+}
+
+static gboolean
+submit_transaction_tree (xmlNodePtr tree, gxpf_data* gdata, const gchar* tag)
+{
+    auto book = static_cast<QofBook*> (gdata->bookdata);
+    auto cb = gdata->cb;
+    auto parsedata = gdata->parsedata;
+    std::string tagname {tag};
+
+    return gdata->pipeline->submit ([=] () -> GncXmlLoadPipeline::Commit
+    {
+        auto rec = std::make_shared<trans_record> ();
+        auto successful = dom_tree_to_trans_record (tree, *rec);
+        if (!successful)
+            xmlElemDump (stdout, NULL, tree);
+        xmlFreeNode (tree);
+        if (!successful)
+            return nullptr;
+
+        return [=] ()
+        {
+            auto trn = trans_record_to_transaction (*rec, book);
+            cb (tagname.c_str (), parsedata, trn);
+            return true;
+        };
+    });
+}
+
 static gboolean
 gnc_transaction_end_handler (gpointer data_for_children,
                              GSList* data_from_children, GSList* sibling_data,
@@ -585,6 +729,10 @@ gnc_transaction_end_handler (gpointer data_for_children,
 
     g_return_val_if_fail (tree, FALSE);
 
+    /* The pipeline frees the tree once it's decoded. */
+    if (gdata->pipeline)
+        return submit_transaction_tree (tree, gdata, tag);
+
     trn = dom_tree_to_transaction (tree,
                                    static_cast<QofBook*> (gdata->bookdata));
     if (trn != NULL)
@@ -600,34 +748,18 @@ gnc_transaction_end_handler (gpointer data_for_children,
 Transaction*
 dom_tree_to_transaction (xmlNodePtr node, QofBook* book)
 {
-    Transaction* trn;
-    gboolean successful;
-    struct trans_pdata pdata;
+    trans_record rec;
 
     g_return_val_if_fail (node, NULL);
     g_return_val_if_fail (book, NULL);
 
-    trn = xaccMallocTransaction (book);
-    g_return_val_if_fail (trn, NULL);
-    xaccTransBeginEdit (trn);
-
-    pdata.trans = trn;
-    pdata.book = book;
-
-    successful = dom_tree_generic_parse (node, trn_dom_handlers, &pdata);
-
-    xaccTransCommitEdit (trn);
-
-    if (!successful)
+    if (!dom_tree_to_trans_record (node, rec))
     {
         xmlElemDump (stdout, NULL, node);
-        xaccTransBeginEdit (trn);
-        xaccTransDestroy (trn);
-        xaccTransCommitEdit (trn);
-        trn = NULL;
+        return NULL;
     }
 
-    return trn;
+    return trans_record_to_transaction (rec, book);
 }
 
 sixtp*
@@ -722,7 +722,8 @@ GncXmlBackend::remove_old_files ()
         if (! (g_str_has_suffix (dent, ".LNK") ||
                g_str_has_suffix (dent, ".xac") /* old data file extension */ ||
                g_str_has_suffix (dent, GNC_DATAFILE_EXT) ||
-               g_str_has_suffix (dent, GNC_LOGFILE_EXT)))
+               g_str_has_suffix (dent, GNC_LOGFILE_EXT) ||
+               g_str_has_suffix (dent, GNC_JOURNALFILE_EXT)))
             continue;
 
         name = g_build_filename (m_dirname.c_str(), dent, (gchar*)NULL);
@@ -773,8 +774,9 @@ GncXmlBackend::remove_old_files ()
              * be safe */
             regex_t pattern;
             gchar* stamp_start = name + strlen (m_fullpath.c_str());
-            gchar* expression = g_strdup_printf ("^\\.[[:digit:]]{14}(\\%s|\\%s|\\.xac)$",
-                                                 GNC_DATAFILE_EXT, GNC_LOGFILE_EXT);
+            gchar* expression = g_strdup_printf ("^\\.[[:digit:]]{14}(\\%s|\\%s|\\%s|\\.xac)$",
+                                                 GNC_DATAFILE_EXT, GNC_LOGFILE_EXT,
+                                                 GNC_JOURNALFILE_EXT);
             gboolean got_date_stamp = FALSE;
 
             if (regcomp (&pattern, expression, REG_EXTENDED | REG_ICASE) != 0)
@@ -0,0 +1,167 @@
+/********************************************************************
+ * gnc-xml-load-pipeline.cpp: Decode XML subtrees on worker threads *
+ * while a file is being parsed.                                    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+#include <glib.h>
+
+#include <config.h>
+
+#include <qof.h>
+
+#include "gnc-xml-load-pipeline.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <system_error>
+
+static QofLogModule log_module = GNC_MOD_IO;
+
+/* Decoding is much cheaper than building the objects, which the parsing
+ * thread does alone, so more workers than this only sit idle. */
+static constexpr unsigned max_workers = 8;
+
+GncXmlLoadPipeline::GncXmlLoadPipeline (unsigned nthreads, size_t max_pending) :
+    m_max_pending {std::max<size_t> (max_pending, 1)}
+{
+    if (!nthreads)
+    {
+        auto cores = std::thread::hardware_concurrency ();
+        nthreads = std::min (cores > 1 ? cores - 1 : 0, max_workers);
+    }
+    try
+    {
+        while (m_workers.size () < nthreads)
+            m_workers.emplace_back (&GncXmlLoadPipeline::worker, this);
+    }
+    catch (const std::system_error& err)
+    {
+        PWARN ("Could not start a load thread: %s", err.what ());
+    }
+    DEBUG ("Decoding on %u threads", threads ());
+}
+
+GncXmlLoadPipeline::~GncXmlLoadPipeline ()
+{
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_stopping = true;
+    }
+    m_queued.notify_all ();
+    for (auto& thread : m_workers)
+        thread.join ();
+}
+
+/* Workers take the queued jobs in turn until the pipeline is destroyed.
+ * The queue is always emptied first so that every decode step gets to
+ * free what it was given. */
+void
+GncXmlLoadPipeline::worker () noexcept
+{
+    std::unique_lock<std::mutex> lock (m_mutex);
+    for (;;)
+    {
+        m_queued.wait (lock, [this] { return m_stopping || !m_jobs.empty (); });
+        if (m_jobs.empty ())
+            return;
+
+        auto job = std::move (m_jobs.front ());
+        m_jobs.pop_front ();
+        lock.unlock ();
+
+        Commit commit;
+        try
+        {
+            commit = job.decode ();
+        }
+        catch (const std::exception& err)
+        {
+            PERR ("Decoding failed: %s", err.what ());
+        }
+        if (!commit)
+            commit = [] { return false; };
+
+        lock.lock ();
+        m_decoded.emplace (job.seq, std::move (commit));
+        m_decoded_cond.notify_one ();
+    }
+}
+
+/* Runs the commit steps of decoded jobs in submission order, waiting
+ * for the workers while more than max_pending jobs are outstanding. */
+bool
+GncXmlLoadPipeline::commit_decoded (uint64_t max_pending)
+{
+    std::unique_lock<std::mutex> lock (m_mutex);
+    for (;;)
+    {
+        auto next = m_decoded.find (m_committed);
+        if (next == m_decoded.end ())
+        {
+            if (m_submitted - m_committed <= max_pending)
+                break;
+            m_decoded_cond.wait (lock);
+            continue;
+        }
+
+        auto commit = std::move (next->second);
+        m_decoded.erase (next);
+        lock.unlock ();
+        if (!commit ())
+            m_ok = false;
+        lock.lock ();
+        ++m_committed;
+    }
+    return m_ok;
+}
+
+bool
+GncXmlLoadPipeline::submit (Decode decode)
+{
+    if (m_workers.empty ())
+    {
+        Commit commit;
+        try
+        {
+            commit = decode ();
+        }
+        catch (const std::exception& err)
+        {
+            PERR ("Decoding failed: %s", err.what ());
+        }
+        if (!commit || !commit ())
+            m_ok = false;
+        return m_ok;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock (m_mutex);
+        m_jobs.push_back ({m_submitted++, std::move (decode)});
+    }
+    m_queued.notify_one ();
+    return commit_decoded (m_max_pending);
+}
+
+bool
+GncXmlLoadPipeline::drain ()
+{
+    if (m_workers.empty ())
+        return m_ok;
+    return commit_decoded (0);
+}
@@ -0,0 +1,100 @@
+/********************************************************************
+ * gnc-xml-load-pipeline.hpp: Decode XML subtrees on worker threads *
+ * while a file is being parsed.                                    *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#ifndef GNC_XML_LOAD_PIPELINE_HPP
+#define GNC_XML_LOAD_PIPELINE_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/** Lets the parser hand the DOM subtree of an element to worker threads
+ * and carry on reading the file while they decode it.
+ *
+ * Each job is split in two. The decode step runs on a worker and must
+ * not touch the engine: no books, collections, commodity tables or
+ * events. It returns a commit step, which the pipeline runs on the
+ * parsing thread, one at a time and in the order the jobs were
+ * submitted, to build the engine objects and put them in the book.
+ *
+ * Elements whose handlers look up objects built by earlier ones must
+ * drain() the pipeline first. With no workers, submit() just runs both
+ * steps in turn.
+ */
+class GncXmlLoadPipeline
+{
+public:
+    /** Runs on the parsing thread; returns false if it failed. */
+    using Commit = std::function<bool ()>;
+    /** Runs on a worker thread and returns the step to finish the job. */
+    using Decode = std::function<Commit ()>;
+
+    /** @param nthreads The number of workers, 0 for one for each core
+     * besides the parsing thread's.
+     * @param max_pending How many jobs may be submitted but not yet
+     * committed before submit() waits for the workers.
+     */
+    explicit GncXmlLoadPipeline (unsigned nthreads = 0,
+                                 size_t max_pending = 1024);
+    /** Joins the workers. Jobs that haven't been committed by then are
+     * dropped, so call drain() first. */
+    ~GncXmlLoadPipeline ();
+    GncXmlLoadPipeline (const GncXmlLoadPipeline&) = delete;
+    GncXmlLoadPipeline& operator= (const GncXmlLoadPipeline&) = delete;
+
+    /** Queues a job and commits any that are ready.
+     * @return false if any job has failed so far. */
+    bool submit (Decode decode);
+    /** Waits for and commits every submitted job.
+     * @return false if any job has failed so far. */
+    bool drain ();
+    unsigned threads () const noexcept { return m_workers.size (); }
+
+private:
+    struct Job
+    {
+        uint64_t seq;
+        Decode decode;
+    };
+
+    void worker () noexcept;
+    bool commit_decoded (uint64_t max_pending);
+
+    std::mutex m_mutex;
+    std::condition_variable m_queued;
+    std::condition_variable m_decoded_cond;
+    std::deque<Job> m_jobs;
+    std::unordered_map<uint64_t, Commit> m_decoded;
+    uint64_t m_submitted = 0;
+    uint64_t m_committed = 0;
+    size_t m_max_pending;
+    bool m_stopping = false;
+    bool m_ok = true;
+    std::vector<std::thread> m_workers;
+};
+
+#endif /* GNC_XML_LOAD_PIPELINE_HPP */
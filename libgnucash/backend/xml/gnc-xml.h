@@ -32,6 +32,7 @@
 
 #include "gnc-xml-helper.h"
 #include "sixtp.h"
+#include "sixtp-dom-generators.h"
 
 xmlNodePtr gnc_account_dom_tree_create (Account* act, gboolean exporting,
                                         gboolean allow_incompat);
@@ -60,6 +61,9 @@ xmlNodePtr gnc_budget_dom_tree_create (GncBudget* bgt);
 sixtp* gnc_budget_sixtp_parser_create (void);
 
 xmlNodePtr gnc_transaction_dom_tree_create (Transaction* txn);
+/** Writes what gnc_transaction_dom_tree_create() would, without building
+ *  the tree. */
+void gnc_transaction_write_xml (GncXmlWriter& writer, Transaction* txn);
 sixtp* gnc_transaction_sixtp_parser_create (void);
 
 sixtp* gnc_template_transaction_sixtp_parser_create (void);
@@ -24,11 +24,12 @@
 #include <config.h>
 
 #include "io-gncxml-gen.h"
+#include "gnc-xml-load-pipeline.hpp"
 
 gboolean
 gnc_xml_parse_file (sixtp* top_parser, const char* filename,
                     gxpf_callback callback, gpointer parsedata,
-                    gpointer bookdata)
+                    gpointer bookdata, GncXmlLoadPipeline* pipeline)
 {
     gpointer parse_result = NULL;
     gxpf_data gpdata;
@@ -36,15 +37,18 @@ gnc_xml_parse_file (sixtp* top_parser, const char* filename,
     gpdata.cb = callback;
     gpdata.parsedata = parsedata;
     gpdata.bookdata = bookdata;
+    gpdata.pipeline = pipeline;
 
-    return sixtp_parse_file (top_parser, filename,
-                             NULL, &gpdata, &parse_result);
+    if (!sixtp_parse_file (top_parser, filename,
+                           NULL, &gpdata, &parse_result))
+        return FALSE;
+    return pipeline ? pipeline->drain () : TRUE;
 }
 
 gboolean
 gnc_xml_parse_fd (sixtp* top_parser, FILE* fd,
                   gxpf_callback callback, gpointer parsedata,
-                  gpointer bookdata)
+                  gpointer bookdata, GncXmlLoadPipeline* pipeline)
 {
     gpointer parse_result = NULL;
     gxpf_data gpdata;
@@ -52,7 +56,10 @@ gnc_xml_parse_fd (sixtp* top_parser, FILE* fd,
     gpdata.cb = callback;
     gpdata.parsedata = parsedata;
     gpdata.bookdata = bookdata;
+    gpdata.pipeline = pipeline;
 
-    return sixtp_parse_fd (top_parser, fd,
-                           NULL, &gpdata, &parse_result);
+    if (!sixtp_parse_fd (top_parser, fd,
+                         NULL, &gpdata, &parse_result))
+        return FALSE;
+    return pipeline ? pipeline->drain () : TRUE;
 }
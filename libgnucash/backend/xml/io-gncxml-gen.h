@@ -29,6 +29,8 @@
 
 #include "sixtp.h"
 
+class GncXmlLoadPipeline;
+
 typedef gboolean (*gxpf_callback) (const char* tag, gpointer parsedata,
                                    gpointer data);
 
@@ -37,18 +39,23 @@ struct gxpf_data_struct
     gxpf_callback cb;
     gpointer parsedata;
     gpointer bookdata;
+    /* Handlers that can decode their subtrees on worker threads submit
+     * them here if it isn't NULL. */
+    GncXmlLoadPipeline* pipeline;
 };
 
 typedef struct gxpf_data_struct gxpf_data;
 
+/* If pipeline is given the objects it decodes are all built by the
+ * time these return. */
 gboolean
 gnc_xml_parse_file (sixtp* top_parser, const char* filename,
                     gxpf_callback callback, gpointer parsedata,
-                    gpointer bookdata);
+                    gpointer bookdata, GncXmlLoadPipeline* pipeline = nullptr);
 
 gboolean
 gnc_xml_parse_fd (sixtp* top_parser, FILE* fd,
                   gxpf_callback callback, gpointer parsedata,
-                  gpointer bookdata);
+                  gpointer bookdata, GncXmlLoadPipeline* pipeline = nullptr);
 
 #endif /* IO_GNCXML_GEN_H */
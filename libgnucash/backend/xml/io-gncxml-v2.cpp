@@ -72,6 +72,7 @@
 #include "sixtp-dom-parsers.h"
 #include "io-gncxml-v2.h"
 #include "io-gncxml-gen.h"
+#include "gnc-xml-load-pipeline.hpp"
 
 /* Do not treat -Wstrict-aliasing warnings as errors because of problems of the
  * G_LOCK* macros as declared by glib.  See
@@ -101,6 +102,7 @@ struct file_backend
     sixtp*          parser;
     FILE*           out;
     QofBook*        book;
+    GncXmlWriter*   writer;
 };
 
 static std::vector<GncXmlDataType_t> backend_registry;
@@ -628,6 +630,24 @@ generic_callback (const char* tag, gpointer globaldata, gpointer data)
     return TRUE;
 }
 
+/* Transactions are built by the load pipeline after the parser has
+ * moved on. Everything else may look them up, e.g. an invoice's posted
+ * transaction or a lot's splits, so wait for them to be in the book
+ * before any other element is read. */
+static gboolean
+drain_pipeline_before_child (gpointer data_for_children,
+                             GSList* data_from_children, GSList* sibling_data,
+                             gpointer parent_data, gpointer global_data,
+                             gpointer* result, const gchar* tag,
+                             const gchar* child_tag)
+{
+    gxpf_data* gdata = (gxpf_data*)global_data;
+
+    if (!gdata->pipeline || g_strcmp0 (child_tag, TRANSACTION_TAG) == 0)
+        return TRUE;
+    return gdata->pipeline->drain ();
+}
+
 static void
 add_parser(const GncXmlDataType_t& data, struct file_backend* be_data)
 {
@@ -765,6 +785,9 @@ qof_session_load_from_xml_file_v2_full (
     if (be_data.ok == FALSE)
         goto bail;
 
+    sixtp_set_before_child (main_parser, drain_pipeline_before_child);
+    sixtp_set_before_child (book_parser, drain_pipeline_before_child);
+
     /* stop logging while we load */
     xaccLogDisable ();
     xaccDisableDataScrubbing ();
@@ -773,13 +796,16 @@ qof_session_load_from_xml_file_v2_full (
     {
         gpointer parse_result = NULL;
         gxpf_data gpdata;
+        GncXmlLoadPipeline pipeline;
 
         gpdata.cb = generic_callback;
         gpdata.parsedata = gd;
         gpdata.bookdata = book;
+        gpdata.pipeline = &pipeline;
 
         retval = sixtp_parse_push (top_parser, push_handler, push_user_data,
-                                   NULL, &gpdata, &parse_result);
+                                   NULL, &gpdata, &parse_result) &&
+                 pipeline.drain ();
     }
     else
     {
@@ -799,8 +825,11 @@ qof_session_load_from_xml_file_v2_full (
         }
         else
         {
+            /* The inflating thread and the SAX parser keep reading the
+             * file while the pipeline's workers decode transactions. */
+            GncXmlLoadPipeline pipeline;
             retval = gnc_xml_parse_fd (top_parser, file,
-                                       generic_callback, gd, book);
+                                       generic_callback, gd, book, &pipeline);
             fclose (file);
             if (thread)
                 g_thread_join (thread);
@@ -1153,14 +1182,12 @@ static int
 xml_add_trn_data (Transaction* t, gpointer data)
 {
     struct file_backend* be_data = static_cast<decltype (be_data)> (data);
-    xmlNodePtr node;
-
-    node = gnc_transaction_dom_tree_create (t);
-
-    xmlElemDump (be_data->out, NULL, node);
-    xmlFreeNode (node);
 
-    if (ferror (be_data->out) || fprintf (be_data->out, "\n") < 0)
+    /* Transactions are most of the file, so they are written directly
+     * instead of going through a DOM tree like the other objects. */
+    gnc_transaction_write_xml (*be_data->writer, t);
+    be_data->writer->write ("\n");
+    if (!be_data->writer->ok ())
         return -1;
 
     be_data->gd->counter.transactions_loaded++;
@@ -1172,13 +1199,16 @@ static gboolean
 write_transactions (FILE* out, QofBook* book, sixtp_gdv2* gd)
 {
     struct file_backend be_data;
+    GncXmlWriter writer (out);
 
     be_data.out = out;
     be_data.gd = gd;
+    be_data.writer = &writer;
     return 0 ==
            xaccAccountTreeForEachTransaction (gnc_book_get_root_account (book),
                                               xml_add_trn_data,
-                                              (gpointer) &be_data);
+                                              (gpointer) &be_data)
+           && writer.flush ();
 }
 
 static gboolean
@@ -1193,9 +1223,12 @@ write_template_transaction_data (FILE* out, QofBook* book, sixtp_gdv2* gd)
     ra = gnc_book_get_template_root (book);
     if (gnc_account_n_descendants (ra) > 0)
     {
+        GncXmlWriter writer (out);
+        be_data.writer = &writer;
         if (fprintf (out, "<%s>\n", TEMPLATE_TRANSACTION_TAG) < 0
             || !write_account_tree (out, ra, gd)
             || xaccAccountTreeForEachTransaction (ra, xml_add_trn_data, (gpointer)&be_data)
+            || !writer.flush ()
             || fprintf (out, "</%s>\n", TEMPLATE_TRANSACTION_TAG) < 0)
 
             return FALSE;
@@ -35,6 +35,8 @@
 #include <kvp-frame.hpp>
 #include <gnc-datetime.hpp>
 
+#include <algorithm>
+
 static QofLogModule log_module = GNC_MOD_IO;
 
 xmlNodePtr
@@ -332,3 +334,331 @@ qof_instance_slots_to_dom_tree (const char* tag, const QofInstance* inst)
     frame->for_each_slot_temp (&add_kvp_slot, ret);
     return ret;
 }
+
+/* ================================================================ */
+/* GncXmlWriter: xmlElemDump() indents each element by two spaces per
+ * level, up to 60 levels, when its parent holds only elements, and
+ * writes elements without content as <tag/>. */
+
+static constexpr size_t writer_buffer_size = 64 * 1024;
+static constexpr size_t max_indent_level = 60;
+
+void
+GncXmlWriter::open_tag (const char* tag)
+{
+    if (!m_open.empty ())
+    {
+        auto& parent = m_open.back ();
+        if (!parent.second)
+        {
+            m_buf += ">\n";
+            parent.second = true;
+        }
+        m_buf.append (2 * std::min (m_open.size (), max_indent_level), ' ');
+    }
+    m_buf += '<';
+    m_buf += tag;
+}
+
+void
+GncXmlWriter::close_child ()
+{
+    if (!m_open.empty ())
+        m_buf += '\n';
+    if (m_buf.size () >= writer_buffer_size)
+        flush ();
+}
+
+/* Replace the characters checked_char_cast() would, then escape them
+ * the way libxml2 does for UTF-8 output. */
+void
+GncXmlWriter::append_escaped (const char* text, bool attribute)
+{
+    gchar* copy = nullptr;
+    if (!g_utf8_validate (text, -1, nullptr))
+        text = copy = reinterpret_cast<gchar*> (checked_char_cast (g_strdup (text)));
+
+    for (auto p = reinterpret_cast<const unsigned char*> (text); *p; ++p)
+    {
+        switch (*p)
+        {
+        case '<':
+            m_buf += "&lt;";
+            break;
+        case '>':
+            m_buf += "&gt;";
+            break;
+        case '&':
+            m_buf += "&amp;";
+            break;
+        case '\r':
+            m_buf += "&#13;";
+            break;
+        case '"':
+            m_buf += attribute ? "&quot;" : "\"";
+            break;
+        case '\n':
+            m_buf += attribute ? "&#10;" : "\n";
+            break;
+        case '\t':
+            m_buf += attribute ? "&#9;" : "\t";
+            break;
+        default:
+            m_buf += *p < 0x20 ? '?' : static_cast<char> (*p);
+            break;
+        }
+    }
+    g_free (copy);
+}
+
+void
+GncXmlWriter::start_element (const char* tag)
+{
+    open_tag (tag);
+    m_open.emplace_back (tag, false);
+}
+
+void
+GncXmlWriter::attribute (const char* name, const char* value)
+{
+    m_buf += ' ';
+    m_buf += name;
+    m_buf += "=\"";
+    append_escaped (value, true);
+    m_buf += '"';
+}
+
+void
+GncXmlWriter::end_element ()
+{
+    g_return_if_fail (!m_open.empty ());
+    auto [tag, has_children] = m_open.back ();
+    m_open.pop_back ();
+    if (!has_children)
+    {
+        m_buf += "/>";
+    }
+    else
+    {
+        m_buf.append (2 * std::min (m_open.size (), max_indent_level), ' ');
+        m_buf += "</";
+        m_buf += tag;
+        m_buf += '>';
+    }
+    close_child ();
+}
+
+void
+GncXmlWriter::text_element (const char* tag, const char* text,
+                            const char* type)
+{
+    open_tag (tag);
+    if (type)
+        attribute ("type", type);
+    if (!text)
+    {
+        m_buf += "/>";
+    }
+    else
+    {
+        m_buf += '>';
+        append_escaped (text, false);
+        m_buf += "</";
+        m_buf += tag;
+        m_buf += '>';
+    }
+    close_child ();
+}
+
+void
+GncXmlWriter::write (const char* str)
+{
+    m_buf += str;
+    if (m_buf.size () >= writer_buffer_size)
+        flush ();
+}
+
+bool
+GncXmlWriter::flush ()
+{
+    if (!m_buf.empty ())
+    {
+        if (!m_error &&
+            fwrite (m_buf.data (), 1, m_buf.size (), m_out) != m_buf.size ())
+            m_error = true;
+        m_buf.clear ();
+    }
+    return ok ();
+}
+
+void
+guid_to_xml (GncXmlWriter& writer, const char* tag, const GncGUID* gid)
+{
+    char guid_str[GUID_ENCODING_LENGTH + 1];
+
+    if (!guid_to_string_buff (gid, guid_str))
+    {
+        PERR ("guid_to_string_buff failed\n");
+        return;
+    }
+    writer.text_element (tag, guid_str, "guid");
+}
+
+void
+commodity_ref_to_xml (GncXmlWriter& writer, const char* tag,
+                      const gnc_commodity* c)
+{
+    g_return_if_fail (c);
+
+    auto name_space = gnc_commodity_get_namespace (c);
+    auto mnemonic = gnc_commodity_get_mnemonic (c);
+    if (!name_space || !mnemonic)
+        return;
+    writer.start_element (tag);
+    writer.text_element ("cmdty:space", name_space);
+    writer.text_element ("cmdty:id", mnemonic);
+    writer.end_element ();
+}
+
+void
+time64_to_xml (GncXmlWriter& writer, const char* tag, time64 time,
+               const char* type)
+{
+    g_return_if_fail (time != INT64_MAX);
+    auto date_str = GncDateTime(time).format_iso8601();
+    if (date_str.empty())
+        return;
+    date_str += " +0000"; //Tack on a UTC offset to mollify GnuCash for Android
+    writer.start_element (tag);
+    if (type)
+        writer.attribute ("type", type);
+    writer.text_element ("ts:date", date_str.c_str ());
+    writer.end_element ();
+}
+
+void
+gdate_to_xml (GncXmlWriter& writer, const char* tag, const GDate* date,
+              const char* type)
+{
+    char date_str[512];
+
+    g_return_if_fail (date);
+    g_date_strftime (date_str, sizeof (date_str), "%Y-%m-%d", date);
+    writer.start_element (tag);
+    if (type)
+        writer.attribute ("type", type);
+    writer.text_element ("gdate", date_str);
+    writer.end_element ();
+}
+
+void
+gnc_numeric_to_xml (GncXmlWriter& writer, const char* tag,
+                    const gnc_numeric* num)
+{
+    g_return_if_fail (num);
+
+    auto numstr = gnc_numeric_to_string (*num);
+    g_return_if_fail (numstr);
+    writer.text_element (tag, *numstr ? numstr : nullptr);
+    g_free (numstr);
+}
+
+static void write_kvp_slot (GncXmlWriter& writer, const char* key,
+                            KvpValue* value);
+
+/* Writes what add_kvp_value_node adds to the tree. */
+static void
+write_kvp_value (GncXmlWriter& writer, const char* tag, KvpValue* val)
+{
+    switch (val->get_type ())
+    {
+    case KvpValue::Type::STRING:
+        writer.text_element (tag, val->get<const char*> (), "string");
+        break;
+    case KvpValue::Type::INT64:
+    {
+        auto str = g_strdup_printf ("%" G_GINT64_FORMAT, val->get<int64_t> ());
+        writer.text_element (tag, str, "integer");
+        g_free (str);
+        break;
+    }
+    case KvpValue::Type::DOUBLE:
+    {
+        auto str = double_to_string (val->get<double> ());
+        writer.text_element (tag, str, "double");
+        g_free (str);
+        break;
+    }
+    case KvpValue::Type::NUMERIC:
+    {
+        auto str = gnc_numeric_to_string (val->get<gnc_numeric> ());
+        writer.text_element (tag, str, "numeric");
+        g_free (str);
+        break;
+    }
+    case KvpValue::Type::GUID:
+    {
+        gchar guidstr[GUID_ENCODING_LENGTH + 1];
+        guid_to_string_buff (val->get<GncGUID*> (), guidstr);
+        writer.text_element (tag, guidstr, "guid");
+        break;
+    }
+    /* Note: The type attribute must remain 'timespec' to maintain
+     * compatibility.
+     */
+    case KvpValue::Type::TIME64:
+        time64_to_xml (writer, tag, val->get<Time64> ().t, "timespec");
+        break;
+    case KvpValue::Type::GDATE:
+    {
+        auto d = val->get<GDate> ();
+        gdate_to_xml (writer, tag, &d, "gdate");
+        break;
+    }
+    case KvpValue::Type::GLIST:
+        writer.start_element (tag);
+        writer.attribute ("type", "list");
+        for (auto cursor = val->get<GList*> (); cursor; cursor = cursor->next)
+            write_kvp_value (writer, "slot:value",
+                             static_cast<KvpValue*> (cursor->data));
+        writer.end_element ();
+        break;
+    case KvpValue::Type::FRAME:
+    {
+        writer.start_element (tag);
+        writer.attribute ("type", "frame");
+        auto frame = val->get<KvpFrame*> ();
+        if (frame)
+            frame->for_each_slot_temp ([&writer](const char* key, KvpValue* value)
+                                       { write_kvp_slot (writer, key, value); });
+        writer.end_element ();
+        break;
+    }
+    default:
+        writer.text_element (tag, nullptr);
+        break;
+    }
+}
+
+static void
+write_kvp_slot (GncXmlWriter& writer, const char* key, KvpValue* value)
+{
+    writer.start_element ("slot");
+    writer.text_element ("slot:key", key);
+    write_kvp_value (writer, "slot:value", value);
+    writer.end_element ();
+}
+
+void
+qof_instance_slots_to_xml (GncXmlWriter& writer, const char* tag,
+                           const QofInstance* inst)
+{
+    KvpFrame* frame = qof_instance_get_slots (inst);
+    if (!frame || frame->empty())
+        return;
+
+    writer.start_element (tag);
+    frame->for_each_slot_temp ([&writer](const char* key, KvpValue* value)
+                               { write_kvp_slot (writer, key, value); });
+    writer.end_element ();
+}
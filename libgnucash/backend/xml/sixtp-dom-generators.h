@@ -26,6 +26,11 @@
 
 #include <glib.h>
 
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
 #include "gnc-commodity.h"
 #include "qof.h"
 #include "Recurrence.h"
@@ -47,4 +52,57 @@ xmlNodePtr recurrence_to_dom_tree (const gchar* tag, const Recurrence* r);
 
 gchar* double_to_string (double value);
 
+/** Writes XML straight to a FILE, producing the same bytes as building
+ *  the nodes with the generators above and dumping them with
+ *  xmlElemDump(), but without allocating any nodes. Output is buffered,
+ *  so flush() before writing to the FILE in any other way. */
+class GncXmlWriter
+{
+public:
+    explicit GncXmlWriter (FILE* out) : m_out{out} {}
+    ~GncXmlWriter () { flush (); }
+    GncXmlWriter (const GncXmlWriter&) = delete;
+    GncXmlWriter& operator= (const GncXmlWriter&) = delete;
+
+    /** Open an element whose content is other elements. The tag must
+     *  stay valid until end_element(). */
+    void start_element (const char* tag);
+    /** Add an attribute to the element just opened. */
+    void attribute (const char* name, const char* value);
+    void end_element ();
+    /** Write an element holding only text, as xmlNewTextChild() makes
+     *  it: a NULL text gives an empty element. The text is cleaned up
+     *  like checked_char_cast() does. */
+    void text_element (const char* tag, const char* text,
+                       const char* type = nullptr);
+    /** Write bytes as they are, between top-level elements. */
+    void write (const char* str);
+    /** @return false if writing to the FILE failed. */
+    bool flush ();
+    bool ok () const { return !m_error && !ferror (m_out); }
+
+private:
+    void open_tag (const char* tag);
+    void close_child ();
+    void append_escaped (const char* text, bool attribute);
+
+    FILE* m_out;
+    std::string m_buf;
+    /* The open elements, and whether each has any children yet. */
+    std::vector<std::pair<const char*, bool>> m_open;
+    bool m_error = false;
+};
+
+void guid_to_xml (GncXmlWriter& writer, const char* tag, const GncGUID* gid);
+void commodity_ref_to_xml (GncXmlWriter& writer, const char* tag,
+                           const gnc_commodity* c);
+void time64_to_xml (GncXmlWriter& writer, const char* tag, time64 time,
+                    const char* type = nullptr);
+void gdate_to_xml (GncXmlWriter& writer, const char* tag, const GDate* date,
+                   const char* type = nullptr);
+void gnc_numeric_to_xml (GncXmlWriter& writer, const char* tag,
+                         const gnc_numeric* num);
+void qof_instance_slots_to_xml (GncXmlWriter& writer, const char* tag,
+                                const QofInstance* inst);
+
 #endif /* _SIXTP_DOM_GENERATORS_H_ */
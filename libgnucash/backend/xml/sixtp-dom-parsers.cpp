@@ -403,7 +403,7 @@ dom_tree_to_kvp_value (xmlNodePtr node)
     return ret;
 }
 
-static gboolean
+gboolean
 dom_tree_to_kvp_frame_given (xmlNodePtr node, KvpFrame* frame)
 {
     xmlNodePtr mark;
@@ -669,8 +669,8 @@ failure:
 }
 
 
-gnc_commodity*
-dom_tree_to_commodity_ref_no_engine (xmlNodePtr node, QofBook* book)
+gboolean
+dom_tree_to_commodity_names (xmlNodePtr node, gchar** space, gchar** id)
 {
     /* Turn something like this
 
@@ -679,16 +679,17 @@ dom_tree_to_commodity_ref_no_engine (xmlNodePtr node, QofBook* book)
          <cmdty:id>LNUX</cmdty:space>
        </currency>
 
-       into a gnc_commodity*, returning NULL on failure.  Both sub-nodes
-       are required, though for now, order is irrelevant. */
+       into the namespace and mnemonic of a commodity, which the caller
+       must g_free, returning FALSE on failure.  Both sub-nodes are
+       required, though for now, order is irrelevant.  This doesn't
+       touch the engine, so it may be called on any thread. */
 
-    gnc_commodity* c = NULL;
     gchar* space_str = NULL;
     gchar* id_str = NULL;
     xmlNodePtr n;
 
-    if (!node) return NULL;
-    if (!node->xmlChildrenNode) return NULL;
+    if (!node) return FALSE;
+    if (!node->xmlChildrenNode) return FALSE;
 
     for (n = node->xmlChildrenNode; n; n = n->next)
     {
@@ -702,12 +703,12 @@ dom_tree_to_commodity_ref_no_engine (xmlNodePtr node, QofBook* book)
             {
                 if (space_str)
                 {
-                    return NULL;
+                    goto failure;
                 }
                 else
                 {
                     gchar* content = dom_tree_to_text (n);
-                    if (!content) return NULL;
+                    if (!content) goto failure;
                     space_str = content;
                 }
             }
@@ -715,32 +716,46 @@ dom_tree_to_commodity_ref_no_engine (xmlNodePtr node, QofBook* book)
             {
                 if (id_str)
                 {
-                    return NULL;
+                    goto failure;
                 }
                 else
                 {
                     gchar* content = dom_tree_to_text (n);
-                    if (!content) return NULL;
+                    if (!content) goto failure;
                     id_str = content;
                 }
             }
             break;
         default:
             PERR ("unexpected sub-node.");
-            return NULL;
+            goto failure;
             break;
         }
     }
     if (! (space_str && id_str))
-    {
-        c = NULL;
-    }
-    else
-    {
-        g_strstrip (space_str);
-        g_strstrip (id_str);
-        c = gnc_commodity_new (book, NULL, space_str, id_str, NULL, 0);
-    }
+        goto failure;
+
+    *space = g_strstrip (space_str);
+    *id = g_strstrip (id_str);
+    return TRUE;
+
+failure:
+    g_free (space_str);
+    g_free (id_str);
+    return FALSE;
+}
+
+gnc_commodity*
+dom_tree_to_commodity_ref_no_engine (xmlNodePtr node, QofBook* book)
+{
+    gnc_commodity* c = NULL;
+    gchar* space_str = NULL;
+    gchar* id_str = NULL;
+
+    if (!dom_tree_to_commodity_names (node, &space_str, &id_str))
+        return NULL;
+
+    c = gnc_commodity_new (book, NULL, space_str, id_str, NULL, 0);
 
     g_free (space_str);
     g_free (id_str);
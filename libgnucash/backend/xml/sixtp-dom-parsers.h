@@ -35,6 +35,8 @@ GncGUID* dom_tree_to_guid (xmlNodePtr node);
 
 gnc_commodity* dom_tree_to_commodity_ref (xmlNodePtr node, QofBook* book);
 gnc_commodity* dom_tree_to_commodity_ref_no_engine (xmlNodePtr node, QofBook*);
+gboolean dom_tree_to_commodity_names (xmlNodePtr node, gchar** space,
+                                      gchar** id);
 
 GList* dom_tree_freqSpec_to_recurrences (xmlNodePtr node, QofBook* book);
 Recurrence* dom_tree_to_recurrence (xmlNodePtr node);
@@ -46,6 +48,7 @@ gnc_numeric* dom_tree_to_gnc_numeric (xmlNodePtr node);
 gchar* dom_tree_to_text (xmlNodePtr tree);
 gboolean string_to_binary (const gchar* str,  void** v, guint64* data_len);
 gboolean dom_tree_create_instance_slots (xmlNodePtr node, QofInstance* inst);
+gboolean dom_tree_to_kvp_frame_given (xmlNodePtr node, KvpFrame* frame);
 
 gboolean dom_tree_to_integer (xmlNodePtr node, gint64* daint);
 gboolean dom_tree_to_guint16 (xmlNodePtr node, guint16* i);
@@ -0,0 +1,246 @@
+/********************************************************************
+ * bench-xml-load.cpp: Time reading transactions from an XML file   *
+ * on the parsing thread alone and through GncXmlLoadPipeline.      *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/* Usage: bench-xml-load [number-of-transactions [number-of-threads]]
+ *
+ * Writes a file of two-split transactions (200k by default) carrying
+ * memos, notes and online ids, then reads it into a fresh book twice:
+ * building each transaction as soon as its element ends, as the file
+ * backend used to, and through a GncXmlLoadPipeline decoding on the
+ * given number of threads (0, the default, for one per spare core).
+ * Both books must end up with every transaction and the same balances.
+ */
+
+#include <glib.h>
+
+#include <config.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <gnc-bench.hpp>
+
+#include <gnc-engine.h>
+#include <cashobjects.h>
+#include <TransLog.h>
+#include <AccountP.h>
+#include <Transaction.h>
+#include <gnc-commodity.h>
+
+#include "../gnc-xml.h"
+#include "../sixtp.h"
+#include "../sixtp-parsers.h"
+#include "../sixtp-dom-generators.h"
+#include "../io-gncxml-gen.h"
+#include "../gnc-xml-load-pipeline.hpp"
+
+static constexpr time64 seconds_per_day = 24 * 60 * 60;
+static constexpr time64 start_date = 946728000; /* 2000-01-01 12:00 UTC */
+
+struct bench_book
+{
+    QofBook* book;
+    Account* acc;
+    Account* offset;
+};
+
+/* The accounts of a book to load into get the GUIDs of the source
+ * book's, which is what the transaction parser looks them up by. */
+static bench_book
+new_bench_book (const bench_book* source)
+{
+    bench_book bb;
+    bb.book = qof_book_new ();
+    auto root = gnc_account_create_root (bb.book);
+    bb.acc = xaccMallocAccount (bb.book);
+    bb.offset = xaccMallocAccount (bb.book);
+    if (source)
+    {
+        xaccAccountSetGUID (bb.acc, xaccAccountGetGUID (source->acc));
+        xaccAccountSetGUID (bb.offset, xaccAccountGetGUID (source->offset));
+    }
+    gnc_account_append_child (root, bb.acc);
+    gnc_account_append_child (root, bb.offset);
+    return bb;
+}
+
+static void
+populate_book (const bench_book& bb, int ntrans)
+{
+    auto table = gnc_commodity_table_get_table (bb.book);
+    auto currency = gnc_commodity_table_lookup (table, "ISO4217", "USD");
+
+    xaccAccountBeginEdit (bb.acc);
+    xaccAccountBeginEdit (bb.offset);
+    for (int i = 0; i < ntrans; ++i)
+    {
+        auto amount = gnc_numeric_create ((i % 1000) - 400, 100);
+        auto id = "FITID" + std::to_string (i);
+        auto trans = xaccMallocTransaction (bb.book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, currency);
+        xaccTransSetDatePostedSecsNormalized (trans, start_date + (i % 7300) * seconds_per_day);
+        xaccTransSetDescription (trans, "Payee & Sons <imported>");
+        xaccTransSetNotes (trans, "imported");
+        qof_instance_set (QOF_INSTANCE (trans), "online-id", id.c_str (), NULL);
+
+        auto split = xaccMallocSplit (bb.book);
+        xaccSplitSetParent (split, trans);
+        xaccSplitSetAccount (split, bb.acc);
+        xaccSplitSetMemo (split, "groceries");
+        xaccSplitSetAmount (split, amount);
+        xaccSplitSetValue (split, amount);
+        qof_instance_set (QOF_INSTANCE (split), "online-id", id.c_str (), NULL);
+
+        auto other = xaccMallocSplit (bb.book);
+        xaccSplitSetParent (other, trans);
+        xaccSplitSetAccount (other, bb.offset);
+        xaccSplitSetAmount (other, gnc_numeric_neg (amount));
+        xaccSplitSetValue (other, gnc_numeric_neg (amount));
+        xaccTransCommitEdit (trans);
+    }
+    xaccAccountCommitEdit (bb.offset);
+    xaccAccountCommitEdit (bb.acc);
+}
+
+static int
+write_trans (Transaction* trans, gpointer data)
+{
+    auto writer = static_cast<GncXmlWriter*> (data);
+    gnc_transaction_write_xml (*writer, trans);
+    writer->write ("\n");
+    return writer->ok () ? 0 : -1;
+}
+
+static gboolean
+count_transaction (const char* tag, gpointer parsedata, gpointer data)
+{
+    ++*static_cast<int*> (parsedata);
+    return TRUE;
+}
+
+/* Reads the file into a new book, returning the number of transactions
+ * read or -1 if parsing failed. */
+static int
+load_book (FILE* file, const bench_book& bb, GncXmlLoadPipeline* pipeline)
+{
+    auto top_parser = sixtp_new ();
+    auto main_parser = sixtp_new ();
+    int count = 0;
+
+    if (!sixtp_add_some_sub_parsers (top_parser, TRUE, "gnc-v2", main_parser,
+                                     NULL, NULL) ||
+        !sixtp_add_some_sub_parsers (main_parser, TRUE, "gnc:transaction",
+                                     gnc_transaction_sixtp_parser_create (),
+                                     NULL, NULL))
+        return -1;
+
+    rewind (file);
+    auto ok = gnc_xml_parse_fd (top_parser, file, count_transaction, &count,
+                                bb.book, pipeline);
+    sixtp_destroy (top_parser);
+    return ok ? count : -1;
+}
+
+static bool
+balances_match (const bench_book& expected, const bench_book& loaded)
+{
+    xaccAccountRecomputeBalance (loaded.acc);
+    xaccAccountRecomputeBalance (loaded.offset);
+    return gnc_numeric_equal (xaccAccountGetBalance (expected.acc),
+                              xaccAccountGetBalance (loaded.acc)) &&
+           gnc_numeric_equal (xaccAccountGetBalance (expected.offset),
+                              xaccAccountGetBalance (loaded.offset));
+}
+
+int
+main (int argc, char** argv)
+{
+    int ntrans = bench_arg (argc, argv, 1, 200000);
+    unsigned nthreads = bench_arg (argc, argv, 2, 0);
+    int failures = 0;
+
+    qof_init ();
+    if (!cashobjects_register ())
+        return EXIT_FAILURE;
+    xaccLogDisable ();
+
+    auto source = new_bench_book (nullptr);
+    auto start = Clock::now ();
+    populate_book (source, ntrans);
+    std::cout << "Created " << ntrans << " transactions in "
+              << elapsed_ms (start) << " ms\n";
+
+    auto file = tmpfile ();
+    if (!file)
+        return EXIT_FAILURE;
+    {
+        GncXmlWriter writer (file);
+        writer.write ("<gnc-v2>\n");
+        if (xaccAccountTreeForEachTransaction (gnc_book_get_root_account (source.book),
+                                               write_trans, &writer))
+            ++failures;
+        writer.write ("</gnc-v2>\n");
+        if (!writer.flush ())
+            ++failures;
+    }
+    fflush (file);
+
+    auto serial = new_bench_book (&source);
+    start = Clock::now ();
+    auto serial_count = load_book (file, serial, nullptr);
+    auto serial_ms = elapsed_ms (start);
+    if (serial_count != ntrans || !balances_match (source, serial))
+        ++failures;
+
+    auto pipelined = new_bench_book (&source);
+    unsigned used_threads;
+    start = Clock::now ();
+    int pipelined_count;
+    {
+        GncXmlLoadPipeline pipeline (nthreads);
+        used_threads = pipeline.threads ();
+        pipelined_count = load_book (file, pipelined, &pipeline);
+    }
+    auto pipelined_ms = elapsed_ms (start);
+    if (pipelined_count != ntrans || !balances_match (source, pipelined))
+        ++failures;
+
+    auto per_100k = 100000.0 / ntrans;
+    std::cout << "Loaded " << ntrans << " transactions, parsing thread only: "
+              << serial_ms << " ms (" << serial_ms * per_100k
+              << " ms per 100k), pipeline with " << used_threads
+              << " decoding threads: " << pipelined_ms << " ms ("
+              << pipelined_ms * per_100k << " ms per 100k)\n";
+    if (failures)
+        std::cout << "The loaded books differ from the one written\n";
+
+    fclose (file);
+    qof_book_destroy (pipelined.book);
+    qof_book_destroy (serial.book);
+    qof_book_destroy (source.book);
+    qof_close ();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,186 @@
+/********************************************************************
+ * bench-xml-save.cpp: Time writing transactions to an XML file     *
+ * through DOM trees and through GncXmlWriter.                      *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/* Usage: bench-xml-save [number-of-transactions]
+ *
+ * Builds a book of two-split transactions (200k by default) carrying
+ * memos, notes and online ids, then writes them all the way the file
+ * backend used to, building and dumping a DOM tree per transaction,
+ * and with GncXmlWriter. Both files must be identical.
+ */
+
+#include <glib.h>
+
+#include <config.h>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <gnc-bench.hpp>
+
+#include <gnc-engine.h>
+#include <cashobjects.h>
+#include <TransLog.h>
+#include <Account.h>
+#include <Transaction.h>
+#include <gnc-commodity.h>
+
+#include "../gnc-xml.h"
+#include "../sixtp-dom-generators.h"
+
+static constexpr time64 seconds_per_day = 24 * 60 * 60;
+static constexpr time64 start_date = 946728000; /* 2000-01-01 12:00 UTC */
+
+static void
+populate_book (QofBook* book, Account* acc, Account* offset, int ntrans)
+{
+    auto table = gnc_commodity_table_get_table (book);
+    auto currency = gnc_commodity_table_lookup (table, "ISO4217", "USD");
+
+    xaccAccountBeginEdit (acc);
+    xaccAccountBeginEdit (offset);
+    for (int i = 0; i < ntrans; ++i)
+    {
+        auto amount = gnc_numeric_create ((i % 1000) - 400, 100);
+        auto id = "FITID" + std::to_string (i);
+        auto trans = xaccMallocTransaction (book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, currency);
+        xaccTransSetDatePostedSecsNormalized (trans, start_date + (i % 7300) * seconds_per_day);
+        xaccTransSetDescription (trans, "Payee & Sons <imported>");
+        xaccTransSetNotes (trans, "imported");
+        qof_instance_set (QOF_INSTANCE (trans), "online-id", id.c_str (), NULL);
+
+        auto split = xaccMallocSplit (book);
+        xaccSplitSetParent (split, trans);
+        xaccSplitSetAccount (split, acc);
+        xaccSplitSetMemo (split, "groceries");
+        xaccSplitSetAmount (split, amount);
+        xaccSplitSetValue (split, amount);
+        qof_instance_set (QOF_INSTANCE (split), "online-id", id.c_str (), NULL);
+
+        auto other = xaccMallocSplit (book);
+        xaccSplitSetParent (other, trans);
+        xaccSplitSetAccount (other, offset);
+        xaccSplitSetAmount (other, gnc_numeric_neg (amount));
+        xaccSplitSetValue (other, gnc_numeric_neg (amount));
+        xaccTransCommitEdit (trans);
+    }
+    xaccAccountCommitEdit (offset);
+    xaccAccountCommitEdit (acc);
+}
+
+static int
+dom_write_trans (Transaction* trans, gpointer data)
+{
+    auto out = static_cast<FILE*> (data);
+    auto node = gnc_transaction_dom_tree_create (trans);
+    xmlElemDump (out, NULL, node);
+    xmlFreeNode (node);
+    return fprintf (out, "\n") < 0 ? -1 : 0;
+}
+
+static int
+stream_write_trans (Transaction* trans, gpointer data)
+{
+    auto writer = static_cast<GncXmlWriter*> (data);
+    gnc_transaction_write_xml (*writer, trans);
+    writer->write ("\n");
+    return writer->ok () ? 0 : -1;
+}
+
+static std::string
+file_contents (FILE* file)
+{
+    std::string contents;
+    char buf[65536];
+    size_t len;
+
+    rewind (file);
+    while ((len = fread (buf, 1, sizeof (buf), file)) > 0)
+        contents.append (buf, len);
+    return contents;
+}
+
+int
+main (int argc, char** argv)
+{
+    int ntrans = bench_arg (argc, argv, 1, 200000);
+    int failures = 0;
+
+    qof_init ();
+    if (!cashobjects_register ())
+        return EXIT_FAILURE;
+    xaccLogDisable ();
+
+    auto book = qof_book_new ();
+    auto root = gnc_account_create_root (book);
+    auto acc = xaccMallocAccount (book);
+    auto offset = xaccMallocAccount (book);
+    gnc_account_append_child (root, acc);
+    gnc_account_append_child (root, offset);
+
+    auto start = Clock::now ();
+    populate_book (book, acc, offset, ntrans);
+    std::cout << "Created " << ntrans << " transactions in "
+              << elapsed_ms (start) << " ms\n";
+
+    auto dom_file = tmpfile ();
+    auto stream_file = tmpfile ();
+    if (!dom_file || !stream_file)
+        return EXIT_FAILURE;
+
+    start = Clock::now ();
+    if (xaccAccountTreeForEachTransaction (root, dom_write_trans, dom_file))
+        ++failures;
+    fflush (dom_file);
+    auto dom_ms = elapsed_ms (start);
+
+    start = Clock::now ();
+    {
+        GncXmlWriter writer (stream_file);
+        if (xaccAccountTreeForEachTransaction (root, stream_write_trans, &writer) ||
+            !writer.flush ())
+            ++failures;
+    }
+    fflush (stream_file);
+    auto stream_ms = elapsed_ms (start);
+
+    if (file_contents (dom_file) != file_contents (stream_file))
+        ++failures;
+
+    auto per_100k = 100000.0 / ntrans;
+    std::cout << "Saved " << ntrans << " transactions, DOM trees: " << dom_ms
+              << " ms (" << dom_ms * per_100k << " ms per 100k), GncXmlWriter: "
+              << stream_ms << " ms (" << stream_ms * per_100k << " ms per 100k)\n";
+    if (failures)
+        std::cout << "The two ways wrote different files\n";
+
+    fclose (dom_file);
+    fclose (stream_file);
+    qof_book_destroy (book);
+    qof_close ();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
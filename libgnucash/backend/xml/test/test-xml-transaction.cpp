@@ -49,8 +49,12 @@
 #include "../sixtp-parsers.h"
 #include "../sixtp-dom-parsers.h"
 #include "../io-gncxml-gen.h"
+#include "../gnc-xml-load-pipeline.hpp"
 #include "test-file-stuff.h"
 #include <test-stuff.h>
+
+#include <string>
+
 static QofBook* book;
 
 extern gboolean gnc_transaction_xml_v2_testing;
@@ -368,6 +372,51 @@ test_add_transaction (const char* tag, gpointer globaldata, gpointer data)
     return retval;
 }
 
+static std::string
+file_contents (FILE* file)
+{
+    std::string contents;
+    char buf[4096];
+    size_t len;
+
+    rewind (file);
+    while ((len = fread (buf, 1, sizeof (buf), file)) > 0)
+        contents.append (buf, len);
+    return contents;
+}
+
+/* The streaming writer must produce exactly what dumping the DOM tree
+ * does. */
+static void
+test_write_matches_dom (xmlNodePtr node, Transaction* trn, int i)
+{
+    FILE* dom_file = tmpfile ();
+    FILE* stream_file = tmpfile ();
+
+    xmlElemDump (dom_file, NULL, node);
+    fflush (dom_file);
+    {
+        GncXmlWriter writer (stream_file);
+        gnc_transaction_write_xml (writer, trn);
+        do_test (writer.flush (), "GncXmlWriter flush");
+    }
+
+    auto dom = file_contents (dom_file);
+    auto streamed = file_contents (stream_file);
+    if (dom == streamed)
+    {
+        success_args ("transaction_write_xml", __FILE__, __LINE__, "%d", i);
+    }
+    else
+    {
+        failure_args ("transaction_write_xml", __FILE__, __LINE__,
+                      "streamed output differs from the DOM tree:\n%s\n%s",
+                      dom.c_str (), streamed.c_str ());
+    }
+    fclose (dom_file);
+    fclose (stream_file);
+}
+
 static void
 test_transaction (void)
 {
@@ -439,6 +488,8 @@ test_transaction (void)
             success_args ("transaction_xml", __FILE__, __LINE__, "%d", i);
         }
 
+        test_write_matches_dom (test_node, ran_trn, i);
+
         filename1 = g_strdup_printf ("test_file_XXXXXX");
 
         fd = g_mkstemp (filename1);
@@ -489,6 +540,20 @@ test_transaction (void)
             }
             else
                 really_get_rid_of_transaction (data.new_trn);
+
+            /* Decoding the tree on a worker thread must give the same
+             * transaction. */
+            {
+                GncXmlLoadPipeline pipeline (1);
+                if (!gnc_xml_parse_file (parser, filename1, test_add_transaction,
+                                         (gpointer)&data, book, &pipeline))
+                {
+                    failure_args ("gnc_xml_parse_file with a pipeline returned FALSE",
+                                  __FILE__, __LINE__, "%d", i);
+                }
+                else
+                    really_get_rid_of_transaction (data.new_trn);
+            }
         }
         /* no handling of circular data structures.  We'll do that later */
         /* sixtp_destroy(parser); */
@@ -33,7 +33,7 @@
 #include <stdint.h>
 #include <string.h>
 
-#include "AccountP.h"
+#include "AccountP.hpp"
 #include "Split.h"
 #include "Transaction.h"
 #include "TransactionP.h"
@@ -42,9 +42,12 @@
 #include "gnc-lot.h"
 #include "gnc-pricedb.h"
 #include "qofinstance-p.h"
+#include "qofquery-p.h"
+#include "qofquerycore-p.h"
 #include "gnc-features.h"
 #include "guid.hpp"
 
+#include <algorithm>
 #include <numeric>
 #include <map>
 #include <unordered_set>
@@ -332,6 +335,7 @@ gnc_account_init(Account* acc)
     priv->starting_cleared_balance = gnc_numeric_zero();
     priv->starting_reconciled_balance = gnc_numeric_zero();
     priv->balance_dirty = FALSE;
+    priv->balance_dirty_from = 0;
 
     priv->higher_balance_limit = gnc_numeric_create (1,0);
     priv->higher_balance_cached = false;
@@ -339,8 +343,15 @@ gnc_account_init(Account* acc)
     priv->lower_balance_cached = false;
     priv->include_sub_account_balances = TriState::Unset;
 
-    priv->splits = NULL;
+    new (&priv->splits) SplitsVec ();
+    new (&priv->splits_set) SplitsSet ();
     priv->sort_dirty = FALSE;
+
+    new (&priv->balance_index) SplitBalanceIndex ();
+    priv->balance_index_valid = FALSE;
+
+    new (&priv->open_lots) OpenLotIndex ();
+    new (&priv->imap_bayes) std::unique_ptr<ImapBayesIndex> ();
 }
 
 static void
@@ -352,6 +363,12 @@ gnc_account_dispose (GObject *acctp)
 static void
 gnc_account_finalize(GObject* acctp)
 {
+    AccountPrivate *priv = GET_PRIVATE(acctp);
+    priv->splits.~SplitsVec ();
+    priv->splits_set.~SplitsSet ();
+    priv->balance_index.~SplitBalanceIndex ();
+    priv->open_lots.~OpenLotIndex ();
+    priv->imap_bayes.~unique_ptr ();
     G_OBJECT_CLASS(gnc_account_parent_class)->finalize(acctp);
 }
 
@@ -1370,30 +1387,29 @@ xaccFreeAccount (Account *acc)
         }
         g_list_free (priv->lots);
         priv->lots = NULL;
+        priv->open_lots = OpenLotIndex ();
     }
 
     /* Next, clean up the splits */
     /* NB there shouldn't be any splits by now ... they should
      * have been all been freed by CommitEdit().  We can remove this
      * check once we know the warning isn't occurring any more. */
-    if (priv->splits)
+    if (!priv->splits.empty())
     {
-        GList *slist;
         PERR (" instead of calling xaccFreeAccount(), please call\n"
               " xaccAccountBeginEdit(); xaccAccountDestroy();\n");
 
         qof_instance_reset_editlevel(acc);
 
-        slist = g_list_copy(priv->splits);
-        for (lp = slist; lp; lp = lp->next)
+        /* xaccSplitDestroy removes the split from priv->splits */
+        auto slist = priv->splits;
+        for (auto s : slist)
         {
-            Split *s = (Split *) lp->data;
             g_assert(xaccSplitGetAccount(s) == acc);
             xaccSplitDestroy (s);
         }
-        g_list_free(slist);
-/* Nothing here (or in xaccAccountCommitEdit) NULLs priv->splits, so this asserts every time.
-        g_assert(priv->splits == NULL);
+/* Nothing here (or in xaccAccountCommitEdit) empties priv->splits, so this asserts every time.
+        g_assert(priv->splits.empty());
 */
     }
 
@@ -1491,7 +1507,7 @@ xaccAccountCommitEdit (Account *acc)
     priv = GET_PRIVATE(acc);
     if (qof_instance_get_destroying(acc))
     {
-        GList *lp, *slist;
+        GList *lp;
         QofCollection *col;
 
         qof_instance_increase_editlevel(acc);
@@ -1508,18 +1524,14 @@ xaccAccountCommitEdit (Account *acc)
            themselves will be destroyed by the transaction code */
         if (!qof_book_shutting_down(book))
         {
-            slist = g_list_copy(priv->splits);
-            for (lp = slist; lp; lp = lp->next)
-            {
-                Split *s = static_cast<Split *>(lp->data);
+            auto slist = priv->splits;
+            for (auto s : slist)
                 xaccSplitDestroy (s);
-            }
-            g_list_free(slist);
         }
         else
         {
-            g_list_free(priv->splits);
-            priv->splits = NULL;
+            priv->splits.clear();
+            priv->splits_set.clear();
         }
 
         /* It turns out there's a case where this assertion does not hold:
@@ -1527,7 +1539,7 @@ xaccAccountCommitEdit (Account *acc)
            deleting all the splits in it.  The splits will just get
            recreated and put right back into the same account!
 
-           g_assert(priv->splits == NULL || qof_book_shutting_down(acc->inst.book));
+           g_assert(priv->splits.empty() || qof_book_shutting_down(acc->inst.book));
         */
 
         if (!qof_book_shutting_down(book))
@@ -1544,6 +1556,7 @@ xaccAccountCommitEdit (Account *acc)
         }
         g_list_free(priv->lots);
         priv->lots = NULL;
+        priv->open_lots = OpenLotIndex ();
 
         qof_instance_set_dirty(&acc->inst);
         qof_instance_decrease_editlevel(acc);
@@ -1830,39 +1843,31 @@ xaccAccountEqual(const Account *aa, const Account *ab, gboolean check_guids)
     /* no parent; always compare downwards. */
 
     {
-        GList *la = priv_aa->splits;
-        GList *lb = priv_ab->splits;
+        const auto& la = priv_aa->splits;
+        const auto& lb = priv_ab->splits;
 
-        if ((la && !lb) || (!la && lb))
+        if (la.empty() != lb.empty())
         {
             PWARN ("only one has splits");
             return FALSE;
         }
 
-        if (la && lb)
+        /* presume that the splits are in the same order */
+        auto ia = la.begin(), ib = lb.begin();
+        for (; ia != la.end() && ib != lb.end(); ++ia, ++ib)
         {
-            /* presume that the splits are in the same order */
-            while (la && lb)
-            {
-                Split *sa = (Split *) la->data;
-                Split *sb = (Split *) lb->data;
-
-                if (!xaccSplitEqual(sa, sb, check_guids, TRUE, FALSE))
-                {
-                    PWARN ("splits differ");
-                    return(FALSE);
-                }
-
-                la = la->next;
-                lb = lb->next;
-            }
-
-            if ((la != NULL) || (lb != NULL))
+            if (!xaccSplitEqual(*ia, *ib, check_guids, TRUE, FALSE))
             {
-                PWARN ("number of splits differs");
+                PWARN ("splits differ");
                 return(FALSE);
             }
         }
+
+        if (ia != la.end() || ib != lb.end())
+        {
+            PWARN ("number of splits differs");
+            return(FALSE);
+        }
     }
 
     if (!xaccAcctChildrenEqual(priv_aa->children, priv_ab->children, check_guids))
@@ -1876,6 +1881,24 @@ xaccAccountEqual(const Account *aa, const Account *ab, gboolean check_guids)
 
 /********************************************************************\
 \********************************************************************/
+
+static bool
+split_order_less (const Split *a, const Split *b)
+{
+    return xaccSplitOrder (a, b) < 0;
+}
+
+/* Mark the running balances stale from the split at position pos
+ * onward. Positions only ever shift at or after the point of a change,
+ * so keeping the minimum over all changes since the last recompute is
+ * enough for xaccAccountRecomputeBalance to resume from there. */
+static void
+mark_balance_dirty_from (AccountPrivate *priv, size_t pos)
+{
+    priv->balance_dirty = TRUE;
+    priv->balance_dirty_from = std::min (priv->balance_dirty_from, pos);
+}
+
 void
 gnc_account_set_sort_dirty (Account *acc)
 {
@@ -1901,7 +1924,35 @@ gnc_account_set_balance_dirty (Account *acc)
         return;
 
     priv = GET_PRIVATE(acc);
+    mark_balance_dirty_from (priv, 0);
+}
+
+void
+gnc_account_set_split_dirty (Account *acc, Split *s)
+{
+    AccountPrivate *priv;
+
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+    g_return_if_fail(GNC_IS_SPLIT(s));
+
+    if (qof_instance_get_destroying(acc))
+        return;
+
+    /* The split's sort keys may already have changed, so the binary
+     * search can miss it. A split that isn't in the list yet gets
+     * marked by gnc_account_insert_split. */
+    priv = GET_PRIVATE(acc);
+    auto& splits = priv->splits;
+    auto it = splits.end();
+    if (!priv->sort_dirty)
+        it = std::lower_bound (splits.begin(), splits.end(), s,
+                               split_order_less);
+    priv->sort_dirty = TRUE;
     priv->balance_dirty = TRUE;
+    if (it == splits.end() || *it != s)
+        it = std::find (splits.begin(), splits.end(), s);
+    if (it != splits.end())
+        mark_balance_dirty_from (priv, it - splits.begin());
 }
 
 void gnc_account_set_defer_bal_computation (Account *acc, gboolean defer)
@@ -1929,29 +1980,31 @@ gboolean gnc_account_get_defer_bal_computation (Account *acc)
 
 /********************************************************************\
 \********************************************************************/
-
 gboolean
 gnc_account_insert_split (Account *acc, Split *s)
 {
     AccountPrivate *priv;
-    GList *node;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
     g_return_val_if_fail(GNC_IS_SPLIT(s), FALSE);
 
     priv = GET_PRIVATE(acc);
-    node = g_list_find(priv->splits, s);
-    if (node)
+    if (!priv->splits_set.insert(s).second)
         return FALSE;
 
-    if (qof_instance_get_editlevel(acc) == 0)
+    if (qof_instance_get_editlevel(acc) == 0 && !priv->sort_dirty)
     {
-        priv->splits = g_list_insert_sorted(priv->splits, s,
-                                            (GCompareFunc)xaccSplitOrder);
+        /* Binary search for the slot; only the tail gets moved. */
+        auto pos = std::upper_bound (priv->splits.begin(), priv->splits.end(),
+                                     s, split_order_less);
+        mark_balance_dirty_from (priv, pos - priv->splits.begin());
+        priv->splits.insert (pos, s);
     }
     else
     {
-        priv->splits = g_list_prepend(priv->splits, s);
+        /* Appended splits get merged into place by xaccAccountSortSplits. */
+        mark_balance_dirty_from (priv, priv->splits.size());
+        priv->splits.push_back (s);
         priv->sort_dirty = TRUE;
     }
 
@@ -1960,7 +2013,6 @@ gnc_account_insert_split (Account *acc, Split *s)
     /* Also send an event based on the account */
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_ADDED, s);
 
-    priv->balance_dirty = TRUE;
 //  DRH: Should the below be added? It is present in the delete path.
 //  xaccAccountRecomputeBalance(acc);
     return TRUE;
@@ -1970,23 +2022,32 @@ gboolean
 gnc_account_remove_split (Account *acc, Split *s)
 {
     AccountPrivate *priv;
-    GList *node;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), FALSE);
     g_return_val_if_fail(GNC_IS_SPLIT(s), FALSE);
 
     priv = GET_PRIVATE(acc);
-    node = g_list_find(priv->splits, s);
-    if (NULL == node)
+    if (!priv->splits_set.erase(s))
         return FALSE;
 
-    priv->splits = g_list_delete_link(priv->splits, node);
+    /* The split's sort keys may have changed since it was placed, so
+     * fall back to a linear search if the binary search misses it. */
+    auto& splits = priv->splits;
+    auto it = splits.end();
+    if (!priv->sort_dirty)
+        it = std::lower_bound (splits.begin(), splits.end(), s, split_order_less);
+    if (it == splits.end() || *it != s)
+        it = std::find (splits.begin(), splits.end(), s);
+    if (it != splits.end())
+    {
+        mark_balance_dirty_from (priv, it - splits.begin());
+        splits.erase (it);
+    }
     //FIXME: find better event type
     qof_event_gen(&acc->inst, QOF_EVENT_MODIFY, NULL);
     // And send the account-based event, too
     qof_event_gen(&acc->inst, GNC_EVENT_ITEM_REMOVED, s);
 
-    priv->balance_dirty = TRUE;
     xaccAccountRecomputeBalance(acc);
     return TRUE;
 }
@@ -2001,9 +2062,25 @@ xaccAccountSortSplits (Account *acc, gboolean force)
     priv = GET_PRIVATE(acc);
     if (!priv->sort_dirty || (!force && qof_instance_get_editlevel(acc) > 0))
         return;
-    priv->splits = g_list_sort(priv->splits, (GCompareFunc)xaccSplitOrder);
+
+    /* Usually only a few splits were appended or edited, so sort just
+     * the part following the still-ordered prefix and merge it in
+     * rather than sorting everything. */
+    auto& splits = priv->splits;
+    auto unsorted = std::is_sorted_until (splits.begin(), splits.end(),
+                                          split_order_less);
+    if (unsorted != splits.end())
+    {
+        std::sort (unsorted, splits.end(), split_order_less);
+        /* The merge leaves everything before the slot of the smallest
+         * tail split where it was. */
+        auto first_moved = std::upper_bound (splits.begin(), unsorted,
+                                             *unsorted, split_order_less);
+        mark_balance_dirty_from (priv, first_moved - splits.begin());
+        std::inplace_merge (splits.begin(), unsorted, splits.end(),
+                            split_order_less);
+    }
     priv->sort_dirty = FALSE;
-    priv->balance_dirty = TRUE;
 }
 
 static void
@@ -2112,6 +2189,99 @@ gnc_account_set_policy (Account *acc, GNCPolicy *policy)
 /********************************************************************\
 \********************************************************************/
 
+static void
+open_lots_unfile (OpenLotIndex& index, GNCLot *lot)
+{
+    auto it = index.filed.find (lot);
+    if (it == index.filed.end ())
+        return;
+    auto bucket = index.buckets.find (it->second.first);
+    bucket->second.erase (it->second.second);
+    if (bucket->second.empty ())
+        index.buckets.erase (bucket);
+    index.filed.erase (it);
+}
+
+/* File the lot under its opening split if splits can be assigned to
+ * it: the lot is open, the opening amount isn't zero and the balance
+ * hasn't crossed zero. */
+static void
+open_lots_file (OpenLotIndex& index, GNCLot *lot)
+{
+    if (gnc_lot_is_closed (lot))
+        return;
+    auto split = gnc_lot_get_earliest_split (lot);
+    if (!split || gnc_numeric_zero_p (split->amount))
+        return;
+    auto positive = gnc_numeric_positive_p (split->amount);
+    if (positive != gnc_numeric_positive_p (gnc_lot_get_balance (lot)))
+        return;
+
+    auto trans = split->parent;
+    OpenLotKey key {positive, trans ? trans->common_currency : nullptr};
+    OpenLotEntry entry {trans ? trans->date_posted : 0, index.seq[lot], lot};
+    index.buckets[key].insert (entry);
+    index.filed.emplace (lot, std::make_pair (key, entry));
+}
+
+static void
+open_lots_refresh (OpenLotIndex& index)
+{
+    std::unordered_set<GNCLot*> dirty;
+    dirty.swap (index.dirty);
+    for (auto lot : dirty)
+    {
+        open_lots_unfile (index, lot);
+        open_lots_file (index, lot);
+    }
+}
+
+void
+gnc_account_lot_changed (Account *acc, GNCLot *lot)
+{
+    g_return_if_fail (GNC_IS_ACCOUNT (acc));
+    auto& index = GET_PRIVATE (acc)->open_lots;
+    if (index.seq.count (lot))
+        index.dirty.insert (lot);
+}
+
+GNCLot *
+gnc_account_find_open_lot (Account *acc, gboolean positive_opening,
+                           gnc_commodity *currency, gboolean earliest)
+{
+    g_return_val_if_fail (GNC_IS_ACCOUNT (acc), nullptr);
+    auto& index = GET_PRIVATE (acc)->open_lots;
+    open_lots_refresh (index);
+
+    /* Each bucket is in date order, so only its first entry (or the
+     * first one of its last date) is a candidate. The sentinel dates
+     * can't win, as they never could with the old linear search. */
+    const OpenLotEntry *best = nullptr;
+    OpenLotOrder before;
+    for (auto& [key, lots] : index.buckets)
+    {
+        if (key.first != static_cast<bool>(positive_opening) ||
+            (currency && !gnc_commodity_equiv (currency, key.second)))
+            continue;
+        if (earliest)
+        {
+            auto& entry = *lots.begin ();
+            if (entry.posted != G_MAXINT64 && (!best || before (entry, *best)))
+                best = &entry;
+        }
+        else
+        {
+            auto last = lots.rbegin ()->posted;
+            auto& entry = *lots.lower_bound ({last, UINT64_MAX, nullptr});
+            if (entry.posted != G_MININT64 &&
+                (!best || entry.posted > best->posted ||
+                 (entry.posted == best->posted && entry.seq > best->seq)))
+                best = &entry;
+        }
+    }
+    return best ? best->lot : nullptr;
+}
+
 void
 xaccAccountRemoveLot (Account *acc, GNCLot *lot)
 {
@@ -2125,6 +2295,9 @@ xaccAccountRemoveLot (Account *acc, GNCLot *lot)
 
     ENTER ("(acc=%p, lot=%p)", acc, lot);
     priv->lots = g_list_remove(priv->lots, lot);
+    open_lots_unfile (priv->open_lots, lot);
+    priv->open_lots.seq.erase (lot);
+    priv->open_lots.dirty.erase (lot);
     qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_REMOVE, NULL);
     qof_event_gen (&acc->inst, QOF_EVENT_MODIFY, NULL);
     LEAVE ("(acc=%p, lot=%p)", acc, lot);
@@ -2154,10 +2327,15 @@ xaccAccountInsertLot (Account *acc, GNCLot *lot)
         old_acc = lot_account;
         opriv = GET_PRIVATE(old_acc);
         opriv->lots = g_list_remove(opriv->lots, lot);
+        open_lots_unfile (opriv->open_lots, lot);
+        opriv->open_lots.seq.erase (lot);
+        opriv->open_lots.dirty.erase (lot);
     }
 
     priv = GET_PRIVATE(acc);
     priv->lots = g_list_prepend(priv->lots, lot);
+    priv->open_lots.seq[lot] = priv->open_lots.next_seq++;
+    priv->open_lots.dirty.insert (lot);
     gnc_lot_set_account(lot, acc);
 
     /* Don't move the splits to the new account.  The caller will do this
@@ -2201,7 +2379,7 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
 
     /* optimizations */
     from_priv = GET_PRIVATE(accfrom);
-    if (!from_priv->splits || accfrom == accto)
+    if (from_priv->splits.empty() || accfrom == accto)
         return;
 
     /* check for book mix-up */
@@ -2211,7 +2389,8 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
     xaccAccountBeginEdit(accfrom);
     xaccAccountBeginEdit(accto);
     /* Begin editing both accounts and all transactions in accfrom. */
-    g_list_foreach(from_priv->splits, (GFunc)xaccPreSplitMove, NULL);
+    std::for_each (from_priv->splits.begin(), from_priv->splits.end(),
+                   [](Split *s){ xaccPreSplitMove (s, nullptr); });
 
     /* Concatenate accfrom's lists of splits and lots to accto's lists. */
     //to_priv->splits = g_list_concat(to_priv->splits, from_priv->splits);
@@ -2228,10 +2407,13 @@ xaccAccountMoveAllSplits (Account *accfrom, Account *accto)
      * Convert each split's amount to accto's commodity.
      * Commit to editing each transaction.
      */
-    g_list_foreach(from_priv->splits, (GFunc)xaccPostSplitMove, (gpointer)accto);
+    /* xaccPostSplitMove removes the split from accfrom, so work on a copy */
+    auto splits = from_priv->splits;
+    std::for_each (splits.begin(), splits.end(),
+                   [accto](Split *s){ xaccPostSplitMove (s, accto); });
 
     /* Finally empty accfrom. */
-    g_assert(from_priv->splits == NULL);
+    g_assert(from_priv->splits.empty());
     g_assert(from_priv->lots == NULL);
     xaccAccountCommitEdit(accfrom);
     xaccAccountCommitEdit(accto);
@@ -2276,7 +2458,6 @@ xaccAccountRecomputeBalance (Account * acc)
     gnc_numeric  noclosing_balance;
     gnc_numeric  cleared_balance;
     gnc_numeric  reconciled_balance;
-    GList *lp;
 
     if (NULL == acc) return;
 
@@ -2286,17 +2467,47 @@ xaccAccountRecomputeBalance (Account * acc)
     if (qof_instance_get_destroying(acc)) return;
     if (qof_book_shutting_down(qof_instance_get_book(acc))) return;
 
-    balance            = priv->starting_balance;
-    noclosing_balance  = priv->starting_noclosing_balance;
-    cleared_balance    = priv->starting_cleared_balance;
-    reconciled_balance = priv->starting_reconciled_balance;
+    /* The splits ahead of balance_dirty_from haven't moved or changed
+     * since the last recompute, so resume from the running balances of
+     * the last of them. The retained part of the index is in date order
+     * if the whole index was. */
+    auto& splits = priv->splits;
+    auto& bal_index = priv->balance_index;
+    auto start = std::min (priv->balance_dirty_from, splits.size ());
+    if (start > bal_index.size ())
+        start = 0;
+    auto index_ordered = start == 0 || priv->balance_index_valid;
+
+    if (start == 0)
+    {
+        balance            = priv->starting_balance;
+        noclosing_balance  = priv->starting_noclosing_balance;
+        cleared_balance    = priv->starting_cleared_balance;
+        reconciled_balance = priv->starting_reconciled_balance;
+    }
+    else
+    {
+        auto last = splits[start - 1];
+        balance            = last->balance;
+        noclosing_balance  = last->noclosing_balance;
+        cleared_balance    = last->cleared_balance;
+        reconciled_balance = last->reconciled_balance;
+    }
+
+    PINFO ("acct=%s starting baln=%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT
+           " from split %zu of %zu", priv->accountName, balance.num,
+           balance.denom, start, splits.size ());
 
-    PINFO ("acct=%s starting baln=%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT,
-           priv->accountName, balance.num, balance.denom);
-    for (lp = priv->splits; lp; lp = lp->next)
+    /* The balance index can only be searched by date if the splits
+     * are in date order, which they normally are once sorted. */
+    bal_index.resize (start);
+    bal_index.reserve (splits.size ());
+
+    for (auto it = splits.begin () + start; it != splits.end (); ++it)
     {
-        Split *split = (Split *) lp->data;
+        auto split = *it;
         gnc_numeric amt = xaccSplitGetAmount (split);
+        time64 date = xaccTransGetDate (split->parent);
 
         balance = gnc_numeric_add_fixed(balance, amt);
 
@@ -2320,13 +2531,18 @@ xaccAccountRecomputeBalance (Account * acc)
         split->cleared_balance = cleared_balance;
         split->reconciled_balance = reconciled_balance;
 
+        if (!bal_index.empty () && date < bal_index.back ().date)
+            index_ordered = false;
+        bal_index.push_back ({date, balance, noclosing_balance});
     }
 
+    priv->balance_index_valid = index_ordered;
     priv->balance = balance;
     priv->noclosing_balance = noclosing_balance;
     priv->cleared_balance = cleared_balance;
     priv->reconciled_balance = reconciled_balance;
     priv->balance_dirty = FALSE;
+    priv->balance_dirty_from = splits.size ();
 }
 
 /********************************************************************\
@@ -2443,7 +2659,7 @@ xaccAccountSetType (Account *acc, GNCAccountType tip)
 
     xaccAccountBeginEdit(acc);
     priv->type = tip;
-    priv->balance_dirty = TRUE; /* new type may affect balance computation */
+    mark_balance_dirty_from (priv, 0); /* new type may affect balance computation */
     mark_account(acc);
     xaccAccountCommitEdit(acc);
 }
@@ -2603,7 +2819,6 @@ void
 xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
 {
     AccountPrivate *priv;
-    GList *lp;
 
     /* errors */
     g_return_if_fail(GNC_IS_ACCOUNT(acc));
@@ -2622,9 +2837,8 @@ xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
     priv->non_standard_scu = FALSE;
 
     /* iterate over splits */
-    for (lp = priv->splits; lp; lp = lp->next)
+    for (auto s : priv->splits)
     {
-        Split *s = (Split *) lp->data;
         Transaction *trans = xaccSplitGetParent (s);
 
         xaccTransBeginEdit (trans);
@@ -2633,7 +2847,7 @@ xaccAccountSetCommodity (Account * acc, gnc_commodity * com)
     }
 
     priv->sort_dirty = TRUE;  /* Not needed. */
-    priv->balance_dirty = TRUE;
+    mark_balance_dirty_from (priv, 0);
     mark_account (acc);
 
     xaccAccountCommitEdit(acc);
@@ -3460,7 +3674,7 @@ gnc_account_set_start_balance (Account *acc, const gnc_numeric start_baln)
 
     priv = GET_PRIVATE(acc);
     priv->starting_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    mark_balance_dirty_from (priv, 0);
 }
 
 void
@@ -3473,7 +3687,7 @@ gnc_account_set_start_cleared_balance (Account *acc,
 
     priv = GET_PRIVATE(acc);
     priv->starting_cleared_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    mark_balance_dirty_from (priv, 0);
 }
 
 void
@@ -3486,7 +3700,20 @@ gnc_account_set_start_reconciled_balance (Account *acc,
 
     priv = GET_PRIVATE(acc);
     priv->starting_reconciled_balance = start_baln;
-    priv->balance_dirty = TRUE;
+    mark_balance_dirty_from (priv, 0);
+}
+
+void
+gnc_account_set_start_noclosing_balance (Account *acc,
+        const gnc_numeric start_baln)
+{
+    AccountPrivate *priv;
+
+    g_return_if_fail(GNC_IS_ACCOUNT(acc));
+
+    priv = GET_PRIVATE(acc);
+    priv->starting_noclosing_balance = start_baln;
+    mark_balance_dirty_from (priv, 0);
 }
 
 gnc_numeric
@@ -3514,7 +3741,6 @@ gnc_numeric
 xaccAccountGetProjectedMinimumBalance (const Account *acc)
 {
     AccountPrivate *priv;
-    GList *node;
     time64 today;
     gnc_numeric lowest = gnc_numeric_zero ();
     int seen_a_transaction = 0;
@@ -3523,9 +3749,9 @@ xaccAccountGetProjectedMinimumBalance (const Account *acc)
 
     priv = GET_PRIVATE(acc);
     today = gnc_time64_get_today_end();
-    for (node = g_list_last(priv->splits); node; node = node->prev)
+    for (auto it = priv->splits.rbegin(); it != priv->splits.rend(); ++it)
     {
-        Split *split = static_cast<Split*>(node->data);
+        Split *split = *it;
 
         if (!seen_a_transaction)
         {
@@ -3557,6 +3783,7 @@ GetBalanceAsOfDate (Account *acc, time64 date, gboolean ignclosing)
      * xaccAccountForEachTransaction by using gpointer return
      * values rather than gints.
      */
+    AccountPrivate *priv;
     Split *latest = nullptr;
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
@@ -3564,15 +3791,35 @@ GetBalanceAsOfDate (Account *acc, time64 date, gboolean ignclosing)
     xaccAccountSortSplits (acc, TRUE); /* just in case, normally a noop */
     xaccAccountRecomputeBalance (acc); /* just in case, normally a noop */
 
-    for (GList *lp = GET_PRIVATE(acc)->splits; lp; lp = lp->next)
+    priv = GET_PRIVATE(acc);
+    if (priv->balance_index_valid && !priv->balance_dirty && !priv->sort_dirty)
+    {
+        /* The latest split strictly before date holds the balance. */
+        const auto& bal_index = priv->balance_index;
+        auto it = std::lower_bound (bal_index.begin(), bal_index.end(), date,
+                                    [](const SplitBalanceEntry& entry, time64 t)
+                                    { return entry.date < t; });
+        if (it == bal_index.begin())
+            return ignclosing ? priv->starting_noclosing_balance :
+                priv->starting_balance;
+        --it;
+        return ignclosing ? it->noclosing_balance : it->balance;
+    }
+
+    /* The balances couldn't be brought up to date, e.g. because the
+     * account is being edited; fall back to walking the splits. */
+    for (auto split : priv->splits)
     {
-        if (xaccTransGetDate (xaccSplitGetParent ((Split *)lp->data)) >= date)
+        if (xaccTransGetDate (xaccSplitGetParent (split)) >= date)
             break;
-        latest = (Split *)lp->data;
+        latest = split;
     }
 
+    /* Without an earlier split the balance is where the account starts,
+     * which isn't zero when a backend hasn't loaded all its splits. */
     if (!latest)
-        return gnc_numeric_zero();
+        return ignclosing ? priv->starting_noclosing_balance :
+            priv->starting_balance;
 
     if (ignclosing)
         return xaccSplitGetNoclosingBalance (latest);
@@ -3599,9 +3846,8 @@ xaccAccountGetReconciledBalanceAsOfDate (Account *acc, time64 date)
 
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), gnc_numeric_zero());
 
-    for (GList *node = GET_PRIVATE(acc)->splits; node; node = node->next)
+    for (auto split : GET_PRIVATE(acc)->splits)
     {
-        Split *split = (Split*) node->data;
         if ((xaccSplitGetReconcile (split) == YREC) &&
             (xaccSplitGetDateReconciled (split) <= date))
             balance = gnc_numeric_add_fixed (balance, xaccSplitGetAmount (split));
@@ -3956,15 +4202,6 @@ xaccAccountGetNoclosingBalanceChangeForPeriod (Account *acc, time64 t1,
 /********************************************************************\
 \********************************************************************/
 
-/* THIS API NEEDS TO CHANGE.
- *
- * This code exposes the internal structure of the account object to
- * external callers by returning the actual list used by the object.
- * It should instead return a copy of the split list that the caller
- * is required to free.  That change would provide the freedom of
- * allowing the internal organization to change data structures if
- * necessary for whatever reason, while leaving the external API
- * unchanged. */
 /* XXX: violates the const'ness by forcing a sort before returning
  * the splitlist */
 SplitList *
@@ -3972,15 +4209,33 @@ xaccAccountGetSplitList (const Account *acc)
 {
     g_return_val_if_fail(GNC_IS_ACCOUNT(acc), NULL);
     xaccAccountSortSplits((Account*)acc, FALSE);  // normally a noop
+    auto& splits{GET_PRIVATE(acc)->splits};
+    return std::accumulate (splits.rbegin(), splits.rend(), static_cast<GList*>(nullptr),
+                            g_list_prepend);
+}
+
+const SplitsVec&
+xaccAccountGetSplits (const Account *acc)
+{
+    static const SplitsVec empty;
+    g_return_val_if_fail(GNC_IS_ACCOUNT(acc), empty);
+    xaccAccountSortSplits((Account*)acc, FALSE);  // normally a noop
     return GET_PRIVATE(acc)->splits;
 }
 
+size_t
+xaccAccountGetSplitsSize (const Account *account)
+{
+    g_return_val_if_fail(GNC_IS_ACCOUNT(account), 0);
+    return GET_PRIVATE(account)->splits.size();
+}
+
 
 gboolean gnc_account_and_descendants_empty (Account *acc)
 {
     g_return_val_if_fail (GNC_IS_ACCOUNT (acc), FALSE);
     auto priv = GET_PRIVATE (acc);
-    if (priv->splits != nullptr) return FALSE;
+    if (!priv->splits.empty()) return FALSE;
     for (auto *n = priv->children; n; n = n->next)
     {
         if (!gnc_account_and_descendants_empty (static_cast<Account*>(n->data)))
@@ -5358,7 +5613,6 @@ finder_help_function(const Account *acc, const char *description,
                      Split **split, Transaction **trans )
 {
     AccountPrivate *priv;
-    GList *slp;
 
     /* First, make sure we set the data to NULL BEFORE we start */
     if (split) *split = NULL;
@@ -5371,9 +5625,9 @@ finder_help_function(const Account *acc, const char *description,
      * list is in date order, and the most recent matches should be
      * returned!?  */
     priv = GET_PRIVATE(acc);
-    for (slp = g_list_last(priv->splits); slp; slp = slp->prev)
+    for (auto it = priv->splits.rbegin(); it != priv->splits.rend(); ++it)
     {
-        Split *lsplit = static_cast<Split*>(slp->data);
+        Split *lsplit = *it;
         Transaction *ltrans = xaccSplitGetParent(lsplit);
 
         if (g_strcmp0 (description, xaccTransGetDescription (ltrans)) == 0)
@@ -5490,8 +5744,8 @@ gnc_account_merge_children (Account *parent)
             gnc_account_merge_children (acc_a);
 
             /* consolidate transactions */
-            while (priv_b->splits)
-                xaccSplitSetAccount (static_cast <Split*> (priv_b->splits->data), acc_a);
+            while (!priv_b->splits.empty())
+                xaccSplitSetAccount (priv_b->splits.front(), acc_a);
 
             /* move back one before removal. next iteration around the loop
              * will get the node after node_b */
@@ -5533,7 +5787,13 @@ xaccAccountBeginStagedTransactionTraversals (const Account *account)
     if (!account)
         return;
     priv = GET_PRIVATE(account);
-    xaccSplitsBeginStagedTransactionTraversals(priv->splits);
+    for (auto s : priv->splits)
+    {
+        Transaction *trans = s->parent;
+
+        if (trans)
+            trans->marker = 0;
+    }
 }
 
 gboolean
@@ -5550,16 +5810,11 @@ xaccTransactionTraverse (Transaction *trans, int stage)
     return FALSE;
 }
 
-static void do_one_split (Split *s, gpointer data)
-{
-    Transaction *trans = s->parent;
-    trans->marker = 0;
-}
-
 static void do_one_account (Account *account, gpointer data)
 {
     AccountPrivate *priv = GET_PRIVATE(account);
-    g_list_foreach(priv->splits, (GFunc)do_one_split, NULL);
+    for (auto s : priv->splits)
+        s->parent->marker = 0;
 }
 
 /* Replacement for xaccGroupBeginStagedTransactionTraversals */
@@ -5580,24 +5835,19 @@ xaccAccountStagedTransactionTraversal (const Account *acc,
                                        void *cb_data)
 {
     AccountPrivate *priv;
-    GList *split_p;
-    GList *next;
     Transaction *trans;
-    Split *s;
     int retval;
 
     if (!acc) return 0;
 
     priv = GET_PRIVATE(acc);
-    for (split_p = priv->splits; split_p; split_p = next)
+    /* Iterate over a copy of the split vector, just in case some
+     * naughty thunk adds or removes splits in this account. This
+     * reduces, but does not eliminate, the possibility of undefined
+     * results if a thunk destroys splits from this account. */
+    auto splits = priv->splits;
+    for (auto s : splits)
     {
-        /* Get the next element in the split list now, just in case some
-         * naughty thunk destroys the one we're using. This reduces, but
-         * does not eliminate, the possibility of undefined results if
-         * a thunk removes splits from this account. */
-        next = g_list_next(split_p);
-
-        s = static_cast <Split*> (split_p->data);
         trans = s->parent;
         if (trans && (trans->marker < stage))
         {
@@ -5620,9 +5870,8 @@ gnc_account_tree_staged_transaction_traversal (const Account *acc,
         void *cb_data)
 {
     const AccountPrivate *priv;
-    GList *acc_p, *split_p;
+    GList *acc_p;
     Transaction *trans;
-    Split *s;
     int retval;
 
     if (!acc) return 0;
@@ -5637,9 +5886,9 @@ gnc_account_tree_staged_transaction_traversal (const Account *acc,
     }
 
     /* Now this account */
-    for (split_p = priv->splits; split_p; split_p = g_list_next(split_p))
+    auto splits = priv->splits;
+    for (auto s : splits)
     {
-        s = static_cast <Split*> (split_p->data);
         trans = s->parent;
         if (trans && (trans->marker < stage))
         {
@@ -5795,21 +6044,6 @@ struct AccountProbability
     double product_difference; /* product of (1-probabilities) */
 };
 
-struct AccountTokenCount
-{
-    std::string account_guid;
-    int64_t token_count; /** occurrences of a given token for this account_guid */
-};
-
-/** total_count and the token_count for a given account let us calculate the
- * probability of a given account with any single token
- */
-struct TokenAccountsInfo
-{
-    std::vector<AccountTokenCount> accounts;
-    int64_t total_count;
-};
-
 /** holds an account guid and its corresponding integer probability
   the integer probability is some factor of 10
  */
@@ -5819,17 +6053,6 @@ struct AccountInfo
     int32_t probability;
 };
 
-static void
-build_token_info(char const * suffix, KvpValue * value, TokenAccountsInfo & tokenInfo)
-{
-    if (strlen(suffix) == GUID_ENCODING_LENGTH)
-    {
-        tokenInfo.total_count += value->get<int64_t>();
-        /*By convention, the key ends with the account GUID.*/
-        tokenInfo.accounts.emplace_back(AccountTokenCount{std::string{suffix}, value->get<int64_t>()});
-    }
-}
-
 /** We scale the probability values by probability_factor.
   ie. with probability_factor of 100000, 10% would be
   0.10 * 100000 = 10000 */
@@ -5863,38 +6086,148 @@ highest_probability(FinalProbabilityVec const & probabilities)
     return ret;
 }
 
+/* The slot keys are "import-map-bayes/<token>/<guid>". Splits what
+ * follows "import-map-bayes/" into token and GUID string, returning false
+ * if it isn't of that form. */
+static bool
+split_imap_bayes_suffix (std::string_view suffix, std::string_view& token,
+                         std::string_view& guid)
+{
+    if (suffix.size () < 1 + GUID_ENCODING_LENGTH)
+        return false;
+    auto guid_start = suffix.size () - GUID_ENCODING_LENGTH;
+    if (suffix[guid_start - 1] != '/')
+        return false;
+    token = suffix.substr (0, guid_start - 1);
+    guid = suffix.substr (guid_start);
+    return true;
+}
+
+static uint32_t
+imap_bayes_token_id (ImapBayesIndex& index, std::string_view token)
+{
+    auto iter = index.token_ids.find (token);
+    if (iter != index.token_ids.end ())
+        return iter->second;
+    auto id = static_cast<uint32_t> (index.tokens.size ());
+    index.token_names.emplace_back (token);
+    index.token_ids.emplace (index.token_names.back (), id);
+    index.tokens.emplace_back ();
+    return id;
+}
+
+static uint32_t
+imap_bayes_account_id (ImapBayesIndex& index, std::string_view guid)
+{
+    std::string guid_str {guid};
+    auto iter = index.account_ids.find (guid_str);
+    if (iter != index.account_ids.end ())
+        return iter->second;
+    auto id = static_cast<uint32_t> (index.account_guids.size ());
+    index.account_guids.push_back (guid_str);
+    index.account_ids.emplace (std::move (guid_str), id);
+    return id;
+}
+
+/* Sets the count of an account for a token, keeping the token's accounts
+ * in the order of their GUID strings as the slots are. */
+static void
+imap_bayes_set_count (ImapBayesIndex& index, std::string_view token,
+                      std::string_view guid, int64_t count)
+{
+    auto& entry = index.tokens[imap_bayes_token_id (index, token)];
+    auto account = imap_bayes_account_id (index, guid);
+    auto spot = std::lower_bound (entry.counts.begin (), entry.counts.end (), guid,
+        [&index] (std::pair<uint32_t, int64_t> const& a, std::string_view g) {
+            return std::string_view {index.account_guids[a.first]} < g;
+        });
+    if (spot != entry.counts.end () && spot->first == account)
+    {
+        entry.total += count - spot->second;
+        spot->second = count;
+    }
+    else
+    {
+        entry.total += count;
+        entry.counts.insert (spot, {account, count});
+    }
+}
+
+static void
+build_imap_bayes_index (char const * suffix, KvpValue * value, ImapBayesIndex & index)
+{
+    std::string_view token, guid;
+    if (split_imap_bayes_suffix (suffix, token, guid))
+        imap_bayes_set_count (index, token, guid, value->get<int64_t> ());
+}
+
+/* Returns the account's index if it matches its slots, or nullptr. */
+static ImapBayesIndex*
+imap_bayes_current (Account* acc)
+{
+    auto priv = GET_PRIVATE (acc);
+    auto frame = qof_instance_get_slots (QOF_INSTANCE (acc));
+    auto index = priv->imap_bayes.get ();
+    if (index && frame && index->frame == frame &&
+        index->version == frame->version ())
+        return index;
+    return nullptr;
+}
+
+static ImapBayesIndex&
+imap_bayes_index (Account* acc)
+{
+    if (auto index = imap_bayes_current (acc))
+        return *index;
+
+    auto priv = GET_PRIVATE (acc);
+    auto frame = qof_instance_get_slots (QOF_INSTANCE (acc));
+    priv->imap_bayes.reset (new ImapBayesIndex);
+    auto& index = *priv->imap_bayes;
+    index.frame = frame;
+    index.version = frame->version ();
+    frame->for_each_slot_prefix (IMAP_FRAME_BAYES "/", &build_imap_bayes_index, index);
+    return index;
+}
+
 static ProbabilityVec
 get_first_pass_probabilities(Account* acc, GList * tokens)
 {
     ProbabilityVec ret;
+    auto& index = imap_bayes_index (acc);
+    /* Where each account is in ret, so that accounts come in the order in
+     * which tokens first mention them. */
+    std::unordered_map<uint32_t, size_t> positions;
     /* find the probability for each account that contains any of the tokens
      * in the input tokens list. */
     for (auto current_token = tokens; current_token; current_token = current_token->next)
     {
-        TokenAccountsInfo tokenInfo{};
-        auto path = std::string{IMAP_FRAME_BAYES "/"} + static_cast <char const *> (current_token->data) + "/";
-        qof_instance_foreach_slot_prefix (QOF_INSTANCE (acc), path, &build_token_info, tokenInfo);
-        for (auto const & current_account_token : tokenInfo.accounts)
+        if (!current_token->data)
+            continue;
+        auto token = index.token_ids.find (static_cast <char const *> (current_token->data));
+        if (token == index.token_ids.end ())
+            continue;
+        auto const & tokenInfo = index.tokens[token->second];
+        for (auto const & current_account_token : tokenInfo.counts)
         {
-            auto item = std::find_if(ret.begin(), ret.end(), [&current_account_token]
-                (std::pair<std::string, AccountProbability> const & a) {
-                    return current_account_token.account_guid == a.first;
-                });
-            if (item != ret.end())
+            auto position = positions.find (current_account_token.first);
+            if (position != positions.end ())
             {/* This account is already in the map */
-                item->second.product = ((double)current_account_token.token_count /
-                                      (double)tokenInfo.total_count) * item->second.product;
-                item->second.product_difference = ((double)1 - ((double)current_account_token.token_count /
-                                              (double)tokenInfo.total_count)) * item->second.product_difference;
+                auto item = &ret[position->second];
+                item->second.product = ((double)current_account_token.second /
+                                      (double)tokenInfo.total) * item->second.product;
+                item->second.product_difference = ((double)1 - ((double)current_account_token.second /
+                                              (double)tokenInfo.total)) * item->second.product_difference;
             }
             else
             {
                 /* add a new entry */
                 AccountProbability new_probability;
-                new_probability.product = ((double)current_account_token.token_count /
-                                      (double)tokenInfo.total_count);
+                new_probability.product = ((double)current_account_token.second /
+                                      (double)tokenInfo.total);
                 new_probability.product_difference = 1 - (new_probability.product);
-                ret.push_back({current_account_token.account_guid, std::move(new_probability)});
+                positions.emplace (current_account_token.first, ret.size ());
+                ret.push_back({index.account_guids[current_account_token.first], std::move(new_probability)});
             }
         } /* for all accounts in tokenInfo */
     }
@@ -6093,7 +6426,7 @@ gnc_account_imap_find_account_bayes (Account *acc, GList *tokens)
     return account;
 }
 
-static void
+static int64_t
 change_imap_entry (Account *acc, std::string const & path, int64_t token_count)
 {
     GValue value = G_VALUE_INIT;
@@ -6126,6 +6459,7 @@ change_imap_entry (Account *acc, std::string const & path, int64_t token_count)
     qof_instance_set_path_kvp (QOF_INSTANCE (acc), &value, {path});
     gnc_features_set_used (gnc_account_get_book(acc), GNC_FEATURE_GUID_FLAT_BAYESIAN);
     g_value_unset (&value);
+    return token_count;
 }
 
 /** Updates the imap for a given account using a list of tokens */
@@ -6154,6 +6488,8 @@ gnc_account_imap_add_account_bayes (Account *acc,
     PINFO("account name: '%s'", account_fullname);
 
     guid_string = guid_to_string (xaccAccountGetGUID (added_acc));
+    /* Keep the index in step rather than have the next lookup rebuild it. */
+    auto index = imap_bayes_current (acc);
 
     /* process each token in the list */
     for (current_token = g_list_first(tokens); current_token;
@@ -6170,8 +6506,13 @@ gnc_account_imap_add_account_bayes (Account *acc,
         PINFO("adding token '%s'", (char*)current_token->data);
         auto path = std::string {IMAP_FRAME_BAYES} + '/' + static_cast<char*>(current_token->data) + '/' + guid_string;
         /* change the imap entry for the account */
-        change_imap_entry (acc, path, token_count);
+        token_count = change_imap_entry (acc, path, token_count);
+        if (index)
+            imap_bayes_set_count (*index, static_cast<char*>(current_token->data),
+                                  guid_string, token_count);
     }
+    if (index)
+        index->version = qof_instance_get_slots (QOF_INSTANCE (acc))->version ();
     /* free up the account fullname and guid string */
     qof_instance_set_dirty (QOF_INSTANCE (acc));
     xaccAccountCommitEdit (acc);
@@ -6367,6 +6708,167 @@ gnc_account_book_end(QofBook* book)
     xaccAccountDestroy (root_account);
 }
 
+/* ================================================================ */
+/* Query index for splits.  A query for the splits of some accounts
+ * visits only the splits of those accounts, and if it also restricts
+ * the date posted, only the splits in that range, found by binary
+ * search in the accounts' date-ordered split vectors.  The candidates
+ * are the splits committed to the accounts, so while a transaction of
+ * the book is open, whose splits may have moved or changed date since,
+ * the index declines and the query scans the collection. */
+
+using SplitRange = std::pair<SplitsVec::const_iterator, SplitsVec::const_iterator>;
+
+static bool
+query_term_path_is (const QofQueryTerm *qt, const char *first,
+                    const char *second)
+{
+    auto path = qof_query_term_get_param_path (qt);
+    if (!path || g_strcmp0 (static_cast<char*>(path->data), first))
+        return false;
+    path = path->next;
+    if (!second)
+        return !path;
+    return path && !path->next &&
+        !g_strcmp0 (static_cast<char*>(path->data), second);
+}
+
+/* Find the accounts and the inclusive posted-date range that the
+ * AND-terms restrict splits to. Returns false if no term restricts the
+ * accounts. */
+static bool
+split_index_scope (QofBook *book, const GList *and_terms,
+                   std::vector<Account*>& accounts, time64& start, time64& end)
+{
+    const query_guid_def *account_match = nullptr;
+
+    start = INT64_MIN;
+    end = INT64_MAX;
+    for (auto node = and_terms; node; node = node->next)
+    {
+        auto qt = static_cast<const QofQueryTerm*>(node->data);
+        auto pd = qof_query_term_get_pred_data (qt);
+
+        if (qof_query_term_is_inverted (qt))
+            continue;
+
+        if (!g_strcmp0 (pd->type_name, QOF_TYPE_GUID) &&
+            query_term_path_is (qt, SPLIT_ACCOUNT, QOF_PARAM_GUID))
+        {
+            auto gdef = reinterpret_cast<const query_guid_def*>(pd);
+            if (gdef->options == QOF_GUID_MATCH_ANY && !account_match)
+                account_match = gdef;
+        }
+        else if (!g_strcmp0 (pd->type_name, QOF_TYPE_DATE) &&
+                 query_term_path_is (qt, SPLIT_TRANS, TRANS_DATE_POSTED))
+        {
+            auto ddef = reinterpret_cast<const query_date_def*>(pd);
+            if (ddef->options != QOF_DATE_MATCH_NORMAL)
+                continue;
+            switch (pd->how)
+            {
+            case QOF_COMPARE_GT:
+                if (ddef->date < INT64_MAX)
+                    start = std::max (start, ddef->date + 1);
+                break;
+            case QOF_COMPARE_GTE:
+                start = std::max (start, ddef->date);
+                break;
+            case QOF_COMPARE_LT:
+                if (ddef->date > INT64_MIN)
+                    end = std::min (end, ddef->date - 1);
+                break;
+            case QOF_COMPARE_LTE:
+                end = std::min (end, ddef->date);
+                break;
+            case QOF_COMPARE_EQUAL:
+                start = std::max (start, ddef->date);
+                end = std::min (end, ddef->date);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    if (!account_match)
+        return false;
+
+    for (auto node = account_match->guids; node; node = node->next)
+    {
+        auto acc = xaccAccountLookup (static_cast<GncGUID*>(node->data), book);
+        if (acc && std::find (accounts.begin(), accounts.end(), acc) == accounts.end())
+            accounts.push_back (acc);
+    }
+    return true;
+}
+
+static SplitRange
+split_index_range (const Account *acc, time64 start, time64 end)
+{
+    auto priv = GET_PRIVATE (acc);
+    const auto& splits = priv->splits;
+
+    /* The vector is only in date order once it's been sorted. */
+    if (priv->sort_dirty || start > end)
+        return start > end ? SplitRange{splits.end(), splits.end()}
+                           : SplitRange{splits.begin(), splits.end()};
+
+    auto date_of = [](const Split *s)
+                   { return xaccTransGetDate (xaccSplitGetParent (s)); };
+    auto first = std::lower_bound (splits.begin(), splits.end(), start,
+                                   [&](const Split *s, time64 t)
+                                   { return date_of (s) < t; });
+    auto last = std::upper_bound (first, splits.end(), end,
+                                  [&](time64 t, const Split *s)
+                                  { return t < date_of (s); });
+    return {first, last};
+}
+
+static gint64
+split_index_estimate (QofBook *book, const GList *and_terms)
+{
+    std::vector<Account*> accounts;
+    time64 start, end;
+    gint64 visits = 0;
+
+    if (xaccTransCountOpen (book) ||
+        !split_index_scope (book, and_terms, accounts, start, end))
+        return -1;
+
+    for (auto acc : accounts)
+    {
+        auto range = split_index_range (acc, start, end);
+        visits += range.second - range.first;
+    }
+    return visits;
+}
+
+static void
+split_index_foreach (QofBook *book, const GList *and_terms,
+                     QofInstanceForeachCB cb, gpointer user_data)
+{
+    std::vector<Account*> accounts;
+    time64 start, end;
+
+    if (!split_index_scope (book, and_terms, accounts, start, end))
+        return;
+
+    for (auto acc : accounts)
+    {
+        auto range = split_index_range (acc, start, end);
+        std::for_each (range.first, range.second,
+                       [&](Split *split){ cb (QOF_INSTANCE (split), user_data); });
+    }
+}
+
+static const QofQueryIndex split_account_index =
+{
+    "account splits",
+    split_index_estimate,
+    split_index_foreach,
+};
+
 #ifdef _MSC_VER
 /* MSVC compiler doesn't have C99 "designated initializers"
  * so we wrap them in a macro that is empty on MSVC. */
@@ -6494,7 +6996,16 @@ gboolean xaccAccountRegister (void)
         { NULL },
     };
 
+    /* Getters that only read the account, see qof_query_set_parallel */
+    static const char *threadsafe_params[] =
+    {
+        ACCOUNT_NAME_, ACCOUNT_CODE_, ACCOUNT_DESCRIPTION_, ACCOUNT_PARENT,
+        QOF_PARAM_BOOK, QOF_PARAM_GUID, nullptr
+    };
+
     qof_class_register (GNC_ID_ACCOUNT, (QofSortFunc) qof_xaccAccountOrder, params);
+    qof_class_set_params_threadsafe (GNC_ID_ACCOUNT, threadsafe_params);
+    qof_query_register_index (GNC_ID_SPLIT, &split_account_index);
 
     return qof_object_register (&account_object_def);
 }
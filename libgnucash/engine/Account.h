@@ -357,6 +357,12 @@ typedef enum
     void gnc_account_set_start_reconciled_balance (Account *acc,
             const gnc_numeric start_baln);
 
+    /** This function will set the starting commodity balance without
+     *  closing entries for this account, for backends that return a
+     *  partial list of splits like gnc_account_set_start_balance(). */
+    void gnc_account_set_start_noclosing_balance (Account *acc,
+            const gnc_numeric start_baln);
+
     /** Tell the account that the running balances may be incorrect and
      *  need to be recomputed.
      *
@@ -369,6 +375,15 @@ typedef enum
      *  @param acc Set the flag on this account. */
     void gnc_account_set_sort_dirty (Account *acc);
 
+    /** Tell the account that a split's amount, reconcile state or sort
+     *  keys have changed. The splits may need to be resorted and the
+     *  running balances are recomputed from that split onward.
+     *
+     *  @param acc The account holding the split.
+     *
+     *  @param s The split that changed. */
+    void gnc_account_set_split_dirty (Account *acc, Split *s);
+
     /** Set the defer balance flag. If defer is true, the account balance
      * is not automatically computed, which can save a lot of time if
      * multiple operations have to be done on the same account. If
@@ -1039,19 +1054,18 @@ typedef enum
      *    account first.*/
 #define xaccAccountInsertSplit(acc, s)  xaccSplitSetAccount((s), (acc))
 
-    /** The xaccAccountGetSplitList() routine returns a pointer to a GList of
-     *    the splits in the account.
-     * @note This GList is the account's internal
-     *    data structure: do not delete it when done; treat it as a read-only
-     *    structure.  Note that some routines (such as xaccAccountRemoveSplit())
-     *    modify this list directly, and could leave you with a corrupted
-     *    pointer.
-     * @note This should be changed so that the returned value is a copy
-     * of the list. No other part of the code should have access to the
-     * internal data structure used by this object.
+    /** The xaccAccountGetSplitList() routine returns a newly allocated
+     *    GList of the splits in the account, in xaccSplitOrder() order.
+     * @note The caller owns the list and must free it with g_list_free()
+     *    when done; the splits themselves belong to the account.
+     *    C++ code should prefer xaccAccountGetSplits(), which doesn't
+     *    copy.
      */
     SplitList* xaccAccountGetSplitList (const Account *account);
 
+    /** Returns the number of splits in the account. */
+    size_t xaccAccountGetSplitsSize (const Account *account);
+
     /** The xaccAccountMoveAllSplits() routine reassigns each of the splits
      *  in accfrom to accto. */
     void xaccAccountMoveAllSplits (Account *accfrom, Account *accto);
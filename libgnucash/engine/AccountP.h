@@ -49,108 +49,9 @@ extern "C" {
 
 /** STRUCTS *********************************************************/
 
-/** This is the data that describes an account.
- *
- * This is the *private* header for the account structure.
- * No one outside of the engine should ever include this file.
-*/
-
-typedef enum
-{
-    Unset = -1,
-    False,
-    True
-} TriState;
-
-/** \struct Account */
-typedef struct AccountPrivate
-{
-    /* The accountName is an arbitrary string assigned by the user.
-     * It is intended to a short, 5 to 30 character long string that
-     * is displayed by the GUI as the account mnemonic.
-     */
-    const char *accountName;
-
-    /* The accountCode is an arbitrary string assigned by the user.
-     * It is intended to be reporting code that is a synonym for the
-     * accountName. Typically, it will be a numeric value that follows
-     * the numbering assignments commonly used by accountants, such
-     * as 100, 200 or 600 for top-level accounts, and 101, 102..  etc.
-     * for detail accounts.
-     */
-    const char *accountCode;
-
-    /* The description is an arbitrary string assigned by the user.
-     * It is intended to be a longer, 1-5 sentence description of what
-     * this account is all about.
-     */
-    const char *description;
-
-    /* The type field is the account type, picked from the enumerated
-     * list that includes ACCT_TYPE_BANK, ACCT_TYPE_STOCK,
-     * ACCT_TYPE_CREDIT, ACCT_TYPE_INCOME, etc.  Its intended use is to
-     * be a hint to the GUI as to how to display and format the
-     * transaction data.
-     */
-    GNCAccountType type;
-
-    /*
-     * The commodity field denotes the kind of 'stuff' stored
-     * in this account.  The 'amount' field of a split indicates
-     * how much of the 'stuff' there is.
-     */
-    gnc_commodity * commodity;
-    int commodity_scu;
-    gboolean non_standard_scu;
-
-    /* The parent and children pointers are used to implement an account
-     * hierarchy, of accounts that have sub-accounts ("detail accounts").
-     */
-    Account *parent;    /* back-pointer to parent */
-    GList *children;    /* list of sub-accounts */
-
-    /* protected data - should only be set by backends */
-    gnc_numeric starting_balance;
-    gnc_numeric starting_noclosing_balance;
-    gnc_numeric starting_cleared_balance;
-    gnc_numeric starting_reconciled_balance;
-
-    /* cached parameters */
-    gnc_numeric balance;
-    gnc_numeric noclosing_balance;
-    gnc_numeric cleared_balance;
-    gnc_numeric reconciled_balance;
-
-    gnc_numeric higher_balance_limit;
-    gboolean    higher_balance_cached;
-    gnc_numeric lower_balance_limit;
-    gboolean    lower_balance_cached;
-    TriState    include_sub_account_balances;
- 
-    gboolean balance_dirty;     /* balances in splits incorrect */
-
-    GList *splits;              /* list of split pointers */
-    gboolean sort_dirty;        /* sort order of splits is bad */
-
-    LotList   *lots;		/* list of lot pointers */
-    GNCPolicy *policy;		/* Cached pointer to policy method */
-
-    TriState sort_reversed;
-    TriState equity_type;
-    char *notes;
-    char *color;
-    char *tax_us_code;
-    char *tax_us_pns;
-    char *last_num;
-    char *sort_order;
-    char *filter;
-
-    /* The "mark" flag can be used by the user to mark this account
-     * in any way desired.  Handy for specialty traversals of the
-     * account tree. */
-    short mark;
-    gboolean defer_bal_computation;
-} AccountPrivate;
+/* The AccountPrivate structure is defined in AccountP.hpp; it is only
+ * accessible from C++. */
+typedef struct AccountPrivate AccountPrivate;
 
 struct account_s
 {
@@ -165,6 +66,18 @@ void xaccAccountSetGUID (Account *account, const GncGUID *guid);
 /* Register Accounts with the engine */
 gboolean xaccAccountRegister (void);
 
+/* Tell the account that something lot depends on has changed: its
+ * splits, or their amounts, dates or currency. */
+void gnc_account_lot_changed (Account *acc, GNCLot *lot);
+
+/* Find the open lot with the earliest (or latest) opening date whose
+ * opening split has the given sign and whose balance has not crossed
+ * zero. currency, if not NULL, must be equivalent to the currency of the
+ * opening transaction. Used by the capital gains code. */
+GNCLot *gnc_account_find_open_lot (Account *acc, gboolean positive_opening,
+                                   gnc_commodity *currency,
+                                   gboolean earliest);
+
 /* Structure for accessing static functions for testing */
 typedef struct
 {
@@ -0,0 +1,251 @@
+/********************************************************************\
+ * AccountP.hpp -- Account engine-private data structure            *
+ * Copyright (C) 1997 Robin D. Clark                                *
+ * Copyright (C) 1997-2002, Linas Vepstas <linas@linas.org>         *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ *                                                                  *
+\********************************************************************/
+
+/** @file AccountP.hpp
+ *
+ * This is the *private* C++ header for the account structure. It holds
+ * the definition of AccountPrivate, which uses C++ containers and so
+ * cannot live in AccountP.h. No one outside of the engine should ever
+ * include this file.
+ */
+
+#ifndef XACC_ACCOUNT_P_HPP
+#define XACC_ACCOUNT_P_HPP
+
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "Account.hpp"
+#include "AccountP.h"
+
+/** The running balances of one split, keyed by the posted date of its
+ *  transaction. */
+struct SplitBalanceEntry
+{
+    time64 date;
+    gnc_numeric balance;
+    gnc_numeric noclosing_balance;
+};
+
+using SplitBalanceIndex = std::vector<SplitBalanceEntry>;
+using SplitsSet = std::unordered_set<Split*>;
+
+/** An open lot filed under the posted date of its opening split. seq
+ *  counts the lots inserted into the account, so that among lots opened
+ *  on the same date the most recently inserted one comes first, as it
+ *  does in the account's lot list. */
+struct OpenLotEntry
+{
+    time64 posted;
+    uint64_t seq;
+    GNCLot *lot;
+};
+
+struct OpenLotOrder
+{
+    bool operator()(const OpenLotEntry& a, const OpenLotEntry& b) const
+    {
+        if (a.posted != b.posted)
+            return a.posted < b.posted;
+        return a.seq > b.seq;
+    }
+};
+
+/** Whether the opening split of a lot is positive, and the currency of
+ *  its transaction. */
+using OpenLotKey = std::pair<bool, gnc_commodity*>;
+using OpenLotSet = std::set<OpenLotEntry, OpenLotOrder>;
+
+/** The open lots of an account that the capital gains code may assign
+ *  splits to, i.e. those whose balance still has the sign of their
+ *  opening split. Lots are only re-examined when they have been reported
+ *  as changed, and then lazily before the next lookup. */
+struct OpenLotIndex
+{
+    std::map<OpenLotKey, OpenLotSet> buckets;
+    /* Where each filed lot is, to take it out again. */
+    std::unordered_map<GNCLot*, std::pair<OpenLotKey, OpenLotEntry>> filed;
+    /* Insertion sequence of every lot in the account. */
+    std::unordered_map<GNCLot*, uint64_t> seq;
+    std::unordered_set<GNCLot*> dirty;
+    uint64_t next_seq = 0;
+};
+
+/** How often a token of the Bayesian import map was seen with each
+ *  account, in the order of the accounts' GUID strings, and in all. */
+struct ImapBayesToken
+{
+    std::vector<std::pair<uint32_t, int64_t>> counts;
+    int64_t total = 0;
+};
+
+/** The "import-map-bayes/<token>/<guid>" slots of an account inverted,
+ *  so that scoring a transaction takes one hash lookup per token instead
+ *  of a scan of the slots. Tokens and the GUID strings of the accounts are
+ *  interned and numbered. The index is built on first use and is only
+ *  good while the account's KVP frame is the one at the version it
+ *  records; gnc_account_imap_add_account_bayes updates it in step with
+ *  the slots it changes. */
+struct ImapBayesIndex
+{
+    const KvpFrame *frame = nullptr;
+    uint64_t version = 0;
+    std::deque<std::string> token_names;
+    std::unordered_map<std::string_view, uint32_t> token_ids;
+    std::vector<ImapBayesToken> tokens;
+    std::vector<std::string> account_guids;
+    std::unordered_map<std::string, uint32_t> account_ids;
+};
+
+/** This is the data that describes an account.
+ *
+ * This is the *private* header for the account structure.
+ * No one outside of the engine should ever include this file.
+*/
+
+enum TriState
+{
+    Unset = -1,
+    False,
+    True
+};
+
+/** \struct Account */
+struct AccountPrivate
+{
+    /* The accountName is an arbitrary string assigned by the user.
+     * It is intended to a short, 5 to 30 character long string that
+     * is displayed by the GUI as the account mnemonic.
+     */
+    const char *accountName;
+
+    /* The accountCode is an arbitrary string assigned by the user.
+     * It is intended to be reporting code that is a synonym for the
+     * accountName. Typically, it will be a numeric value that follows
+     * the numbering assignments commonly used by accountants, such
+     * as 100, 200 or 600 for top-level accounts, and 101, 102..  etc.
+     * for detail accounts.
+     */
+    const char *accountCode;
+
+    /* The description is an arbitrary string assigned by the user.
+     * It is intended to be a longer, 1-5 sentence description of what
+     * this account is all about.
+     */
+    const char *description;
+
+    /* The type field is the account type, picked from the enumerated
+     * list that includes ACCT_TYPE_BANK, ACCT_TYPE_STOCK,
+     * ACCT_TYPE_CREDIT, ACCT_TYPE_INCOME, etc.  Its intended use is to
+     * be a hint to the GUI as to how to display and format the
+     * transaction data.
+     */
+    GNCAccountType type;
+
+    /*
+     * The commodity field denotes the kind of 'stuff' stored
+     * in this account.  The 'amount' field of a split indicates
+     * how much of the 'stuff' there is.
+     */
+    gnc_commodity * commodity;
+    int commodity_scu;
+    gboolean non_standard_scu;
+
+    /* The parent and children pointers are used to implement an account
+     * hierarchy, of accounts that have sub-accounts ("detail accounts").
+     */
+    Account *parent;    /* back-pointer to parent */
+    GList *children;    /* list of sub-accounts */
+
+    /* protected data - should only be set by backends */
+    gnc_numeric starting_balance;
+    gnc_numeric starting_noclosing_balance;
+    gnc_numeric starting_cleared_balance;
+    gnc_numeric starting_reconciled_balance;
+
+    /* cached parameters */
+    gnc_numeric balance;
+    gnc_numeric noclosing_balance;
+    gnc_numeric cleared_balance;
+    gnc_numeric reconciled_balance;
+
+    gnc_numeric higher_balance_limit;
+    gboolean    higher_balance_cached;
+    gnc_numeric lower_balance_limit;
+    gboolean    lower_balance_cached;
+    TriState    include_sub_account_balances;
+ 
+    gboolean balance_dirty;     /* balances in splits incorrect */
+    /* Position of the first split whose running balances may be
+     * incorrect; the splits before it are untouched since the last
+     * recompute and keep their balances. */
+    size_t balance_dirty_from;
+
+    /* Date-ordered copy of the running balances stored in the splits,
+     * rebuilt by xaccAccountRecomputeBalance. It lets the as-of-date
+     * balance queries binary search instead of walking the split list.
+     * balance_index_valid records that the entries are in date order;
+     * the index is only usable while it is set and the balances are
+     * clean. */
+    SplitBalanceIndex balance_index;
+    gboolean balance_index_valid;
+
+    SplitsVec splits;           /* split pointers in xaccSplitOrder */
+    SplitsSet splits_set;       /* the same splits, for membership tests */
+    gboolean sort_dirty;        /* sort order of splits is bad */
+
+    LotList   *lots;		/* list of lot pointers */
+    OpenLotIndex open_lots;     /* the open ones among them, by date */
+    GNCPolicy *policy;		/* Cached pointer to policy method */
+
+    /* The import map inverted, for matching imported transactions. */
+    std::unique_ptr<ImapBayesIndex> imap_bayes;
+
+    TriState sort_reversed;
+    TriState equity_type;
+    char *notes;
+    char *color;
+    char *tax_us_code;
+    char *tax_us_pns;
+    char *last_num;
+    char *sort_order;
+    char *filter;
+
+    /* The "mark" flag can be used by the user to mark this account
+     * in any way desired.  Handy for specialty traversals of the
+     * account tree. */
+    short mark;
+    gboolean defer_bal_computation;
+};
+
+#endif /* XACC_ACCOUNT_P_HPP */
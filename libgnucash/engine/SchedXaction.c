@@ -449,6 +449,7 @@ delete_template_trans(SchedXaction *sx)
             = g_list_prepend(templ_acct_transactions, split_trans);
         }
     }
+    g_list_free (templ_acct_splits);
 
     g_list_foreach(templ_acct_transactions,
                    sxprivTransMapDelete,
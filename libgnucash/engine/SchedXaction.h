@@ -217,6 +217,8 @@ gint gnc_sx_get_instance_count( const SchedXaction *sx, /*@ null @*/ SXTmpStateD
 */
 void gnc_sx_set_instance_count( SchedXaction *sx, gint instanceNum );
 
+/** Returns a newly allocated list of the template splits; free it
+ *  with g_list_free(). */
 GList *xaccSchedXactionGetSplits( const SchedXaction *sx );
 void xaccSchedXactionSetSplits( SchedXaction *sx, GList *newSplits );
 
@@ -169,6 +169,7 @@ xaccAccountScrubOrphans (Account *acc, QofPercentageFunc percentagefunc)
                                gnc_account_get_root (acc));
         current_split++;
     }
+    g_list_free (splits);
     (percentagefunc)(NULL, -1.0);
     scrub_depth--;
 }
@@ -221,13 +222,15 @@ xaccAccountTreeScrubSplits (Account *account)
 void
 xaccAccountScrubSplits (Account *account)
 {
-    GList *node;
+    GList *node, *splits;
     scrub_depth++;
-    for (node = xaccAccountGetSplitList (account); node; node = node->next)
+    splits = xaccAccountGetSplitList (account);
+    for (node = splits; node; node = node->next)
     {
         if (abort_now) break;
         xaccSplitScrub (node->data);
     }
+    g_list_free (splits);
     scrub_depth--;
 }
 
@@ -401,6 +404,7 @@ xaccAccountScrubImbalance (Account *acc, QofPercentageFunc percentagefunc)
               curr_split_no + 1, split_count);
         curr_split_no++;
     }
+    g_list_free (splits);
     (percentagefunc)(NULL, -1.0);
     scrub_depth--;
 }
@@ -77,8 +77,13 @@ restart_loop:
         if (gnc_numeric_zero_p (split->amount) &&
                 xaccTransGetVoidStatus(split->parent)) continue;
 
-        if (xaccSplitAssign (split)) goto restart_loop;
+        if (xaccSplitAssign (split))
+        {
+            g_list_free (splits);
+            goto restart_loop;
+        }
     }
+    g_list_free (splits);
     xaccAccountCommitEdit (acc);
     LEAVE ("acc=%s", xaccAccountGetName(acc));
 }
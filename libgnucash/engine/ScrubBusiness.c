@@ -402,6 +402,7 @@ gncScrubLotDanglingPayments (GNCLot *lot)
 
         filtered_list = g_list_prepend (filtered_list, free_split);
     }
+    g_list_free (split_list);
 
     filtered_list = g_list_reverse (filtered_list);
     match_list = gncSLFindOffsSplits (filtered_list, ll_val);
@@ -709,12 +710,16 @@ restart:
             // If gncScrubBusinessSplit returns true, a split was deleted and hence
             // The account split list has become invalid, so we need to start over
             if (gncScrubBusinessSplit (split))
+            {
+                g_list_free (splits);
                 goto restart;
+            }
 
         PINFO("Finished processing split %d of %d",
               curr_split_no + 1, split_count);
         curr_split_no++;
     }
+    g_list_free (splits);
     xaccAccountCommitEdit(acc);
     (percentagefunc)(NULL, -1.0);
     LEAVE ("(acc=%s)", str);
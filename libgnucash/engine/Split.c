@@ -730,7 +730,7 @@ void mark_split (Split *s)
 {
     if (s->acc)
     {
-        g_object_set(s->acc, "sort-dirty", TRUE, "balance-dirty", TRUE, NULL);
+        gnc_account_set_split_dirty (s->acc, s);
     }
 
     /* set dirty flag on lot too. */
@@ -1031,7 +1031,7 @@ xaccSplitCommitEdit(Split *s)
 
     if (acc)
     {
-        g_object_set(acc, "sort-dirty", TRUE, "balance-dirty", TRUE, NULL);
+        gnc_account_set_split_dirty (acc, s);
         xaccAccountRecomputeBalance(acc);
     }
 }
@@ -1216,6 +1216,8 @@ qofSplitSetAmount (Split *split, gnc_numeric amt)
     {
         split->amount = amt;
     }
+    /* The lot caches the sum of its split amounts. */
+    if (split->lot) gnc_lot_set_closed_unknown(split->lot);
 }
 
 /* The amount of the split in the _account's_ commodity. */
@@ -1891,6 +1893,14 @@ xaccSplitGetMemo (const Split *split)
     return split ? split->memo : NULL;
 }
 
+const char *
+xaccSplitGetOnlineID (const Split *split)
+{
+    if (!split) return NULL;
+    return qof_instance_get_cached_string (QOF_INSTANCE (split),
+                                           QOF_CACHED_SLOT_ONLINE_ID);
+}
+
 const char *
 xaccSplitGetAction (const Split *split)
 {
@@ -2333,7 +2343,18 @@ gboolean xaccSplitRegister (void)
             { NULL },
         };
 
+    /* Getters that only read the split, see qof_query_set_parallel */
+    static const char *threadsafe_params[] =
+    {
+        SPLIT_DATE_RECONCILED, SPLIT_BALANCE, SPLIT_CLEARED_BALANCE,
+        SPLIT_RECONCILED_BALANCE, SPLIT_MEMO, SPLIT_ACTION, SPLIT_RECONCILE,
+        SPLIT_AMOUNT, SPLIT_SHARE_PRICE, SPLIT_VALUE, SPLIT_LOT, SPLIT_TRANS,
+        SPLIT_ACCOUNT, SPLIT_ACCOUNT_GUID, QOF_PARAM_BOOK, QOF_PARAM_GUID,
+        NULL
+    };
+
     qof_class_register (GNC_ID_SPLIT, (QofSortFunc)xaccSplitOrder, params);
+    qof_class_set_params_threadsafe (GNC_ID_SPLIT, threadsafe_params);
     qof_class_register (SPLIT_ACCT_FULLNAME,
                         (QofSortFunc)xaccSplitCompareAccountFullNames, NULL);
     qof_class_register (SPLIT_CORR_ACCT_NAME,
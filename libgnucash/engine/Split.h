@@ -157,6 +157,10 @@ void          xaccSplitSetMemo (Split *split, const char *memo);
 /** Returns the memo string. */
 const char *  xaccSplitGetMemo (const Split *split);
 
+/** Returns the online id that an importer stored with the split, or NULL.
+ * The string belongs to the split. */
+const char *  xaccSplitGetOnlineID (const Split *split);
+
 /** The Action is an arbitrary user-assigned string.
  * The action field is an arbitrary user-assigned value.
  * It is meant to be a very short (one to ten character) string that
@@ -29,11 +29,18 @@
 #include <glib.h>
 #include <glib/gstdio.h>
 #include <string.h>
+#ifdef HAVE_UNISTD_H
+# include <unistd.h>
+#endif
+#ifdef G_OS_WIN32
+# include <io.h>
+#endif
 
 #include "Account.h"
 #include "Transaction.h"
 #include "TransactionP.h"
 #include "TransLog.h"
+#include "gnc-uri-utils.h"
 #include "qof.h"
 #ifdef _MSC_VER
 # define g_fopen fopen
@@ -80,6 +87,20 @@ static QofLogModule log_module = "gnc.translog";
  *     occurred at a certain time, it can be located.
  * (-) hack alert -- something better than just the account name
  *     is needed for identifying the account.
+ *
+ * The binary journal, which may be chosen instead, records the same
+ * fields as the text log for bulk imports, where formatting the text
+ * and flushing it for every commit takes time. Each record is a 32 bit
+ * length, that many bytes of payload and a 32 bit FNV-1a checksum of
+ * the payload, so that a record cut short or garbled by a crash ends
+ * the journal rather than being replayed. Integers are little endian,
+ * strings are a 32 bit length followed by that many bytes, and GUIDs
+ * are their 16 bytes. The payload is the flag, the time of logging, the
+ * dates entered and posted, the transaction GUID, its num, description
+ * and notes and the number of splits; then for each split its GUID,
+ * whether it has an account and if so the account's GUID and name, its
+ * memo, action and reconcile flag, amount and value as numerator and
+ * denominator and reconcile date.
  */
 /* ------------------------------------------------------------------ */
 
@@ -89,6 +110,22 @@ static FILE * trans_log = NULL; /**< current log file handle */
 static char * trans_log_name = NULL; /**< current log file name */
 static char * log_base_name = NULL;
 
+static gboolean log_binary = FALSE; /**< format of logs opened from now on */
+static gboolean trans_log_binary = FALSE; /**< format of the current log */
+static guint log_flush_interval = 0; /**< in milliseconds */
+static gboolean log_sync = FALSE;
+
+/** Binary records not yet written to the current log. */
+static GByteArray * log_buffer = NULL;
+/** Whether anything has been logged since the log was last flushed,
+ *  and when the first of it was, in monotonic microseconds. */
+static gboolean log_pending = FALSE;
+static gint64 log_pending_since = 0;
+#define LOG_BUFFER_LIMIT (64 * 1024)
+
+/** Scratch space for the splits of the transaction being logged. */
+static GArray * log_splits = NULL;
+
 /********************************************************************\
 \********************************************************************/
 
@@ -100,6 +137,10 @@ void xaccLogEnable  (void)
 {
     gen_logs = 1;
 }
+gboolean xaccLogIsEnabled (void)
+{
+    return gen_logs != 0;
+}
 
 /********************************************************************\
 \********************************************************************/
@@ -131,6 +172,35 @@ xaccLogSetBaseName (const char *basepath)
 }
 
 
+void
+xaccLogSetBinary (gboolean binary)
+{
+    log_binary = binary;
+
+    if (trans_log && trans_log_binary != log_binary)
+    {
+        xaccCloseLog();
+        xaccOpenLog();
+    }
+}
+
+
+void
+xaccLogSetFlushInterval (guint msecs)
+{
+    log_flush_interval = msecs;
+    if (!log_flush_interval)
+        xaccLogFlush();
+}
+
+
+void
+xaccLogSetSync (gboolean sync)
+{
+    log_sync = sync;
+}
+
+
 /*
  * See if the provided file name is that of the current log file.
  * Since the filename is generated with a time-stamp we can ignore the
@@ -155,6 +225,18 @@ xaccFileIsCurrentLog (const gchar *name)
 /********************************************************************\
 \********************************************************************/
 
+static void
+write_text_header (FILE *log)
+{
+    /*  Note: this must match src/import-export/log-replay/gnc-log-replay.c */
+    fprintf (log, "mod\ttrans_guid\tsplit_guid\ttime_now\t"
+             "date_entered\tdate_posted\t"
+             "acc_guid\tacc_name\tnum\tdescription\t"
+             "notes\tmemo\taction\treconciled\t"
+             "amount\tvalue\tdate_reconciled\n");
+    fprintf (log, "-----------------\n");
+}
+
 void
 xaccOpenLog (void)
 {
@@ -170,12 +252,16 @@ xaccOpenLog (void)
 
     if (!log_base_name) log_base_name = g_strdup ("translog");
 
-    /* tag each filename with a timestamp */
+    /* tag each filename with a timestamp, and keep journals apart from
+     * text logs, which a format switch in the same second would append
+     * to otherwise */
     timestamp = gnc_date_timestamp ();
 
-    filename = g_strconcat (log_base_name, ".", timestamp, ".log", NULL);
+    filename = g_strconcat (log_base_name, ".", timestamp,
+                            log_binary ? GNC_JOURNALFILE_EXT : GNC_LOGFILE_EXT,
+                            NULL);
 
-    trans_log = g_fopen (filename, "a");
+    trans_log = g_fopen (filename, log_binary ? "ab" : "a");
     if (!trans_log)
     {
         int norr = errno;
@@ -186,6 +272,7 @@ xaccOpenLog (void)
         g_free (timestamp);
         return;
     }
+    trans_log_binary = log_binary;
 
     /* Save the log file name */
     if (trans_log_name)
@@ -195,22 +282,51 @@ xaccOpenLog (void)
     g_free (filename);
     g_free (timestamp);
 
-    /*  Note: this must match src/import-export/log-replay/gnc-log-replay.c */
-    fprintf (trans_log, "mod\ttrans_guid\tsplit_guid\ttime_now\t"
-             "date_entered\tdate_posted\t"
-             "acc_guid\tacc_name\tnum\tdescription\t"
-             "notes\tmemo\taction\treconciled\t"
-             "amount\tvalue\tdate_reconciled\n");
-    fprintf (trans_log, "-----------------\n");
+    if (!trans_log_binary)
+        write_text_header (trans_log);
+    else if (fseek (trans_log, 0, SEEK_END) == 0 && ftell (trans_log) == 0)
+        fwrite (XACC_LOG_JOURNAL_MAGIC, 1, XACC_LOG_JOURNAL_MAGIC_LEN, trans_log);
+
+    if (!log_buffer)
+        log_buffer = g_byte_array_new ();
 }
 
 /********************************************************************\
 \********************************************************************/
 
+static void
+sync_log_file (FILE *log)
+{
+#ifdef G_OS_WIN32
+    _commit (_fileno (log));
+#else
+    fsync (fileno (log));
+#endif
+}
+
+void
+xaccLogFlush (void)
+{
+    if (!trans_log || !log_pending) return;
+
+    if (log_buffer->len)
+    {
+        if (fwrite (log_buffer->data, 1, log_buffer->len, trans_log) != log_buffer->len)
+            PERR ("Error writing to the transaction journal: %s",
+                  g_strerror (errno));
+        g_byte_array_set_size (log_buffer, 0);
+    }
+    fflush (trans_log);
+    if (log_sync)
+        sync_log_file (trans_log);
+    log_pending = FALSE;
+}
+
 void
 xaccCloseLog (void)
 {
     if (!trans_log) return;
+    xaccLogFlush ();
     fflush (trans_log);
     fclose (trans_log);
     trans_log = NULL;
@@ -219,84 +335,442 @@ xaccCloseLog (void)
 /********************************************************************\
 \********************************************************************/
 
-void
-xaccTransWriteLog (Transaction *trans, char flag)
+static void
+write_text_record (FILE *log, const XaccLogTrans *record)
 {
-    GList *node;
     char trans_guid_str[GUID_ENCODING_LENGTH + 1];
     char split_guid_str[GUID_ENCODING_LENGTH + 1];
-    const char *trans_notes;
+    char acc_guid_str[GUID_ENCODING_LENGTH + 1];
     char dnow[100], dent[100], dpost[100], drecn[100];
+    guint i;
 
-    if (!gen_logs)
-    {
-         PINFO ("Attempt to write disabled transaction log");
-	 return;
-    }
-    if (!trans_log) return;
-
-    gnc_time64_to_iso8601_buff (gnc_time(NULL), dnow);
-    gnc_time64_to_iso8601_buff (trans->date_entered, dent);
-    gnc_time64_to_iso8601_buff (trans->date_posted, dpost);
-    guid_to_string_buff (xaccTransGetGUID(trans), trans_guid_str);
-    trans_notes = xaccTransGetNotes(trans);
-    fprintf (trans_log, "===== START\n");
+    gnc_time64_to_iso8601_buff (record->time_now, dnow);
+    gnc_time64_to_iso8601_buff (record->date_entered, dent);
+    gnc_time64_to_iso8601_buff (record->date_posted, dpost);
+    guid_to_string_buff (&record->guid, trans_guid_str);
+    fprintf (log, "===== START\n");
 
-    for (node = trans->splits; node; node = node->next)
+    for (i = 0; i < record->num_splits; i++)
     {
-        Split *split = node->data;
-        const char * accname = "";
-        char acc_guid_str[GUID_ENCODING_LENGTH + 1];
-        gnc_numeric amt, val;
+        const XaccLogSplit *split = &record->splits[i];
 
-        if (xaccSplitGetAccount(split))
-        {
-            accname = xaccAccountGetName (xaccSplitGetAccount(split));
-            guid_to_string_buff(xaccAccountGetGUID(xaccSplitGetAccount(split)),
-                                acc_guid_str);
-        }
+        if (split->has_account)
+            guid_to_string_buff (&split->account_guid, acc_guid_str);
         else
-        {
             acc_guid_str[0] = '\0';
-        }
 
         gnc_time64_to_iso8601_buff (split->date_reconciled, drecn);
-
-        guid_to_string_buff (xaccSplitGetGUID(split), split_guid_str);
-        amt = xaccSplitGetAmount (split);
-        val = xaccSplitGetValue (split);
+        guid_to_string_buff (&split->guid, split_guid_str);
 
         /* use tab-separated fields */
-        fprintf (trans_log,
+        fprintf (log,
                  "%c\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t%s\t"
                  "%s\t%s\t%s\t%s\t%c\t%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT "\t%" G_GINT64_FORMAT "/%" G_GINT64_FORMAT "\t%s\n",
-                 flag,
+                 record->flag,
                  trans_guid_str, split_guid_str,  /* trans+split make up unique id */
-                 /* Note that the next three strings always exist,
-                 		* so we don't need to test them. */
                  dnow,
                  dent,
                  dpost,
                  acc_guid_str,
-                 accname ? accname : "",
-                 trans->num ? trans->num : "",
-                 trans->description ? trans->description : "",
-                 trans_notes ? trans_notes : "",
-                 split->memo ? split->memo : "",
-                 split->action ? split->action : "",
+                 split->account_name,
+                 record->num,
+                 record->description,
+                 record->notes,
+                 split->memo,
+                 split->action,
                  split->reconciled,
-                 gnc_numeric_num(amt),
-                 gnc_numeric_denom(amt),
-                 gnc_numeric_num(val),
-                 gnc_numeric_denom(val),
-                 /* The next string always exists. No need to test it. */
+                 gnc_numeric_num(split->amount),
+                 gnc_numeric_denom(split->amount),
+                 gnc_numeric_num(split->value),
+                 gnc_numeric_denom(split->value),
                  drecn);
     }
 
-    fprintf (trans_log, "===== END\n");
+    fprintf (log, "===== END\n");
+}
 
-    /* get data out to the disk */
-    fflush (trans_log);
+static void
+put_u32 (GByteArray *buf, guint32 val)
+{
+    guint8 bytes[4] = {val, val >> 8, val >> 16, val >> 24};
+    g_byte_array_append (buf, bytes, sizeof bytes);
+}
+
+static void
+put_i64 (GByteArray *buf, gint64 val)
+{
+    put_u32 (buf, (guint64)val);
+    put_u32 (buf, (guint64)val >> 32);
+}
+
+static void
+put_guid (GByteArray *buf, const GncGUID *guid)
+{
+    g_byte_array_append (buf, guid->reserved, GUID_DATA_SIZE);
+}
+
+static void
+put_string (GByteArray *buf, const char *str)
+{
+    guint32 len = strlen (str);
+    put_u32 (buf, len);
+    g_byte_array_append (buf, (const guint8 *)str, len);
+}
+
+static guint32
+journal_checksum (const guint8 *data, gsize len)
+{
+    /* FNV-1a */
+    guint32 hash = 2166136261u;
+    gsize i;
+    for (i = 0; i < len; i++)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static void
+write_journal_record (GByteArray *buf, const XaccLogTrans *record)
+{
+    guint start, i;
+    guint8 flag = record->flag;
+    guint32 len;
+
+    start = buf->len;
+    put_u32 (buf, 0); /* the length, filled in below */
+    g_byte_array_append (buf, &flag, 1);
+    put_i64 (buf, record->time_now);
+    put_i64 (buf, record->date_entered);
+    put_i64 (buf, record->date_posted);
+    put_guid (buf, &record->guid);
+    put_string (buf, record->num);
+    put_string (buf, record->description);
+    put_string (buf, record->notes);
+    put_u32 (buf, record->num_splits);
+
+    for (i = 0; i < record->num_splits; i++)
+    {
+        const XaccLogSplit *split = &record->splits[i];
+        guint8 has_account = split->has_account ? 1 : 0;
+        guint8 reconciled = split->reconciled;
+
+        put_guid (buf, &split->guid);
+        g_byte_array_append (buf, &has_account, 1);
+        if (has_account)
+        {
+            put_guid (buf, &split->account_guid);
+            put_string (buf, split->account_name);
+        }
+        put_string (buf, split->memo);
+        put_string (buf, split->action);
+        g_byte_array_append (buf, &reconciled, 1);
+        put_i64 (buf, gnc_numeric_num (split->amount));
+        put_i64 (buf, gnc_numeric_denom (split->amount));
+        put_i64 (buf, gnc_numeric_num (split->value));
+        put_i64 (buf, gnc_numeric_denom (split->value));
+        put_i64 (buf, split->date_reconciled);
+    }
+
+    len = buf->len - start - 4;
+    buf->data[start] = len;
+    buf->data[start + 1] = len >> 8;
+    buf->data[start + 2] = len >> 16;
+    buf->data[start + 3] = len >> 24;
+    put_u32 (buf, journal_checksum (buf->data + start + 4, len));
+}
+
+void
+xaccTransWriteLog (Transaction *trans, char flag)
+{
+    XaccLogTrans record;
+    const char *trans_notes;
+    GList *node;
+
+    if (!gen_logs)
+    {
+         PINFO ("Attempt to write disabled transaction log");
+	 return;
+    }
+    if (!trans_log) return;
+
+    if (!log_splits)
+        log_splits = g_array_new (FALSE, FALSE, sizeof (XaccLogSplit));
+    g_array_set_size (log_splits, 0);
+
+    for (node = trans->splits; node; node = node->next)
+    {
+        Split *split = node->data;
+        Account *acc = xaccSplitGetAccount (split);
+        XaccLogSplit log_split;
+
+        log_split.guid = *xaccSplitGetGUID (split);
+        log_split.has_account = acc != NULL;
+        log_split.account_name = "";
+        if (acc)
+        {
+            const char *accname = xaccAccountGetName (acc);
+            log_split.account_guid = *xaccAccountGetGUID (acc);
+            log_split.account_name = accname ? accname : "";
+        }
+        log_split.memo = split->memo ? split->memo : "";
+        log_split.action = split->action ? split->action : "";
+        log_split.reconciled = split->reconciled;
+        log_split.amount = xaccSplitGetAmount (split);
+        log_split.value = xaccSplitGetValue (split);
+        log_split.date_reconciled = split->date_reconciled;
+        g_array_append_val (log_splits, log_split);
+    }
+
+    trans_notes = xaccTransGetNotes (trans);
+    record.flag = flag;
+    record.time_now = gnc_time (NULL);
+    record.date_entered = trans->date_entered;
+    record.date_posted = trans->date_posted;
+    record.guid = *xaccTransGetGUID (trans);
+    record.num = trans->num ? trans->num : "";
+    record.description = trans->description ? trans->description : "";
+    record.notes = trans_notes ? trans_notes : "";
+    record.num_splits = log_splits->len;
+    record.splits = (const XaccLogSplit *)log_splits->data;
+
+    if (trans_log_binary)
+        write_journal_record (log_buffer, &record);
+    else
+        write_text_record (trans_log, &record);
+
+    /* get data out to the disk, now or together with what follows */
+    if (!log_pending)
+    {
+        log_pending = TRUE;
+        log_pending_since = g_get_monotonic_time ();
+    }
+    if (log_flush_interval == 0 || log_buffer->len >= LOG_BUFFER_LIMIT ||
+        g_get_monotonic_time () - log_pending_since >= (gint64)log_flush_interval * 1000)
+        xaccLogFlush ();
+}
+
+/********************************************************************\
+\********************************************************************/
+
+/** A position in a journal being read. Reading past the end clears ok
+ *  and returns zeroes. */
+typedef struct
+{
+    const guint8 *pos;
+    const guint8 *end;
+    gboolean ok;
+} JournalReader;
+
+static const guint8 *
+get_bytes (JournalReader *reader, gsize len)
+{
+    const guint8 *bytes = reader->pos;
+    if (!reader->ok || (gsize)(reader->end - reader->pos) < len)
+    {
+        reader->ok = FALSE;
+        return NULL;
+    }
+    reader->pos += len;
+    return bytes;
+}
+
+static guint8
+get_u8 (JournalReader *reader)
+{
+    const guint8 *bytes = get_bytes (reader, 1);
+    return bytes ? bytes[0] : 0;
+}
+
+static guint32
+get_u32 (JournalReader *reader)
+{
+    const guint8 *bytes = get_bytes (reader, 4);
+    if (!bytes) return 0;
+    return bytes[0] | (guint32)bytes[1] << 8 | (guint32)bytes[2] << 16 |
+        (guint32)bytes[3] << 24;
+}
+
+static gint64
+get_i64 (JournalReader *reader)
+{
+    guint64 low = get_u32 (reader);
+    guint64 high = get_u32 (reader);
+    return (gint64)(low | high << 32);
+}
+
+static void
+get_guid (JournalReader *reader, GncGUID *guid)
+{
+    const guint8 *bytes = get_bytes (reader, GUID_DATA_SIZE);
+    if (bytes)
+        memcpy (guid->reserved, bytes, GUID_DATA_SIZE);
+}
+
+static const char *
+get_string (JournalReader *reader, GPtrArray *strings)
+{
+    guint32 len = get_u32 (reader);
+    const guint8 *bytes = get_bytes (reader, len);
+    char *str = bytes ? g_strndup ((const char *)bytes, len) : g_strdup ("");
+    g_ptr_array_add (strings, str);
+    return str;
+}
+
+static gboolean
+is_journal (const char *contents, gsize length)
+{
+    return length >= XACC_LOG_JOURNAL_MAGIC_LEN &&
+        memcmp (contents, XACC_LOG_JOURNAL_MAGIC, XACC_LOG_JOURNAL_MAGIC_LEN) == 0;
+}
+
+gboolean
+xaccLogIsJournal (const char *path)
+{
+    char magic[XACC_LOG_JOURNAL_MAGIC_LEN];
+    gboolean result = FALSE;
+    FILE *file = g_fopen (path, "rb");
+
+    if (!file) return FALSE;
+    if (fread (magic, 1, sizeof magic, file) == sizeof magic)
+        result = is_journal (magic, sizeof magic);
+    fclose (file);
+    return result;
+}
+
+gboolean
+xaccLogReadJournal (const char *path, XaccLogTransCB callback, gpointer data)
+{
+    GError *error = NULL;
+    GMappedFile *file;
+    const char *contents;
+    gsize length;
+    JournalReader reader;
+    GPtrArray *strings;
+    GArray *splits;
+
+    g_return_val_if_fail (path && callback, FALSE);
+
+    file = g_mapped_file_new (path, FALSE, &error);
+    if (!file)
+    {
+        PWARN ("Cannot open the transaction journal %s: %s", path, error->message);
+        g_error_free (error);
+        return FALSE;
+    }
+    contents = g_mapped_file_get_contents (file);
+    length = g_mapped_file_get_length (file);
+    if (!contents || !is_journal (contents, length))
+    {
+        g_mapped_file_unref (file);
+        return FALSE;
+    }
+
+    reader.pos = (const guint8 *)contents + XACC_LOG_JOURNAL_MAGIC_LEN;
+    reader.end = (const guint8 *)contents + length;
+    reader.ok = TRUE;
+    strings = g_ptr_array_new_with_free_func (g_free);
+    splits = g_array_new (FALSE, FALSE, sizeof (XaccLogSplit));
+
+    while (reader.pos < reader.end)
+    {
+        JournalReader payload;
+        XaccLogTrans record;
+        guint32 len, checksum, i;
+
+        len = get_u32 (&reader);
+        payload.pos = get_bytes (&reader, len);
+        checksum = get_u32 (&reader);
+        if (!reader.ok || checksum != journal_checksum (payload.pos, len))
+        {
+            PWARN ("The transaction journal %s ends with a damaged record", path);
+            break;
+        }
+        payload.end = payload.pos + len;
+        payload.ok = TRUE;
+
+        record.flag = get_u8 (&payload);
+        record.time_now = get_i64 (&payload);
+        record.date_entered = get_i64 (&payload);
+        record.date_posted = get_i64 (&payload);
+        get_guid (&payload, &record.guid);
+        record.num = get_string (&payload, strings);
+        record.description = get_string (&payload, strings);
+        record.notes = get_string (&payload, strings);
+        record.num_splits = get_u32 (&payload);
+
+        g_array_set_size (splits, 0);
+        for (i = 0; i < record.num_splits && payload.ok; i++)
+        {
+            XaccLogSplit split;
+
+            get_guid (&payload, &split.guid);
+            split.has_account = get_u8 (&payload) != 0;
+            split.account_name = "";
+            if (split.has_account)
+            {
+                get_guid (&payload, &split.account_guid);
+                split.account_name = get_string (&payload, strings);
+            }
+            split.memo = get_string (&payload, strings);
+            split.action = get_string (&payload, strings);
+            split.reconciled = get_u8 (&payload);
+            split.amount.num = get_i64 (&payload);
+            split.amount.denom = get_i64 (&payload);
+            split.value.num = get_i64 (&payload);
+            split.value.denom = get_i64 (&payload);
+            split.date_reconciled = get_i64 (&payload);
+            g_array_append_val (splits, split);
+        }
+        record.splits = (const XaccLogSplit *)splits->data;
+
+        if (!payload.ok)
+        {
+            PWARN ("The transaction journal %s holds a malformed record", path);
+            break;
+        }
+        if (!callback (&record, data))
+            break;
+        g_ptr_array_set_size (strings, 0);
+    }
+
+    g_array_free (splits, TRUE);
+    g_ptr_array_free (strings, TRUE);
+    g_mapped_file_unref (file);
+    return TRUE;
+}
+
+static gboolean
+write_text_record_cb (const XaccLogTrans *record, gpointer data)
+{
+    write_text_record (data, record);
+    return TRUE;
+}
+
+gboolean
+xaccLogJournalToText (const char *journal_path, const char *log_path)
+{
+    FILE *log;
+    gboolean result;
+
+    g_return_val_if_fail (journal_path && log_path, FALSE);
+
+    if (!xaccLogIsJournal (journal_path))
+        return FALSE;
+
+    log = g_fopen (log_path, "w");
+    if (!log)
+    {
+        PWARN ("Cannot open %s: %s", log_path, g_strerror (errno));
+        return FALSE;
+    }
+
+    write_text_header (log);
+    result = xaccLogReadJournal (journal_path, write_text_record_cb, log);
+    if (fclose (log) != 0)
+        result = FALSE;
+    return result;
 }
 
 /************************ END OF ************************************\
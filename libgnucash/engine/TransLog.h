@@ -75,6 +75,9 @@ void    xaccLogEnable (void);
 /** document me */
 void    xaccLogDisable (void);
 
+/** Returns TRUE unless logging was turned off with xaccLogDisable(). */
+gboolean xaccLogIsEnabled (void);
+
 /** The xaccLogSetBaseName() method sets the base filepath and the
  *    root part of the journal file name.  If the journal file is
  *    already open, it will close it and reopen it with the new
@@ -85,6 +88,92 @@ void    xaccLogSetBaseName (const char *);
 /** Test a filename to see if it is the name of the current logfile */
 gboolean xaccFileIsCurrentLog (const gchar *name);
 
+/** The xaccLogSetBinary() method selects the compact binary journal
+ *    format instead of tab-separated text for the log. Binary
+ *    journals are named like text logs but end in GNC_JOURNALFILE_EXT
+ *    instead of GNC_LOGFILE_EXT, and start with XACC_LOG_JOURNAL_MAGIC.
+ *    If the log is open in the other format, it is closed and reopened.
+ */
+void    xaccLogSetBinary (gboolean binary);
+
+/** The xaccLogSetFlushInterval() method sets how long, in
+ *    milliseconds, logged transactions may be held in memory so that
+ *    they are written to the disk together. With the default of 0
+ *    each one is written out as it is logged. Otherwise they are
+ *    written out when a transaction is logged after the interval has
+ *    passed since the oldest of them was, once 64 KiB of them are
+ *    held, or when the log is flushed or closed; a crash loses those
+ *    not yet written. Saving a session flushes the log, and so should
+ *    a timer running at the interval in a program with a main loop.
+ */
+void    xaccLogSetFlushInterval (guint msecs);
+
+/** The xaccLogSetSync() method sets whether every write to the log is
+ *    followed by an fsync, so that it survives a system crash too.
+ */
+void    xaccLogSetSync (gboolean sync);
+
+/** Write any logged transactions held in memory out to the log. */
+void    xaccLogFlush (void);
+
+#define XACC_LOG_JOURNAL_MAGIC "GNCJRNL1"
+#define XACC_LOG_JOURNAL_MAGIC_LEN 8
+
+/** A split as the binary journal records it. The strings are never
+ *  NULL. */
+typedef struct
+{
+    GncGUID guid;
+    gboolean has_account;
+    GncGUID account_guid;
+    const char *account_name;
+    const char *memo;
+    const char *action;
+    char reconciled;
+    gnc_numeric amount;
+    gnc_numeric value;
+    time64 date_reconciled;
+} XaccLogSplit;
+
+/** A transaction as the binary journal records it, with the flag it
+ *  was logged with. The strings are never NULL. */
+typedef struct
+{
+    char flag;
+    time64 time_now;
+    time64 date_entered;
+    time64 date_posted;
+    GncGUID guid;
+    const char *num;
+    const char *description;
+    const char *notes;
+    guint num_splits;
+    const XaccLogSplit *splits;
+} XaccLogTrans;
+
+/** Called for each transaction read from a binary journal. The record
+ *  is only valid during the call. Return FALSE to stop reading. */
+typedef gboolean (*XaccLogTransCB) (const XaccLogTrans *trans, gpointer data);
+
+/** Test whether the file at path is a binary journal. */
+gboolean xaccLogIsJournal (const char *path);
+
+/** Read the binary journal at path, calling callback for each
+ *  transaction in it. Reading stops at a record cut short or damaged
+ *  by a crash.
+ *
+ *  @return FALSE if the file cannot be read or isn't a binary journal.
+ */
+gboolean xaccLogReadJournal (const char *path, XaccLogTransCB callback,
+                             gpointer data);
+
+/** Write the binary journal at journal_path out as the tab-separated
+ *  text log at log_path that would have been logged instead.
+ *
+ *  @return FALSE if the journal cannot be read or the log written.
+ */
+gboolean xaccLogJournalToText (const char *journal_path, const char *log_path);
+
 #ifdef __cplusplus
 }
 #endif
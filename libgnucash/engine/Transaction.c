@@ -186,6 +186,9 @@ const char *doclink_uri_str = "assoc_uri"; // this is the old name for the docum
 
 #define ISO_DATELENGTH 32 /* length of an iso 8601 date string. */
 
+/* Book data key holding the number of the book's open transactions */
+#define OPEN_TRANS_COUNT "gnc-open-transactions"
+
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = GNC_MOD_ENGINE;
 
@@ -626,6 +629,72 @@ dupe_trans (const Transaction *from)
     return to;
 }
 
+/********************************************************************\
+ * Record the state of the transaction and its splits as an edit
+ * begins, so that xaccTransRollbackEdit can restore it.  Unlike
+ * dupe_trans nothing is cloned: only the slots that get changed
+ * during the edit are copied, when they are first changed.
+\********************************************************************/
+static TransUndo *
+trans_undo_new (Transaction *trans)
+{
+    TransUndo *undo;
+    SplitUndo *su;
+    GList *node;
+    guint num_splits = g_list_length (trans->splits);
+
+    undo = g_malloc (sizeof (TransUndo) + num_splits * sizeof (SplitUndo));
+    undo->num = CACHE_INSERT (trans->num);
+    undo->description = CACHE_INSERT (trans->description);
+    undo->date_entered = trans->date_entered;
+    undo->date_posted = trans->date_posted;
+    undo->common_currency = trans->common_currency;
+    undo->num_splits = num_splits;
+    undo->splits = (SplitUndo *) (undo + 1);
+
+    for (node = trans->splits, su = undo->splits; node; node = node->next, su++)
+    {
+        Split *s = node->data;
+
+        /* Hold the split: it may be freed before the edit ends. */
+        su->split = g_object_ref (s);
+        su->action = CACHE_INSERT (s->action);
+        su->memo = CACHE_INSERT (s->memo);
+        su->reconciled = s->reconciled;
+        su->date_reconciled = s->date_reconciled;
+        su->amount = s->amount;
+        su->value = s->value;
+        su->lot = s->lot;
+        su->gains_split = s->gains_split;
+        qof_instance_kvp_snapshot_begin (QOF_INSTANCE (s));
+    }
+    qof_instance_kvp_snapshot_begin (QOF_INSTANCE (trans));
+
+    return undo;
+}
+
+static void
+trans_undo_free (Transaction *trans, TransUndo *undo)
+{
+    guint i;
+
+    if (!undo) return;
+
+    for (i = 0; i < undo->num_splits; i++)
+    {
+        SplitUndo *su = &undo->splits[i];
+
+        qof_instance_kvp_snapshot_end (QOF_INSTANCE (su->split), FALSE);
+        CACHE_REMOVE (su->action);
+        CACHE_REMOVE (su->memo);
+        g_object_unref (su->split);
+    }
+    qof_instance_kvp_snapshot_end (QOF_INSTANCE (trans), FALSE);
+    CACHE_REMOVE (undo->num);
+    CACHE_REMOVE (undo->description);
+    g_free (undo);
+}
+
 /********************************************************************\
  * Use this routine to externally duplicate a transaction.  It creates
  * a full fledged transaction with unique guid, splits, etc. and
@@ -819,7 +888,7 @@ xaccFreeTransaction (Transaction *trans)
     trans->date_posted = 0;
     if (trans->orig)
     {
-        xaccFreeTransaction (trans->orig);
+        trans_undo_free (trans, trans->orig);
         trans->orig = NULL;
     }
 
@@ -1432,12 +1501,40 @@ xaccTransSetCurrency (Transaction *trans, gnc_commodity *curr)
 /********************************************************************\
 \********************************************************************/
 
+/* Every edit opened by xaccTransBeginEdit ends in exactly one of
+ * trans_cleanup_commit, xaccTransRollbackEdit or do_destroy, which
+ * take it back out of the count. */
+static void
+trans_count_open (Transaction *trans, gint delta)
+{
+    QofBook *book = qof_instance_get_book (trans);
+    gint count;
+
+    if (!book || qof_book_shutting_down (book))
+        return;
+
+    count = GPOINTER_TO_INT (qof_book_get_data (book, OPEN_TRANS_COUNT));
+    count = MAX (count + delta, 0);
+    qof_book_set_data (book, OPEN_TRANS_COUNT, GINT_TO_POINTER (count));
+}
+
+guint
+xaccTransCountOpen (const QofBook *book)
+{
+    if (!book || qof_book_shutting_down (book))
+        return 0;
+
+    return GPOINTER_TO_UINT (qof_book_get_data (book, OPEN_TRANS_COUNT));
+}
+
 void
 xaccTransBeginEdit (Transaction *trans)
 {
     if (!trans) return;
     if (!qof_begin_edit(&trans->inst)) return;
 
+    trans_count_open (trans, 1);
+
     if (qof_book_shutting_down(qof_instance_get_book(trans))) return;
 
     if (!qof_book_is_readonly(qof_instance_get_book(trans)))
@@ -1446,9 +1543,9 @@ xaccTransBeginEdit (Transaction *trans)
         xaccTransWriteLog (trans, 'B');
     }
 
-    /* Make a clone of the transaction; we will use this
+    /* Record the state of the transaction; we will use this
      * in case we need to roll-back the edit. */
-    trans->orig = dupe_trans (trans);
+    trans->orig = trans_undo_new (trans);
 }
 
 /********************************************************************\
@@ -1494,6 +1591,9 @@ do_destroy (Transaction *trans)
     SplitList *node;
     gboolean shutting_down = qof_book_shutting_down(qof_instance_get_book(trans));
 
+    if (qof_instance_get_editlevel (trans) > 0)
+        trans_count_open (trans, -1);
+
     /* If there are capital-gains transactions associated with this,
      * they need to be destroyed too unless we're shutting down in
      * which case all transactions will be destroyed. */
@@ -1613,10 +1713,10 @@ static void trans_cleanup_commit(Transaction *trans)
     if (!qof_book_is_readonly(qof_instance_get_book(trans)))
         xaccTransWriteLog (trans, 'C');
 
-    /* Get rid of the copy we made. We won't be rolling back,
+    /* Get rid of the state we recorded. We won't be rolling back,
      * so we don't need it any more.  */
     PINFO ("get rid of rollback trans=%p", trans->orig);
-    xaccFreeTransaction (trans->orig);
+    trans_undo_free (trans, trans->orig);
     trans->orig = NULL;
 
     /* Sort the splits. Why do we need to do this ?? */
@@ -1626,6 +1726,7 @@ static void trans_cleanup_commit(Transaction *trans)
     /* Put back to zero. */
     qof_instance_decrease_editlevel(trans);
     g_assert(qof_instance_get_editlevel(trans) == 0);
+    trans_count_open (trans, -1);
 
     gen_event_trans (trans); //TODO: could be conditional
     qof_event_gen (&trans->inst, QOF_EVENT_MODIFY, NULL);
@@ -1697,7 +1798,6 @@ xaccTransCommitEdit (Transaction *trans)
 }
 
 #define SWAP_STR(a, b) do { const char *tmp = (a); (a) = (b); (b) = tmp; } while (0);
-#define SWAP(a, b)     do { gpointer tmp = (a); (a) = (b); (b) = tmp; } while (0);
 
 /* Ughhh. The Rollback function is terribly complex, and, what's worse,
  * it only rolls back the basics.  The TransCommit functions did a bunch
@@ -1710,9 +1810,9 @@ xaccTransCommitEdit (Transaction *trans)
 void
 xaccTransRollbackEdit (Transaction *trans)
 {
-    GList *node, *onode;
+    GList *node;
     QofBackend *be;
-    Transaction *orig;
+    TransUndo *orig;
     GList *slist;
     int num_preexist, i;
 
@@ -1740,8 +1840,8 @@ xaccTransRollbackEdit (Transaction *trans)
     SWAP_STR(trans->description, orig->description);
     trans->date_entered = orig->date_entered;
     trans->date_posted = orig->date_posted;
-    SWAP(trans->common_currency, orig->common_currency);
-    qof_instance_swap_kvp (QOF_INSTANCE (trans), QOF_INSTANCE (orig));
+    trans->common_currency = orig->common_currency;
+    qof_instance_kvp_snapshot_end (QOF_INSTANCE (trans), TRUE);
 
     /* The splits at the front of trans->splits are exactly the same
        splits as in the original, but some of them may have changed, so
@@ -1749,25 +1849,29 @@ xaccTransRollbackEdit (Transaction *trans)
 /* FIXME: Runs off the transaction's splits, so deleted splits are not
  * restored!
  */
-    num_preexist = g_list_length(orig->splits);
+    num_preexist = orig->num_splits;
     slist = g_list_copy(trans->splits);
-    for (i = 0, node = slist, onode = orig->splits; node;
-            i++, node = node->next, onode = onode ? onode->next : NULL)
+    for (i = 0, node = slist; node; i++, node = node->next)
     {
         Split *s = node->data;
 
         if (!qof_instance_is_dirty(QOF_INSTANCE(s)))
             continue;
 
-        if (i < num_preexist && onode)
+        if (i < num_preexist)
         {
-            Split *so = onode->data;
+            SplitUndo *so = &orig->splits[i];
 
             xaccSplitRollbackEdit(s);
             SWAP_STR(s->action, so->action);
             SWAP_STR(s->memo, so->memo);
-            qof_instance_copy_kvp (QOF_INSTANCE (s), QOF_INSTANCE (so));
+            if (s == so->split)
+                qof_instance_kvp_snapshot_end (QOF_INSTANCE (s), TRUE);
+            else
+                qof_instance_copy_kvp_snapshot (QOF_INSTANCE (s),
+                                                QOF_INSTANCE (so->split));
             s->reconciled = so->reconciled;
+            if (s->lot) gnc_lot_set_closed_unknown (s->lot);
             s->amount = so->amount;
             s->value = so->value;
             s->lot = so->lot;
@@ -1802,11 +1906,14 @@ xaccTransRollbackEdit (Transaction *trans)
     }
     g_list_free(slist);
 
-    // orig->splits may still have duped splits so free them
-    for (node = orig->splits; node; node = node->next)
-        xaccFreeSplit(node->data);
-    g_list_free(orig->splits);
-    orig->splits = NULL;
+    /* The restored amounts, dates and currency change what the lots
+     * and the accounts' open lot indexes have cached. */
+    for (node = trans->splits; node; node = node->next)
+    {
+        Split *s = node->data;
+        if (s->lot)
+            gnc_lot_set_closed_unknown (s->lot);
+    }
 
     /* Now that the engine copy is back to its original version,
      * get the backend to fix it in the database */
@@ -1853,13 +1960,14 @@ xaccTransRollbackEdit (Transaction *trans)
     if (!qof_book_is_readonly(qof_instance_get_book(trans)))
         xaccTransWriteLog (trans, 'R');
 
-    xaccFreeTransaction (trans->orig);
+    trans_undo_free (trans, trans->orig);
 
     trans->orig = NULL;
     qof_instance_set_destroying(trans, FALSE);
 
     /* Put back to zero. */
     qof_instance_decrease_editlevel(trans);
+    trans_count_open (trans, -1);
     /* FIXME: The register code seems to depend on the engine to
        generate an event during rollback, even though the state is just
        reverting to what it was. */
@@ -2388,16 +2496,18 @@ xaccTransGetIsClosingTxn (const Transaction *trans)
 {
     if (!trans) return FALSE;
 
-    GValue v = G_VALUE_INIT;
-    gboolean rv;
-    qof_instance_get_kvp (QOF_INSTANCE (trans), &v, 1, trans_is_closing_str);
-    if (G_VALUE_HOLDS_INT64 (&v))
-        rv = (g_value_get_int64 (&v) ? 1 : 0);
-    else
-        rv = 0;
-    g_value_unset (&v);
+    /* Called for every split when an account's balances are recomputed,
+     * so it reads the cached slot rather than going through a GValue. */
+    return qof_instance_get_cached_int64 (QOF_INSTANCE (trans),
+                                          QOF_CACHED_SLOT_BOOK_CLOSING, 0) != 0;
+}
 
-    return rv;
+const char *
+xaccTransGetOnlineID (const Transaction *trans)
+{
+    if (!trans) return NULL;
+    return qof_instance_get_cached_string (QOF_INSTANCE (trans),
+                                           QOF_CACHED_SLOT_ONLINE_ID);
 }
 
 /********************************************************************\
@@ -3213,7 +3323,15 @@ gboolean xaccTransRegister (void)
             { NULL },
         };
 
+    /* Getters that only read the transaction, see qof_query_set_parallel */
+    static const char *threadsafe_params[] =
+    {
+        TRANS_NUM, TRANS_DESCRIPTION, TRANS_DATE_ENTERED, TRANS_DATE_POSTED,
+        TRANS_SPLITLIST, QOF_PARAM_BOOK, QOF_PARAM_GUID, NULL
+    };
+
     qof_class_register (GNC_ID_TRANS, (QofSortFunc)xaccTransOrder, params);
+    qof_class_set_params_threadsafe (GNC_ID_TRANS, threadsafe_params);
 
     return qof_object_register (&trans_object_def);
 }
@@ -3233,6 +3351,8 @@ _utest_trans_fill_functions (void)
     func->trans_cleanup_commit = trans_cleanup_commit;
     func->xaccTransScrubGainsDate = xaccTransScrubGainsDate;
     func->dupe_trans = dupe_trans;
+    func->trans_undo_new = trans_undo_new;
+    func->trans_undo_free = trans_undo_free;
     return func;
 }
 
@@ -359,6 +359,10 @@ void          xaccTransSetIsClosingTxn (Transaction *trans, gboolean is_closing)
 /** Returns whether this transaction is a "closing transaction" */
 gboolean      xaccTransGetIsClosingTxn (const Transaction *trans);
 
+/** Returns the online id that an importer stored with the transaction, or
+ * NULL. The string belongs to the transaction. */
+const char *  xaccTransGetOnlineID (const Transaction *trans);
+
 
 /** Add a split to the transaction
  *
@@ -67,6 +67,37 @@ extern "C" {
  * of the splits must always be kept zero.
  */
 
+/* The state of a split when its transaction's edit began, kept so
+ * that xaccTransRollbackEdit can put it back. */
+typedef struct
+{
+    Split *split;
+    const char *action;
+    const char *memo;
+    char reconciled;
+    time64 date_reconciled;
+    gnc_numeric amount;
+    gnc_numeric value;
+    GNCLot *lot;
+    Split *gains_split;
+} SplitUndo;
+
+/* The state of a transaction when its edit began. It is recorded in a
+ * single block: strings and splits are referenced rather than copied,
+ * and the slots of the transaction and of its splits are only copied
+ * if they change during the edit (see qof_instance_kvp_snapshot_begin).
+ */
+typedef struct
+{
+    const char *num;
+    const char *description;
+    time64 date_entered;
+    time64 date_posted;
+    gnc_commodity *common_currency;
+    guint num_splits;
+    SplitUndo *splits;
+} TransUndo;
+
 /* A split transaction is one which shows up as a credit (or debit) in
  * one account, and pieces of it show up as debits (or credits) in other
  * accounts.  Thus, a single credit-card transaction might be split
@@ -109,11 +140,11 @@ struct transaction_s
      * corresponding to the current traversal. */
     unsigned char  marker;
 
-    /* The orig pointer points at a copy of the original transaction,
-     * before editing was started.  This orig copy is used to rollback
-     * any changes made if/when the edit is abandoned.
+    /* The orig pointer points at the state of the transaction before
+     * editing was started.  It is used to rollback any changes made
+     * if/when the edit is abandoned.
      */
-    Transaction *orig;
+    TransUndo *orig;
 
     /* A flag to indicate when a transaction represents an invoice, a payment,
      * or a link between the two.
@@ -177,6 +208,11 @@ void xaccDisableDataScrubbing(void);
 void xaccTransRemoveSplit (Transaction *trans, const Split *split);
 void check_open (const Transaction *trans);
 
+/** The number of the book's transactions with an edit open. Splits
+ *  changed inside an open edit are only moved between the accounts'
+ *  split vectors when the edit is committed. */
+guint xaccTransCountOpen (const QofBook *book);
+
 /* Structure for accessing static functions for testing */
 typedef struct
 {
@@ -190,6 +226,8 @@ typedef struct
     void (*trans_cleanup_commit)(Transaction*);
     void (*xaccTransScrubGainsDate)(Transaction*);
     Transaction *(*dupe_trans)(const Transaction*);
+    TransUndo *(*trans_undo_new)(Transaction*);
+    void (*trans_undo_free)(Transaction*, TransUndo*);
 
 } TransTestFunctions;
 
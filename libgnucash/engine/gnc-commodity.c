@@ -36,6 +36,7 @@
 #include <qofinstance-p.h>
 
 #include "gnc-commodity.h"
+#include "gnc-pricedb-p.h"
 #include "gnc-locale-utils.h"
 #include "gnc-prefs.h"
 #include "guid.h"
@@ -933,6 +934,7 @@ commodity_free(gnc_commodity * cm)
     book = qof_instance_get_book(&cm->inst);
     table = gnc_commodity_table_get_table(book);
     gnc_commodity_table_remove(table, cm);
+    gnc_pricedb_forget_commodity(gnc_pricedb_get_db(book), cm);
     priv = GET_PRIVATE(cm);
 
     qof_event_gen (&cm->inst, QOF_EVENT_DESTROY, NULL);
@@ -1988,6 +1990,8 @@ gnc_commodity_table_remove(gnc_commodity_table * table,
     if (c != comm) return;
 
     qof_event_gen (&comm->inst, QOF_EVENT_REMOVE, NULL);
+    gnc_pricedb_forget_commodity(gnc_pricedb_get_db(qof_instance_get_book(comm)),
+                                 comm);
 
     nsp = gnc_commodity_table_find_namespace(table, ns_name);
     if (!nsp) return;
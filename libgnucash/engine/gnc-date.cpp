@@ -113,6 +113,8 @@ gnc_localtime (const time64 *secs)
 struct tm*
 gnc_localtime_r (const time64 *secs, struct tm* time)
 {
+    if (GncDateTime::local_tm (*secs, *time))
+        return time;
     try
     {
         *time = static_cast<struct tm>(GncDateTime(*secs));
@@ -574,11 +576,44 @@ qof_print_date_dmy_buff (char * buff, const size_t len, int day, int month, int
     return strlen(buff);
 }
 
+/* The numeric formats come out the same in every locale, so there's no
+ * need for a GncDateTime and its stream facets to print them.
+ */
+static gboolean
+print_numeric_date (char *buff, const size_t len, const struct tm *tm,
+                    QofDateFormat which_format)
+{
+    int year = tm->tm_year + 1900, month = tm->tm_mon + 1, day = tm->tm_mday;
+
+    switch (which_format)
+    {
+    case QOF_DATE_FORMAT_US:
+        snprintf (buff, len, "%02d/%02d/%04d", month, day, year);
+        return TRUE;
+    case QOF_DATE_FORMAT_UK:
+        snprintf (buff, len, "%02d/%02d/%04d", day, month, year);
+        return TRUE;
+    case QOF_DATE_FORMAT_CE:
+        snprintf (buff, len, "%02d.%02d.%04d", day, month, year);
+        return TRUE;
+    case QOF_DATE_FORMAT_ISO:
+        snprintf (buff, len, "%04d-%02d-%02d", year, month, day);
+        return TRUE;
+    default:
+        return FALSE;
+    }
+}
+
 size_t
 qof_print_date_buff (char * buff, const size_t len, time64 t)
 {
     if (!buff) return 0;
 
+    struct tm tm;
+    if (len && GncDateTime::local_tm (t, tm) &&
+        print_numeric_date (buff, len, &tm, dateFormat))
+        return strlen(buff);
+
     try
     {
         GncDateTime gncdt(t);
@@ -656,6 +691,68 @@ normalize_format (const std::string& format)
     return normalized;
 }
 
+/* Reads the complete numeric dates that are nearly always typed or
+   imported: three fields of digits separated by single delimiters, with
+   a year of at least three digits. That takes none of
+   qof_scan_date_internal's copying, tokenizing or finding today's date;
+   anything else, including fields out of range, gets the full treatment.
+*/
+static gboolean
+scan_numeric_date (const char *buff, int *day, int *month, int *year,
+                   QofDateFormat which_format)
+{
+    int fields[3];
+    const char *p = buff;
+
+    for (int i = 0; i < 3; ++i)
+    {
+        int ndigits = 0;
+        if (i > 0)
+        {
+            if (*p == '\0' || !strchr (".,-+/\\() ", *p))
+                return FALSE;
+            ++p;
+        }
+        fields[i] = 0;
+        for (; g_ascii_isdigit (*p) && ndigits < 9; ++p, ++ndigits)
+            fields[i] = fields[i] * 10 + (*p - '0');
+        if (!ndigits)
+            return FALSE;
+    }
+    if (*p != '\0')
+        return FALSE;
+
+    int iday, imonth, iyear;
+    switch (which_format)
+    {
+    case QOF_DATE_FORMAT_UK:
+    case QOF_DATE_FORMAT_CE:
+        iday = fields[0];
+        imonth = fields[1];
+        iyear = fields[2];
+        break;
+    case QOF_DATE_FORMAT_ISO:
+        iyear = fields[0];
+        imonth = fields[1];
+        iday = fields[2];
+        break;
+    case QOF_DATE_FORMAT_US:
+        imonth = fields[0];
+        iday = fields[1];
+        iyear = fields[2];
+        break;
+    default:
+        return FALSE;
+    }
+    if (imonth < 1 || imonth > 12 || iday < 1 || iday > 31 || iyear < 100)
+        return FALSE;
+
+    if (year) *year = iyear;
+    if (month) *month = imonth;
+    if (day) *day = iday;
+    return TRUE;
+}
+
 /* Convert a string into  day, month and year integers
 
     Convert a string into  day / month / year integers according to
@@ -690,6 +787,9 @@ qof_scan_date_internal (const char *buff, int *day, int *month, int *year,
 
     if (!buff) return(FALSE);
 
+    if (scan_numeric_date (buff, day, month, year, which_format))
+        return TRUE;
+
     if (which_format == QOF_DATE_FORMAT_UTC)
     {
         if (strptime(buff, QOF_UTC_DATE_FORMAT, &utc)
@@ -1117,6 +1217,9 @@ time64
 gnc_iso8601_to_time64_gmt(const char *cstr)
 {
     if (!cstr) return INT64_MAX;
+    time64 time;
+    if (GncDateTime::parse_iso8601 (cstr, time))
+        return time;
     try
     {
         GncDateTime gncdt(cstr);
@@ -1141,6 +1244,8 @@ char *
 gnc_time64_to_iso8601_buff (time64 time, char * buff)
 {
     if (! buff) return NULL;
+    if (auto end = GncDateTime::format_iso8601 (time, buff))
+        return end;
     try
     {
         GncDateTime gncdt(time);
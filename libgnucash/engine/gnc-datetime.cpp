@@ -31,11 +31,13 @@
 #include <boost/regex.hpp>
 #include <libintl.h>
 #include <locale.h>
+#include <atomic>
 #include <map>
 #include <memory>
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #ifdef __MINGW32__
 #include <codecvt>
@@ -58,6 +60,9 @@ using time64 = int64_t;
 
 static const TimeZoneProvider ltzp;
 static const TimeZoneProvider* tzp = &ltzp;
+/* Changed with tzp so that the per-thread caches of zone offsets notice
+ * a new provider even if it reuses an old one's address. */
+static std::atomic<unsigned> tzp_generation{0};
 
 // For converting to/from POSIX time.
 static const PTime unix_epoch (Date(1970, boost::gregorian::Jan, 1),
@@ -267,12 +272,14 @@ void
 _set_tzp(TimeZoneProvider& new_tzp)
 {
     tzp = &new_tzp;
+    ++tzp_generation;
 }
 
 void
 _reset_tzp()
 {
     tzp = &ltzp;
+    ++tzp_generation;
 }
 
 class GncDateTimeImpl
@@ -555,6 +562,171 @@ GncDateTimeImpl::timestamp()
     return str.substr(0, 8) + str.substr(9, 15);
 }
 
+/* Fast paths for the conversions done for every transaction and price
+ * that is loaded, saved, logged or displayed. They do plain arithmetic on
+ * the calendar instead of going through local_date_time and the stream
+ * facets, and leave anything unusual to the general code above.
+ */
+static constexpr int64_t seconds_per_day = 24 * 60 * 60;
+
+/* Days from 1970-01-01 to a date of the proleptic Gregorian calendar that
+ * boost::gregorian uses, and back; from Howard Hinnant's chrono-compatible
+ * date algorithms.
+ */
+static constexpr int64_t
+days_from_civil(int64_t year, unsigned month, unsigned day) noexcept
+{
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(year - era * 400);
+    const unsigned doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+static void
+civil_from_days(int64_t days, int& year, unsigned& month, unsigned& day) noexcept
+{
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(days - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    day = doy - (153 * mp + 2) / 5 + 1;
+    month = mp < 10 ? mp + 3 : mp - 9;
+    year = static_cast<int>(yoe + era * 400 + (month <= 2));
+}
+
+static constexpr int fast_min_year = 1400;
+static constexpr int fast_max_year = 9999;
+static constexpr time64 fast_min_time = days_from_civil(fast_min_year, 1, 1) * seconds_per_day;
+static constexpr time64 fast_end_time = days_from_civil(fast_max_year + 1, 1, 1) * seconds_per_day;
+
+static inline int64_t
+floor_div(int64_t num, int64_t den) noexcept
+{
+    auto quot = num / den;
+    return quot * den > num ? quot - 1 : quot;
+}
+
+static unsigned
+days_in_month(int year, unsigned month) noexcept
+{
+    static const unsigned days[] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0))
+        return 29;
+    return days[month - 1];
+}
+
+/* The offsets of the zone that tzp->get() selects for a UTC year.
+ *
+ * local_date_time decides whether DST is in effect on the standard local
+ * time: from the local start of DST until the DST offset before its
+ * local end, which is in daylight time. Both are kept here converted to
+ * standard local time for the years before, of and after the UTC year,
+ * as that's where the standard local time can fall. In the southern
+ * hemisphere DST starts late in a year and ends early in it.
+ */
+struct ZoneYear
+{
+    bool usable;
+    bool has_dst;
+    time64 std_offset;
+    time64 dst_offset;
+    time64 dst_start[3];
+    time64 dst_end[3];
+};
+
+static time64
+seconds_from_epoch(const PTime& ptime)
+{
+    return (ptime - unix_epoch).total_seconds();
+}
+
+static ZoneYear
+make_zone_year(int utc_year)
+{
+    ZoneYear zy{};
+    auto tz = tzp->get(utc_year);
+    if (!tz)
+        return zy;
+    zy.std_offset = tz->base_utc_offset().total_seconds();
+    zy.has_dst = tz->has_dst();
+    if (zy.has_dst)
+    {
+        zy.dst_offset = tz->dst_offset().total_seconds();
+        for (int i = 0; i < 3; ++i)
+        {
+            auto year = utc_year + i - 1;
+            auto start = tz->dst_local_start_time(year);
+            auto end = tz->dst_local_end_time(year);
+            /* local_date_time treats a start and end on the same day
+             * specially; leave such zones to it. */
+            if (start.date() == end.date())
+                return zy;
+            zy.dst_start[i] = seconds_from_epoch(start);
+            zy.dst_end[i] = seconds_from_epoch(end) - zy.dst_offset;
+        }
+    }
+    zy.usable = true;
+    return zy;
+}
+
+static const ZoneYear*
+zone_year(int utc_year) noexcept
+{
+    thread_local unsigned cache_generation = 0;
+    thread_local std::unordered_map<int, ZoneYear> cache;
+    try
+    {
+        auto generation = tzp_generation.load(std::memory_order_relaxed);
+        if (generation != cache_generation)
+        {
+            cache.clear();
+            cache_generation = generation;
+        }
+        auto iter = cache.find(utc_year);
+        if (iter == cache.end())
+            iter = cache.emplace(utc_year, make_zone_year(utc_year)).first;
+        return iter->second.usable ? &iter->second : nullptr;
+    }
+    catch (const std::exception&)
+    {
+        return nullptr;
+    }
+}
+
+static inline char*
+write_digits(char* buff, unsigned value, int ndigits) noexcept
+{
+    for (int i = ndigits - 1; i >= 0; --i, value /= 10)
+        buff[i] = '0' + value % 10;
+    return buff + ndigits;
+}
+
+static inline bool
+read_digits(const char*& str, int ndigits, int& value) noexcept
+{
+    value = 0;
+    for (int i = 0; i < ndigits; ++i, ++str)
+    {
+        if (*str < '0' || *str > '9')
+            return false;
+        value = value * 10 + (*str - '0');
+    }
+    return true;
+}
+
+static inline bool
+read_char(const char*& str, char c) noexcept
+{
+    if (*str != c)
+        return false;
+    ++str;
+    return true;
+}
+
 /* Member function definitions for GncDateImpl.
  */
 GncDateImpl::GncDateImpl(const std::string str, const std::string fmt) :
@@ -698,6 +870,137 @@ GncDateTime::timestamp()
     return GncDateTimeImpl::timestamp();
 }
 
+bool
+GncDateTime::local_tm(time64 time, struct tm& tm) noexcept
+{
+    if (time < fast_min_time || time >= fast_end_time)
+        return false;
+    int year;
+    unsigned month, day;
+    civil_from_days(floor_div(time, seconds_per_day), year, month, day);
+    auto zone = zone_year(year);
+    if (!zone)
+        return false;
+
+    auto offset = zone->std_offset;
+    bool is_dst = false;
+    if (zone->has_dst)
+    {
+        auto std_time = time + zone->std_offset;
+        int std_year;
+        civil_from_days(floor_div(std_time, seconds_per_day), std_year, month, day);
+        auto index = std_year - year + 1;
+        if (index < 0 || index > 2)
+            return false;
+        auto start = zone->dst_start[index], end = zone->dst_end[index];
+        is_dst = start < end ? std_time >= start && std_time < end :
+            std_time >= start || std_time < end;
+        if (is_dst)
+            offset += zone->dst_offset;
+    }
+
+    auto local = time + offset;
+    auto days = floor_div(local, seconds_per_day);
+    civil_from_days(days, year, month, day);
+    if (year < fast_min_year || year > fast_max_year)
+        return false;
+    auto secs = static_cast<int>(local - days * seconds_per_day);
+
+    memset(&tm, 0, sizeof(tm));
+    tm.tm_year = year - 1900;
+    tm.tm_mon = month - 1;
+    tm.tm_mday = day;
+    tm.tm_hour = secs / 3600;
+    tm.tm_min = secs / 60 % 60;
+    tm.tm_sec = secs % 60;
+    tm.tm_wday = static_cast<int>(days - floor_div(days + 4, 7) * 7 + 4); // 1970-01-01 was a Thursday
+    tm.tm_yday = static_cast<int>(days - days_from_civil(year, 1, 1));
+    tm.tm_isdst = is_dst;
+#if HAVE_STRUCT_TM_GMTOFF
+    tm.tm_gmtoff = offset;
+#endif
+    return true;
+}
+
+char*
+GncDateTime::format_iso8601(time64 time, char* buff) noexcept
+{
+    if (time < fast_min_time || time >= fast_end_time)
+        return nullptr;
+    int year;
+    unsigned month, day;
+    auto days = floor_div(time, seconds_per_day);
+    auto secs = static_cast<unsigned>(time - days * seconds_per_day);
+    civil_from_days(days, year, month, day);
+
+    auto p = write_digits(buff, year, 4);
+    *p++ = '-';
+    p = write_digits(p, month, 2);
+    *p++ = '-';
+    p = write_digits(p, day, 2);
+    *p++ = ' ';
+    p = write_digits(p, secs / 3600, 2);
+    *p++ = ':';
+    p = write_digits(p, secs / 60 % 60, 2);
+    *p++ = ':';
+    p = write_digits(p, secs % 60, 2);
+    *p = '\0';
+    return p;
+}
+
+bool
+GncDateTime::parse_iso8601(const char* str, time64& time) noexcept
+{
+    if (!str)
+        return false;
+    int year, month, day, hour, minute, second;
+    if (!read_digits(str, 4, year))
+        return false;
+    if (*str == '-')
+    {
+        if (!(read_char(str, '-') && read_digits(str, 2, month) &&
+              read_char(str, '-') && read_digits(str, 2, day) &&
+              read_char(str, ' ') && read_digits(str, 2, hour) &&
+              read_char(str, ':') && read_digits(str, 2, minute) &&
+              read_char(str, ':') && read_digits(str, 2, second)))
+            return false;
+    }
+    else if (!(read_digits(str, 2, month) && read_digits(str, 2, day) &&
+               read_digits(str, 2, hour) && read_digits(str, 2, minute) &&
+               read_digits(str, 2, second)))
+        return false;
+
+    while (*str == ' ' || (*str >= '\t' && *str <= '\r'))
+        ++str;
+    int64_t zone_secs = 0;
+    if (*str == '+' || *str == '-')
+    {
+        auto sign = *str++ == '-' ? -1 : 1;
+        int zone_hours, zone_minutes = 0;
+        if (!read_digits(str, 2, zone_hours))
+            return false;
+        if (read_char(str, ':') || *str)
+            if (!read_digits(str, 2, zone_minutes))
+                return false;
+        if (zone_hours > 23 || zone_minutes > 59)
+            return false;
+        zone_secs = sign * (zone_hours * 3600 + zone_minutes * 60);
+    }
+    if (*str)
+        return false;
+
+    if (year < fast_min_year || month < 1 || month > 12 || day < 1 ||
+        static_cast<unsigned>(day) > days_in_month(year, month) ||
+        hour > 23 || minute > 59 || second > 59)
+        return false;
+    auto utc = days_from_civil(year, month, day) * seconds_per_day +
+        hour * 3600 + minute * 60 + second - zone_secs;
+    if (utc < fast_min_time || utc >= fast_end_time)
+        return false;
+    time = utc;
+    return true;
+}
+
 /* GncDate */
 GncDate::GncDate() : m_impl{new GncDateImpl} {}
 GncDate::GncDate(int year, int month, int day) :
@@ -156,7 +156,29 @@ public:
  *  @return a std::string in the format YYYYMMDDHHMMSS.
  */
     static std::string timestamp();
-    
+/** Fill a struct tm with the local time as casting a GncDateTime to one
+ *  does, but without constructing it or its time zone. The zone's offsets
+ *  are cached for each year.
+ *  @return false, leaving tm unchanged, if the time is outside the years
+ *  1400-9999 or the zone's rules are unusual; fall back on the cast then.
+ */
+    static bool local_tm(time64 time, struct tm& tm) noexcept;
+/** Write a time as format_iso8601() does, followed by a NUL, without
+ *  constructing a GncDateTime.
+ *  @param buff A buffer of at least 20 chars.
+ *  @return A pointer to the NUL, or nullptr if the time is outside the
+ *  years 1400-9999.
+ */
+    static char* format_iso8601(time64 time, char* buff) noexcept;
+/** Read a string of the form YYYY-MM-DD HH:MM:SS or YYYYMMDDHHMMSS with
+ *  an optional +HH, +HHMM or +HH:MM offset without constructing a
+ *  GncDateTime, giving the same time as the string constructor would.
+ *  @return false if the string has fractional seconds or is otherwise
+ *  not of that form, or a field is out of range. The string constructor
+ *  may still accept it.
+ */
+    static bool parse_iso8601(const char* str, time64& time) noexcept;
+
 private:
     std::unique_ptr<GncDateTimeImpl> m_impl;
 };
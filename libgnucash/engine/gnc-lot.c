@@ -95,6 +95,11 @@ typedef struct GNCLotPrivate
     signed char is_closed;
 #define LOT_CLOSED_UNKNOWN (-1)
 
+    /* Sum of the split amounts, kept up to date as splits are added
+     * and removed. Only valid while balance_valid is set. */
+    gnc_numeric balance;
+    gboolean balance_valid;
+
     /* traversal marker, handy for preventing recursion */
     unsigned char marker;
 } GNCLotPrivate;
@@ -119,6 +124,8 @@ gnc_lot_init(GNCLot* lot)
     priv->splits = NULL;
     priv->cached_invoice = NULL;
     priv->is_closed = LOT_CLOSED_UNKNOWN;
+    priv->balance = gnc_numeric_zero();
+    priv->balance_valid = TRUE;
     priv->marker = 0;
 }
 
@@ -418,7 +425,29 @@ gnc_lot_set_closed_unknown(GNCLot* lot)
     {
         priv = GET_PRIVATE(lot);
         priv->is_closed = LOT_CLOSED_UNKNOWN;
+        priv->balance_valid = FALSE;
+        if (priv->account)
+            gnc_account_lot_changed (priv->account, lot);
+    }
+}
+
+/* Adjust the cached balance by the amount of a split entering (or
+ * leaving) the lot, and let the account re-file the lot. */
+static void
+gnc_lot_adjust_balance (GNCLot *lot, gnc_numeric amount, gboolean add)
+{
+    GNCLotPrivate* priv = GET_PRIVATE(lot);
+
+    priv->is_closed = LOT_CLOSED_UNKNOWN;
+    if (priv->balance_valid)
+    {
+        priv->balance = add ? gnc_numeric_add_fixed (priv->balance, amount)
+                        : gnc_numeric_sub_fixed (priv->balance, amount);
+        if (gnc_numeric_check (priv->balance) != GNC_ERROR_OK)
+            priv->balance_valid = FALSE;
     }
+    if (priv->account)
+        gnc_account_lot_changed (priv->account, lot);
 }
 
 SplitList *
@@ -514,15 +543,24 @@ gnc_lot_get_balance (GNCLot *lot)
         return zero;
     }
 
-    /* Sum over splits; because they all belong to same account
-     * they will have same denominator.
-     */
-    for (node = priv->splits; node; node = node->next)
+    if (priv->balance_valid)
     {
-        Split *s = node->data;
-        gnc_numeric amt = xaccSplitGetAmount (s);
-        baln = gnc_numeric_add_fixed (baln, amt);
-        g_assert (gnc_numeric_check (baln) == GNC_ERROR_OK);
+        baln = priv->balance;
+    }
+    else
+    {
+        /* Sum over splits; because they all belong to same account
+         * they will have same denominator.
+         */
+        for (node = priv->splits; node; node = node->next)
+        {
+            Split *s = node->data;
+            gnc_numeric amt = xaccSplitGetAmount (s);
+            baln = gnc_numeric_add_fixed (baln, amt);
+            g_assert (gnc_numeric_check (baln) == GNC_ERROR_OK);
+        }
+        priv->balance = baln;
+        priv->balance_valid = TRUE;
     }
 
     /* cache a zero balance as a closed lot */
@@ -635,7 +673,7 @@ gnc_lot_add_split (GNCLot *lot, Split *split)
     priv->splits = g_list_append (priv->splits, split);
 
     /* for recomputation of is-closed */
-    priv->is_closed = LOT_CLOSED_UNKNOWN;
+    gnc_lot_adjust_balance (lot, split->amount, TRUE);
     gnc_lot_commit_edit(lot);
 
     qof_event_gen (QOF_INSTANCE(lot), QOF_EVENT_MODIFY, NULL);
@@ -646,15 +684,21 @@ void
 gnc_lot_remove_split (GNCLot *lot, Split *split)
 {
     GNCLotPrivate* priv;
+    GList *node;
     if (!lot || !split) return;
     priv = GET_PRIVATE(lot);
 
     ENTER ("(lot=%p, split=%p)", lot, split);
     gnc_lot_begin_edit(lot);
     qof_instance_set_dirty(QOF_INSTANCE(lot));
-    priv->splits = g_list_remove (priv->splits, split);
+    node = g_list_find (priv->splits, split);
+    if (node)
+    {
+        priv->splits = g_list_delete_link (priv->splits, node);
+        /* force an is-closed computation */
+        gnc_lot_adjust_balance (lot, split->amount, FALSE);
+    }
     xaccSplitSetLot(split, NULL);
-    priv->is_closed = LOT_CLOSED_UNKNOWN;   /* force an is-closed computation */
 
     if (NULL == priv->splits)
     {
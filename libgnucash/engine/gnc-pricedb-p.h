@@ -60,8 +60,12 @@ struct gnc_price_db_s
 {
     QofInstance inst;              /* globally unique object identifier */
     GHashTable *commodity_hash;
+    GHashTable *price_series;    /* commodity -> commodity -> GPtrArray */
+    GHashTable *conversion_cache;      /* memoized get_nearest_price */
+    GHashTable *conversion_generation; /* commodity -> generation */
     gboolean bulk_update;		 /* TRUE while reading XML file, etc. */
     gboolean reset_nth_price_cache;
+    GHashTable *nth_price_cache; /* commodity -> GPtrArray, see nth_price_array */
 };
 
 struct _GncPriceDBClass
@@ -95,6 +99,11 @@ void     gnc_pricedb_substitute_commodity(GNCPriceDB *db,
         gnc_commodity *old_c,
         gnc_commodity *new_c);
 
+/** Drop what the price database memoized for a commodity that is being
+ *  removed or destroyed. Those caches are keyed by the commodity's address,
+ *  which a commodity allocated later could reuse. */
+void     gnc_pricedb_forget_commodity(GNCPriceDB *db, const gnc_commodity *c);
+
 /** register the pricedb object with the gncObject system */
 gboolean gnc_pricedb_register (void);
 
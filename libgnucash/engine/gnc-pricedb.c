@@ -44,6 +44,7 @@ static gboolean
 pricedb_pricelist_traversal(GNCPriceDB *db,
                             gboolean (*f)(GList *p, gpointer user_data),
                             gpointer user_data);
+static void pricedb_conversions_changed(GNCPriceDB *db, GNCPrice *p);
 
 enum
 {
@@ -575,6 +576,8 @@ gnc_price_set_value(GNCPrice *p, gnc_numeric value)
         p->value = value;
         gnc_price_set_dirty(p);
         gnc_price_commit_edit (p);
+        if (p->db)
+            pricedb_conversions_changed (p->db, p);
     }
 }
 
@@ -823,6 +826,294 @@ gnc_price_list_equal(PriceList *prices1, PriceList *prices2)
     return TRUE;
 }
 
+/* ==================================================================== */
+/* price series functions
+
+   A price series holds every price between two commodities, quoted in
+   either direction, in a GPtrArray sorted like the price lists: newest
+   first by compare_prices_by_date.  It is the merge of the two price
+   lists that pricedb_get_prices_internal would build for the pair, but
+   kept up to date by add_price and remove_price so that the point
+   lookups can binary search it.  The series doesn't hold references;
+   the price lists do.
+ */
+
+/* The series of a pair is filed under the commodity with the lower
+ * address, then the other one, so both orders find the same series. */
+static GPtrArray *
+pricedb_get_series (GNCPriceDB *db, const gnc_commodity *a,
+                    const gnc_commodity *b, gboolean create)
+{
+    GHashTable *inner;
+    GPtrArray *series;
+
+    if (!db->price_series) return NULL;
+    if (GPOINTER_TO_SIZE (a) > GPOINTER_TO_SIZE (b))
+    {
+        const gnc_commodity *tmp = a;
+        a = b;
+        b = tmp;
+    }
+
+    inner = g_hash_table_lookup (db->price_series, a);
+    if (!inner)
+    {
+        if (!create) return NULL;
+        inner = g_hash_table_new (NULL, NULL);
+        g_hash_table_insert (db->price_series, (gpointer)a, inner);
+    }
+
+    series = g_hash_table_lookup (inner, b);
+    if (!series && create)
+    {
+        series = g_ptr_array_new ();
+        g_hash_table_insert (inner, (gpointer)b, series);
+    }
+    return series;
+}
+
+/* Index of the first price in the series that is not newer than t,
+ * or the length of the series if all of them are. */
+static guint
+price_series_first_not_after (GPtrArray *series, time64 t)
+{
+    guint lo = 0, hi = series->len;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        if (gnc_price_get_time64 (g_ptr_array_index (series, mid)) > t)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Index at which g_list_insert_sorted would place p in the price list. */
+static guint
+price_series_insert_pos (GPtrArray *series, GNCPrice *p)
+{
+    guint lo = 0, hi = series->len;
+
+    while (lo < hi)
+    {
+        guint mid = lo + (hi - lo) / 2;
+        if (compare_prices_by_date (g_ptr_array_index (series, mid), p) < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/* Same test as price_list_is_duplicate, but only looking at the prices
+ * of the series that are close enough in time to be on the same day. */
+static gboolean
+price_series_has_duplicate (GPtrArray *series, GNCPrice *p)
+{
+    const time64 window = 2 * 24 * 60 * 60;
+    PriceListIsDuplStruct dupl = { p, FALSE };
+    time64 t = gnc_price_get_time64 (p);
+    guint i;
+
+    for (i = price_series_first_not_after (series, t + window);
+         i < series->len && !dupl.isDupl; ++i)
+    {
+        GNCPrice *other = g_ptr_array_index (series, i);
+        if (gnc_price_get_time64 (other) < t - window)
+            break;
+        price_list_is_duplicate (other, &dupl);
+    }
+    return dupl.isDupl;
+}
+
+static void
+price_series_insert (GPtrArray *series, GNCPrice *p)
+{
+    g_ptr_array_insert (series, price_series_insert_pos (series, p), p);
+}
+
+static void
+price_series_remove (GNCPriceDB *db, GNCPrice *p)
+{
+    GPtrArray *series = pricedb_get_series (db, p->commodity, p->currency,
+                                            FALSE);
+    guint pos;
+
+    if (!series) return;
+    /* The price's sort keys are normally unchanged since it was
+     * inserted; fall back to a linear search in case they aren't. */
+    pos = price_series_insert_pos (series, p);
+    if (pos >= series->len || g_ptr_array_index (series, pos) != p)
+    {
+        if (!g_ptr_array_remove (series, p))
+            return;
+    }
+    else
+        g_ptr_array_remove_index (series, pos);
+
+    if (series->len == 0)
+    {
+        const gnc_commodity *a = p->commodity, *b = p->currency;
+        GHashTable *inner;
+        if (GPOINTER_TO_SIZE (a) > GPOINTER_TO_SIZE (b))
+        {
+            a = p->currency;
+            b = p->commodity;
+        }
+        inner = g_hash_table_lookup (db->price_series, a);
+        g_hash_table_remove (inner, b);
+        g_ptr_array_free (series, TRUE);
+        if (g_hash_table_size (inner) == 0)
+        {
+            g_hash_table_remove (db->price_series, a);
+            g_hash_table_destroy (inner);
+        }
+    }
+}
+
+static void
+destroy_price_series_inner (gpointer key, gpointer data, gpointer user_data)
+{
+    g_ptr_array_free ((GPtrArray *) data, TRUE);
+}
+
+static void
+destroy_price_series (gpointer key, gpointer data, gpointer user_data)
+{
+    GHashTable *inner = (GHashTable *) data;
+    g_hash_table_foreach (inner, destroy_price_series_inner, NULL);
+    g_hash_table_destroy (inner);
+}
+
+/* ==================================================================== */
+/* conversion cache
+
+   get_nearest_price results are memoized per (from, to, time, kind of
+   lookup); reports ask for the same conversions at the same report
+   dates over and over.  A conversion only looks at prices that have
+   from or to as one of their two commodities, either directly or as
+   one leg of a one-hop route, so each commodity carries a generation
+   number that is bumped whenever a price involving it is added,
+   removed or revalued.  An entry is only used while both generations
+   it was computed with are current.
+ */
+
+/* Drop the whole cache rather than track ages once it gets this big. */
+#define PRICE_CONVERSION_CACHE_MAX 65536
+
+typedef struct
+{
+    const gnc_commodity *from;
+    const gnc_commodity *to;
+    time64 t;
+    gboolean before_date;
+} PriceConversionKey;
+
+typedef struct
+{
+    PriceConversionKey key;
+    gnc_numeric price;
+    guint from_generation;
+    guint to_generation;
+} PriceConversion;
+
+static guint
+price_conversion_hash (gconstpointer data)
+{
+    const PriceConversionKey *key = data;
+    guint hash = g_direct_hash (key->from);
+    hash = hash * 31 + g_direct_hash (key->to);
+    hash = hash * 31 + g_int64_hash (&key->t);
+    return hash * 31 + key->before_date;
+}
+
+static gboolean
+price_conversion_equal (gconstpointer a, gconstpointer b)
+{
+    const PriceConversionKey *ka = a, *kb = b;
+    return ka->from == kb->from && ka->to == kb->to && ka->t == kb->t &&
+        ka->before_date == kb->before_date;
+}
+
+static guint
+conversion_generation (GNCPriceDB *db, const gnc_commodity *c)
+{
+    return GPOINTER_TO_UINT (g_hash_table_lookup (db->conversion_generation, c));
+}
+
+static void
+pricedb_conversions_changed (GNCPriceDB *db, GNCPrice *p)
+{
+    if (!db->conversion_generation) return;
+    g_hash_table_insert (db->conversion_generation, p->commodity,
+                         GUINT_TO_POINTER (conversion_generation (db, p->commodity) + 1));
+    g_hash_table_insert (db->conversion_generation, p->currency,
+                         GUINT_TO_POINTER (conversion_generation (db, p->currency) + 1));
+}
+
+static gboolean
+conversion_cache_lookup (GNCPriceDB *db, const gnc_commodity *from,
+                         const gnc_commodity *to, time64 t,
+                         gboolean before_date, gnc_numeric *price)
+{
+    PriceConversionKey key = { from, to, t, before_date };
+    PriceConversion *entry;
+
+    if (!db || !db->conversion_cache) return FALSE;
+    entry = g_hash_table_lookup (db->conversion_cache, &key);
+    if (!entry ||
+        entry->from_generation != conversion_generation (db, from) ||
+        entry->to_generation != conversion_generation (db, to))
+        return FALSE;
+    *price = entry->price;
+    return TRUE;
+}
+
+static void
+conversion_cache_insert (GNCPriceDB *db, const gnc_commodity *from,
+                         const gnc_commodity *to, time64 t,
+                         gboolean before_date, gnc_numeric price)
+{
+    PriceConversion *entry;
+
+    if (!db || !db->conversion_cache) return;
+    if (g_hash_table_size (db->conversion_cache) >= PRICE_CONVERSION_CACHE_MAX)
+        g_hash_table_remove_all (db->conversion_cache);
+
+    entry = g_new (PriceConversion, 1);
+    entry->key.from = from;
+    entry->key.to = to;
+    entry->key.t = t;
+    entry->key.before_date = before_date;
+    entry->price = price;
+    entry->from_generation = conversion_generation (db, from);
+    entry->to_generation = conversion_generation (db, to);
+    g_hash_table_replace (db->conversion_cache, &entry->key, entry);
+}
+
+static gboolean
+conversion_uses_commodity (gpointer key, gpointer value, gpointer user_data)
+{
+    const PriceConversionKey *k = key;
+    return k->from == user_data || k->to == user_data;
+}
+
+void
+gnc_pricedb_forget_commodity (GNCPriceDB *db, const gnc_commodity *c)
+{
+    if (!db || !c) return;
+    if (db->conversion_cache)
+    {
+        g_hash_table_foreach_remove (db->conversion_cache,
+                                     conversion_uses_commodity, (gpointer)c);
+        g_hash_table_remove (db->conversion_generation, c);
+    }
+    if (db->nth_price_cache)
+        g_hash_table_remove (db->nth_price_cache, c);
+}
+
 /* ==================================================================== */
 /* GNCPriceDB functions
 
@@ -831,7 +1122,9 @@ gnc_price_list_equal(PriceList *prices1, PriceList *prices2)
    type gnc_commodity*) to GNCPrice lists (see gnc-pricedb.h for a
    description of GNCPrice lists).  The top-level key is the commodity
    you want the prices for, and the second level key is the commodity
-   that the value is expressed in terms of.
+   that the value is expressed in terms of.  Alongside it the price
+   series index the same prices by pair of commodities for the time
+   based lookups.
  */
 
 /* GObject Initialization */
@@ -883,6 +1176,14 @@ gnc_pricedb_create(QofBook * book)
 
     result->commodity_hash = g_hash_table_new(NULL, NULL);
     g_return_val_if_fail (result->commodity_hash, NULL);
+    result->price_series = g_hash_table_new(NULL, NULL);
+    result->conversion_cache = g_hash_table_new_full (price_conversion_hash,
+                                                      price_conversion_equal,
+                                                      NULL, g_free);
+    result->conversion_generation = g_hash_table_new(NULL, NULL);
+    result->nth_price_cache =
+        g_hash_table_new_full (NULL, NULL, NULL,
+                               (GDestroyNotify)g_ptr_array_unref);
     return result;
 }
 
@@ -930,6 +1231,24 @@ gnc_pricedb_destroy(GNCPriceDB *db)
     }
     g_hash_table_destroy (db->commodity_hash);
     db->commodity_hash = NULL;
+    if (db->price_series)
+    {
+        g_hash_table_foreach (db->price_series, destroy_price_series, NULL);
+        g_hash_table_destroy (db->price_series);
+        db->price_series = NULL;
+    }
+    if (db->conversion_cache)
+    {
+        g_hash_table_destroy (db->conversion_cache);
+        g_hash_table_destroy (db->conversion_generation);
+        db->conversion_cache = NULL;
+        db->conversion_generation = NULL;
+    }
+    if (db->nth_price_cache)
+    {
+        g_hash_table_destroy (db->nth_price_cache);
+        db->nth_price_cache = NULL;
+    }
     /* qof_instance_release (&db->inst); */
     g_object_unref(db);
 }
@@ -1072,6 +1391,7 @@ add_price(GNCPriceDB *db, GNCPrice *p)
     /* This function will use p, adding a ref, so treat p as read-only
        if this function succeeds. */
     GList *price_list;
+    GPtrArray *series;
     gnc_commodity *commodity;
     gnc_commodity *currency;
     GHashTable *currency_hash;
@@ -1135,10 +1455,21 @@ add_price(GNCPriceDB *db, GNCPrice *p)
     }
 
     price_list = g_hash_table_lookup(currency_hash, currency);
-    if (!gnc_price_list_insert(&price_list, p, !db->bulk_update))
+    series = pricedb_get_series (db, commodity, currency, TRUE);
+    if (!db->bulk_update && price_series_has_duplicate (series, p))
     {
-        LEAVE ("gnc_price_list_insert failed");
-        return FALSE;
+        /* Like gnc_price_list_insert, a duplicate keeps the reference
+         * but isn't added. */
+        gnc_price_ref(p);
+    }
+    else
+    {
+        if (!gnc_price_list_insert(&price_list, p, FALSE))
+        {
+            LEAVE ("gnc_price_list_insert failed");
+            return FALSE;
+        }
+        price_series_insert (series, p);
     }
 
     if (!price_list)
@@ -1149,6 +1480,8 @@ add_price(GNCPriceDB *db, GNCPrice *p)
 
     g_hash_table_insert(currency_hash, currency, price_list);
     p->db = db;
+    pricedb_conversions_changed (db, p);
+    db->reset_nth_price_cache = TRUE;
 
     qof_event_gen (&p->inst, QOF_EVENT_ADD, NULL);
 
@@ -1242,6 +1575,9 @@ remove_price(GNCPriceDB *db, GNCPrice *p, gboolean cleanup)
         LEAVE (" cannot remove price list");
         return FALSE;
     }
+    price_series_remove (db, p);
+    pricedb_conversions_changed (db, p);
+    db->reset_nth_price_cache = TRUE;
 
     /* if the price list is empty, then remove this currency from the
        commodity hash */
@@ -1792,20 +2128,18 @@ GNCPrice *gnc_pricedb_lookup_latest(GNCPriceDB *db,
                           const gnc_commodity *commodity,
                           const gnc_commodity *currency)
 {
-    GList *price_list;
+    GPtrArray *series;
     GNCPrice *result;
 
     if (!db || !commodity || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, commodity, currency);
 
-    price_list = pricedb_get_prices_internal(db, commodity, currency, TRUE);
-    if (!price_list) return NULL;
-    /* This works magically because prices are inserted in date-sorted
-     * order, and the latest date always comes first. So return the
-     * first in the list.  */
-    result = price_list->data;
+    series = pricedb_get_series (db, commodity, currency, FALSE);
+    if (!series || !series->len) return NULL;
+    /* The series is sorted newest first, so the latest price is the
+     * first one. */
+    result = g_ptr_array_index (series, 0);
     gnc_price_ref(result);
-    g_list_free (price_list);
     LEAVE("price is %p", result);
     return result;
 }
@@ -2124,103 +2458,93 @@ gnc_pricedb_get_prices(GNCPriceDB *db,
     return result;
 }
 
-/* Return the number of prices in the data base for the given commodity
- */
+/* Helper function for combining the price lists in nth_price_array. */
 static void
-price_count_helper(gpointer key, gpointer value, gpointer data)
+array_combine (gpointer key, gpointer value, gpointer data)
 {
-    int *result = data;
-    GList *price_list = value;
+    GPtrArray *array = data;
+    GList *node;
+    for (node = value; node; node = node->next)
+        g_ptr_array_add (array, node->data);
+}
 
-    *result += g_list_length(price_list);
+/* gnc_pricedb_nth_price is used by gnc-tree-model-price.c for iterating
+ * through the prices when building or filtering the pricedb dialog's
+ * GtkTreeView. gtk-tree-view-price.c sorts the results after it has obtained
+ * the values so there's nothing gained by sorting. The model asks for the
+ * prices of a commodity one index at a time, so each commodity's price lists
+ * (here commodity is the one being priced and currency the one in which the
+ * price is denominated; note that they may both be currencies or not) are
+ * concatenated once into an array that is kept in the DB until
+ * reset_nth_price_cache is set by adding or removing a price or by
+ * gnc_pricedb_nth_price_reset_cache.
+ */
+static GPtrArray *
+nth_price_array (GNCPriceDB *db, const gnc_commodity *c)
+{
+    GHashTable *currency_hash;
+    GPtrArray *prices;
+
+    if (!db->nth_price_cache)
+        return NULL;
+
+    if (db->reset_nth_price_cache)
+    {
+        g_hash_table_remove_all (db->nth_price_cache);
+        db->reset_nth_price_cache = FALSE;
+    }
+
+    prices = g_hash_table_lookup (db->nth_price_cache, c);
+    if (prices)
+        return prices;
+
+    currency_hash = g_hash_table_lookup (db->commodity_hash, c);
+    if (!currency_hash)
+        return NULL;
+
+    prices = g_ptr_array_new ();
+    g_hash_table_foreach (currency_hash, array_combine, prices);
+    g_hash_table_insert (db->nth_price_cache, (gpointer)c, prices);
+    return prices;
 }
 
+/* Return the number of prices in the data base for the given commodity
+ */
 int
 gnc_pricedb_num_prices(GNCPriceDB *db,
                        const gnc_commodity *c)
 {
     int result = 0;
-    GHashTable *currency_hash;
+    GPtrArray *prices;
 
     if (!db || !c) return 0;
     ENTER ("db=%p commodity=%p", db, c);
 
-    currency_hash = g_hash_table_lookup(db->commodity_hash, c);
-    if (currency_hash)
-    {
-        g_hash_table_foreach(currency_hash, price_count_helper,  (gpointer)&result);
-    }
+    /* The price tree model asks for this along with gnc_pricedb_nth_price,
+     * so count the same array rather than walk the price lists each time. */
+    prices = nth_price_array (db, c);
+    if (prices)
+        result = prices->len;
 
     LEAVE ("count=%d", result);
     return result;
 }
 
-/* Helper function for combining the price lists in gnc_pricedb_nth_price. */
-static void
-list_combine (gpointer element, gpointer data)
-{
-    GList *list = *(GList**)data;
-    if (list == NULL)
-        *(GList**)data = g_list_copy (element);
-    else
-    {
-        GList *new_list = g_list_concat ((GList *)list, g_list_copy (element));
-        *(GList**)data = new_list;
-    }
-}
-
-/* This function is used by gnc-tree-model-price.c for iterating through the
- * prices when building or filtering the pricedb dialog's
- * GtkTreeView. gtk-tree-view-price.c sorts the results after it has obtained
- * the values so there's nothing gained by sorting. However, for very large
- * collections of prices in multiple currencies (here commodity is the one being
- * priced and currency the one in which the price is denominated; note that they
- * may both be currencies or not) just concatenating the price lists together
- * can be expensive because the receiving list must be traversed to obtain its
- * end. To avoid that cost n times we cache the commodity and merged price list.
- * Since this is a GUI-driven function there is no concern about concurrency.
- */
-
 GNCPrice *
 gnc_pricedb_nth_price (GNCPriceDB *db,
                        const gnc_commodity *c,
                        const int n)
 {
-    static const gnc_commodity *last_c = NULL;
-    static GList *prices = NULL;
-
     GNCPrice *result = NULL;
-    GHashTable *currency_hash;
+    GPtrArray *prices;
     g_return_val_if_fail (GNC_IS_COMMODITY (c), NULL);
 
     if (!db || !c || n < 0) return NULL;
     ENTER ("db=%p commodity=%s index=%d", db, gnc_commodity_get_mnemonic(c), n);
 
-    if (last_c && prices && last_c == c && db->reset_nth_price_cache == FALSE)
-    {
-        result = g_list_nth_data (prices, n);
-        LEAVE ("price=%p", result);
-        return result;
-    }
-
-    last_c = c;
-
-    if (prices)
-    {
-        g_list_free (prices);
-        prices = NULL;
-    }
-
-    db->reset_nth_price_cache = FALSE;
-
-    currency_hash = g_hash_table_lookup (db->commodity_hash, c);
-    if (currency_hash)
-    {
-        GList *currencies = g_hash_table_get_values (currency_hash);
-        g_list_foreach (currencies, list_combine, &prices);
-        result = g_list_nth_data (prices, n);
-        g_list_free (currencies);
-    }
+    prices = nth_price_array (db, c);
+    if (prices && (guint)n < prices->len)
+        result = g_ptr_array_index (prices, n);
 
     LEAVE ("price=%p", result);
     return result;
@@ -2248,27 +2572,29 @@ gnc_pricedb_lookup_at_time64(GNCPriceDB *db,
                              const gnc_commodity *currency,
                              time64 t)
 {
-    GList *price_list;
-    GList *item = NULL;
+    GPtrArray *series;
+    GNCPrice *p;
+    guint pos;
 
     if (!db || !c || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    item = price_list;
-    while (item)
+    series = pricedb_get_series (db, c, currency, FALSE);
+    if (!series)
     {
-        GNCPrice *p = item->data;
-        time64 price_time = gnc_price_get_time64(p);
-        if (price_time == t)
+        LEAVE (" ");
+        return NULL;
+    }
+    pos = price_series_first_not_after (series, t);
+    if (pos < series->len)
+    {
+        p = g_ptr_array_index (series, pos);
+        if (gnc_price_get_time64(p) == t)
         {
             gnc_price_ref(p);
-            g_list_free (price_list);
             LEAVE("price is %p", p);
             return p;
         }
-        item = item->next;
     }
-    g_list_free (price_list);
     LEAVE (" ");
     return NULL;
 }
@@ -2280,36 +2606,24 @@ lookup_nearest_in_time(GNCPriceDB *db,
                        time64 t,
                        gboolean sameday)
 {
-    GList *price_list;
+    GPtrArray *series;
     GNCPrice *current_price = NULL;
     GNCPrice *next_price = NULL;
     GNCPrice *result = NULL;
-    GList *item = NULL;
+    guint pos;
 
     if (!db || !c || !currency) return NULL;
     if (t == INT64_MAX) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    if (!price_list) return NULL;
-    item = price_list;
+    series = pricedb_get_series (db, c, currency, FALSE);
+    if (!series || !series->len) return NULL;
 
-    /* default answer */
-    current_price = item->data;
-
-    /* find the first candidate past the one we want.  Remember that
-       prices are in most-recent-first order. */
-    while (!next_price && item)
-    {
-        GNCPrice *p = item->data;
-        time64 price_time = gnc_price_get_time64(p);
-        if (price_time <= t)
-        {
-            next_price = item->data;
-            break;
-        }
-        current_price = item->data;
-        item = item->next;
-    }
+    /* find the first candidate past the one we want and the one before
+       it.  Remember that prices are in most-recent-first order. */
+    pos = price_series_first_not_after (series, t);
+    if (pos < series->len)
+        next_price = g_ptr_array_index (series, pos);
+    current_price = g_ptr_array_index (series, pos ? pos - 1 : 0);
 
     if (current_price)      /* How can this be null??? */
     {
@@ -2381,7 +2695,6 @@ lookup_nearest_in_time(GNCPriceDB *db,
     }
 
     gnc_price_ref(result);
-    g_list_free (price_list);
     LEAVE (" ");
     return result;
 }
@@ -2402,28 +2715,18 @@ gnc_pricedb_lookup_nearest_before_t64 (GNCPriceDB *db,
                                        const gnc_commodity *currency,
                                        time64 t)
 {
-    GList *price_list;
+    GPtrArray *series;
     GNCPrice *current_price = NULL;
-    /*  GNCPrice *next_price = NULL;
-        GNCPrice *result = NULL;*/
-    GList *item = NULL;
-    time64 price_time;
+    guint pos;
 
     if (!db || !c || !currency) return NULL;
     ENTER ("db=%p commodity=%p currency=%p", db, c, currency);
-    price_list = pricedb_get_prices_internal (db, c, currency, TRUE);
-    if (!price_list) return NULL;
-    item = price_list;
-    do
-    {
-        price_time = gnc_price_get_time64 (item->data);
-        if (price_time <= t)
-            current_price = item->data;
-        item = item->next;
-    }
-    while (price_time > t && item);
+    series = pricedb_get_series (db, c, currency, FALSE);
+    if (!series || !series->len) return NULL;
+    pos = price_series_first_not_after (series, t);
+    if (pos < series->len)
+        current_price = g_ptr_array_index (series, pos);
     gnc_price_ref(current_price);
-    g_list_free (price_list);
     LEAVE (" ");
     return current_price;
 }
@@ -2592,6 +2895,9 @@ get_nearest_price (GNCPriceDB *pdb,
     if (gnc_commodity_equiv (orig_curr, new_curr))
         return gnc_numeric_create (1, 1);
 
+    if (conversion_cache_lookup (pdb, orig_curr, new_curr, t, before, &price))
+        return price;
+
     /* Look for a direct price. */
     price = direct_price_conversion (pdb, orig_curr, new_curr, t, before);
 
@@ -2601,7 +2907,9 @@ get_nearest_price (GNCPriceDB *pdb,
     if (gnc_numeric_zero_p (price))
         price = indirect_price_conversion (pdb, orig_curr, new_curr, t, before);
 
-    return gnc_numeric_reduce (price);
+    price = gnc_numeric_reduce (price);
+    conversion_cache_insert (pdb, orig_curr, new_curr, t, before, price);
+    return price;
 }
 
 gnc_numeric
@@ -2630,6 +2938,19 @@ gnc_pricedb_get_latest_price (GNCPriceDB *pdb,
     return get_nearest_price (pdb, orig_currency, new_currency, INT64_MAX, FALSE);
 }
 
+static gnc_numeric
+convert_amount_at_price (gnc_numeric amount, gnc_numeric price,
+                         const gnc_commodity *new_currency)
+{
+    /* the price retrieved may be invalid. return zero. see 798015 */
+    if (gnc_numeric_check (price))
+        return gnc_numeric_zero ();
+
+    return gnc_numeric_mul
+        (amount, price, gnc_commodity_get_fraction (new_currency),
+         GNC_HOW_DENOM_EXACT | GNC_HOW_RND_ROUND);
+}
+
 static gnc_numeric
 convert_amount_at_date (GNCPriceDB *pdb,
                         gnc_numeric amount,
@@ -2644,14 +2965,41 @@ convert_amount_at_date (GNCPriceDB *pdb,
         return amount;
 
     price = get_nearest_price (pdb, orig_currency, new_currency, t, before_date);
+    return convert_amount_at_price (amount, price, new_currency);
+}
 
-    /* the price retrieved may be invalid. return zero. see 798015 */
-    if (gnc_numeric_check (price))
-        return gnc_numeric_zero ();
-
-    return gnc_numeric_mul
-        (amount, price, gnc_commodity_get_fraction (new_currency),
-         GNC_HOW_DENOM_EXACT | GNC_HOW_RND_ROUND);
+static void
+convert_amounts_at_dates (GNCPriceDB *pdb,
+                          gsize n,
+                          const gnc_numeric *amounts,
+                          const time64 *times,
+                          const gnc_commodity *orig_currency,
+                          const gnc_commodity *new_currency,
+                          gboolean before_date,
+                          gnc_numeric *results)
+{
+    gnc_numeric price = gnc_numeric_zero ();
+    gboolean have_price = FALSE;
+    time64 price_time = 0;
+    gsize i;
+
+    for (i = 0; i < n; ++i)
+    {
+        if (gnc_numeric_zero_p (amounts[i]))
+        {
+            results[i] = amounts[i];
+            continue;
+        }
+        /* Callers usually batch amounts at a handful of dates in order. */
+        if (!have_price || times[i] != price_time)
+        {
+            price = get_nearest_price (pdb, orig_currency, new_currency,
+                                       times[i], before_date);
+            price_time = times[i];
+            have_price = TRUE;
+        }
+        results[i] = convert_amount_at_price (amounts[i], price, new_currency);
+    }
 }
 
 /*
@@ -2689,6 +3037,34 @@ gnc_pricedb_convert_balance_nearest_before_price_t64 (GNCPriceDB *pdb,
         (pdb, balance, balance_currency, new_currency, t, TRUE);
 }
 
+void
+gnc_pricedb_convert_balances_nearest_price_t64 (GNCPriceDB *pdb,
+                                                gsize n,
+                                                const gnc_numeric *balances,
+                                                const time64 *times,
+                                                const gnc_commodity *balance_currency,
+                                                const gnc_commodity *new_currency,
+                                                gnc_numeric *results)
+{
+    g_return_if_fail (n == 0 || (balances && times && results));
+    convert_amounts_at_dates (pdb, n, balances, times, balance_currency,
+                              new_currency, FALSE, results);
+}
+
+void
+gnc_pricedb_convert_balances_nearest_before_price_t64 (GNCPriceDB *pdb,
+                                                       gsize n,
+                                                       const gnc_numeric *balances,
+                                                       const time64 *times,
+                                                       const gnc_commodity *balance_currency,
+                                                       const gnc_commodity *new_currency,
+                                                       gnc_numeric *results)
+{
+    g_return_if_fail (n == 0 || (balances && times && results));
+    convert_amounts_at_dates (pdb, n, balances, times, balance_currency,
+                              new_currency, TRUE, results);
+}
+
 /* ==================================================================== */
 /* gnc_pricedb_foreach_price infrastructure
  */
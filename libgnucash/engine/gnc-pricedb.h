@@ -647,6 +647,47 @@ gnc_pricedb_convert_balance_nearest_before_price_t64 (GNCPriceDB *pdb,
                                                      const gnc_commodity *new_currency,
                                                      time64 t);
 
+/** @brief Convert a batch of balances from one currency to another, each
+ * using the price nearest to its own time.
+ *
+ * Equivalent to calling gnc_pricedb_convert_balance_nearest_price_t64 on
+ * each (balance, time) pair, but the price is only looked up once for a
+ * run of equal times.
+ * @param pdb The pricedb
+ * @param n The number of balances
+ * @param balances The n balances to be converted
+ * @param times The n times nearest to which the prices should be used
+ * @param balance_currency The commodity in which the balances are currently
+ * expressed
+ * @param new_currency The commodity to which the balances should be converted
+ * @param results Array of n receiving the converted balances, each
+ * gnc_numeric_zero if no price is available.
+ */
+void
+gnc_pricedb_convert_balances_nearest_price_t64 (GNCPriceDB *pdb,
+                                                gsize n,
+                                                const gnc_numeric *balances,
+                                                const time64 *times,
+                                                const gnc_commodity *balance_currency,
+                                                const gnc_commodity *new_currency,
+                                                gnc_numeric *results);
+
+/** @brief Convert a batch of balances from one currency to another, each
+ * using the last price before its own time.
+ *
+ * The batch counterpart of
+ * gnc_pricedb_convert_balance_nearest_before_price_t64; see
+ * gnc_pricedb_convert_balances_nearest_price_t64 for the parameters.
+ */
+void
+gnc_pricedb_convert_balances_nearest_before_price_t64 (GNCPriceDB *pdb,
+                                                       gsize n,
+                                                       const gnc_numeric *balances,
+                                                       const time64 *times,
+                                                       const gnc_commodity *balance_currency,
+                                                       const gnc_commodity *new_currency,
+                                                       gnc_numeric *results);
+
 typedef gboolean (*GncPriceForeachFunc)(GNCPrice *p, gpointer user_data);
 
 /** @brief Call a GncPriceForeachFunction once for each price in db, until the
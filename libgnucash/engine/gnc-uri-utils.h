@@ -60,6 +60,7 @@
 
 #define GNC_DATAFILE_EXT ".gnucash"
 #define GNC_LOGFILE_EXT  ".log"
+#define GNC_JOURNALFILE_EXT ".jrnl"
 
 #include "platform.h"
 
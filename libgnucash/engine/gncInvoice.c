@@ -1397,7 +1397,7 @@ gncInvoiceAttachToLot (GncInvoice *invoice, GNCLot *lot)
 GncInvoice
 *gncInvoiceGetInvoiceFromLot (GNCLot *lot)
 {
-    GncGUID *guid = NULL;
+    const GncGUID *guid = NULL;
     QofBook *book;
     GncInvoice *invoice = NULL;
 
@@ -1407,9 +1407,9 @@ GncInvoice
     if (!invoice)
     {
         book = gnc_lot_get_book (lot);
-        qof_instance_get (QOF_INSTANCE(lot), "invoice", &guid, NULL);
+        guid = qof_instance_get_cached_guid (QOF_INSTANCE (lot),
+                                             QOF_CACHED_SLOT_INVOICE);
         invoice = gncInvoiceLookup (book, guid);
-        guid_free (guid);
         gnc_lot_set_cached_invoice (lot, invoice);
     }
 
@@ -1435,16 +1435,16 @@ gncInvoiceAttachToTxn (GncInvoice *invoice, Transaction *txn)
 GncInvoice
 *gncInvoiceGetInvoiceFromTxn (const Transaction *txn)
 {
-    GncGUID *guid = NULL;
+    const GncGUID *guid = NULL;
     QofBook *book;
     GncInvoice *invoice = NULL;
 
     if (!txn) return NULL;
 
     book = xaccTransGetBook (txn);
-    qof_instance_get (QOF_INSTANCE (txn), "invoice", &guid, NULL);
+    guid = qof_instance_get_cached_guid (QOF_INSTANCE (txn),
+                                         QOF_CACHED_SLOT_INVOICE);
     invoice = gncInvoiceLookup (book, guid);
-    guid_free (guid);
     return invoice;
 }
 
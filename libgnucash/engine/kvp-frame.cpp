@@ -33,13 +33,37 @@
 #include <typeinfo>
 #include <sstream>
 #include <algorithm>
+#include <atomic>
 #include <vector>
 #include <numeric>
 
 /* This static indicates the debugging module that this .o belongs to.  */
 static QofLogModule log_module = "qof.kvp";
 
-KvpFrameImpl::KvpFrameImpl(const KvpFrameImpl & rhs) noexcept
+static std::atomic<uint64_t> kvp_generation{1};
+/* Frames take a new version from this when created and when their slots
+ * change, so that no two frames ever share one. */
+static std::atomic<uint64_t> kvp_version{1};
+
+static uint64_t
+next_version () noexcept
+{
+    return kvp_version.fetch_add (1, std::memory_order_relaxed) + 1;
+}
+
+uint64_t
+KvpFrameImpl::generation() noexcept
+{
+    return kvp_generation.load (std::memory_order_relaxed);
+}
+
+KvpFrameImpl::KvpFrameImpl() noexcept :
+    m_version {next_version ()}
+{
+}
+
+KvpFrameImpl::KvpFrameImpl(const KvpFrameImpl & rhs) noexcept :
+    m_version {next_version ()}
 {
     std::for_each(rhs.m_valuemap.begin(), rhs.m_valuemap.end(),
         [this](const map_type::value_type & a)
@@ -53,6 +77,7 @@ KvpFrameImpl::KvpFrameImpl(const KvpFrameImpl & rhs) noexcept
 
 KvpFrameImpl::~KvpFrameImpl() noexcept
 {
+    kvp_generation.fetch_add (1, std::memory_order_relaxed);
     std::for_each(m_valuemap.begin(), m_valuemap.end(),
 		 [](const map_type::value_type &a){
 		      qof_string_cache_remove(a.first);
@@ -100,6 +125,8 @@ KvpValue *
 KvpFrame::set_impl (std::string const & key, KvpValue * value) noexcept
 {
     KvpValue * ret {};
+    kvp_generation.fetch_add (1, std::memory_order_relaxed);
+    m_version = next_version ();
     auto spot = m_valuemap.find (key.c_str ());
     if (spot != m_valuemap.end ())
     {
@@ -89,6 +89,7 @@
 #include <string>
 #include <vector>
 #include <cstring>
+#include <cstdint>
 #include <algorithm>
 #include <iostream>
 using Path = std::vector<std::string>;
@@ -121,7 +122,7 @@ struct KvpFrameImpl
     using map_type = std::map<const char *, KvpValue*, cstring_comparer>;
 
     public:
-    KvpFrameImpl() noexcept {};
+    KvpFrameImpl() noexcept;
 
     /**
      * Performs a deep copy.
@@ -224,6 +225,21 @@ struct KvpFrameImpl
      * @return true if the frame contains nothing.
      */
     bool empty() const noexcept { return m_valuemap.empty(); }
+
+    /** Count of the slots set or removed and of the frames destroyed, in
+     * any frame. A value found by get_slot() stays valid for as long as the
+     * count is unchanged, so a lookup can be cached against it.
+     * @return The current count.
+     */
+    static uint64_t generation() noexcept;
+
+    /** Changes whenever one of the frame's own slots, not those of frames
+     * nested in it, is set or removed. No two frames ever have the same
+     * version, so a summary of a frame's slots can be cached against the
+     * frame and its version.
+     * @return The frame's version.
+     */
+    uint64_t version() const noexcept { return m_version; }
     friend int compare(const KvpFrameImpl&, const KvpFrameImpl&) noexcept;
 
     map_type::iterator begin() { return m_valuemap.begin(); }
@@ -231,6 +247,7 @@ struct KvpFrameImpl
 
     private:
     map_type m_valuemap;
+    uint64_t m_version;
 
     KvpFrame * get_child_frame_or_nullptr (Path const &) noexcept;
     KvpFrame * get_child_frame_or_create (Path const &) noexcept;
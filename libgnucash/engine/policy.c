@@ -66,8 +66,8 @@
 static Split *
 DirectionPolicyGetSplit (GNCPolicy *pcy, GNCLot *lot, short reverse)
 {
-    Split *split;
-    SplitList *node;
+    Split *split, *retval = NULL;
+    SplitList *splits, *node;
     gnc_commodity *common_currency;
     gboolean want_positive;
     gnc_numeric baln;
@@ -101,11 +101,8 @@ DirectionPolicyGetSplit (GNCPolicy *pcy, GNCLot *lot, short reverse)
      * hasn't been assigned to a lot.  Return that split.
      * Make use of the fact that the splits in an account are
      * already in date order; so we don't have to sort. */
-    node = xaccAccountGetSplitList (lot_account);
-    if (reverse)
-    {
-        node = g_list_last (node);
-    }
+    splits = xaccAccountGetSplitList (lot_account);
+    node = reverse ? g_list_last (splits) : splits;
     while (node)
     {
         gboolean is_match;
@@ -134,7 +131,11 @@ DirectionPolicyGetSplit (GNCPolicy *pcy, GNCLot *lot, short reverse)
 
         is_positive = gnc_numeric_positive_p (split->amount);
         if ((want_positive && is_positive) ||
-                ((!want_positive) && (!is_positive))) return split;
+                ((!want_positive) && (!is_positive)))
+        {
+            retval = split;
+            break;
+        }
 donext:
         if (reverse)
         {
@@ -145,7 +146,8 @@ donext:
             node = node->next;
         }
     }
-    return NULL;
+    g_list_free (splits);
+    return retval;
 }
 
 /* ============================================================== */
@@ -210,6 +210,12 @@ public:
  *    better to wait for the query).
  */
     virtual void load (QofBook*, QofBackendLoadType) = 0;
+/**
+ *    Called before a query is run on a book, so that a backend which loaded
+ *    only part of its data can first load the objects the query may match.
+ *    Backends that load everything need not implement it.
+ */
+    virtual void load_for_query(QofBook*, QofQuery*) {}
 /**
  *    Called when the engine is about to make a change to a data structure. It
  *    could provide an advisory lock on data, but no backend does this.
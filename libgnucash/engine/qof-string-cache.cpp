@@ -42,9 +42,13 @@ static QofLogModule log_module = QOF_MOD_UTIL;
 /*                                                                     */
 /* The cache is a GHashTable where a copy of the string is the key,    */
 /* and a ref count is the value                                        */
+/*                                                                     */
+/* Inserts and removes take a lock so that KVP frames can be built on  */
+/* other threads, as the XML backend does while loading a file.        */
 /* =================================================================== */
 
 static GHashTable* qof_string_cache = NULL;
+G_LOCK_DEFINE_STATIC (qof_string_cache);
 
 static GHashTable*
 qof_get_string_cache(void)
@@ -63,17 +67,21 @@ qof_get_string_cache(void)
 void
 qof_string_cache_init(void)
 {
+    G_LOCK (qof_string_cache);
     (void)qof_get_string_cache();
+    G_UNLOCK (qof_string_cache);
 }
 
 void
 qof_string_cache_destroy (void)
 {
+    G_LOCK (qof_string_cache);
     if (qof_string_cache)
     {
         g_hash_table_destroy(qof_string_cache);
     }
     qof_string_cache = NULL;
+    G_UNLOCK (qof_string_cache);
 }
 
 /* If the key exists in the cache, check the refcount.  If 1, just
@@ -83,6 +91,7 @@ qof_string_cache_remove(const char * key)
 {
     if (key && key[0] != 0)
     {
+        G_LOCK (qof_string_cache);
         GHashTable* cache = qof_get_string_cache();
         gpointer value;
         gpointer cache_key;
@@ -98,6 +107,7 @@ qof_string_cache_remove(const char * key)
                 --(*refcount);
             }
         }
+        G_UNLOCK (qof_string_cache);
     }
 }
 
@@ -113,6 +123,7 @@ qof_string_cache_insert(const char * key)
             return "";
         }
 
+        G_LOCK (qof_string_cache);
         GHashTable* cache = qof_get_string_cache();
         gpointer value;
         gpointer cache_key;
@@ -120,6 +131,7 @@ qof_string_cache_insert(const char * key)
         {
             guint* refcount = (guint*)value;
             ++(*refcount);
+            G_UNLOCK (qof_string_cache);
             return static_cast <char *> (cache_key);
         }
         else
@@ -128,6 +140,7 @@ qof_string_cache_insert(const char * key)
             guint* refcount = static_cast<unsigned int*>(g_malloc(sizeof(guint)));
             *refcount = 1;
             g_hash_table_insert(cache, new_key, refcount);
+            G_UNLOCK (qof_string_cache);
             return static_cast <char *> (new_key);
         }
     }
@@ -66,7 +66,8 @@ extern "C"
  * Note that all the work is done when inserting or removing.  Once
  * cached the strings are just plain C strings.
  *
- * The string cache is demand-created on first use.
+ * The string cache is demand-created on first use. Inserting and
+ * removing strings is safe from several threads.
  *
  **/
 
@@ -31,6 +31,7 @@ static QofLogModule log_module = QOF_MOD_CLASS;
 
 static GHashTable *classTable = NULL;
 static GHashTable *sortTable = NULL;
+static GHashTable *threadsafeTable = NULL; /* set of QofParam* */
 static gboolean initialized = FALSE;
 
 static gboolean clear_table (gpointer key, gpointer value, gpointer user_data)
@@ -58,6 +59,7 @@ qof_class_init(void)
 
     classTable = g_hash_table_new (g_str_hash, g_str_equal);
     sortTable = g_hash_table_new (g_str_hash, g_str_equal);
+    threadsafeTable = g_hash_table_new (NULL, NULL);
 }
 
 void
@@ -69,6 +71,7 @@ qof_class_shutdown (void)
     g_hash_table_foreach_remove (classTable, clear_table, NULL);
     g_hash_table_destroy (classTable);
     g_hash_table_destroy (sortTable);
+    g_hash_table_destroy (threadsafeTable);
 }
 
 QofSortFunc
@@ -121,6 +124,31 @@ qof_class_register (QofIdTypeConst obj_name,
     }
 }
 
+void
+qof_class_set_params_threadsafe (QofIdTypeConst obj_name,
+                                 const char * const *param_names)
+{
+    g_return_if_fail (obj_name);
+    g_return_if_fail (param_names);
+    if (!check_init()) return;
+
+    for (; *param_names; param_names++)
+    {
+        const QofParam *param = qof_class_get_parameter (obj_name, *param_names);
+        if (param)
+            g_hash_table_add (threadsafeTable, (gpointer)param);
+        else
+            PWARN ("no parameter %s in %s", *param_names, obj_name);
+    }
+}
+
+gboolean
+qof_class_param_is_threadsafe (const QofParam *param)
+{
+    if (!param || !initialized) return FALSE;
+    return g_hash_table_contains (threadsafeTable, param);
+}
+
 gboolean
 qof_class_is_registered (QofIdTypeConst obj_name)
 {
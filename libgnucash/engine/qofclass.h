@@ -243,6 +243,19 @@ QofType qof_class_get_parameter_type (QofIdTypeConst obj_name,
 const QofParam * qof_class_get_parameter (QofIdTypeConst obj_name,
         const char *parameter);
 
+/** Mark the getters of the named parameters of obj_name as thread-safe:
+ *  they only read the object, so a query run with
+ *  qof_query_set_parallel() may call them from several threads at once.
+ *  The parameters must already be registered with qof_class_register().
+ *
+ *  @param param_names A NULL-terminated array of parameter names.
+ */
+void qof_class_set_params_threadsafe (QofIdTypeConst obj_name,
+                                      const char * const *param_names);
+
+/** Return TRUE if the parameter's getter was marked thread-safe */
+gboolean qof_class_param_is_threadsafe (const QofParam *param);
+
 /** Return the object's parameter getter function */
 QofAccessFunc qof_class_get_parameter_getter (QofIdTypeConst obj_name,
         const char *parameter);
@@ -134,12 +134,59 @@ void qof_instance_set_kvp (QofInstance *, GValue const * value, unsigned count,
  */
 void qof_instance_get_kvp (QofInstance *, GValue * value, unsigned count, ...);
 
+/** The KVP slots that the engine reads inside loops over every split or
+ * transaction. Their lookups are cached on the instance until some KVP
+ * frame is changed, see KvpFrameImpl::generation().
+ */
+typedef enum
+{
+    QOF_CACHED_SLOT_BOOK_CLOSING, /**< "book_closing" on transactions */
+    QOF_CACHED_SLOT_ONLINE_ID,    /**< "online_id" on splits and transactions */
+    QOF_CACHED_SLOT_INVOICE,      /**< "gncInvoice/invoice-guid" on
+                                   * transactions and lots */
+    QOF_CACHED_SLOT_COUNT
+} QofCachedSlot;
+
+/** Retrieves an int64 KVP slot without boxing it in a GValue.
+ * @param inst: The QofInstance
+ * @param slot: Which of the cached slots to read.
+ * @param default_value: Returned if the slot is missing or isn't an int64.
+ */
+gint64 qof_instance_get_cached_int64 (const QofInstance *inst,
+                                      QofCachedSlot slot,
+                                      gint64 default_value);
+
+/** Retrieves a string KVP slot without copying it.
+ * @return The string, owned by the instance's KVP, or NULL if the slot is
+ * missing or isn't a string.
+ */
+const char* qof_instance_get_cached_string (const QofInstance *inst,
+                                            QofCachedSlot slot);
+
+/** Retrieves a GncGUID KVP slot without copying it.
+ * @return The GncGUID, owned by the instance's KVP, or NULL if the slot is
+ * missing or isn't a GncGUID.
+ */
+const GncGUID* qof_instance_get_cached_guid (const QofInstance *inst,
+                                             QofCachedSlot slot);
+
 /** @} Close out the DOxygen ingroup */
 /* Functions to isolate the KVP mechanism inside QOF for cases where
 GValue * operations won't work.
  */
 void qof_instance_copy_kvp (QofInstance *to, const QofInstance *from);
 void qof_instance_swap_kvp (QofInstance *a, QofInstance *b);
+/** Remember the slots of inst as they are now so that an edit can be
+ *  rolled back. They are only copied when first changed through these
+ *  functions; changes made directly to the frame returned by
+ *  qof_instance_get_slots are not seen. */
+void qof_instance_kvp_snapshot_begin (QofInstance *inst);
+/** Forget the snapshot, first putting it back as the slots of inst if
+ *  restore is TRUE. */
+void qof_instance_kvp_snapshot_end (QofInstance *inst, gboolean restore);
+/** Like qof_instance_copy_kvp, but copies the slots from had when its
+ *  snapshot was begun. */
+void qof_instance_copy_kvp_snapshot (QofInstance *to, const QofInstance *from);
 int qof_instance_compare_kvp (const QofInstance *a, const QofInstance *b);
 /** Returns a g_strdup'd string which must be g_freed. */
 char* qof_instance_kvp_as_string (const QofInstance *inst);
@@ -68,6 +68,24 @@ enum
     PROP_IDATA,
 };
 
+/* Paths of the QofCachedSlots, in the same order. */
+static const Path cached_slot_paths[QOF_CACHED_SLOT_COUNT] =
+{
+    {"book_closing"},
+    {"online_id"},
+    {"gncInvoice", "invoice-guid"},
+};
+
+/* The cached slot values are those of frame while the KVP generation
+ * stayed the same; bit n of looked_up is set once slot n has been read. */
+struct QofInstanceSlotCache
+{
+    const KvpFrame *frame;
+    uint64_t generation;
+    unsigned int looked_up;
+    KvpValue *values[QOF_CACHED_SLOT_COUNT];
+};
+
 typedef struct QofInstancePrivate
 {
 //    QofIdType        e_type;    /**<	Entity type */
@@ -106,6 +124,14 @@ typedef struct QofInstancePrivate
     /* -------------------------------------------------------------- */
     /* Backend private expansion data */
     guint32  idata;   /* used by the sql backend for kvp management */
+
+    /* Lookups of the hot KVP slots, allocated on first use. */
+    QofInstanceSlotCache *slot_cache;
+
+    /* Copy-on-write snapshot of the slots, see
+     * qof_instance_kvp_snapshot_begin. */
+    gboolean kvp_snapshot_pending;
+    KvpFrame *kvp_snapshot;
 }  QofInstancePrivate;
 
 #define GET_PRIVATE(o)  \
@@ -264,6 +290,9 @@ qof_instance_init (QofInstance *inst)
     priv->do_free = FALSE;
     priv->dirty = FALSE;
     priv->infant = TRUE;
+    priv->slot_cache = nullptr;
+    priv->kvp_snapshot_pending = FALSE;
+    priv->kvp_snapshot = nullptr;
 }
 
 void
@@ -335,6 +364,11 @@ qof_instance_finalize_real (GObject *instp)
     inst->kvp_data = nullptr;
 
     priv = GET_PRIVATE(inst);
+    delete priv->slot_cache;
+    priv->slot_cache = nullptr;
+    delete priv->kvp_snapshot;
+    priv->kvp_snapshot = nullptr;
+    priv->kvp_snapshot_pending = FALSE;
     priv->editlevel = 0;
     priv->do_free = FALSE;
     priv->dirty = FALSE;
@@ -565,6 +599,22 @@ qof_instance_books_equal (gconstpointer ptr1, gconstpointer ptr2)
     return (priv1->book == priv2->book);
 }
 
+/* Give inst the slots in frm. If the old frame would be the snapshot
+ * of an edit (see kvp_will_change) keep it rather than copying it. */
+static void
+replace_kvp (QofInstance *inst, KvpFrame *frm)
+{
+    if (inst->kvp_data && (inst->kvp_data != frm))
+    {
+        auto priv = GET_PRIVATE(inst);
+        if (priv->kvp_snapshot_pending && !priv->kvp_snapshot)
+            priv->kvp_snapshot = inst->kvp_data;
+        else
+            delete inst->kvp_data;
+    }
+    inst->kvp_data = frm;
+}
+
 /* Watch out: This function is still used (as a "friend") in src/import-export/aqb/gnc-ab-kvp.c */
 KvpFrame*
 qof_instance_get_slots (const QofInstance *inst)
@@ -581,13 +631,8 @@ qof_instance_set_slots (QofInstance *inst, KvpFrame *frm)
     if (!inst) return;
 
     priv = GET_PRIVATE(inst);
-    if (inst->kvp_data && (inst->kvp_data != frm))
-    {
-        delete inst->kvp_data;
-    }
-
+    replace_kvp (inst, frm);
     priv->dirty = TRUE;
-    inst->kvp_data = frm;
 }
 
 void
@@ -1040,6 +1085,49 @@ qof_commit_edit_part2(QofInstance *inst,
     return TRUE;
 }
 
+/* Called before the slots of inst are changed: the first change after
+ * qof_instance_kvp_snapshot_begin keeps a copy of them. */
+static void
+kvp_will_change (const QofInstance *inst)
+{
+    auto priv = GET_PRIVATE(inst);
+    if (priv->kvp_snapshot_pending && !priv->kvp_snapshot)
+        priv->kvp_snapshot = new KvpFrame(*inst->kvp_data);
+}
+
+void
+qof_instance_kvp_snapshot_begin (QofInstance *inst)
+{
+    g_return_if_fail (QOF_IS_INSTANCE (inst));
+    auto priv = GET_PRIVATE(inst);
+    delete priv->kvp_snapshot;
+    priv->kvp_snapshot = nullptr;
+    priv->kvp_snapshot_pending = TRUE;
+}
+
+void
+qof_instance_kvp_snapshot_end (QofInstance *inst, gboolean restore)
+{
+    g_return_if_fail (QOF_IS_INSTANCE (inst));
+    auto priv = GET_PRIVATE(inst);
+    if (priv->kvp_snapshot)
+    {
+        if (restore)
+            std::swap (inst->kvp_data, priv->kvp_snapshot);
+        delete priv->kvp_snapshot;
+        priv->kvp_snapshot = nullptr;
+    }
+    priv->kvp_snapshot_pending = FALSE;
+}
+
+void
+qof_instance_copy_kvp_snapshot (QofInstance *to, const QofInstance *from)
+{
+    g_return_if_fail (QOF_IS_INSTANCE (to) && QOF_IS_INSTANCE (from));
+    auto snapshot = GET_PRIVATE(from)->kvp_snapshot;
+    replace_kvp (to, new KvpFrame(snapshot ? *snapshot : *from->kvp_data));
+}
+
 gboolean
 qof_instance_has_kvp (QofInstance *inst)
 {
@@ -1048,6 +1136,7 @@ qof_instance_has_kvp (QofInstance *inst)
 
 void qof_instance_set_path_kvp (QofInstance * inst, GValue const * value, std::vector<std::string> const & path)
 {
+    kvp_will_change (inst);
     delete inst->kvp_data->set_path (path, kvp_value_from_gvalue (value));
 }
 
@@ -1060,6 +1149,7 @@ qof_instance_set_kvp (QofInstance * inst, GValue const * value, unsigned count,
     for (unsigned i{0}; i < count; ++i)
         path.push_back (va_arg (args, char const *));
     va_end (args);
+    kvp_will_change (inst);
     delete inst->kvp_data->set_path (path, kvp_value_from_gvalue (value));
 }
 
@@ -1080,16 +1170,75 @@ qof_instance_get_kvp (QofInstance * inst, GValue * value, unsigned count, ...)
     gvalue_from_kvp_value (inst->kvp_data->get_slot (path), value);
 }
 
+static KvpValue*
+get_cached_slot (const QofInstance *inst, QofCachedSlot slot)
+{
+    auto frame = inst->kvp_data;
+    /* Most splits and transactions have no KVP at all. */
+    if (frame == nullptr || frame->empty())
+        return nullptr;
+
+    auto priv = GET_PRIVATE(inst);
+    if (priv->slot_cache == nullptr)
+        priv->slot_cache = new QofInstanceSlotCache{};
+    auto cache = priv->slot_cache;
+    auto generation = KvpFrame::generation();
+    if (cache->frame != frame || cache->generation != generation)
+    {
+        cache->frame = frame;
+        cache->generation = generation;
+        cache->looked_up = 0;
+    }
+    if (!(cache->looked_up & (1u << slot)))
+    {
+        cache->values[slot] = frame->get_slot (cached_slot_paths[slot]);
+        cache->looked_up |= 1u << slot;
+    }
+    return cache->values[slot];
+}
+
+gint64
+qof_instance_get_cached_int64 (const QofInstance *inst, QofCachedSlot slot,
+                               gint64 default_value)
+{
+    g_return_val_if_fail (QOF_IS_INSTANCE (inst), default_value);
+    auto value = get_cached_slot (inst, slot);
+    if (value == nullptr || value->get_type() != KvpValue::Type::INT64)
+        return default_value;
+    return value->get<int64_t>();
+}
+
+const char*
+qof_instance_get_cached_string (const QofInstance *inst, QofCachedSlot slot)
+{
+    g_return_val_if_fail (QOF_IS_INSTANCE (inst), nullptr);
+    auto value = get_cached_slot (inst, slot);
+    if (value == nullptr || value->get_type() != KvpValue::Type::STRING)
+        return nullptr;
+    return value->get<const char*>();
+}
+
+const GncGUID*
+qof_instance_get_cached_guid (const QofInstance *inst, QofCachedSlot slot)
+{
+    g_return_val_if_fail (QOF_IS_INSTANCE (inst), nullptr);
+    auto value = get_cached_slot (inst, slot);
+    if (value == nullptr || value->get_type() != KvpValue::Type::GUID)
+        return nullptr;
+    return value->get<GncGUID*>();
+}
+
 void
 qof_instance_copy_kvp (QofInstance *to, const QofInstance *from)
 {
-    delete to->kvp_data;
-    to->kvp_data = new KvpFrame(*from->kvp_data);
+    replace_kvp (to, new KvpFrame(*from->kvp_data));
 }
 
 void
 qof_instance_swap_kvp (QofInstance *a, QofInstance *b)
 {
+    kvp_will_change (a);
+    kvp_will_change (b);
     std::swap(a->kvp_data, b->kvp_data);
 }
 
@@ -1113,6 +1262,7 @@ qof_instance_kvp_add_guid (const QofInstance *inst, const char* path,
 {
     g_return_if_fail (inst->kvp_data != NULL);
 
+    kvp_will_change (inst);
     auto container = new KvpFrame;
     Time64 t{time};
     container->set({key}, new KvpValue(const_cast<GncGUID*>(guid)));
@@ -1179,6 +1329,7 @@ qof_instance_kvp_remove_guid (const QofInstance *inst, const char *path,
     auto v = inst->kvp_data->get_slot({path});
     if (v == NULL) return;
 
+    kvp_will_change (inst);
     switch (v->get_type())
     {
     case KvpValue::Type::FRAME:
@@ -1222,6 +1373,8 @@ qof_instance_kvp_merge_guids (const QofInstance *target,
     auto v = donor->kvp_data->get_slot({path});
     if (v == NULL) return;
 
+    kvp_will_change (target);
+    kvp_will_change (donor);
     auto target_val = target->kvp_data->get_slot({path});
     switch (v->get_type())
     {
@@ -1262,12 +1415,14 @@ qof_instance_has_slot (const QofInstance *inst, const char *path)
 
 void qof_instance_slot_path_delete (QofInstance const * inst, std::vector<std::string> const & path)
 {
+    kvp_will_change (inst);
     delete inst->kvp_data->set (path, nullptr);
 }
 
 void
 qof_instance_slot_delete (QofInstance const *inst, char const * path)
 {
+    kvp_will_change (inst);
     delete inst->kvp_data->set ({path}, nullptr);
 }
 
@@ -1278,7 +1433,10 @@ void qof_instance_slot_path_delete_if_empty (QofInstance const * inst, std::vect
     {
         auto frame = slot->get <KvpFrame*> ();
         if (frame && frame->empty())
+        {
+            kvp_will_change (inst);
             delete inst->kvp_data->set (path, nullptr);
+        }
     }
 }
 
@@ -1290,7 +1448,10 @@ qof_instance_slot_delete_if_empty (QofInstance const *inst, char const * path)
     {
         auto frame = slot->get <KvpFrame*> ();
         if (frame && frame->empty ())
+        {
+            kvp_will_change (inst);
             delete inst->kvp_data->set ({path}, nullptr);
+        }
     }
 }
 
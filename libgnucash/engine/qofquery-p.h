@@ -71,6 +71,43 @@ QofQueryParamList * qof_query_sort_get_param_path (const QofQuerySort *querysort
 gint qof_query_sort_get_sort_options (const QofQuerySort *querysort);
 gboolean qof_query_sort_get_increasing (const QofQuerySort *querysort);
 
+/* Query indexes
+ *
+ * An index lets qof_query_run visit only the objects that can satisfy
+ * the AND-terms of a query with a single OR-term, instead of every
+ * object of the searched-for type in the book.  estimate returns the
+ * number of objects foreach would visit, or -1 if the index can't serve
+ * the terms.  foreach must call cb exactly once on every object that can
+ * match the terms; it may call it on others as well, since the query
+ * still checks all of its terms on each object it's given.
+ */
+typedef struct
+{
+    const char *name;           /* shown in the query plan */
+    gint64 (*estimate) (QofBook *book, const GList *and_terms);
+    void (*foreach) (QofBook *book, const GList *and_terms,
+                     QofInstanceForeachCB cb, gpointer user_data);
+} QofQueryIndex;
+
+/* Make index available to queries for objects of obj_type. The index
+ * must stay valid until qof_query_shutdown. */
+void qof_query_register_index (QofIdTypeConst obj_type,
+                               const QofQueryIndex *index);
+
+/* Describe how qof_query_run will evaluate the query: the index or scan
+ * used for each book and the order in which the AND-terms are checked.
+ * This is the plan printed by qof_query_print. Free with g_free. */
+gchar * qof_query_explain (QofQuery *q);
+
+/* Call handler with user_data as each query is destroyed, so that
+ * whatever was kept for the query can be let go of. The query's books
+ * may be gone by then, so the handler must not look at them. */
+typedef void (*QofQueryDestroyHandler) (QofQuery *q, gpointer user_data);
+void qof_query_add_destroy_handler (QofQueryDestroyHandler handler,
+                                    gpointer user_data);
+void qof_query_remove_destroy_handler (QofQueryDestroyHandler handler,
+                                       gpointer user_data);
+
 #ifdef __cplusplus
 }
 #endif
@@ -29,6 +29,11 @@
 #include <regex.h>
 #include <string.h>
 
+#include <algorithm>
+#include <system_error>
+#include <thread>
+#include <vector>
+
 #include "qof.h"
 #include "qof-backend.hpp"
 #include "qofbook-p.h"
@@ -90,6 +95,9 @@ struct _QofQuery
     /* The maximum number of results to return */
     gint              max_results;
 
+    /* Check the objects on several threads, see qof_query_set_parallel */
+    gboolean          parallel;
+
     /* list of books that will be participating in the query */
     GList *           books;
 
@@ -103,13 +111,33 @@ struct _QofQuery
     GList *           results;
 };
 
+/* A matching object and the order in which it was found. Matches that
+ * sort equal stay in that order, as they would with a stable sort. */
+struct QofQueryMatch
+{
+    gpointer          object;
+    gint              seq;
+};
+
 typedef struct _QofQueryCB
 {
     QofQuery *        query;
-    GList *           list;
+    GList *           plan;   /* AND-terms in evaluation order */
+    std::vector<QofQueryMatch> matches;
+    gboolean          parallel; /* check the objects on several threads */
+    gboolean          sorted; /* the results are sorted */
+    gint              limit;  /* max_results, -1 for no limit */
     gint              count;
 } QofQueryCB;
 
+/* Indexes registered with qof_query_register_index: a GPtrArray of
+ * QofQueryIndex for each object type. */
+static GHashTable *query_indexes = NULL;
+
+/* A parallel query uses a thread for each this many objects, up to the
+ * number of cores. */
+#define QUERY_PARALLEL_MIN_OBJECTS 4096
+
 /* initial_term will be owned by the new Query */
 static void query_init (QofQuery *q, QofQueryTerm *initial_term)
 {
@@ -353,6 +381,13 @@ sort_func (const gconstpointer a, const gconstpointer b, const gpointer q)
     }
 }
 
+static bool
+match_less (const QofQuery *q, const QofQueryMatch& a, const QofQueryMatch& b)
+{
+    int retval = sort_func (a.object, b.object, (gpointer)q);
+    return retval < 0 || (retval == 0 && a.seq < b.seq);
+}
+
 /* ==================================================================== */
 /* This is the main workhorse for performing the query.  For each
  * object, it walks over all of the query terms to see if the
@@ -360,14 +395,14 @@ sort_func (const gconstpointer a, const gconstpointer b, const gpointer q)
  */
 
 static int
-check_object (const QofQuery *q, gpointer object)
+check_object (const GList *terms, gpointer object)
 {
     const GList     * and_ptr;
     const GList     * or_ptr;
     const QofQueryTerm * qt;
     int       and_terms_ok = 1;
 
-    for (or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+    for (or_ptr = terms; or_ptr; or_ptr = or_ptr->next)
     {
         and_terms_ok = 1;
         for (and_ptr = static_cast<GList*>(or_ptr->data); and_ptr;
@@ -413,10 +448,119 @@ check_object (const QofQuery *q, gpointer object)
      * may want to get all objects, but in a particular sorted
      * order.
      */
-    if (NULL == q->terms) return 1;
+    if (NULL == terms) return 1;
     return 0;
 }
 
+/* ==================================================================== */
+/* The query planner.  The AND-terms of each OR-term are checked in
+ * order of their estimated cost, so that a cheap and selective GncGUID
+ * or date comparison rejects most objects before a string or regex
+ * match is tried, and a query with a single OR-term is run over a
+ * registered index instead of the whole collection when the index
+ * visits fewer objects.
+ */
+
+static int
+query_term_cost (const QofQueryTerm *qt)
+{
+    const QofQueryPredData *pd = qt->pdata;
+    int cost;
+
+    if (!g_strcmp0 (pd->type_name, QOF_TYPE_GUID))
+        cost = 0;
+    else if (!g_strcmp0 (pd->type_name, QOF_TYPE_CHAR) ||
+             !g_strcmp0 (pd->type_name, QOF_TYPE_BOOLEAN) ||
+             !g_strcmp0 (pd->type_name, QOF_TYPE_DATE) ||
+             !g_strcmp0 (pd->type_name, QOF_TYPE_INT32) ||
+             !g_strcmp0 (pd->type_name, QOF_TYPE_INT64) ||
+             !g_strcmp0 (pd->type_name, QOF_TYPE_DOUBLE))
+        cost = 1;
+    else if (!g_strcmp0 (pd->type_name, QOF_TYPE_NUMERIC))
+        cost = 2;
+    else if (!g_strcmp0 (pd->type_name, QOF_TYPE_STRING) &&
+             ((const query_string_def *)pd)->is_regex)
+        cost = 4;
+    else
+        cost = 3;
+
+    /* Each step of the parameter path is one more getter call. */
+    return cost * 4 + g_slist_length (qt->param_list);
+}
+
+static gint
+query_term_cost_cmp (gconstpointer a, gconstpointer b)
+{
+    int cost_a = query_term_cost (static_cast<const QofQueryTerm*>(a));
+    int cost_b = query_term_cost (static_cast<const QofQueryTerm*>(b));
+    return (cost_a > cost_b) - (cost_a < cost_b);
+}
+
+/* Return a copy of the query's OR-list of AND-lists with the AND-terms
+ * in evaluation order. The terms still belong to the query; free the
+ * plan with query_plan_free. */
+static GList *
+query_plan_terms (const QofQuery *q)
+{
+    GList *plan = NULL;
+    const GList *or_ptr;
+
+    for (or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+    {
+        GList *and_terms = g_list_copy (static_cast<GList*>(or_ptr->data));
+        /* g_list_sort is stable, equal costs keep the caller's order. */
+        plan = g_list_prepend (plan, g_list_sort (and_terms,
+                                                  query_term_cost_cmp));
+    }
+    return g_list_reverse (plan);
+}
+
+static void
+query_plan_free (GList *plan)
+{
+    g_list_free_full (plan, (GDestroyNotify)g_list_free);
+}
+
+/* Return the registered index that visits the fewest objects of book
+ * for the query, or NULL if none of them beats scanning the collection.
+ * An index serves a conjunction, so only a query with a single OR-term
+ * can use one. */
+static const QofQueryIndex *
+query_choose_index (const QofQuery *q, QofBook *book,
+                    gint64 *visits, gint64 *total)
+{
+    const QofQueryIndex *best = NULL;
+    GPtrArray *indexes = NULL;
+    QofCollection *col;
+    gint64 best_visits;
+    guint i;
+
+    col = q->search_for ? qof_book_get_collection (book, q->search_for) : NULL;
+    best_visits = col ? qof_collection_count (col) : 0;
+    if (total) *total = best_visits;
+
+    if (query_indexes && q->search_for)
+        indexes = static_cast<GPtrArray*>(g_hash_table_lookup (query_indexes,
+                                                               q->search_for));
+    if (indexes && q->terms && !q->terms->next)
+    {
+        const GList *and_terms = static_cast<GList*>(q->terms->data);
+        for (i = 0; i < indexes->len; i++)
+        {
+            auto index = static_cast<const QofQueryIndex*>(g_ptr_array_index (indexes, i));
+            gint64 estimate = index->estimate (book, and_terms);
+            if (estimate >= 0 && estimate < best_visits)
+            {
+                best = index;
+                best_visits = estimate;
+            }
+        }
+    }
+
+    if (visits) *visits = best_visits;
+    return best;
+}
+
 /* walk the list of parameters, starting with the given object, and
  * compile the list of parameter get-functions.  Save the last valid
  * parameter definition in "final" and return the list of functions.
@@ -564,18 +708,114 @@ static void compile_terms (QofQuery *q)
     LEAVE (" query=%p", q);
 }
 
+static void add_match (QofQueryCB* ql, gpointer object)
+{
+    QofQueryMatch match {object, ql->count++};
+
+    if (!ql->sorted || ql->limit < 0)
+    {
+        ql->matches.push_back (match);
+        return;
+    }
+
+    /* Only the last max_results in sort order are returned, so keep
+     * them in a heap with the first of them on top and drop the rest
+     * as they come. */
+    auto heap_cmp = [ql](const QofQueryMatch& a, const QofQueryMatch& b)
+                    { return match_less (ql->query, b, a); };
+    if (ql->matches.size () < (size_t)ql->limit)
+    {
+        ql->matches.push_back (match);
+        std::push_heap (ql->matches.begin (), ql->matches.end (), heap_cmp);
+    }
+    else if (ql->limit > 0 &&
+             match_less (ql->query, ql->matches.front (), match))
+    {
+        std::pop_heap (ql->matches.begin (), ql->matches.end (), heap_cmp);
+        ql->matches.back () = match;
+        std::push_heap (ql->matches.begin (), ql->matches.end (), heap_cmp);
+    }
+}
+
 static void check_item_cb (gpointer object, gpointer user_data)
 {
     QofQueryCB* ql = static_cast<QofQueryCB*>(user_data);
 
     if (!object || !ql) return;
 
-    if (check_object (ql->query, object))
+    if (check_object (ql->plan, object))
+        add_match (ql, object);
+    return;
+}
+
+static void collect_item_cb (gpointer object, gpointer user_data)
+{
+    static_cast<std::vector<gpointer>*>(user_data)->push_back (object);
+}
+
+/* A query may run on several threads if every getter its terms call
+ * only reads the object. The predicates of the core types in
+ * qofquerycore.cpp only read their predicate data. */
+static gboolean
+query_is_threadsafe (const QofQuery *q)
+{
+    for (const GList *or_ptr = q->terms; or_ptr; or_ptr = or_ptr->next)
+        for (const GList *and_ptr = static_cast<GList*>(or_ptr->data); and_ptr;
+             and_ptr = and_ptr->next)
+        {
+            auto qt = static_cast<const QofQueryTerm*>(and_ptr->data);
+            for (const GSList *node = qt->param_fcns; node; node = node->next)
+                if (!qof_class_param_is_threadsafe (static_cast<QofParam*>(node->data)))
+                    return FALSE;
+        }
+    return TRUE;
+}
+
+/* Check objects on up to one thread per core, each taking a contiguous
+ * slice. The matches are added in slice order, so the results are
+ * the same as those of checking the objects one by one. */
+static void
+check_objects_parallel (QofQueryCB* qcb, const std::vector<gpointer>& objects)
+{
+    size_t nthreads = std::min<size_t> (std::thread::hardware_concurrency (),
+                                        objects.size () / QUERY_PARALLEL_MIN_OBJECTS);
+    if (nthreads < 2)
+    {
+        for (auto object : objects)
+            check_item_cb (object, qcb);
+        return;
+    }
+
+    size_t slice = (objects.size () + nthreads - 1) / nthreads;
+    std::vector<std::vector<gpointer>> matches (nthreads);
+    auto check_slice = [&](size_t i)
     {
-        ql->list = g_list_prepend (ql->list, object);
-        ql->count++;
+        auto first = objects.begin () + std::min (i * slice, objects.size ());
+        auto last = objects.begin () + std::min ((i + 1) * slice, objects.size ());
+        for (auto object = first; object != last; ++object)
+            if (*object && check_object (qcb->plan, *object))
+                matches[i].push_back (*object);
+    };
+
+    std::vector<std::thread> threads;
+    size_t started = 0;
+    try
+    {
+        for (; started < nthreads; started++)
+            threads.emplace_back (check_slice, started);
     }
-    return;
+    catch (const std::system_error& err)
+    {
+        PWARN ("Could not start a query thread: %s", err.what ());
+    }
+    for (size_t i = started; i < nthreads; i++)
+        check_slice (i);
+    for (auto& thread : threads)
+        thread.join ();
+
+    for (const auto& slice_matches : matches)
+        for (auto object : slice_matches)
+            add_match (qcb, object);
 }
 
 static int param_list_cmp (const QofQueryParamList *l1, const QofQueryParamList *l2)
@@ -734,8 +974,6 @@ static GList * qof_query_run_internal (QofQuery *q,
     g_return_val_if_fail (run_cb, NULL);
     ENTER (" q=%p", q);
 
-    /* XXX: Prioritize the query terms? */
-
     /* prepare the Query for processing */
     if (q->changed)
     {
@@ -749,59 +987,39 @@ static GList * qof_query_run_internal (QofQuery *q,
 
     /* Now run the query over all the objects and save the results */
     {
-        QofQueryCB qcb;
+        QofQueryCB qcb {};
+        std::vector<QofQueryMatch>& matches = qcb.matches;
 
-        memset (&qcb, 0, sizeof (qcb));
         qcb.query = q;
+        qcb.plan = query_plan_terms (q);
+        qcb.parallel = q->parallel && query_is_threadsafe (q);
+        qcb.sorted = q->primary_sort.comp_fcn || q->primary_sort.obj_cmp ||
+            (q->primary_sort.use_default && q->defaultSort);
+        qcb.limit = q->max_results < 0 ? -1 : q->max_results;
 
         /* Run the query callback */
         run_cb(&qcb, cb_arg);
 
-        matching_objects = qcb.list;
+        query_plan_free (qcb.plan);
         object_count = qcb.count;
-    }
-    PINFO ("matching objects=%p count=%d", matching_objects, object_count);
 
-    /* There is no absolute need to reverse this list, since it's being
-     * sorted below. However, in the common case, we will be searching
-     * in a confined location where the objects are already in order,
-     * thus reversing will put us in the correct order we want and make
-     * the sorting go much faster.
-     */
-    matching_objects = g_list_reverse(matching_objects);
-
-    /* Now sort the matching objects based on the search criteria */
-    if (q->primary_sort.comp_fcn || q->primary_sort.obj_cmp ||
-            (q->primary_sort.use_default && q->defaultSort))
-    {
-        matching_objects = g_list_sort_with_data(matching_objects, sort_func, q);
-    }
-
-    /* Crop the list to limit the number of splits. */
-    if ((object_count > q->max_results) && (q->max_results > -1))
-    {
-        if (q->max_results > 0)
-        {
-            GList *mptr;
-
-            /* mptr is set to the first node of what will be the new list */
-            mptr = g_list_nth(matching_objects, object_count - q->max_results);
-            /* mptr should not be NULL, but let's be safe */
-            if (mptr != NULL)
-            {
-                if (mptr->prev != NULL) mptr->prev->next = NULL;
-                mptr->prev = NULL;
-            }
-            g_list_free(matching_objects);
-            matching_objects = mptr;
-        }
-        else
-        {
-            /* q->max_results == 0 */
-            g_list_free(matching_objects);
-            matching_objects = NULL;
-        }
+        /* Now sort the matching objects based on the search criteria */
+        if (qcb.sorted)
+            std::sort (matches.begin (), matches.end (),
+                       [q](const QofQueryMatch& a, const QofQueryMatch& b)
+                       { return match_less (q, a, b); });
+
+        /* Crop the matches to the last max_results; with a sort the
+         * heap in check_item_cb has already done this. */
+        auto first = matches.begin ();
+        if (qcb.limit >= 0 && matches.size () > (size_t)qcb.limit)
+            first = matches.end () - qcb.limit;
+
+        for (auto match = matches.end (); match != first; )
+            matching_objects = g_list_prepend (matching_objects,
+                                               (--match)->object);
     }
+    PINFO ("matching objects=%p count=%d", matching_objects, object_count);
 
     q->changed = 0;
 
@@ -822,24 +1040,27 @@ static void qof_query_run_cb(QofQueryCB* qcb, gpointer cb_arg)
     for (node = qcb->query->books; node; node = node->next)
     {
         QofBook* book = static_cast<QofBook*>(node->data);
-#ifdef QOF_BACKEND_QUERY
-        QofBackend* be = book->backend;
-
+        QofBackend* be = qof_book_get_backend (book);
 
+        /* Let the backend load what it hasn't loaded yet */
         if (be)
-        {
-            gpointer compiled_query = g_hash_table_lookup (qcb->query->be_compiled,
-                                      book);
+            be->load_for_query (book, qcb->query);
 
-            if (compiled_query && be->run_query)
-            {
-                (be->run_query) (be, compiled_query);
-            }
-        }
-#endif
-        /* And then iterate over all the objects */
-        qof_object_foreach (qcb->query->search_for, book,
-                            (QofInstanceForeachCB) check_item_cb, qcb);
+        /* And then iterate over the objects that can match */
+        auto index = query_choose_index (qcb->query, book, NULL, NULL);
+        auto item_cb = qcb->parallel ? collect_item_cb : check_item_cb;
+        std::vector<gpointer> objects;
+        gpointer item_data = qcb->parallel ? (gpointer)&objects : (gpointer)qcb;
+
+        if (index)
+            index->foreach (book, static_cast<GList*>(qcb->query->terms->data),
+                            (QofInstanceForeachCB) item_cb, item_data);
+        else
+            qof_object_foreach (qcb->query->search_for, book,
+                                (QofInstanceForeachCB) item_cb, item_data);
+
+        if (qcb->parallel)
+            check_objects_parallel (qcb, objects);
     }
 }
 
@@ -987,9 +1208,33 @@ GSList * qof_query_get_term_type (QofQuery *q, QofQueryParamList *term_param)
     return g_slist_reverse (results);
 }
 
+/* Called as each query is destroyed. They don't go through the query's
+ * books, which may have been destroyed before it. */
+static std::vector<std::pair<QofQueryDestroyHandler, gpointer>> destroy_handlers;
+
+void qof_query_add_destroy_handler (QofQueryDestroyHandler handler,
+                                    gpointer user_data)
+{
+    g_return_if_fail (handler != NULL);
+    destroy_handlers.emplace_back (handler, user_data);
+}
+
+void qof_query_remove_destroy_handler (QofQueryDestroyHandler handler,
+                                       gpointer user_data)
+{
+    auto entry = std::find (destroy_handlers.begin (), destroy_handlers.end (),
+                            std::make_pair (handler, user_data));
+    if (entry != destroy_handlers.end ())
+        destroy_handlers.erase (entry);
+}
+
 void qof_query_destroy (QofQuery *q)
 {
     if (!q) return;
+    /* A handler may remove itself, so go through a copy. */
+    auto handlers = destroy_handlers;
+    for (const auto& entry : handlers)
+        entry.first (q, entry.second);
     free_members (q);
     query_clear_compiles (q);
     g_hash_table_destroy (q->be_compiled);
@@ -1048,6 +1293,7 @@ QofQuery * qof_query_invert (QofQuery *q)
     case 0:
         retval = qof_query_create();
         retval->max_results = q->max_results;
+        retval->parallel    = q->parallel;
         break;
 
         /* This is the DeMorgan expansion for a single AND expression. */
@@ -1055,6 +1301,7 @@ QofQuery * qof_query_invert (QofQuery *q)
     case 1:
         retval = qof_query_create();
         retval->max_results = q->max_results;
+        retval->parallel    = q->parallel;
         retval->books = g_list_copy (q->books);
         retval->search_for = q->search_for;
         retval->changed = 1;
@@ -1088,6 +1335,7 @@ QofQuery * qof_query_invert (QofQuery *q)
         retval = qof_query_merge(iright, ileft, QOF_QUERY_AND);
         retval->books          = g_list_copy (q->books);
         retval->max_results    = q->max_results;
+        retval->parallel       = q->parallel;
         retval->search_for     = q->search_for;
         retval->changed        = 1;
 
@@ -1148,6 +1396,7 @@ qof_query_merge(QofQuery *q1, QofQuery *q2, QofQueryOp op)
             g_list_concat(copy_or_terms(q1->terms), copy_or_terms(q2->terms));
         retval->books           = merge_books (q1->books, q2->books);
         retval->max_results    = q1->max_results;
+        retval->parallel       = q1->parallel;
         retval->changed        = 1;
         break;
 
@@ -1155,6 +1404,7 @@ qof_query_merge(QofQuery *q1, QofQuery *q2, QofQueryOp op)
         retval = qof_query_create();
         retval->books          = merge_books (q1->books, q2->books);
         retval->max_results    = q1->max_results;
+        retval->parallel       = q1->parallel;
         retval->changed        = 1;
 
         /* g_list_append() can take forever, so let's build the list in
@@ -1273,6 +1523,12 @@ void qof_query_set_max_results (QofQuery *q, int n)
     q->max_results = n;
 }
 
+void qof_query_set_parallel (QofQuery *q, gboolean parallel)
+{
+    if (!q) return;
+    q->parallel = parallel;
+}
+
 void qof_query_add_guid_list_match (QofQuery *q, QofQueryParamList *param_list,
                                     GList *guid_list, QofGuidMatch options,
                                     QofQueryOp op)
@@ -1348,10 +1604,39 @@ void qof_query_init (void)
 
 void qof_query_shutdown (void)
 {
+    if (query_indexes)
+    {
+        g_hash_table_destroy (query_indexes);
+        query_indexes = NULL;
+    }
     qof_class_shutdown ();
     qof_query_core_shutdown ();
 }
 
+void qof_query_register_index (QofIdTypeConst obj_type,
+                               const QofQueryIndex *index)
+{
+    GPtrArray *indexes;
+
+    g_return_if_fail (obj_type);
+    g_return_if_fail (index && index->estimate && index->foreach);
+
+    if (!query_indexes)
+        query_indexes = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                               (GDestroyNotify)g_ptr_array_unref);
+
+    indexes = static_cast<GPtrArray*>(g_hash_table_lookup (query_indexes, obj_type));
+    if (!indexes)
+    {
+        indexes = g_ptr_array_new ();
+        g_hash_table_insert (query_indexes, g_strdup (obj_type), indexes);
+    }
+    for (guint i = 0; i < indexes->len; i++)
+        if (g_ptr_array_index (indexes, i) == index)
+            return;
+    g_ptr_array_add (indexes, (gpointer)index);
+}
+
 int qof_query_get_max_results (const QofQuery *q)
 {
     if (!q) return 0;
@@ -1499,6 +1784,7 @@ static GList *qof_query_printTerms (QofQuery * query, GList * output);
 static GList *qof_query_printSorts (QofQuerySort *s[], const gint numSorts,
                                     GList * output);
 static GList *qof_query_printAndTerms (GList * terms, GList * output);
+static GList *qof_query_printPlan (QofQuery * query, GList * output);
 static const char *qof_query_printStringForHow (QofQueryCompare how);
 static const char *qof_query_printStringMatch (QofStringMatch s);
 static const char *qof_query_printDateMatch (QofDateMatch d);
@@ -1551,6 +1837,8 @@ qof_query_print (QofQuery * query)
     g_string_printf (str, "Maximum number of results: %d", maxResults);
     output = g_list_append (output, str);
 
+    output = qof_query_printPlan (query, output);
+
     qof_query_printOutput (output);
     LEAVE (" ");
 }
@@ -1570,6 +1858,96 @@ qof_query_printOutput (GList * output)
     }
 }
 
+gchar *
+qof_query_explain (QofQuery *q)
+{
+    GList *output, *lst;
+    GString *str;
+
+    g_return_val_if_fail (q, NULL);
+
+    /* The plan depends on the compiled parameter getters. */
+    if (q->changed)
+    {
+        query_clear_compiles (q);
+        compile_terms (q);
+    }
+
+    str = g_string_new (NULL);
+    output = qof_query_printPlan (q, NULL);
+    for (lst = output; lst; lst = lst->next)
+    {
+        GString *line = (GString *) lst->data;
+
+        g_string_append (str, line->str);
+        g_string_append_c (str, '\n');
+        g_string_free (line, TRUE);
+    }
+    g_list_free (output);
+    return g_string_free (str, FALSE);
+}
+
+/*
+        Show the plan qof_query_run will follow: how the objects of
+        each book are found and the order in which the AND terms are
+        checked.
+*/
+static GList *
+qof_query_printPlan (QofQuery * query, GList * output)
+{
+    GList *plan, *lst, *node;
+
+    output = g_list_append (output, g_string_new ("Query Plan:"));
+    for (lst = query->books; lst; lst = lst->next)
+    {
+        QofBook *book = static_cast<QofBook*>(lst->data);
+        gint64 visits, total;
+        const QofQueryIndex *index;
+        GString *gs = g_string_new ("  ");
+
+        index = query_choose_index (query, book, &visits, &total);
+        if (index)
+            g_string_append_printf (gs, "Book %p: index %s, %" G_GINT64_FORMAT
+                                    " of %" G_GINT64_FORMAT " objects",
+                                    book, index->name, visits, total);
+        else
+            g_string_append_printf (gs, "Book %p: scan %" G_GINT64_FORMAT
+                                    " objects", book, total);
+        output = g_list_append (output, gs);
+    }
+
+    if (query->parallel)
+        output = g_list_append (output, g_string_new (query_is_threadsafe (query) ?
+                                "  Parallel: yes" :
+                                "  Parallel: no, a getter is not thread-safe"));
+
+    plan = query_plan_terms (query);
+    for (lst = plan; lst; lst = lst->next)
+    {
+        GString *gs = g_string_new ("  Term order:");
+
+        for (node = static_cast<GList*>(lst->data); node; node = node->next)
+        {
+            QofQueryTerm *qt = static_cast<QofQueryTerm*>(node->data);
+            QofQueryParamList *path;
+
+            g_string_append (gs, node == lst->data ? " " : ", ");
+            if (qt->invert)
+                g_string_append (gs, "NOT ");
+            for (path = qt->param_list; path; path = path->next)
+            {
+                g_string_append (gs, static_cast<char*>(path->data));
+                if (path->next)
+                    g_string_append (gs, "->");
+            }
+        }
+        output = g_list_append (output, gs);
+    }
+    query_plan_free (plan);
+
+    return output;
+}       /* qof_query_printPlan */
+
 /*
         Get the search_for type--This is the type of Object
         we are searching for (SPLIT, TRANS, etc)
@@ -360,6 +360,17 @@ void qof_query_set_sort_increasing (QofQuery *q, gboolean prim_inc,
  */
 void qof_query_set_max_results (QofQuery *q, int n);
 
+/**
+ * Let qof_query_run check the objects on several threads.  The objects
+ * are split into slices that are checked concurrently, and the matches
+ * are merged in the order a serial run would find them, so the results
+ * don't change.  This only happens if every parameter getter the query
+ * terms call was marked with qof_class_set_params_threadsafe(); the
+ * predicates of the core types only read their data.  Sorting is still
+ * done on the calling thread.
+ */
+void qof_query_set_parallel (QofQuery *q, gboolean parallel);
+
 /** Compare two queries for equality.
  * Query terms are compared each to each.
  * This is a simplistic
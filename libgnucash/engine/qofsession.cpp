@@ -55,6 +55,7 @@ static QofLogModule log_module = QOF_MOD_SESSION;
 #include "qof-backend.hpp"
 #include "qofsession.hpp"
 #include "gnc-backend-prov.hpp"
+#include "TransLog.h"
 
 #include <vector>
 #include <boost/algorithm/string.hpp>
@@ -436,6 +437,9 @@ QofSessionImpl::is_saving () const noexcept
 void
 QofSessionImpl::save (QofPercentageFunc percentage_func) noexcept
 {
+    /* Logged changes held in memory get to the disk no later than the
+     * book they were made to. */
+    xaccLogFlush ();
     if (!qof_book_session_not_saved (m_book)) //Clean book, nothing to do.
         return;
     m_saving = true;
@@ -477,6 +481,7 @@ QofSessionImpl::save (QofPercentageFunc percentage_func) noexcept
 void
 QofSessionImpl::safe_save (QofPercentageFunc percentage_func) noexcept
 {
+    xaccLogFlush ();
     if (!(m_backend && m_book)) return;
     if (qof_book_get_backend (m_book) != m_backend)
         qof_book_set_backend (m_book, m_backend);
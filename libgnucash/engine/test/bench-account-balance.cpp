@@ -0,0 +1,162 @@
+/********************************************************************
+ * bench-account-balance.cpp: Time as-of-date balance lookups on a  *
+ * synthetic account with a large number of splits.                 *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/* Usage: bench-account-balance [number-of-splits [number-of-lookups]]
+ *
+ * Builds an account holding one split per day (1M by default), then
+ * times xaccAccountGetBalanceAsOfDate against the linear walk over the
+ * split list that it used to do. Both must return the same balances.
+ */
+
+#include <glib.h>
+
+#include <config.h>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include <gnc-bench.hpp>
+
+#include "qof.h"
+#include "cashobjects.h"
+#include "Account.hpp"
+#include "Split.h"
+#include "Transaction.h"
+#include "TransLog.h"
+#include "gnc-commodity.h"
+
+static constexpr time64 seconds_per_day = 24 * 60 * 60;
+static constexpr time64 start_date = 946728000; /* 2000-01-01 12:00 UTC */
+
+static void
+populate_account (QofBook *book, Account *acc, Account *offset, int nsplits)
+{
+    auto table = gnc_commodity_table_get_table (book);
+    auto currency = gnc_commodity_table_lookup (table, "ISO4217", "USD");
+
+    xaccAccountBeginEdit (acc);
+    xaccAccountBeginEdit (offset);
+    for (int i = 0; i < nsplits; ++i)
+    {
+        auto amount = gnc_numeric_create ((i % 1000) - 400, 100);
+        auto trans = xaccMallocTransaction (book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, currency);
+        xaccTransSetDatePostedSecsNormalized (trans, start_date + i * seconds_per_day);
+
+        auto split = xaccMallocSplit (book);
+        xaccSplitSetParent (split, trans);
+        xaccSplitSetAccount (split, acc);
+        xaccSplitSetAmount (split, amount);
+        xaccSplitSetValue (split, amount);
+
+        auto other = xaccMallocSplit (book);
+        xaccSplitSetParent (other, trans);
+        xaccSplitSetAccount (other, offset);
+        xaccSplitSetAmount (other, gnc_numeric_neg (amount));
+        xaccSplitSetValue (other, gnc_numeric_neg (amount));
+        xaccTransCommitEdit (trans);
+    }
+    xaccAccountCommitEdit (offset);
+    xaccAccountCommitEdit (acc);
+}
+
+/* The algorithm xaccAccountGetBalanceAsOfDate used before the account
+ * kept a balance index. */
+static gnc_numeric
+linear_balance_as_of_date (Account *acc, time64 date)
+{
+    Split *latest = nullptr;
+
+    for (auto split : xaccAccountGetSplits (acc))
+    {
+        if (xaccTransGetDate (xaccSplitGetParent (split)) >= date)
+            break;
+        latest = split;
+    }
+    return latest ? xaccSplitGetBalance (latest) : gnc_numeric_zero ();
+}
+
+int
+main (int argc, char **argv)
+{
+    int nsplits = bench_arg (argc, argv, 1, 1000000);
+    int nlookups = bench_arg (argc, argv, 2, 1000);
+    int failures = 0;
+
+    qof_init ();
+    if (!cashobjects_register ())
+        return EXIT_FAILURE;
+    xaccLogDisable ();
+
+    auto book = qof_book_new ();
+    auto root = gnc_account_create_root (book);
+    auto acc = xaccMallocAccount (book);
+    auto offset = xaccMallocAccount (book);
+    gnc_account_append_child (root, acc);
+    gnc_account_append_child (root, offset);
+
+    auto start = Clock::now ();
+    populate_account (book, acc, offset, nsplits);
+    std::cout << "Created " << nsplits << " splits in "
+              << elapsed_ms (start) << " ms\n";
+
+    /* Bring the balances up to date outside of the timed loops. */
+    xaccAccountGetBalanceAsOfDate (acc, start_date);
+
+    std::mt19937 gen (42);
+    std::uniform_int_distribution<time64> dist (start_date - seconds_per_day,
+                                                start_date + (time64)nsplits * seconds_per_day);
+    std::vector<time64> dates (nlookups);
+    for (auto& date : dates)
+        date = dist (gen);
+
+    std::vector<gnc_numeric> expected;
+    expected.reserve (nlookups);
+    start = Clock::now ();
+    for (auto date : dates)
+        expected.push_back (linear_balance_as_of_date (acc, date));
+    auto linear_ms = elapsed_ms (start);
+
+    std::vector<gnc_numeric> actual;
+    actual.reserve (nlookups);
+    start = Clock::now ();
+    for (auto date : dates)
+        actual.push_back (xaccAccountGetBalanceAsOfDate (acc, date));
+    auto indexed_ms = elapsed_ms (start);
+
+    for (int i = 0; i < nlookups; ++i)
+        if (!gnc_numeric_equal (expected[i], actual[i]))
+            ++failures;
+
+    std::cout << nlookups << " lookups, linear scan: " << linear_ms
+              << " ms, balance index: " << indexed_ms << " ms\n";
+    if (failures)
+        std::cout << failures << " lookups returned different balances\n";
+
+    qof_book_destroy (book);
+    qof_close ();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
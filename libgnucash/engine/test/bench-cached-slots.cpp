@@ -0,0 +1,206 @@
+/********************************************************************
+ * bench-cached-slots.cpp: Time balance recomputes and online id    *
+ * scans that read KVP slots of every split and transaction.        *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/* Usage: bench-cached-slots [number-of-splits [number-of-passes]]
+ *
+ * Builds an account holding one split per day (1M by default) whose
+ * transactions carry notes and online ids, like an imported book, with
+ * every hundredth one a closing transaction. It then times full balance
+ * recomputes against the same loop reading the closing flag through a
+ * GValue as xaccTransGetIsClosingTxn used to, and a scan of the split
+ * online ids against one going through the "online-id" property. Both
+ * ways must agree.
+ */
+
+#include <glib.h>
+
+#include <config.h>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include <gnc-bench.hpp>
+
+#include "qof.h"
+#include "qofinstance-p.h"
+#include "cashobjects.h"
+#include "Account.hpp"
+#include "Split.h"
+#include "Transaction.h"
+#include "TransLog.h"
+#include "gnc-commodity.h"
+
+static constexpr time64 seconds_per_day = 24 * 60 * 60;
+static constexpr time64 start_date = 946728000; /* 2000-01-01 12:00 UTC */
+
+static void
+populate_account (QofBook *book, Account *acc, Account *offset, int nsplits)
+{
+    auto table = gnc_commodity_table_get_table (book);
+    auto currency = gnc_commodity_table_lookup (table, "ISO4217", "USD");
+
+    xaccAccountBeginEdit (acc);
+    xaccAccountBeginEdit (offset);
+    for (int i = 0; i < nsplits; ++i)
+    {
+        auto amount = gnc_numeric_create ((i % 1000) - 400, 100);
+        auto id = "FITID" + std::to_string (i);
+        auto trans = xaccMallocTransaction (book);
+        xaccTransBeginEdit (trans);
+        xaccTransSetCurrency (trans, currency);
+        xaccTransSetDatePostedSecsNormalized (trans, start_date + i * seconds_per_day);
+        xaccTransSetNotes (trans, "imported");
+        if (i % 100 == 99)
+            xaccTransSetIsClosingTxn (trans, TRUE);
+        qof_instance_set (QOF_INSTANCE (trans), "online-id", id.c_str (), NULL);
+
+        auto split = xaccMallocSplit (book);
+        xaccSplitSetParent (split, trans);
+        xaccSplitSetAccount (split, acc);
+        xaccSplitSetAmount (split, amount);
+        xaccSplitSetValue (split, amount);
+        qof_instance_set (QOF_INSTANCE (split), "online-id", id.c_str (), NULL);
+
+        auto other = xaccMallocSplit (book);
+        xaccSplitSetParent (other, trans);
+        xaccSplitSetAccount (other, offset);
+        xaccSplitSetAmount (other, gnc_numeric_neg (amount));
+        xaccSplitSetValue (other, gnc_numeric_neg (amount));
+        xaccTransCommitEdit (trans);
+    }
+    xaccAccountCommitEdit (offset);
+    xaccAccountCommitEdit (acc);
+}
+
+/* xaccTransGetIsClosingTxn before the slot was cached. */
+static gboolean
+gvalue_is_closing_txn (const Transaction *trans)
+{
+    GValue v = G_VALUE_INIT;
+    gboolean rv;
+    qof_instance_get_kvp (QOF_INSTANCE (trans), &v, 1, "book_closing");
+    if (G_VALUE_HOLDS_INT64 (&v))
+        rv = (g_value_get_int64 (&v) ? 1 : 0);
+    else
+        rv = 0;
+    g_value_unset (&v);
+    return rv;
+}
+
+/* The running balances of xaccAccountRecomputeBalance, reading the
+ * closing flag the old way. */
+static std::pair<gnc_numeric, gnc_numeric>
+gvalue_balances (Account *acc)
+{
+    auto balance = gnc_numeric_zero ();
+    auto noclosing_balance = gnc_numeric_zero ();
+    for (auto split : xaccAccountGetSplits (acc))
+    {
+        auto amt = xaccSplitGetAmount (split);
+        balance = gnc_numeric_add_fixed (balance, amt);
+        if (!gvalue_is_closing_txn (xaccSplitGetParent (split)))
+            noclosing_balance = gnc_numeric_add_fixed (noclosing_balance, amt);
+    }
+    return {balance, noclosing_balance};
+}
+
+int
+main (int argc, char **argv)
+{
+    int nsplits = bench_arg (argc, argv, 1, 1000000);
+    int npasses = bench_arg (argc, argv, 2, 5);
+    int failures = 0;
+
+    qof_init ();
+    if (!cashobjects_register ())
+        return EXIT_FAILURE;
+    xaccLogDisable ();
+
+    auto book = qof_book_new ();
+    auto root = gnc_account_create_root (book);
+    auto acc = xaccMallocAccount (book);
+    auto offset = xaccMallocAccount (book);
+    gnc_account_append_child (root, acc);
+    gnc_account_append_child (root, offset);
+
+    auto start = Clock::now ();
+    populate_account (book, acc, offset, nsplits);
+    std::cout << "Created " << nsplits << " splits in "
+              << elapsed_ms (start) << " ms\n";
+
+    const auto& splits = xaccAccountGetSplits (acc);
+    std::pair<gnc_numeric, gnc_numeric> expected;
+    start = Clock::now ();
+    for (int i = 0; i < npasses; ++i)
+        expected = gvalue_balances (acc);
+    auto gvalue_ms = elapsed_ms (start);
+
+    start = Clock::now ();
+    for (int i = 0; i < npasses; ++i)
+    {
+        gnc_account_set_balance_dirty (acc);
+        xaccAccountRecomputeBalance (acc);
+    }
+    auto cached_ms = elapsed_ms (start);
+    if (!gnc_numeric_equal (expected.first, xaccSplitGetBalance (splits.back ())) ||
+        !gnc_numeric_equal (expected.second,
+                            xaccSplitGetNoclosingBalance (splits.back ())))
+        ++failures;
+
+    int property_ids = 0;
+    start = Clock::now ();
+    for (auto split : splits)
+    {
+        gchar *id = nullptr;
+        qof_instance_get (QOF_INSTANCE (split), "online-id", &id, NULL);
+        if (id && *id)
+            ++property_ids;
+        g_free (id);
+    }
+    auto property_ms = elapsed_ms (start);
+
+    int cached_ids = 0;
+    start = Clock::now ();
+    for (auto split : splits)
+    {
+        auto id = xaccSplitGetOnlineID (split);
+        if (id && *id)
+            ++cached_ids;
+    }
+    auto scan_ms = elapsed_ms (start);
+    if (property_ids != cached_ids)
+        ++failures;
+
+    std::cout << npasses << " balance recomputes, GValue closing flag: "
+              << gvalue_ms << " ms, cached slot: " << cached_ms << " ms\n"
+              << "Online id scan, property: " << property_ms
+              << " ms, cached slot: " << scan_ms << " ms\n";
+    if (failures)
+        std::cout << "The cached slots gave different answers\n";
+
+    qof_book_destroy (book);
+    qof_close ();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
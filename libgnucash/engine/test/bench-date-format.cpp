@@ -0,0 +1,189 @@
+/********************************************************************
+ * bench-date-format.cpp: Time converting dates to and from the     *
+ * strings the file backends, logs and registers use.               *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/* Usage: bench-date-format [number-of-times]
+ *
+ * Converts times spread over a century (1M by default) in the local
+ * time zone the ways the engine does for every transaction it saves,
+ * loads, logs or shows: to and from the ISO strings of the XML and SQL
+ * backends, to a struct tm, and to and from a US format date. Each is
+ * timed through a GncDateTime, as the engine used to do it, and through
+ * the gnc-date function. Both ways must give the same results.
+ */
+
+#include <glib.h>
+
+#include <config.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <gnc-bench.hpp>
+
+#include "qof.h"
+#include "gnc-date.h"
+#include "gnc-datetime.hpp"
+
+static constexpr time64 start_date = 946728000; /* 2000-01-01 12:00 UTC */
+static constexpr time64 century = INT64_C(100) * 365 * 24 * 60 * 60;
+
+static bool
+same_tm (const struct tm& a, const struct tm& b)
+{
+    return a.tm_year == b.tm_year && a.tm_mon == b.tm_mon &&
+        a.tm_mday == b.tm_mday && a.tm_hour == b.tm_hour &&
+        a.tm_min == b.tm_min && a.tm_sec == b.tm_sec &&
+        a.tm_wday == b.tm_wday && a.tm_yday == b.tm_yday &&
+        a.tm_isdst == b.tm_isdst;
+}
+
+static void
+report (const char* what, double old_ms, double new_ms)
+{
+    std::cout << what << ", GncDateTime: " << old_ms << " ms, gnc-date: "
+              << new_ms << " ms\n";
+}
+
+int
+main (int argc, char **argv)
+{
+    int ntimes = bench_arg (argc, argv, 1, 1000000);
+    int failures = 0;
+
+    qof_init ();
+    qof_date_format_set (QOF_DATE_FORMAT_US);
+
+    /* A stride that's prime to the day and hour lands at every time of
+     * day, on both sides of DST changes. */
+    std::vector<time64> times;
+    times.reserve (ntimes);
+    for (int i = 0; i < ntimes; ++i)
+        times.push_back (start_date - century / 2 + (i * INT64_C(7919) * 397) % century);
+
+    std::vector<std::string> iso_strings;
+    iso_strings.reserve (ntimes);
+    auto start = Clock::now ();
+    for (auto t : times)
+        iso_strings.push_back (GncDateTime (t).format_iso8601 ());
+    auto old_ms = elapsed_ms (start);
+
+    char buff[MAX_DATE_LENGTH + 1];
+    start = Clock::now ();
+    for (int i = 0; i < ntimes; ++i)
+    {
+        gnc_time64_to_iso8601_buff (times[i], buff);
+        if (iso_strings[i] != buff)
+            ++failures;
+    }
+    report ("Writing ISO 8601 strings", old_ms, elapsed_ms (start));
+
+    time64 old_sum = 0, new_sum = 0;
+    start = Clock::now ();
+    for (const auto& str : iso_strings)
+        old_sum += static_cast<time64> (GncDateTime (str));
+    old_ms = elapsed_ms (start);
+
+    start = Clock::now ();
+    for (int i = 0; i < ntimes; ++i)
+    {
+        auto t = gnc_iso8601_to_time64_gmt (iso_strings[i].c_str ());
+        if (t != times[i])
+            ++failures;
+        new_sum += t;
+    }
+    report ("Reading ISO 8601 strings", old_ms, elapsed_ms (start));
+    if (old_sum != new_sum)
+        ++failures;
+
+    std::vector<struct tm> tms;
+    tms.reserve (ntimes);
+    start = Clock::now ();
+    for (auto t : times)
+        tms.push_back (static_cast<struct tm> (GncDateTime (t)));
+    old_ms = elapsed_ms (start);
+
+    start = Clock::now ();
+    for (int i = 0; i < ntimes; ++i)
+    {
+        struct tm tm;
+        if (!gnc_localtime_r (&times[i], &tm) || !same_tm (tm, tms[i]))
+            ++failures;
+    }
+    report ("Converting to local struct tm", old_ms, elapsed_ms (start));
+
+    std::vector<std::string> dates;
+    dates.reserve (ntimes);
+    auto format = qof_date_format_get_string (QOF_DATE_FORMAT_US);
+    start = Clock::now ();
+    for (auto t : times)
+        dates.push_back (GncDateTime (t).format (format));
+    old_ms = elapsed_ms (start);
+
+    start = Clock::now ();
+    for (int i = 0; i < ntimes; ++i)
+    {
+        qof_print_date_buff (buff, sizeof (buff), times[i]);
+        if (dates[i] != buff)
+            ++failures;
+    }
+    report ("Printing US dates", old_ms, elapsed_ms (start));
+
+    /* A trailing space sends qof_scan_date down its general path, which
+     * reads the same date. */
+    int64_t old_days = 0, new_days = 0;
+    start = Clock::now ();
+    for (auto& date : dates)
+    {
+        int day, month, year;
+        date += ' ';
+        if (qof_scan_date (date.c_str (), &day, &month, &year))
+            old_days += day + month + year;
+        date.pop_back ();
+    }
+    auto general_ms = elapsed_ms (start);
+
+    start = Clock::now ();
+    for (int i = 0; i < ntimes; ++i)
+    {
+        int day = 0, month = 0, year = 0;
+        if (qof_scan_date (dates[i].c_str (), &day, &month, &year))
+            new_days += day + month + year;
+        if (day != tms[i].tm_mday || month != tms[i].tm_mon + 1 ||
+            year != tms[i].tm_year + 1900)
+            ++failures;
+    }
+    auto scan_ms = elapsed_ms (start);
+    if (old_days != new_days)
+        ++failures;
+    std::cout << "Scanning US dates, general path: " << general_ms
+              << " ms, numeric fast path: " << scan_ms << " ms\n";
+
+    if (failures)
+        std::cout << failures << " conversions differ\n";
+
+    qof_close ();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,195 @@
+/********************************************************************
+ * bench-lot-assign.cpp: Time the FIFO lot lookup used to assign    *
+ * sales to lots in an account with many open lots.                 *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/* Usage: bench-lot-assign [number-of-lots [number-of-sales]]
+ *
+ * Builds a brokerage account holding one purchase lot per day (40k by
+ * default) in shuffled order, then sells them off one at a time, each
+ * time looking up the earliest open lot both with
+ * xaccAccountFindEarliestOpenLot and with the walk over every lot of
+ * the account that it used to do. Both must find the same lots.
+ */
+
+#include <glib.h>
+
+#include <config.h>
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <gnc-bench.hpp>
+
+#include "qof.h"
+#include "cashobjects.h"
+#include "Account.hpp"
+#include "Split.h"
+#include "Transaction.h"
+#include "TransLog.h"
+#include "cap-gains.h"
+#include "gnc-commodity.h"
+#include "gnc-lot.h"
+
+static constexpr time64 seconds_per_day = 24 * 60 * 60;
+static constexpr time64 start_date = 946728000; /* 2000-01-01 12:00 UTC */
+
+static Split *
+add_split (QofBook *book, Account *acc, Account *offset,
+           gnc_commodity *currency, time64 date, gnc_numeric amount)
+{
+    auto trans = xaccMallocTransaction (book);
+    auto split = xaccMallocSplit (book);
+    auto other = xaccMallocSplit (book);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, currency);
+    xaccTransSetDatePostedSecsNormalized (trans, date);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, acc);
+    xaccSplitSetAmount (split, amount);
+    xaccSplitSetValue (split, amount);
+    xaccSplitSetParent (other, trans);
+    xaccSplitSetAccount (other, offset);
+    xaccSplitSetAmount (other, gnc_numeric_neg (amount));
+    xaccSplitSetValue (other, gnc_numeric_neg (amount));
+    xaccTransCommitEdit (trans);
+    return split;
+}
+
+/* xaccAccountFindEarliestOpenLot for a sale before the lots were
+ * indexed. */
+struct LinearSearch
+{
+    GNCLot *lot;
+    gnc_commodity *currency;
+    time64 time;
+};
+
+static gpointer
+linear_helper (GNCLot *lot, gpointer user_data)
+{
+    auto search = static_cast<LinearSearch*>(user_data);
+    if (gnc_lot_is_closed (lot))
+        return nullptr;
+    auto split = gnc_lot_get_earliest_split (lot);
+    if (!split || !gnc_numeric_positive_p (xaccSplitGetAmount (split)))
+        return nullptr;
+    if (!gnc_numeric_positive_p (gnc_lot_get_balance (lot)))
+        return nullptr;
+    auto trans = xaccSplitGetParent (split);
+    if (search->currency &&
+        !gnc_commodity_equiv (search->currency, xaccTransGetCurrency (trans)))
+        return nullptr;
+    auto posted = xaccTransGetDate (trans);
+    if (search->time > posted)
+    {
+        search->time = posted;
+        search->lot = lot;
+    }
+    return nullptr;
+}
+
+static GNCLot *
+linear_earliest_open_lot (Account *acc, gnc_commodity *currency)
+{
+    LinearSearch search {nullptr, currency, G_MAXINT64};
+    xaccAccountForEachLot (acc, linear_helper, &search);
+    return search.lot;
+}
+
+int
+main (int argc, char **argv)
+{
+    int nlots = bench_arg (argc, argv, 1, 40000);
+    int nsales = bench_arg (argc, argv, 2, 1000);
+    int failures = 0;
+
+    qof_init ();
+    if (!cashobjects_register ())
+        return EXIT_FAILURE;
+    xaccLogDisable ();
+
+    auto book = qof_book_new ();
+    auto table = gnc_commodity_table_get_table (book);
+    auto currency = gnc_commodity_table_lookup (table, "ISO4217", "USD");
+    auto root = gnc_account_create_root (book);
+    auto acc = xaccMallocAccount (book);
+    auto offset = xaccMallocAccount (book);
+    gnc_account_append_child (root, acc);
+    gnc_account_append_child (root, offset);
+    xaccAccountSetCommodity (acc, currency);
+    xaccAccountSetCommodity (offset, currency);
+
+    std::vector<int> days (nlots);
+    std::iota (days.begin (), days.end (), 0);
+    std::shuffle (days.begin (), days.end (), std::mt19937 (42));
+
+    auto start = Clock::now ();
+    xaccAccountBeginEdit (acc);
+    xaccAccountBeginEdit (offset);
+    for (auto day : days)
+    {
+        auto lot = gnc_lot_new (book);
+        gnc_lot_add_split (lot, add_split (book, acc, offset, currency,
+                                           start_date + day * seconds_per_day,
+                                           gnc_numeric_create (100 + day % 50, 1)));
+    }
+    std::cout << "Created " << nlots << " lots in "
+              << elapsed_ms (start) << " ms\n";
+
+    auto sign = gnc_numeric_create (-1, 1);
+    double indexed_ms = 0, linear_ms = 0;
+    auto sale_date = start_date + nlots * seconds_per_day;
+    for (int i = 0; i < nsales; ++i)
+    {
+        start = Clock::now ();
+        auto lot = xaccAccountFindEarliestOpenLot (acc, sign, currency);
+        indexed_ms += elapsed_ms (start);
+
+        start = Clock::now ();
+        auto expected = linear_earliest_open_lot (acc, currency);
+        linear_ms += elapsed_ms (start);
+
+        if (lot != expected)
+            ++failures;
+        if (!lot)
+            break;
+        gnc_lot_add_split (lot, add_split (book, acc, offset, currency,
+                                           sale_date + i * seconds_per_day,
+                                           gnc_numeric_neg (gnc_lot_get_balance (lot))));
+    }
+    xaccAccountCommitEdit (offset);
+    xaccAccountCommitEdit (acc);
+
+    std::cout << nsales << " FIFO lookups, linear: " << linear_ms
+              << " ms, indexed: " << indexed_ms << " ms\n";
+    if (failures)
+        std::cout << "The indexed lookup found different lots\n";
+
+    qof_book_destroy (book);
+    qof_close ();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,202 @@
+/********************************************************************
+ * bench-pricedb-lookup.cpp: Time nearest-in-time price lookups and *
+ * balance conversions on a price database with long price series. *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, you can retrieve it from        *
+ * https://www.gnu.org/licenses/old-licenses/gpl-2.0.html           *
+ * or contact:                                                      *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+ ********************************************************************/
+
+/* Usage: bench-pricedb-lookup [securities [days [lookups]]]
+ *
+ * Fills a price database with one price per day for each security
+ * (100 securities over 20 years by default), then times
+ * gnc_pricedb_lookup_nearest_in_time64 against a walk over the price
+ * list like the one it used to do, and
+ * gnc_pricedb_convert_balance_nearest_price_t64 on the same dates, once
+ * cold and once repeated.
+ * Both lookups must find the same prices.
+ */
+
+#include <glib.h>
+
+#include <config.h>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gnc-bench.hpp>
+
+#include "qof.h"
+#include "cashobjects.h"
+#include "gnc-commodity.h"
+#include "gnc-pricedb.h"
+#include "TransLog.h"
+
+static constexpr time64 seconds_per_day = 24 * 60 * 60;
+static constexpr time64 start_date = 946728000; /* 2000-01-01 12:00 UTC */
+
+static std::vector<gnc_commodity*>
+populate_pricedb (QofBook *book, gnc_commodity *currency, int nsecurities,
+                  int ndays)
+{
+    auto table = gnc_commodity_table_get_table (book);
+    auto db = gnc_pricedb_get_db (book);
+    std::vector<gnc_commodity*> securities;
+
+    gnc_pricedb_set_bulk_update (db, TRUE);
+    for (int i = 0; i < nsecurities; ++i)
+    {
+        auto mnemonic = "SEC" + std::to_string (i);
+        auto security = gnc_commodity_new (book, mnemonic.c_str (), "NASDAQ",
+                                           mnemonic.c_str (), nullptr, 10000);
+        security = gnc_commodity_table_insert (table, security);
+        securities.push_back (security);
+
+        for (int day = 0; day < ndays; ++day)
+        {
+            auto price = gnc_price_create (book);
+            gnc_price_begin_edit (price);
+            gnc_price_set_commodity (price, security);
+            gnc_price_set_currency (price, currency);
+            gnc_price_set_time64 (price, start_date + day * seconds_per_day);
+            gnc_price_set_source (price, PRICE_SOURCE_FQ);
+            gnc_price_set_value (price, gnc_numeric_create (1000 + (day * 7 + i) % 500, 100));
+            gnc_price_commit_edit (price);
+            gnc_pricedb_add_price (db, price);
+            gnc_price_unref (price);
+        }
+    }
+    gnc_pricedb_set_bulk_update (db, FALSE);
+    return securities;
+}
+
+/* The walk over the newest-first price list that
+ * gnc_pricedb_lookup_nearest_in_time64 did before the price series. */
+static GNCPrice*
+linear_nearest_in_time (GNCPriceDB *db, gnc_commodity *c,
+                        gnc_commodity *currency, time64 t)
+{
+    auto prices = gnc_pricedb_get_prices (db, c, currency);
+    if (!prices)
+        return nullptr;
+
+    auto current = static_cast<GNCPrice*>(prices->data);
+    GNCPrice *next = nullptr;
+    for (auto node = prices; node; node = node->next)
+    {
+        auto p = static_cast<GNCPrice*>(node->data);
+        if (gnc_price_get_time64 (p) <= t)
+        {
+            next = p;
+            break;
+        }
+        current = p;
+    }
+
+    auto result = current;
+    if (next && llabs (gnc_price_get_time64 (current) - t) >=
+        llabs (gnc_price_get_time64 (next) - t))
+        result = next;
+    gnc_price_ref (result);
+    gnc_price_list_destroy (prices);
+    return result;
+}
+
+int
+main (int argc, char **argv)
+{
+    int nsecurities = bench_arg (argc, argv, 1, 100);
+    int ndays = bench_arg (argc, argv, 2, 7300);
+    int nlookups = bench_arg (argc, argv, 3, 10000);
+    int failures = 0;
+
+    qof_init ();
+    if (!cashobjects_register ())
+        return EXIT_FAILURE;
+    xaccLogDisable ();
+
+    auto book = qof_book_new ();
+    auto table = gnc_commodity_table_get_table (book);
+    auto currency = gnc_commodity_table_lookup (table, "ISO4217", "USD");
+    auto db = gnc_pricedb_get_db (book);
+
+    auto start = Clock::now ();
+    auto securities = populate_pricedb (book, currency, nsecurities, ndays);
+    std::cout << "Created " << gnc_pricedb_get_num_prices (db) << " prices in "
+              << elapsed_ms (start) << " ms\n";
+
+    std::mt19937 gen (42);
+    std::uniform_int_distribution<int> pick (0, nsecurities - 1);
+    std::uniform_int_distribution<time64> dist (start_date - seconds_per_day,
+                                                start_date + (time64)ndays * seconds_per_day);
+    std::vector<std::pair<gnc_commodity*, time64>> queries (nlookups);
+    for (auto& query : queries)
+        query = {securities[pick (gen)], dist (gen)};
+
+    std::vector<GNCPrice*> expected;
+    expected.reserve (nlookups);
+    start = Clock::now ();
+    for (const auto& [security, date] : queries)
+        expected.push_back (linear_nearest_in_time (db, security, currency, date));
+    auto linear_ms = elapsed_ms (start);
+
+    std::vector<GNCPrice*> actual;
+    actual.reserve (nlookups);
+    start = Clock::now ();
+    for (const auto& [security, date] : queries)
+        actual.push_back (gnc_pricedb_lookup_nearest_in_time64 (db, security,
+                                                                currency, date));
+    auto indexed_ms = elapsed_ms (start);
+
+    auto balance = gnc_numeric_create (123456, 100);
+    start = Clock::now ();
+    for (const auto& [security, date] : queries)
+        gnc_pricedb_convert_balance_nearest_price_t64 (db, balance, security,
+                                                       currency, date);
+    auto convert_ms = elapsed_ms (start);
+
+    /* Reports convert at the same dates over and over; the second pass
+     * is answered from the conversion cache. */
+    start = Clock::now ();
+    for (const auto& [security, date] : queries)
+        gnc_pricedb_convert_balance_nearest_price_t64 (db, balance, security,
+                                                       currency, date);
+    auto cached_ms = elapsed_ms (start);
+
+    for (int i = 0; i < nlookups; ++i)
+    {
+        if (expected[i] != actual[i])
+            ++failures;
+        gnc_price_unref (expected[i]);
+        gnc_price_unref (actual[i]);
+    }
+
+    std::cout << nlookups << " lookups, linear scan: " << linear_ms
+              << " ms, price series: " << indexed_ms << " ms\n"
+              << nlookups << " gnc_pricedb_convert_balance_nearest_price_t64: "
+              << convert_ms << " ms, repeated: " << cached_ms << " ms\n";
+    if (failures)
+        std::cout << failures << " lookups found different prices\n";
+
+    qof_book_destroy (book);
+    qof_close ();
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
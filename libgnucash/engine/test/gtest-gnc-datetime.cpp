@@ -569,6 +569,79 @@ TEST(gnc_datetime_functions, test_date)
     EXPECT_EQ(ymd.month, 11);
     EXPECT_EQ(ymd.day - (12 + atime.offset() / 3600) / 24, 13);
 }
+
+static void
+expect_local_tm_matches(time64 start, const char* where)
+{
+    //Every half hour and a bit over two days, taking in a DST change.
+    for (auto time = start; time < start + 2 * 86400; time += 1801)
+    {
+        struct tm fast;
+        ASSERT_TRUE(GncDateTime::local_tm(time, fast)) << where << " " << time;
+        auto slow = static_cast<struct tm>(GncDateTime(time));
+        EXPECT_EQ(fast.tm_year, slow.tm_year) << where << " " << time;
+        EXPECT_EQ(fast.tm_yday, slow.tm_yday) << where << " " << time;
+        EXPECT_EQ(fast.tm_wday, slow.tm_wday) << where << " " << time;
+        EXPECT_EQ(fast.tm_hour, slow.tm_hour) << where << " " << time;
+        EXPECT_EQ(fast.tm_min, slow.tm_min) << where << " " << time;
+        EXPECT_EQ(fast.tm_isdst, slow.tm_isdst) << where << " " << time;
+    }
+}
+
+TEST(gnc_datetime_functions, test_local_tm)
+{
+#ifdef __MINGW32__
+    TimeZoneProvider tzp_can{"A.U.S Eastern Standard Time"};
+    TimeZoneProvider tzp_la{"Pacific Standard Time"};
+#else
+    TimeZoneProvider tzp_can("Australia/Canberra");
+    TimeZoneProvider tzp_la("America/Los_Angeles");
+#endif
+    _set_tzp(tzp_la);
+    expect_local_tm_matches(1583571540, "Los Angeles"); //2020-03-08 start
+    expect_local_tm_matches(1604210340, "Los Angeles"); //2020-11-01 end
+    _reset_tzp();
+    _set_tzp(tzp_can);
+    expect_local_tm_matches(1601650740, "Canberra"); //2020-10-04 start
+    expect_local_tm_matches(1585929540, "Canberra"); //2020-04-05 end
+    _reset_tzp();
+
+    struct tm tm;
+    EXPECT_FALSE(GncDateTime::local_tm(MINTIME - 86400, tm));
+    EXPECT_FALSE(GncDateTime::local_tm(MAXTIME + 86400, tm));
+}
+
+TEST(gnc_datetime_functions, test_format_iso8601_buff)
+{
+    char buff[20];
+    for (time64 time : {INT64_C(0), INT64_C(2394187200), INT64_C(-1),
+                        INT64_C(-8640000001), MINTIME + 86400, MAXTIME - 1})
+    {
+        auto end = GncDateTime::format_iso8601(time, buff);
+        ASSERT_NE(end, nullptr) << time;
+        EXPECT_EQ(GncDateTime(time).format_iso8601(), buff);
+        EXPECT_EQ(end, buff + 19);
+    }
+    EXPECT_EQ(GncDateTime::format_iso8601(MINTIME - 1, buff), nullptr);
+    EXPECT_EQ(GncDateTime::format_iso8601(MAXTIME + 86400, buff), nullptr);
+}
+
+TEST(gnc_datetime_functions, test_parse_iso8601)
+{
+    time64 time;
+    for (auto str : {"2045-11-13 12:00:00", "2045-11-13 12:00:00 -0500",
+                     "2045-11-13 12:00:00+05:30", "20451113120000",
+                     "20451113120000-08", "1400-01-01 00:00:00",
+                     "2000-02-29 23:59:59  "})
+    {
+        EXPECT_TRUE(GncDateTime::parse_iso8601(str, time)) << str;
+        EXPECT_EQ(time, static_cast<time64>(GncDateTime(str))) << str;
+    }
+    for (auto str : {"", "2045", "1900-02-29 00:00:00", "2045-11-13 24:00:00",
+                     "2045-11-13 12:00:00.5", "2045-11-13T12:00:00",
+                     "2045-11-13 12:00:00 +05:", "1400-01-01 00:00:00 +01"})
+        EXPECT_FALSE(GncDateTime::parse_iso8601(str, time)) << str;
+}
 /* This test works only in the America/LosAngeles time zone and
  * there's no straightforward way to make it more flexible. It ensures
  * that DST in that timezone transitions correctly for each day of the
@@ -0,0 +1,469 @@
+/********************************************************************\
+ * gtest-translog.cpp -- Unit tests for the binary journal of       *
+ *                       TransLog.c                                 *
+ *                                                                  *
+ * This program is free software; you can redistribute it and/or    *
+ * modify it under the terms of the GNU General Public License as   *
+ * published by the Free Software Foundation; either version 2 of   *
+ * the License, or (at your option) any later version.              *
+ *                                                                  *
+ * This program is distributed in the hope that it will be useful,  *
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of   *
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the    *
+ * GNU General Public License for more details.                     *
+ *                                                                  *
+ * You should have received a copy of the GNU General Public License*
+ * along with this program; if not, contact:                        *
+ *                                                                  *
+ * Free Software Foundation           Voice:  +1-617-542-5942       *
+ * 51 Franklin Street, Fifth Floor    Fax:    +1-617-542-2652       *
+ * Boston, MA  02110-1301,  USA       gnu@gnu.org                   *
+\********************************************************************/
+
+#include <config.h>
+#include <glib.h>
+#include <glib/gstdio.h>
+#include "../Account.h"
+#include "../Transaction.h"
+#include "../TransLog.h"
+#include "../gnc-commodity.h"
+#include "../gnc-uri-utils.h"
+#include <qof.h>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+struct LoggedSplit
+{
+    GncGUID guid;
+    bool has_account;
+    GncGUID account_guid;
+    std::string account_name;
+    std::string memo;
+    std::string action;
+    char reconciled;
+    gnc_numeric amount;
+    gnc_numeric value;
+};
+
+struct LoggedTrans
+{
+    char flag;
+    GncGUID guid;
+    time64 date_posted;
+    std::string num;
+    std::string description;
+    std::string notes;
+    std::vector<LoggedSplit> splits;
+};
+
+using LoggedTransVec = std::vector<LoggedTrans>;
+
+static gboolean
+collect_trans (const XaccLogTrans *trans, gpointer data)
+{
+    auto records = static_cast<LoggedTransVec*>(data);
+    LoggedTrans record {trans->flag, trans->guid, trans->date_posted,
+                        trans->num, trans->description, trans->notes, {}};
+    for (guint i = 0; i < trans->num_splits; i++)
+    {
+        auto split = &trans->splits[i];
+        record.splits.push_back ({split->guid, split->has_account != FALSE,
+                                  split->account_guid, split->account_name,
+                                  split->memo, split->action, split->reconciled,
+                                  split->amount, split->value});
+    }
+    records->push_back (record);
+    return TRUE;
+}
+
+/* FNV-1a, as the journal checksums its records. */
+static guint32
+fnv1a (const guint8 *data, gsize len)
+{
+    guint32 hash = 2166136261u;
+    for (gsize i = 0; i < len; i++)
+        hash = (hash ^ data[i]) * 16777619u;
+    return hash;
+}
+
+static guint32
+read_u32 (const std::string& bytes, size_t pos)
+{
+    auto data = reinterpret_cast<const guint8*>(bytes.data () + pos);
+    return data[0] | (guint32)data[1] << 8 | (guint32)data[2] << 16 |
+        (guint32)data[3] << 24;
+}
+
+static std::string
+read_file (const std::string& path)
+{
+    gchar *contents = nullptr;
+    gsize length = 0;
+    if (!g_file_get_contents (path.c_str (), &contents, &length, nullptr))
+        return {};
+    std::string result {contents, length};
+    g_free (contents);
+    return result;
+}
+
+static void
+write_file (const std::string& path, const std::string& contents)
+{
+    g_file_set_contents (path.c_str (), contents.data (), contents.size (),
+                         nullptr);
+}
+
+/* The text log lines with the time of logging, which differs between
+ * two logs of the same changes, cut out. */
+static std::vector<std::string>
+text_lines_without_time (const std::string& text)
+{
+    std::vector<std::string> lines;
+    auto split_lines = g_strsplit (text.c_str (), "\n", -1);
+    for (auto line = split_lines; *line; line++)
+    {
+        auto fields = g_strsplit (*line, "\t", -1);
+        if (g_strv_length (fields) > 3 && fields[0][0] != 'm')
+        {
+            g_free (fields[3]);
+            fields[3] = g_strdup ("");
+        }
+        auto joined = g_strjoinv ("\t", fields);
+        lines.push_back (joined);
+        g_free (joined);
+        g_strfreev (fields);
+    }
+    g_strfreev (split_lines);
+    return lines;
+}
+
+class TransLogTest : public testing::Test
+{
+protected:
+    void SetUp()
+    {
+        m_book = qof_book_new ();
+        m_table = gnc_commodity_table_new ();
+        qof_book_set_data (m_book, GNC_COMMODITY_TABLE, m_table);
+        m_usd = gnc_commodity_new (m_book, "United States Dollar", "CURRENCY",
+                                   "USD", NULL, 100);
+        gnc_commodity_table_insert (m_table, m_usd);
+
+        m_root = gnc_account_create_root (m_book);
+        m_bank = make_account ("Bank");
+        m_food = make_account ("Food");
+
+        xaccLogEnable ();
+        xaccLogSetBinary (TRUE);
+        use_new_dir ();
+    }
+
+    void TearDown()
+    {
+        xaccCloseLog ();
+        xaccLogSetBinary (FALSE);
+        xaccLogSetFlushInterval (0);
+        xaccLogDisable ();
+        for (auto& dir : m_dirs)
+        {
+            for (auto& path : log_files (dir))
+                g_unlink (path.c_str ());
+            g_rmdir (dir.c_str ());
+        }
+
+        if (m_trans)
+        {
+            xaccTransBeginEdit (m_trans);
+            xaccTransDestroy (m_trans);
+            xaccTransCommitEdit (m_trans);
+        }
+        xaccAccountBeginEdit (m_root);
+        xaccAccountDestroy (m_root);
+        gnc_commodity_destroy (m_usd);
+        qof_book_set_data (m_book, GNC_COMMODITY_TABLE, nullptr);
+        gnc_commodity_table_destroy (m_table);
+        qof_book_destroy (m_book);
+    }
+
+    Account* make_account (const char *name)
+    {
+        auto acc = xaccMallocAccount (m_book);
+        xaccAccountBeginEdit (acc);
+        xaccAccountSetName (acc, name);
+        xaccAccountSetCommodity (acc, m_usd);
+        gnc_account_append_child (m_root, acc);
+        xaccAccountCommitEdit (acc);
+        return acc;
+    }
+
+    /* Log to a new, empty directory from now on. */
+    void use_new_dir ()
+    {
+        auto dir = g_dir_make_tmp ("gtest-translog-XXXXXX", nullptr);
+        ASSERT_NE (dir, nullptr);
+        m_dirs.push_back (dir);
+        auto base = g_build_filename (dir, "translog", nullptr);
+        xaccLogSetBaseName (base);
+        g_free (base);
+        g_free (dir);
+    }
+
+    std::vector<std::string> log_files (const std::string& dir)
+    {
+        std::vector<std::string> files;
+        auto gdir = g_dir_open (dir.c_str (), 0, nullptr);
+        if (!gdir)
+            return files;
+        while (auto name = g_dir_read_name (gdir))
+        {
+            auto path = g_build_filename (dir.c_str (), name, nullptr);
+            files.push_back (path);
+            g_free (path);
+        }
+        g_dir_close (gdir);
+        return files;
+    }
+
+    /* The log in the directory logged to now. */
+    std::string current_log ()
+    {
+        auto files = log_files (m_dirs.back ());
+        EXPECT_EQ (files.size (), 1u);
+        return files.empty () ? std::string {} : files.front ();
+    }
+
+    void add_trans ()
+    {
+        m_trans = xaccMallocTransaction (m_book);
+        xaccTransBeginEdit (m_trans);
+        xaccTransSetCurrency (m_trans, m_usd);
+        xaccTransSetDatePostedSecsNormalized (m_trans, 1700000000);
+        xaccTransSetNum (m_trans, "42");
+        xaccTransSetDescription (m_trans, "Groceries");
+        xaccTransSetNotes (m_trans, "weekly");
+
+        auto amount = gnc_numeric_create (1234, 100);
+        auto bank = xaccMallocSplit (m_book);
+        xaccSplitSetParent (bank, m_trans);
+        xaccSplitSetAccount (bank, m_bank);
+        xaccSplitSetMemo (bank, "card");
+        xaccSplitSetAmount (bank, gnc_numeric_neg (amount));
+        xaccSplitSetValue (bank, gnc_numeric_neg (amount));
+
+        auto food = xaccMallocSplit (m_book);
+        xaccSplitSetParent (food, m_trans);
+        xaccSplitSetAccount (food, m_food);
+        xaccSplitSetAction (food, "Buy");
+        xaccSplitSetReconcile (food, CREC);
+        xaccSplitSetAmount (food, amount);
+        xaccSplitSetValue (food, amount);
+        xaccTransCommitEdit (m_trans);
+    }
+
+    void edit_trans ()
+    {
+        xaccTransBeginEdit (m_trans);
+        xaccTransSetDescription (m_trans, "Groceries and more");
+        xaccTransCommitEdit (m_trans);
+    }
+
+    QofBook *m_book {};
+    gnc_commodity_table *m_table {};
+    gnc_commodity *m_usd {};
+    Account *m_root {};
+    Account *m_bank {};
+    Account *m_food {};
+    Transaction *m_trans {};
+    std::vector<std::string> m_dirs;
+};
+
+TEST_F (TransLogTest, journal_round_trip)
+{
+    add_trans ();
+    xaccCloseLog ();
+
+    auto path = current_log ();
+    EXPECT_TRUE (xaccLogIsJournal (path.c_str ()));
+
+    LoggedTransVec records;
+    ASSERT_TRUE (xaccLogReadJournal (path.c_str (), collect_trans, &records));
+    ASSERT_EQ (records.size (), 2u);
+
+    EXPECT_EQ (records[0].flag, 'B');
+    EXPECT_TRUE (guid_equal (&records[0].guid, xaccTransGetGUID (m_trans)));
+    EXPECT_TRUE (records[0].splits.empty ());
+
+    auto& commit = records[1];
+    EXPECT_EQ (commit.flag, 'C');
+    EXPECT_TRUE (guid_equal (&commit.guid, xaccTransGetGUID (m_trans)));
+    EXPECT_EQ (commit.date_posted, xaccTransGetDate (m_trans));
+    EXPECT_EQ (commit.num, "42");
+    EXPECT_EQ (commit.description, "Groceries");
+    EXPECT_EQ (commit.notes, "weekly");
+    ASSERT_EQ (commit.splits.size (), 2u);
+
+    for (auto& logged : commit.splits)
+    {
+        auto split = xaccSplitLookup (&logged.guid, m_book);
+        ASSERT_NE (split, nullptr);
+        auto acc = xaccSplitGetAccount (split);
+        EXPECT_TRUE (logged.has_account);
+        EXPECT_TRUE (guid_equal (&logged.account_guid, xaccAccountGetGUID (acc)));
+        EXPECT_EQ (logged.account_name, xaccAccountGetName (acc));
+        EXPECT_EQ (logged.memo, xaccSplitGetMemo (split));
+        EXPECT_EQ (logged.action, xaccSplitGetAction (split));
+        EXPECT_EQ (logged.reconciled, xaccSplitGetReconcile (split));
+        EXPECT_TRUE (gnc_numeric_equal (logged.amount, xaccSplitGetAmount (split)));
+        EXPECT_TRUE (gnc_numeric_equal (logged.value, xaccSplitGetValue (split)));
+    }
+}
+
+TEST_F (TransLogTest, journal_records_are_checksummed)
+{
+    add_trans ();
+    xaccCloseLog ();
+
+    auto bytes = read_file (current_log ());
+    ASSERT_EQ (bytes.compare (0, XACC_LOG_JOURNAL_MAGIC_LEN,
+                              XACC_LOG_JOURNAL_MAGIC), 0);
+
+    /* length, payload, FNV-1a of the payload; nothing after the last */
+    size_t pos = XACC_LOG_JOURNAL_MAGIC_LEN;
+    int count = 0;
+    while (pos < bytes.size ())
+    {
+        ASSERT_LE (pos + 4, bytes.size ());
+        auto len = read_u32 (bytes, pos);
+        ASSERT_LE (pos + 4 + len + 4, bytes.size ());
+        auto payload = reinterpret_cast<const guint8*>(bytes.data () + pos + 4);
+        EXPECT_EQ (payload[0], count ? 'C' : 'B');
+        EXPECT_EQ (read_u32 (bytes, pos + 4 + len), fnv1a (payload, len));
+        pos += 4 + len + 4;
+        count++;
+    }
+    EXPECT_EQ (pos, bytes.size ());
+    EXPECT_EQ (count, 2);
+}
+
+TEST_F (TransLogTest, journal_stops_at_torn_record)
+{
+    add_trans ();
+    xaccCloseLog ();
+
+    auto path = current_log ();
+    auto bytes = read_file (path);
+    auto first_len = read_u32 (bytes, XACC_LOG_JOURNAL_MAGIC_LEN);
+    auto second = XACC_LOG_JOURNAL_MAGIC_LEN + 4 + first_len + 4;
+    LoggedTransVec records;
+
+    /* cut off in the middle of the commit */
+    write_file (path, bytes.substr (0, bytes.size () - 3));
+    EXPECT_TRUE (xaccLogReadJournal (path.c_str (), collect_trans, &records));
+    ASSERT_EQ (records.size (), 1u);
+    EXPECT_EQ (records[0].flag, 'B');
+
+    /* cut off in the length of the commit */
+    records.clear ();
+    write_file (path, bytes.substr (0, second + 2));
+    EXPECT_TRUE (xaccLogReadJournal (path.c_str (), collect_trans, &records));
+    EXPECT_EQ (records.size (), 1u);
+
+    /* garbled inside the commit */
+    records.clear ();
+    auto garbled = bytes;
+    garbled[second + 10] ^= 0x55;
+    write_file (path, garbled);
+    EXPECT_TRUE (xaccLogReadJournal (path.c_str (), collect_trans, &records));
+    EXPECT_EQ (records.size (), 1u);
+
+    /* only the magic */
+    records.clear ();
+    write_file (path, XACC_LOG_JOURNAL_MAGIC);
+    EXPECT_TRUE (xaccLogReadJournal (path.c_str (), collect_trans, &records));
+    EXPECT_TRUE (records.empty ());
+
+    /* not a journal */
+    write_file (path, "mod\ttrans_guid\n");
+    EXPECT_FALSE (xaccLogIsJournal (path.c_str ()));
+    EXPECT_FALSE (xaccLogReadJournal (path.c_str (), collect_trans, &records));
+    EXPECT_TRUE (records.empty ());
+}
+
+TEST_F (TransLogTest, journal_to_text_matches_text_log)
+{
+    add_trans ();
+
+    /* the same edit, logged once as text and once as a journal */
+    xaccLogSetBinary (FALSE);
+    use_new_dir ();
+    edit_trans ();
+    xaccCloseLog ();
+    auto text_log = current_log ();
+
+    xaccLogDisable ();
+    xaccTransBeginEdit (m_trans);
+    xaccTransSetDescription (m_trans, "Groceries");
+    xaccTransCommitEdit (m_trans);
+    xaccLogEnable ();
+
+    xaccLogSetBinary (TRUE);
+    use_new_dir ();
+    edit_trans ();
+    xaccCloseLog ();
+    auto journal = current_log ();
+
+    auto converted = journal + ".txt";
+    ASSERT_TRUE (xaccLogJournalToText (journal.c_str (), converted.c_str ()));
+    auto text = read_file (text_log);
+    auto from_journal = read_file (converted);
+    g_unlink (converted.c_str ());
+
+    EXPECT_EQ (text.size (), from_journal.size ());
+    EXPECT_EQ (text_lines_without_time (text),
+               text_lines_without_time (from_journal));
+}
+
+/* A format switch reopens the log at once, usually within the same
+ * second; the journal and the text log must still be separate files. */
+TEST_F (TransLogTest, format_switch_keeps_files_apart)
+{
+    add_trans ();
+    xaccLogSetBinary (FALSE);
+    edit_trans ();
+    xaccCloseLog ();
+
+    auto files = log_files (m_dirs.back ());
+    ASSERT_EQ (files.size (), 2u);
+    for (auto& path : files)
+    {
+        if (g_str_has_suffix (path.c_str (), GNC_JOURNALFILE_EXT))
+        {
+            LoggedTransVec records;
+            EXPECT_TRUE (xaccLogReadJournal (path.c_str (), collect_trans,
+                                             &records));
+            EXPECT_EQ (records.size (), 2u);
+        }
+        else
+        {
+            EXPECT_TRUE (g_str_has_suffix (path.c_str (), GNC_LOGFILE_EXT));
+            EXPECT_FALSE (xaccLogIsJournal (path.c_str ()));
+            EXPECT_EQ (read_file (path).compare (0, 4, "mod\t"), 0);
+        }
+    }
+}
+
+TEST_F (TransLogTest, journal_held_until_flushed)
+{
+    xaccLogSetFlushInterval (60 * 60 * 1000);
+    add_trans ();
+
+    auto path = current_log ();
+    LoggedTransVec records;
+    xaccLogReadJournal (path.c_str (), collect_trans, &records);
+    EXPECT_TRUE (records.empty ());
+
+    xaccLogFlush ();
+    EXPECT_TRUE (xaccLogReadJournal (path.c_str (), collect_trans, &records));
+    EXPECT_EQ (records.size (), 2u);
+}
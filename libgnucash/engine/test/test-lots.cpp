@@ -30,6 +30,8 @@
 #include <ctype.h>
 #include "qof.h"
 #include "Account.h"
+#include "cap-gains.h"
+#include "gnc-commodity.h"
 #include "gnc-lot.h"
 #include "Scrub3.h"
 #include "cashobjects.h"
@@ -82,6 +84,99 @@ test_lot_kvp ()
     qof_session_end (sess);
 }
 
+static Split *
+add_lot_split (QofBook *book, Account *acc, Account *offset, GNCLot *lot,
+               gnc_commodity *currency, int day, gint64 amount)
+{
+    auto trans = xaccMallocTransaction (book);
+    auto split = xaccMallocSplit (book);
+    auto other = xaccMallocSplit (book);
+    auto amt = gnc_numeric_create (amount, 1);
+
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, currency);
+    xaccTransSetDatePostedSecsNormalized (trans, 946728000 + day * 86400);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, acc);
+    xaccSplitSetAmount (split, amt);
+    xaccSplitSetValue (split, amt);
+    xaccSplitSetParent (other, trans);
+    xaccSplitSetAccount (other, offset);
+    xaccSplitSetAmount (other, gnc_numeric_neg (amt));
+    xaccSplitSetValue (other, gnc_numeric_neg (amt));
+    xaccTransCommitEdit (trans);
+    gnc_lot_add_split (lot, split);
+    return split;
+}
+
+static void
+test_open_lot_index ()
+{
+    auto book = qof_book_new ();
+    auto table = gnc_commodity_table_get_table (book);
+    auto usd = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY, "USD");
+    auto eur = gnc_commodity_table_lookup (table, GNC_COMMODITY_NS_CURRENCY, "EUR");
+    auto root = gnc_account_create_root (book);
+    auto acc = xaccMallocAccount (book);
+    auto offset = xaccMallocAccount (book);
+    auto buy = gnc_numeric_create (1, 1), sell = gnc_numeric_create (-1, 1);
+    gnc_account_append_child (root, acc);
+    gnc_account_append_child (root, offset);
+    xaccAccountSetCommodity (acc, usd);
+    xaccAccountSetCommodity (offset, usd);
+
+    auto lot1 = gnc_lot_new (book);
+    auto lot2 = gnc_lot_new (book);
+    auto lot3 = gnc_lot_new (book);
+    auto short_lot = gnc_lot_new (book);
+    add_lot_split (book, acc, offset, lot1, usd, 3, 10);
+    auto split2 = add_lot_split (book, acc, offset, lot2, usd, 1, 5);
+    auto split3 = add_lot_split (book, acc, offset, lot3, usd, 5, 7);
+    add_lot_split (book, acc, offset, short_lot, usd, 2, -4);
+
+    /* A sale is assigned to the lots opened by purchases, and a purchase
+     * to the short lot. */
+    g_assert (xaccAccountFindEarliestOpenLot (acc, sell, usd) == lot2);
+    g_assert (xaccAccountFindLatestOpenLot (acc, sell, usd) == lot3);
+    g_assert (xaccAccountFindEarliestOpenLot (acc, buy, usd) == short_lot);
+    g_assert (xaccAccountFindEarliestOpenLot (acc, sell, NULL) == lot2);
+    g_assert (xaccAccountFindEarliestOpenLot (acc, sell, eur) == NULL);
+
+    /* Closing a lot takes it out. */
+    add_lot_split (book, acc, offset, lot2, usd, 6, -5);
+    g_assert (gnc_lot_is_closed (lot2));
+    g_assert (xaccAccountFindEarliestOpenLot (acc, sell, usd) == lot1);
+
+    /* So does overfilling one. */
+    auto sale = add_lot_split (book, acc, offset, lot1, usd, 7, -12);
+    g_assert (gnc_numeric_equal (gnc_lot_get_balance (lot1),
+                                 gnc_numeric_create (-2, 1)));
+    g_assert (xaccAccountFindEarliestOpenLot (acc, sell, usd) == lot3);
+
+    /* Changing the amount of a split in the lot puts it back. */
+    xaccSplitSetAmount (sale, gnc_numeric_create (-3, 1));
+    g_assert (gnc_numeric_equal (gnc_lot_get_balance (lot1),
+                                 gnc_numeric_create (7, 1)));
+    g_assert (xaccAccountFindEarliestOpenLot (acc, sell, usd) == lot1);
+
+    /* Changing the posted date of the opening split moves the lot. */
+    xaccTransSetDatePostedSecsNormalized (xaccSplitGetParent (split3), 946728000);
+    g_assert (xaccAccountFindEarliestOpenLot (acc, sell, usd) == lot3);
+    g_assert (xaccAccountFindLatestOpenLot (acc, sell, usd) == lot1);
+
+    /* Removing the opening split of a closed lot leaves the sale, which
+     * opens a short position. */
+    gnc_lot_remove_split (lot2, split2);
+    g_assert (gnc_numeric_equal (gnc_lot_get_balance (lot2),
+                                 gnc_numeric_create (-5, 1)));
+    g_assert (!gnc_lot_is_closed (lot2));
+    g_assert (xaccAccountFindEarliestOpenLot (acc, sell, usd) == lot3);
+    g_assert (xaccAccountFindEarliestOpenLot (acc, buy, usd) == short_lot);
+    g_assert (xaccAccountFindLatestOpenLot (acc, buy, usd) == lot2);
+
+    qof_book_destroy (book);
+}
+
 static void
 run_test (void)
 {
@@ -136,6 +231,7 @@ main (int argc, char **argv)
     }
 
     test_lot_kvp ();
+    test_open_lot_index ();
 
     /* 'erase' the recurring tag line with dummy spaces. */
     fprintf(stdout, "Lots: Test series complete.\n");
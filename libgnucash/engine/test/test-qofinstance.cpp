@@ -302,6 +302,58 @@ test_instance_get_set_slots( Fixture *fixture, gconstpointer pData )
 
 }
 
+static void
+test_instance_cached_slots( Fixture *fixture, gconstpointer pData )
+{
+    auto inst = fixture->inst;
+    GValue v = G_VALUE_INIT;
+
+    g_test_message( "Test the defaults when the slots are missing" );
+    g_assert_cmpint( qof_instance_get_cached_int64( inst, QOF_CACHED_SLOT_BOOK_CLOSING, 7 ), == , 7 );
+    g_assert( qof_instance_get_cached_string( inst, QOF_CACHED_SLOT_ONLINE_ID ) == NULL );
+    g_assert( qof_instance_get_cached_guid( inst, QOF_CACHED_SLOT_INVOICE ) == NULL );
+
+    g_test_message( "Test that setting a slot is seen after it was cached" );
+    g_value_init( &v, G_TYPE_STRING );
+    g_value_set_static_string( &v, "ABC123" );
+    qof_instance_set_kvp( inst, &v, 1, "online_id" );
+    g_value_unset( &v );
+    g_assert_cmpstr( qof_instance_get_cached_string( inst, QOF_CACHED_SLOT_ONLINE_ID ), == , "ABC123" );
+    g_value_init( &v, G_TYPE_INT64 );
+    g_value_set_int64( &v, 1 );
+    qof_instance_set_kvp( inst, &v, 1, "book_closing" );
+    g_value_unset( &v );
+    g_assert_cmpint( qof_instance_get_cached_int64( inst, QOF_CACHED_SLOT_BOOK_CLOSING, 0 ), == , 1 );
+    g_assert_cmpstr( qof_instance_get_cached_string( inst, QOF_CACHED_SLOT_ONLINE_ID ), == , "ABC123" );
+
+    g_test_message( "Test a slot of the wrong type" );
+    g_assert( qof_instance_get_cached_string( inst, QOF_CACHED_SLOT_BOOK_CLOSING ) == NULL );
+
+    g_test_message( "Test a write to a subframe, the way the backends load slots" );
+    auto guid = guid_new();
+    auto frame = qof_instance_get_slots( inst );
+    frame->set_path( {"gncInvoice", "other"}, new KvpValue( INT64_C(0) ) );
+    g_assert( qof_instance_get_cached_guid( inst, QOF_CACHED_SLOT_INVOICE ) == NULL );
+    auto subframe = frame->get_slot( {"gncInvoice"} )->get<KvpFrame*>();
+    delete subframe->set( {"invoice-guid"}, new KvpValue( guid ) );
+    g_assert( guid_equal( qof_instance_get_cached_guid( inst, QOF_CACHED_SLOT_INVOICE ), guid ) );
+
+    g_test_message( "Test removing a slot" );
+    qof_instance_set_kvp( inst, NULL, 1, "book_closing" );
+    g_assert_cmpint( qof_instance_get_cached_int64( inst, QOF_CACHED_SLOT_BOOK_CLOSING, 0 ), == , 0 );
+
+    g_test_message( "Test replacing the frame, as a rollback does" );
+    auto other = static_cast<QofInstance*>( g_object_new( QOF_TYPE_INSTANCE, NULL ) );
+    qof_instance_swap_kvp( inst, other );
+    g_assert( qof_instance_get_cached_string( inst, QOF_CACHED_SLOT_ONLINE_ID ) == NULL );
+    g_assert_cmpstr( qof_instance_get_cached_string( other, QOF_CACHED_SLOT_ONLINE_ID ), == , "ABC123" );
+    qof_instance_copy_kvp( inst, other );
+    g_assert_cmpstr( qof_instance_get_cached_string( inst, QOF_CACHED_SLOT_ONLINE_ID ), == , "ABC123" );
+    qof_instance_set_slots( inst, new KvpFrame );
+    g_assert( qof_instance_get_cached_string( inst, QOF_CACHED_SLOT_ONLINE_ID ) == NULL );
+    g_object_unref( other );
+}
+
 static void
 test_instance_version_cmp( void )
 {
@@ -978,6 +1030,7 @@ test_suite_qofinstance ( void )
     GNC_TEST_ADD_FUNC( suitename, "instance new and destroy", test_instance_new_destroy );
     GNC_TEST_ADD_FUNC( suitename, "init data", test_instance_init_data );
     GNC_TEST_ADD( suitename, "get set slots", Fixture, NULL, setup, test_instance_get_set_slots, teardown );
+    GNC_TEST_ADD( suitename, "cached slots", Fixture, NULL, setup, test_instance_cached_slots, teardown );
     GNC_TEST_ADD_FUNC( suitename, "version compare", test_instance_version_cmp );
     GNC_TEST_ADD( suitename, "get set dirty", Fixture, NULL, setup, test_instance_get_set_dirty, teardown );
     GNC_TEST_ADD( suitename, "display name", Fixture, NULL, setup, test_instance_display_name, teardown );
@@ -23,8 +23,15 @@
 #include <glib.h>
 
 #include <config.h>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
 #include "qof.h"
+#include "qofquery-p.h"
 #include "cashobjects.h"
+#include "Account.hpp"
+#include "Query.h"
 #include "Transaction.h"
 #include "TransLog.h"
 #include "gnc-engine.h"
@@ -65,6 +72,210 @@ test_trans_query (Transaction *trans, gpointer data)
     return 0;
 }
 
+struct IndexTestScope
+{
+    Account *acc;
+    time64 start, end;
+    std::vector<Split*> expected;
+};
+
+static void
+index_test_expected (QofInstance *inst, gpointer data)
+{
+    auto scope = static_cast<IndexTestScope*>(data);
+    auto split = GNC_SPLIT (inst);
+    auto date = xaccTransGetDate (xaccSplitGetParent (split));
+    auto recn = xaccSplitGetReconcile (split);
+
+    if (xaccSplitGetAccount (split) == scope->acc &&
+        date >= scope->start && date <= scope->end &&
+        (recn == NREC || recn == CREC))
+        scope->expected.push_back (split);
+}
+
+/* A query for the splits of one account in a date range is run over
+ * the account's splits. It must find the same splits as checking every
+ * split in the book. */
+static void
+test_split_query_index (QofBook *book, Account *root)
+{
+    IndexTestScope scope {nullptr, 0, 0, {}};
+    size_t most = 0;
+    QofQuery *q;
+    GList *accounts;
+    GList *results;
+    gchar *plan;
+
+    accounts = gnc_account_get_descendants (root);
+    for (GList *node = accounts; node; node = node->next)
+    {
+        auto acc = GNC_ACCOUNT (node->data);
+        if (xaccAccountGetSplits (acc).size () > most)
+        {
+            scope.acc = acc;
+            most = xaccAccountGetSplits (acc).size ();
+        }
+    }
+    g_list_free (accounts);
+    if (!scope.acc)
+        return;
+
+    xaccAccountSortSplits (scope.acc, TRUE);
+    const auto& splits = xaccAccountGetSplits (scope.acc);
+    scope.start = xaccTransGetDate (xaccSplitGetParent (splits[most / 4]));
+    scope.end = xaccTransGetDate (xaccSplitGetParent (splits[most * 3 / 4]));
+    qof_collection_foreach (qof_book_get_collection (book, GNC_ID_SPLIT),
+                            index_test_expected, &scope);
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    xaccQueryAddClearedMatch (q, static_cast<cleared_match_t>(CLEARED_NO | CLEARED_CLEARED),
+                              QOF_QUERY_AND);
+    xaccQueryAddDateMatchTT (q, TRUE, scope.start, TRUE, scope.end, QOF_QUERY_AND);
+    xaccQueryAddSingleAccountMatch (q, scope.acc, QOF_QUERY_AND);
+
+    plan = qof_query_explain (q);
+    do_test (strstr (plan, "index account splits") != NULL,
+             "split query uses the account index");
+    do_test (strstr (plan, "Term order: account->guid, reconcile-flag, "
+                     "trans->date-posted, trans->date-posted") != NULL,
+             "split query checks the account first");
+    g_free (plan);
+
+    results = qof_query_run (q);
+    do_test (g_list_length (results) == scope.expected.size (),
+             "index finds as many splits as a scan");
+    for (GList *node = results; node; node = node->next)
+        if (std::find (scope.expected.begin (), scope.expected.end (),
+                       node->data) == scope.expected.end ())
+        {
+            failure ("index found a split that doesn't match");
+            break;
+        }
+
+    /* A split put in the account inside an open edit only joins the
+     * account's splits on commit, so the query has to scan for it. */
+    auto trans = xaccMallocTransaction (book);
+    xaccTransBeginEdit (trans);
+    xaccTransSetCurrency (trans, xaccAccountGetCommodity (scope.acc));
+    xaccTransSetDatePostedSecs (trans, scope.start);
+    auto split = xaccMallocSplit (book);
+    xaccSplitSetParent (split, trans);
+    xaccSplitSetAccount (split, scope.acc);
+
+    plan = qof_query_explain (q);
+    do_test (strstr (plan, "index account splits") == NULL,
+             "split query scans while a transaction is open");
+    g_free (plan);
+    results = qof_query_run (q);
+    do_test (g_list_find (results, split) != NULL,
+             "query finds the split of the open transaction");
+
+    xaccTransDestroy (trans);
+    xaccTransCommitEdit (trans);
+
+    plan = qof_query_explain (q);
+    do_test (strstr (plan, "index account splits") != NULL,
+             "split query uses the index again after the commit");
+    g_free (plan);
+
+    qof_query_destroy (q);
+}
+
+/* With max_results set the query returns the last results in sort
+ * order, which must be the tail of the results of the unlimited query,
+ * also among splits that sort equal. */
+static void
+test_query_max_results (QofBook *book)
+{
+    QofQuery *q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+
+    for (int sort = 0; sort < 3; sort++)
+    {
+        if (sort == 1)
+            qof_query_set_sort_order (q, qof_query_build_param_list (SPLIT_RECONCILE, NULL),
+                                      NULL, NULL);
+        else if (sort == 2)
+            qof_query_set_sort_order (q, NULL, NULL, NULL);
+
+        qof_query_set_max_results (q, -1);
+        GList *all = g_list_copy (qof_query_run (q));
+        gint n = g_list_length (all);
+
+        for (gint limit : {0, 1, 7, n, n + 3})
+        {
+            qof_query_set_max_results (q, limit);
+            GList *results = qof_query_run (q);
+            GList *expected = g_list_nth (all, MAX (0, n - limit));
+
+            do_test (g_list_length (results) == g_list_length (expected),
+                     "max_results keeps the right number of results");
+            for (; results && expected; results = results->next, expected = expected->next)
+                if (results->data != expected->data)
+                {
+                    failure ("max_results kept different results");
+                    break;
+                }
+        }
+        g_list_free (all);
+    }
+    qof_query_destroy (q);
+}
+
+/* A parallel query must return exactly what a serial one does, and
+ * only run in parallel when its getters are thread-safe. */
+static void
+test_query_parallel (void)
+{
+    QofSession *session = get_random_session ();
+    QofBook *book = qof_session_get_book (session);
+    QofQuery *q;
+    GList *serial, *parallel, *a, *b;
+    gchar *plan;
+
+    add_random_transactions_to_book (book, 5000);
+
+    q = qof_query_create_for (GNC_ID_SPLIT);
+    qof_query_set_book (q, book);
+    qof_query_add_term (q, qof_query_build_param_list (SPLIT_TRANS, TRANS_DESCRIPTION, NULL),
+                        qof_query_string_predicate (QOF_COMPARE_CONTAINS, "a",
+                                                    QOF_STRING_MATCH_CASEINSENSITIVE, FALSE),
+                        QOF_QUERY_AND);
+    qof_query_add_term (q, qof_query_build_param_list (SPLIT_VALUE, NULL),
+                        qof_query_numeric_predicate (QOF_COMPARE_GT, QOF_NUMERIC_MATCH_ANY,
+                                                     gnc_numeric_zero ()),
+                        QOF_QUERY_AND);
+
+    serial = g_list_copy (qof_query_run (q));
+    qof_query_set_parallel (q, TRUE);
+    plan = qof_query_explain (q);
+    do_test (strstr (plan, "Parallel: yes") != NULL, "query runs in parallel");
+    g_free (plan);
+    parallel = qof_query_run (q);
+
+    do_test (g_list_length (serial) == g_list_length (parallel),
+             "parallel query finds as many splits");
+    for (a = serial, b = parallel; a && b; a = a->next, b = b->next)
+        if (a->data != b->data)
+        {
+            failure ("parallel query returned different splits");
+            break;
+        }
+    g_list_free (serial);
+
+    qof_query_add_term (q, qof_query_build_param_list (SPLIT_TRANS, TRANS_IS_CLOSING, NULL),
+                        qof_query_boolean_predicate (QOF_COMPARE_EQUAL, FALSE),
+                        QOF_QUERY_AND);
+    plan = qof_query_explain (q);
+    do_test (strstr (plan, "Parallel: no") != NULL,
+             "query with an unsafe getter runs serially");
+    g_free (plan);
+
+    qof_query_destroy (q);
+    qof_session_end (session);
+}
+
 static void
 run_test (void)
 {
@@ -79,6 +290,8 @@ run_test (void)
     add_random_transactions_to_book (book, 20);
 
     xaccAccountTreeForEachTransaction (root, test_trans_query, book);
+    test_split_query_index (book, root);
+    test_query_max_results (book);
 
     qof_session_end (session);
 }
@@ -106,6 +319,7 @@ main (int argc, char **argv)
     {
         run_test ();
     }
+    test_query_parallel ();
     success("queries seem to work");
 
 cleanup:
@@ -30,7 +30,7 @@
 /* Add specific headers for this class */
 #include "gnc-glib-utils.h"
 #include "../Account.h"
-#include "../AccountP.h"
+#include "../AccountP.hpp"
 #include "../Split.h"
 #include "../Transaction.h"
 #include "../gnc-lot.h"
@@ -893,7 +893,7 @@ test_xaccFreeAccount (Fixture *fixture, gconstpointer pData)
     /* Check that we've got children, lots, and splits to remove */
     g_assert (p_priv->children != NULL);
     g_assert (p_priv->lots != NULL);
-    g_assert (p_priv->splits != NULL);
+    g_assert (!p_priv->splits.empty());
     g_assert (p_priv->parent != NULL);
     g_assert (p_priv->commodity != NULL);
     g_assert_cmpint (check1->hits, ==, 0);
@@ -1008,7 +1008,7 @@ test_xaccAccountCommitEdit (Fixture *fixture, gconstpointer pData)
     /* Check that we've got children, lots, and splits to remove */
     g_assert (p_priv->children != NULL);
     g_assert (p_priv->lots != NULL);
-    g_assert (p_priv->splits != NULL);
+    g_assert (!p_priv->splits.empty());
     g_assert (p_priv->parent != NULL);
     g_assert (p_priv->commodity != NULL);
     g_assert_cmpint (check1->hits, ==, 0);
@@ -1024,7 +1024,7 @@ test_xaccAccountCommitEdit (Fixture *fixture, gconstpointer pData)
     test_signal_assert_hits (sig2, 0);
     g_assert (p_priv->children != NULL);
     g_assert (p_priv->lots != NULL);
-    g_assert (p_priv->splits != NULL);
+    g_assert (!p_priv->splits.empty());
     g_assert (p_priv->parent != NULL);
     g_assert (p_priv->commodity != NULL);
     g_assert_cmpint (check1->hits, ==, 0);
@@ -1397,19 +1397,19 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
 
     /* Check that the call fails with invalid account and split (throws) */
     g_assert (!gnc_account_insert_split (NULL, split1));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 0);
+    g_assert_cmpuint (priv->splits.size(), == , 0);
     g_assert (!priv->sort_dirty);
     g_assert (!priv->balance_dirty);
     test_signal_assert_hits (sig1, 0);
     test_signal_assert_hits (sig2, 0);
     g_assert (!gnc_account_insert_split (fixture->acct, NULL));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 0);
+    g_assert_cmpuint (priv->splits.size(), == , 0);
     g_assert (!priv->sort_dirty);
     g_assert (!priv->balance_dirty);
     test_signal_assert_hits (sig1, 0);
     test_signal_assert_hits (sig2, 0);
     /* g_assert (!gnc_account_insert_split (fixture->acct, (Split*)priv)); */
-    /* g_assert_cmpuint (g_list_length (priv->splits), == , 0); */
+    /* g_assert_cmpuint (priv->splits.size(), == , 0); */
     /* g_assert (!priv->sort_dirty); */
     /* g_assert (!priv->balance_dirty); */
     /* test_signal_assert_hits (sig1, 0); */
@@ -1422,7 +1422,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
 
     /* Check that it works the first time */
     g_assert (gnc_account_insert_split (fixture->acct, split1));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 1);
+    g_assert_cmpuint (priv->splits.size(), == , 1);
     g_assert (!priv->sort_dirty);
     g_assert (priv->balance_dirty);
     test_signal_assert_hits (sig1, 1);
@@ -1434,7 +1434,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     sig3 = test_signal_new (&fixture->acct->inst, GNC_EVENT_ITEM_ADDED, split2);
     /* Now add a second split to the account and check that sort_dirty isn't set. We have to bump the editlevel to force this. */
     g_assert (gnc_account_insert_split (fixture->acct, split2));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 2);
+    g_assert_cmpuint (priv->splits.size(), == , 2);
     g_assert (!priv->sort_dirty);
     g_assert (priv->balance_dirty);
     test_signal_assert_hits (sig1, 2);
@@ -1445,7 +1445,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     qof_instance_increase_editlevel (fixture->acct);
     g_assert (gnc_account_insert_split (fixture->acct, split3));
     qof_instance_decrease_editlevel (fixture->acct);
-    g_assert_cmpuint (g_list_length (priv->splits), == , 3);
+    g_assert_cmpuint (priv->splits.size(), == , 3);
     g_assert (priv->sort_dirty);
     g_assert (priv->balance_dirty);
     test_signal_assert_hits (sig1, 3);
@@ -1456,7 +1456,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     sig3 = test_signal_new (&fixture->acct->inst, GNC_EVENT_ITEM_REMOVED,
                             split3);
     g_assert (gnc_account_remove_split (fixture->acct, split3));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 2);
+    g_assert_cmpuint (priv->splits.size(), == , 2);
     g_assert (priv->sort_dirty);
     g_assert (!priv->balance_dirty);
     test_signal_assert_hits (sig1, 4);
@@ -1464,7 +1464,7 @@ test_gnc_account_insert_remove_split (Fixture *fixture, gconstpointer pData)
     /* And do it again to make sure that it fails when the split has
      * already been removed */
     g_assert (!gnc_account_remove_split (fixture->acct, split3));
-    g_assert_cmpuint (g_list_length (priv->splits), == , 2);
+    g_assert_cmpuint (priv->splits.size(), == , 2);
     g_assert (priv->sort_dirty);
     g_assert (!priv->balance_dirty);
     test_signal_assert_hits (sig1, 4);
@@ -1624,6 +1624,164 @@ test_xaccAccountRecomputeBalance (Fixture *fixture, gconstpointer pData)
     g_assert (!priv->balance_dirty);
 }
 
+/* Random edits for test_xaccAccountRecomputeBalance_incremental. Each
+ * transaction moves an amount between acct and offset. */
+static const char recompute_test_recn[] = {NREC, CREC, YREC, FREC, VREC};
+
+static void
+recompute_test_add_txn (Account *acct, Account *offset, gnc_commodity *curr)
+{
+    auto book = gnc_account_get_book (acct);
+    auto txn = xaccMallocTransaction (book);
+    auto amount = gnc_numeric_create (g_test_rand_int_range (-50000, 50000), 100);
+
+    xaccTransBeginEdit (txn);
+    xaccTransSetCurrency (txn, curr);
+    xaccTransSetDatePostedSecsNormalized (txn, g_test_rand_int_range (0, 365) * 86400);
+    if (g_test_rand_int_range (0, 10) == 0)
+        xaccTransSetIsClosingTxn (txn, TRUE);
+    auto split = xaccMallocSplit (book);
+    xaccSplitSetParent (split, txn);
+    xaccSplitSetAccount (split, acct);
+    xaccSplitSetAmount (split, amount);
+    xaccSplitSetValue (split, amount);
+    xaccSplitSetReconcile (split, recompute_test_recn[g_test_rand_int_range (0, G_N_ELEMENTS (recompute_test_recn))]);
+    auto other = xaccMallocSplit (book);
+    xaccSplitSetParent (other, txn);
+    xaccSplitSetAccount (other, offset);
+    xaccSplitSetAmount (other, gnc_numeric_neg (amount));
+    xaccSplitSetValue (other, gnc_numeric_neg (amount));
+    xaccTransCommitEdit (txn);
+}
+
+static void
+recompute_test_random_edit (Account *acct, Account *offset, gnc_commodity *curr)
+{
+    auto& splits = xaccAccountGetSplits (acct);
+    if (splits.empty ())
+    {
+        recompute_test_add_txn (acct, offset, curr);
+        return;
+    }
+    auto split = splits[g_test_rand_int_range (0, (gint32)splits.size ())];
+    auto txn = xaccSplitGetParent (split);
+    auto other = xaccSplitGetOtherSplit (split);
+
+    switch (g_test_rand_int_range (0, 6))
+    {
+    case 0:
+        recompute_test_add_txn (acct, offset, curr);
+        break;
+    case 1:
+        xaccTransBeginEdit (txn);
+        xaccTransDestroy (txn);
+        xaccTransCommitEdit (txn);
+        break;
+    case 2:
+    {
+        auto amount = gnc_numeric_create (g_test_rand_int_range (-50000, 50000), 100);
+        xaccTransBeginEdit (txn);
+        xaccSplitSetAmount (split, amount);
+        xaccSplitSetValue (split, amount);
+        xaccSplitSetAmount (other, gnc_numeric_neg (amount));
+        xaccSplitSetValue (other, gnc_numeric_neg (amount));
+        xaccTransCommitEdit (txn);
+        break;
+    }
+    case 3:
+        xaccSplitSetReconcile (split, recompute_test_recn[g_test_rand_int_range (0, G_N_ELEMENTS (recompute_test_recn))]);
+        break;
+    case 4:
+        xaccTransBeginEdit (txn);
+        xaccTransSetDatePostedSecsNormalized (txn, g_test_rand_int_range (0, 365) * 86400);
+        xaccTransCommitEdit (txn);
+        break;
+    case 5:
+        /* Splits inserted while the account is being edited are appended
+         * and merged into place by the sort. */
+        xaccAccountBeginEdit (acct);
+        for (auto i = g_test_rand_int_range (1, 5); i > 0; --i)
+            recompute_test_add_txn (acct, offset, curr);
+        xaccAccountCommitEdit (acct);
+        break;
+    }
+}
+
+struct RecomputeTestBalances
+{
+    std::vector<gnc_numeric> split_balances;
+    gnc_numeric balance, noclosing, cleared, reconciled, as_of_date;
+};
+
+static RecomputeTestBalances
+recompute_test_get_balances (AccountPrivate *priv, Account *acct, time64 date)
+{
+    RecomputeTestBalances bals;
+
+    xaccAccountSortSplits (acct, FALSE);
+    xaccAccountRecomputeBalance (acct);
+    g_assert (!priv->balance_dirty);
+    for (auto split : xaccAccountGetSplits (acct))
+    {
+        bals.split_balances.push_back (xaccSplitGetBalance (split));
+        bals.split_balances.push_back (xaccSplitGetNoclosingBalance (split));
+        bals.split_balances.push_back (xaccSplitGetClearedBalance (split));
+        bals.split_balances.push_back (xaccSplitGetReconciledBalance (split));
+    }
+    bals.balance = priv->balance;
+    bals.noclosing = priv->noclosing_balance;
+    bals.cleared = priv->cleared_balance;
+    bals.reconciled = priv->reconciled_balance;
+    bals.as_of_date = xaccAccountGetBalanceAsOfDate (acct, date);
+    return bals;
+}
+
+/* Each edit recomputes the running balances from the first split it
+ * touched; the result must match recomputing the whole account. */
+static void
+test_xaccAccountRecomputeBalance_incremental (void)
+{
+    auto book = qof_book_new ();
+    auto root = gnc_account_create_root (book);
+    auto acct = xaccMallocAccount (book);
+    auto offset = xaccMallocAccount (book);
+    auto curr = gnc_commodity_new (book, "US Dollar", "CURRENCY", "USD", "0", 100);
+    AccountTestFunctions *func = _utest_account_fill_functions ();
+    AccountPrivate *priv = func->get_private (acct);
+
+    gnc_account_append_child (root, acct);
+    gnc_account_append_child (root, offset);
+    xaccAccountSetCommodity (acct, curr);
+    xaccAccountSetCommodity (offset, curr);
+    for (int i = 0; i < 200; ++i)
+        recompute_test_add_txn (acct, offset, curr);
+
+    for (int i = 0; i < 500; ++i)
+    {
+        recompute_test_random_edit (acct, offset, curr);
+        if (g_test_rand_int_range (0, 50) == 0)
+            gnc_account_set_start_balance (acct, gnc_numeric_create (g_test_rand_int_range (-1000, 1000), 1));
+
+        auto date = g_test_rand_int_range (0, 366) * 86400;
+        auto incremental = recompute_test_get_balances (priv, acct, date);
+        gnc_account_set_balance_dirty (acct);
+        auto full = recompute_test_get_balances (priv, acct, date);
+
+        g_assert_cmpuint (incremental.split_balances.size (), ==,
+                          full.split_balances.size ());
+        for (size_t j = 0; j < full.split_balances.size (); ++j)
+            g_assert (gnc_numeric_equal (incremental.split_balances[j],
+                                         full.split_balances[j]));
+        g_assert (gnc_numeric_equal (incremental.balance, full.balance));
+        g_assert (gnc_numeric_equal (incremental.noclosing, full.noclosing));
+        g_assert (gnc_numeric_equal (incremental.cleared, full.cleared));
+        g_assert (gnc_numeric_equal (incremental.reconciled, full.reconciled));
+        g_assert (gnc_numeric_equal (incremental.as_of_date, full.as_of_date));
+    }
+    qof_book_destroy (book);
+    g_free (func);
+}
+
 /* xaccAccountOrder
 int
 xaccAccountOrder (const Account *aa, const Account *ab)// C: 11 in 3 */
@@ -2870,6 +3028,7 @@ test_suite_account (void)
     GNC_TEST_ADD (suitename, "gnc account insert & remove split", Fixture, NULL, setup, test_gnc_account_insert_remove_split,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccount Insert and Remove Lot", Fixture, &good_data, setup, test_xaccAccountInsertRemoveLot,  teardown );
     GNC_TEST_ADD (suitename, "xaccAccountRecomputeBalance", Fixture, &some_data, setup, test_xaccAccountRecomputeBalance,  teardown );
+    GNC_TEST_ADD_FUNC (suitename, "xaccAccountRecomputeBalance incremental", test_xaccAccountRecomputeBalance_incremental);
     GNC_TEST_ADD_FUNC (suitename, "xaccAccountOrder", test_xaccAccountOrder );
     GNC_TEST_ADD (suitename, "qofAccountSetParent", Fixture, &some_data, setup, test_qofAccountSetParent,  teardown );
     GNC_TEST_ADD (suitename, "gnc account append/remove child", Fixture, NULL, setup, test_gnc_account_append_remove_child,  teardown );
@@ -44,6 +44,37 @@ extern "C" void test_suite_transaction ( void );
 
 #include <qof-backend.hpp>
 #include <kvp-frame.hpp>
+#include <cstdlib>
+#include <new>
+#include <string>
+
+/* Count the C++ allocations made while allocation_counting is set.
+ * Every QofInstance allocates its KvpFrame, so cloned transactions and
+ * splits are counted along with copied slots. */
+static bool allocation_counting = false;
+static size_t allocation_count = 0;
+
+void*
+operator new (std::size_t size)
+{
+    if (allocation_counting)
+        ++allocation_count;
+    if (auto ptr = std::malloc (size ? size : 1))
+        return ptr;
+    throw std::bad_alloc ();
+}
+
+void
+operator delete (void *ptr) noexcept
+{
+    std::free (ptr);
+}
+
+void
+operator delete (void *ptr, std::size_t) noexcept
+{
+    std::free (ptr);
+}
 
 /* Copied from Transaction.c. Changing these values will break
  * existing databases, which is a good reason to fail a test.
@@ -706,16 +737,13 @@ static void
 test_xaccFreeTransaction (Fixture *fixture, gconstpointer pData)
 {
     Transaction *txn = fixture->txn;
-    Transaction *orig = xaccMallocTransaction (qof_instance_get_book (QOF_INSTANCE (txn)));
     auto split = static_cast<Split*>(txn->splits->data);
-    auto txn_num = "321";
     g_object_add_weak_pointer (G_OBJECT (txn->splits->data),
                                reinterpret_cast<void**>(&split));
     /* so the "free" doesn't, leaving the structure for us to test */
     g_object_ref (txn);
-    g_object_ref (orig);
-    orig->num = CACHE_INSERT (txn_num);
-    txn->orig = orig;
+    xaccTransBeginEdit (txn);
+    g_assert (txn->orig != NULL);
 
     fixture->func->xaccFreeTransaction (txn);
 
@@ -725,9 +753,7 @@ test_xaccFreeTransaction (Fixture *fixture, gconstpointer pData)
     g_assert (txn->description == NULL);
     g_assert_cmpint (txn->date_entered, ==, 0);
     g_assert_cmpint (txn->date_posted, ==, 0);
-    g_assert_cmpint (GPOINTER_TO_INT(orig->num), ==, 1);
     g_assert (txn->orig == NULL);
-    test_destroy (orig);
 
     g_test_log_set_fatal_handler ((GTestLogFatalFunc) test_log_handler, NULL);
 
@@ -1303,7 +1329,7 @@ test_xaccTransBeginEdit ()
 {
     QofBook *book = qof_book_new ();
     Transaction *txn = xaccMallocTransaction (book);
-    Transaction *dupe = NULL;
+    TransUndo *dupe = NULL;
     auto msg1 = "[xaccOpenLog] Attempt to open disabled transaction log";
     auto msg2 = "[xaccTransWriteLog] Attempt to write disabled transaction log";
     auto loglevel = static_cast<GLogLevelFlags>(G_LOG_LEVEL_INFO);
@@ -1352,6 +1378,65 @@ test_xaccTransBeginEdit ()
     xaccTransDestroy (txn);
     qof_book_destroy (book);
 }
+
+/* xaccTransBeginEdit records what a rollback needs without cloning
+ * the transaction and its splits the way dupe_trans does; only the
+ * slots written during the edit are copied.
+ */
+static void
+test_xaccTransBeginEdit_allocations (Fixture *fixture, gconstpointer pData)
+{
+    Transaction *txn = fixture->txn;
+    auto split1 = static_cast<Split*>(txn->splits->data);
+    auto split2 = static_cast<Split*>(txn->splits->next->data);
+    auto txn_frame = txn->inst.kvp_data;
+    auto split1_frame = split1->inst.kvp_data;
+    auto split2_frame = split2->inst.kvp_data;
+    std::string split2_memo{xaccSplitGetMemo (split2)};
+    GValue v = G_VALUE_INIT;
+
+    allocation_count = 0;
+    allocation_counting = true;
+    auto dupe = fixture->func->dupe_trans (txn);
+    allocation_counting = false;
+    auto dupe_allocations = allocation_count;
+    fixture->func->xaccFreeTransaction (dupe);
+
+    allocation_count = 0;
+    allocation_counting = true;
+    auto undo = fixture->func->trans_undo_new (txn);
+    allocation_counting = false;
+    g_test_message ("C++ allocations: dupe_trans %zu, trans_undo_new %zu",
+                    dupe_allocations, allocation_count);
+    g_assert_cmpuint (dupe_allocations, >, 0);
+    g_assert_cmpuint (allocation_count, ==, 0);
+    g_assert_cmpuint (undo->num_splits, ==, 2);
+    g_assert (undo->splits[0].split == split1);
+    fixture->func->trans_undo_free (txn, undo);
+
+    xaccTransBeginEdit (txn);
+    xaccTransSetDescription (txn, "Salt Peanuts");
+    xaccSplitSetMemo (split2, "baz");
+    xaccTransSetNotes (txn, "Spam");
+    g_value_init (&v, G_TYPE_STRING);
+    g_value_set_string (&v, "FITID0001");
+    qof_instance_set_kvp (QOF_INSTANCE (split1), &v, 1, "online_id");
+    qof_instance_set_dirty (QOF_INSTANCE (split1));
+    g_value_unset (&v);
+    g_assert (txn->inst.kvp_data == txn_frame);
+    g_assert (split2->inst.kvp_data == split2_frame);
+
+    xaccTransRollbackEdit (txn);
+    g_assert_cmpstr (xaccTransGetDescription (txn), ==, "Waldo Pepper");
+    g_assert_cmpstr (xaccTransGetNotes (txn), ==, "Salt pork sausage");
+    g_assert_cmpstr (xaccSplitGetMemo (split2), ==, split2_memo.c_str ());
+    g_assert (xaccSplitGetOnlineID (split1) == NULL);
+    /* The written slots were put back from their copies, the others were
+     * never copied. */
+    g_assert (txn->inst.kvp_data != txn_frame);
+    g_assert (split1->inst.kvp_data != split1_frame);
+    g_assert (split2->inst.kvp_data == split2_frame);
+}
 /* xaccTransDestroy
 void
 xaccTransDestroy (Transaction *trans)// C: 26 in 15 SCM: 4 in 4 Local: 3:0:0
@@ -1488,7 +1573,6 @@ test_trans_cleanup_commit (Fixture *fixture, gconstpointer pData)
     auto bogus_split = xaccMallocSplit (book);
     auto split0 = static_cast<Split*>(fixture->txn->splits->data);
     Account *acct0 = split0->acc;
-    Transaction *orig = NULL;
     auto sig_d_remove = test_signal_new (QOF_INSTANCE (destr_split),
                                QOF_EVENT_REMOVE, NULL);
     auto sig_b_remove = test_signal_new (QOF_INSTANCE (bogus_split),
@@ -1503,8 +1587,7 @@ test_trans_cleanup_commit (Fixture *fixture, gconstpointer pData)
                                 GNC_EVENT_ITEM_CHANGED, NULL);
 
     xaccTransBeginEdit (fixture->txn);
-    orig = fixture->txn->orig;
-    g_object_ref (orig);
+    g_assert (fixture->txn->orig != NULL);
     /* Check the txn-isn't-the-parent path */
     fixture->txn->splits = g_list_prepend (fixture->txn->splits, destr_split);
     fixture->txn->splits = g_list_prepend (fixture->txn->splits, bogus_split);
@@ -1530,15 +1613,13 @@ test_trans_cleanup_commit (Fixture *fixture, gconstpointer pData)
     /* Note that the function itself aborts if qof_instance_editlevel != 0 */
 
     /* load things back up and test the txn-is-the-parent path */
-    qof_instance_increase_editlevel (fixture->txn);
+    xaccTransBeginEdit (fixture->txn);
+    g_assert (fixture->txn->orig != NULL);
     destr_split->parent = fixture->txn;
     bogus_split->parent = fixture->txn;
     fixture->txn->splits = g_list_prepend (fixture->txn->splits, destr_split);
     fixture->txn->splits = g_list_prepend (fixture->txn->splits, bogus_split);
 
-    fixture->txn->orig = orig;
-    orig->num = fixture->txn->num;
-    g_object_ref (orig);
     fixture->func->trans_cleanup_commit (fixture->txn);
 
     g_assert_cmpint (test_signal_return_hits (sig_d_remove), ==, 2);
@@ -1549,8 +1630,7 @@ test_trans_cleanup_commit (Fixture *fixture, gconstpointer pData)
     g_assert_cmpint (test_signal_return_hits (sig_a_changed), ==, 2);
     g_assert_cmpint (g_list_index (fixture->txn->splits, destr_split), ==, -1);
     g_assert_cmpint (g_list_index (fixture->txn->splits, bogus_split), ==, 0);
-    g_assert_cmpint (GPOINTER_TO_INT(orig->num), ==, 1);
-    test_destroy (orig);
+    g_assert (fixture->txn->orig == NULL);
 
 }
 /* xaccTransCommitEdit
@@ -1638,7 +1718,7 @@ static void
 test_xaccTransRollbackEdit (Fixture *fixture, gconstpointer pData)
 {
     Transaction *txn = fixture->txn;
-    Transaction *orig = NULL;
+    TransUndo *orig = NULL;
     QofBook *book = qof_instance_get_book (txn);
     time64 new_post = gnc_time (nullptr);
     time64 new_entered = time64CanonicalDayTime (new_post);
@@ -1655,12 +1735,11 @@ test_xaccTransRollbackEdit (Fixture *fixture, gconstpointer pData)
     xaccTransBeginEdit (txn);
     qof_instance_set_destroying (txn, TRUE);
     orig = txn->orig;
-    base_frame = orig->inst.kvp_data; /* DupeTransaction copies the kvp_frame */
-    g_object_ref (orig); /* Keep rollback from actually freeing it */
+    base_frame = txn->inst.kvp_data; /* Kept, not copied, when replaced */
     txn->num = CACHE_INSERT("321");
     txn->description = CACHE_INSERT("salt peanuts");
     txn->common_currency = NULL;
-    txn->inst.kvp_data = NULL;
+    qof_instance_set_slots (QOF_INSTANCE (txn), new KvpFrame);
     txn->date_entered = new_entered;
     txn->date_posted = new_post;
     txn->splits->data = split_01;
@@ -1668,9 +1747,9 @@ test_xaccTransRollbackEdit (Fixture *fixture, gconstpointer pData)
     qof_instance_set_dirty (QOF_INSTANCE (split_01));
     xaccSplitSetParent (split_02, txn);
     g_object_ref (split_02);
-    auto split_10 = xaccDupeSplit(static_cast<Split*>(orig->splits->data));
+    auto split_10 = xaccDupeSplit(orig->splits[0].split);
     g_object_ref (split_10);
-    auto split_11 = xaccDupeSplit(static_cast<Split*>(orig->splits->next->data));
+    auto split_11 = xaccDupeSplit(orig->splits[1].split);
     g_object_ref (split_11);
     qof_instance_increase_editlevel (QOF_INSTANCE (txn)); /* So it's 2 */
     xaccTransRollbackEdit (txn);
@@ -1682,7 +1761,6 @@ test_xaccTransRollbackEdit (Fixture *fixture, gconstpointer pData)
     xaccTransRollbackEdit (txn);
     g_assert (txn->orig == NULL);
     g_assert_cmpstr (txn->num, ==, "123");
-    g_assert_cmpint (GPOINTER_TO_INT(orig->num), ==, 1);
     g_assert_cmpstr (txn->description, ==, "Waldo Pepper");
     g_assert (txn->inst.kvp_data == base_frame);
     g_assert (txn->common_currency == fixture->curr);
@@ -1702,7 +1780,6 @@ test_xaccTransRollbackEdit (Fixture *fixture, gconstpointer pData)
     g_object_unref (split_10);
     g_object_unref (split_11);
     g_object_unref (split_02);
-    g_object_unref (orig);
 
 }
 /* A second xaccTransRollbackEdit test to check the backend error handling */
@@ -2069,6 +2146,7 @@ test_suite_transaction (void)
 
     GNC_TEST_ADD (suitename, "xaccTransSetCurrency", Fixture, NULL, setup, test_xaccTransSetCurrency, teardown);
     GNC_TEST_ADD_FUNC (suitename, "xaccTransBeginEdit", test_xaccTransBeginEdit);
+    GNC_TEST_ADD (suitename, "xaccTransBeginEdit allocations", Fixture, NULL, setup, test_xaccTransBeginEdit_allocations, teardown);
     GNC_TEST_ADD (suitename, "xaccTransDestroy", Fixture, NULL, setup, test_xaccTransDestroy, teardown);
     GNC_TEST_ADD (suitename, "destroy gains", GainsFixture, NULL, setup_with_gains, test_destroy_gains, teardown_with_gains);
     GNC_TEST_ADD (suitename, "do destroy", GainsFixture, NULL, setup_with_gains, test_do_destroy, teardown_with_gains);
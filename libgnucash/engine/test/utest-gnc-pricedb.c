@@ -719,6 +719,39 @@ test_gnc_pricedb_get_num_prices (PriceDBFixture *fixture, gconstpointer pData)
     int num = gnc_pricedb_get_num_prices(fixture->pricedb);
     g_assert_cmpint(num, ==, 42);
 }
+
+static void
+test_gnc_pricedb_nth_price (PriceDBFixture *fixture, gconstpointer pData)
+{
+    Commodities *c = fixture->com;
+    GHashTable *seen = g_hash_table_new (NULL, NULL);
+    GNCPrice *price;
+    int num = gnc_pricedb_num_prices (fixture->pricedb, c->gbp);
+    int i;
+
+    g_assert_cmpint (num, ==, 23);
+    for (i = 0; i < num; ++i)
+    {
+        price = gnc_pricedb_nth_price (fixture->pricedb, c->gbp, i);
+        g_assert (price != NULL);
+        g_assert (gnc_price_get_commodity (price) == c->gbp);
+        g_assert (!g_hash_table_contains (seen, price));
+        g_hash_table_add (seen, price);
+    }
+    g_assert (gnc_pricedb_nth_price (fixture->pricedb, c->gbp, num) == NULL);
+    g_assert (gnc_pricedb_nth_price (fixture->pricedb, c->gbp, -1) == NULL);
+    g_hash_table_destroy (seen);
+
+    /* Removing a price drops the cached array for the next call. */
+    price = gnc_pricedb_nth_price (fixture->pricedb, c->gbp, 0);
+    gnc_price_ref (price);
+    g_assert (gnc_pricedb_remove_price (fixture->pricedb, price));
+    g_assert_cmpint (gnc_pricedb_num_prices (fixture->pricedb, c->gbp), ==, 22);
+    for (i = 0; i < 22; ++i)
+        g_assert (gnc_pricedb_nth_price (fixture->pricedb, c->gbp, i) != price);
+    g_assert (gnc_pricedb_nth_price (fixture->pricedb, c->gbp, 22) == NULL);
+    gnc_price_unref (price);
+}
 /* pricedb_equal_foreach_pricelist
 static void
 pricedb_equal_foreach_pricelist(gpointer key, gpointer val, gpointer user_data)// Local: 0:1:0
@@ -1349,6 +1382,125 @@ test_gnc_pricedb_convert_balance_nearest_before_price_t64 (PriceDBFixture *fixtu
 
 }
 
+/* gnc_pricedb_convert_balances_nearest_price_t64
+void
+gnc_pricedb_convert_balances_nearest_price_t64(GNCPriceDB *pdb,// Local: 0:0:0
+*/
+static void
+test_gnc_pricedb_convert_balances_nearest_price_t64 (PriceDBFixture *fixture, gconstpointer pData)
+{
+    gnc_numeric balances[] = {gnc_numeric_create(10000, 100),
+                              gnc_numeric_create(2500, 100),
+                              gnc_numeric_zero(),
+                              gnc_numeric_create(-7300, 100),
+                              gnc_numeric_create(10000, 100)};
+    time64 times[] = {gnc_dmy2time64(15, 8, 2011),
+                      gnc_dmy2time64(15, 8, 2011),
+                      gnc_dmy2time64(1, 1, 2010),
+                      gnc_dmy2time64(1, 1, 2010),
+                      gnc_dmy2time64(16, 11, 2012)};
+    const gsize n = G_N_ELEMENTS(balances);
+    gnc_numeric results[G_N_ELEMENTS(balances)];
+    gsize i;
+
+    gnc_pricedb_convert_balances_nearest_price_t64(fixture->pricedb, n,
+                                                   balances, times,
+                                                   fixture->com->usd,
+                                                   fixture->com->gbp,
+                                                   results);
+    for (i = 0; i < n; ++i)
+        g_assert(gnc_numeric_equal(results[i],
+                                   gnc_pricedb_convert_balance_nearest_price_t64(
+                                       fixture->pricedb, balances[i],
+                                       fixture->com->usd, fixture->com->gbp,
+                                       times[i])));
+    g_assert_cmpint(results[0].num, ==, 6186);
+    g_assert_cmpint(results[0].denom, ==, 100);
+    g_assert(gnc_numeric_zero_p(results[2]));
+
+    gnc_pricedb_convert_balances_nearest_before_price_t64(fixture->pricedb, n,
+                                                          balances, times,
+                                                          fixture->com->amzn,
+                                                          fixture->com->aud,
+                                                          results);
+    for (i = 0; i < n; ++i)
+        g_assert(gnc_numeric_equal(results[i],
+                                   gnc_pricedb_convert_balance_nearest_before_price_t64(
+                                       fixture->pricedb, balances[i],
+                                       fixture->com->amzn, fixture->com->aud,
+                                       times[i])));
+}
+
+/* The memoized conversions must follow the prices they were computed
+ * from being added, revalued and removed. */
+static void
+test_gnc_pricedb_conversion_cache (PriceDBFixture *fixture, gconstpointer pData)
+{
+    QofBook *book = qof_instance_get_book(QOF_INSTANCE(fixture->pricedb));
+    time64 t = gnc_dmy2time64(15, 8, 2011);
+    gnc_numeric from = gnc_numeric_create(10000, 100);
+    GNCPrice *price;
+    gnc_commodity *xyz;
+    guint cached;
+    gnc_numeric result =
+        gnc_pricedb_convert_balance_nearest_price_t64(fixture->pricedb, from,
+                                                      fixture->com->usd,
+                                                      fixture->com->aud, t);
+    g_assert_cmpint(result.num, ==, 9391);
+    g_assert_cmpint(result.denom, ==, 100);
+
+    price = construct_price(book, fixture->com->usd, fixture->com->aud, t,
+                            PRICE_SOURCE_USER_PRICE,
+                            gnc_numeric_create(150, 100));
+    g_assert(gnc_pricedb_add_price(fixture->pricedb, price));
+    result = gnc_pricedb_convert_balance_nearest_price_t64(fixture->pricedb,
+                                                           from,
+                                                           fixture->com->usd,
+                                                           fixture->com->aud,
+                                                           t);
+    g_assert_cmpint(result.num, ==, 15000);
+    g_assert_cmpint(result.denom, ==, 100);
+
+    gnc_price_set_value(price, gnc_numeric_create(120, 100));
+    result = gnc_pricedb_convert_balance_nearest_price_t64(fixture->pricedb,
+                                                           from,
+                                                           fixture->com->usd,
+                                                           fixture->com->aud,
+                                                           t);
+    g_assert_cmpint(result.num, ==, 12000);
+    g_assert_cmpint(result.denom, ==, 100);
+
+    g_assert(gnc_pricedb_remove_price(fixture->pricedb, price));
+    result = gnc_pricedb_convert_balance_nearest_price_t64(fixture->pricedb,
+                                                           from,
+                                                           fixture->com->usd,
+                                                           fixture->com->aud,
+                                                           t);
+    g_assert_cmpint(result.num, ==, 9391);
+    g_assert_cmpint(result.denom, ==, 100);
+    gnc_price_unref(price);
+
+    /* Nothing memoized for a commodity outlives it, as a new one could be
+     * allocated at its address. */
+    xyz = gnc_commodity_new(book, "XYZ Corp", "NASDAQ", "XYZ", "", 1);
+    price = construct_price(book, xyz, fixture->com->usd, t,
+                            PRICE_SOURCE_USER_PRICE, gnc_numeric_create(2, 1));
+    g_assert(gnc_pricedb_add_price(fixture->pricedb, price));
+    cached = g_hash_table_size(fixture->pricedb->conversion_cache);
+    result = gnc_pricedb_convert_balance_nearest_price_t64(fixture->pricedb,
+                                                           from, xyz,
+                                                           fixture->com->usd,
+                                                           t);
+    g_assert_cmpint(result.num, ==, 20000);
+    g_assert_cmpuint(g_hash_table_size(fixture->pricedb->conversion_cache), >,
+                     cached);
+    g_assert(gnc_pricedb_remove_price(fixture->pricedb, price));
+    gnc_price_unref(price);
+    gnc_commodity_destroy(xyz);
+    g_assert_cmpuint(g_hash_table_size(fixture->pricedb->conversion_cache), ==,
+                     cached);
+}
+
 static void
 test_gnc_pricedb_get_latest_price (PriceDBFixture *fixture, gconstpointer pData)
 {
@@ -1687,6 +1839,7 @@ GNC_TEST_ADD (suitename, "gnc price list equal", PriceDBFixture, NULL, setup, te
 // GNC_TEST_ADD (suitename, "gnc pricedb get db", Fixture, NULL, setup, test_gnc_pricedb_get_db, teardown);
 // GNC_TEST_ADD (suitename, "num prices helper", Fixture, NULL, setup, test_num_prices_helper, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb get num prices", PriceDBFixture, NULL, setup, test_gnc_pricedb_get_num_prices, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb nth price", PriceDBFixture, NULL, setup, test_gnc_pricedb_nth_price, teardown);
 // GNC_TEST_ADD (suitename, "pricedb equal foreach pricelist", Fixture, NULL, setup, test_pricedb_equal_foreach_pricelist, teardown);
 // GNC_TEST_ADD (suitename, "pricedb equal foreach currencies hash", Fixture, NULL, setup, test_pricedb_equal_foreach_currencies_hash, teardown);
 // GNC_TEST_ADD (suitename, "insert or replace price", Fixture, NULL, setup, test_insert_or_replace_price, teardown);
@@ -1724,6 +1877,8 @@ GNC_TEST_ADD (suitename, "gnc price list equal", PriceDBFixture, NULL, setup, te
     GNC_TEST_ADD (suitename, "gnc pricedb convert balance latest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balance_latest_price, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb convert balance nearest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balance_nearest_price_t64, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb convert balance nearest before price", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balance_nearest_before_price_t64, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb convert balances nearest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_convert_balances_nearest_price_t64, teardown);
+    GNC_TEST_ADD (suitename, "gnc pricedb conversion cache", PriceDBFixture, NULL, setup, test_gnc_pricedb_conversion_cache, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb get latest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_get_latest_price, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb get nearest price", PriceDBFixture, NULL, setup, test_gnc_pricedb_get_nearest_price, teardown);
     GNC_TEST_ADD (suitename, "gnc pricedb get nearest before price", PriceDBFixture, NULL, setup, test_gnc_pricedb_get_nearest_before_price, teardown);